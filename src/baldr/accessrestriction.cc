@@ -1,4 +1,5 @@
 #include "baldr/accessrestriction.h"
+#include <algorithm>
 #include <string.h>
 
 namespace valhalla {
@@ -45,7 +46,69 @@ void AccessRestriction::set_value(const uint64_t v) {
 
 // operator < - for sorting. Sort by route Id.
 bool AccessRestriction::operator<(const AccessRestriction& other) const {
-  return edgeindex() < other.edgeindex();
+  if (edgeindex() != other.edgeindex()) {
+    return edgeindex() < other.edgeindex();
+  }
+  if (type() != other.type()) {
+    return type() < other.type();
+  }
+  if (modes() != other.modes()) {
+    return modes() < other.modes();
+  }
+  return value() < other.value();
+}
+
+// Constructor of a summary without any restrictions.
+TruckRestriction::TruckRestriction(const uint32_t edgeindex, const bool complete)
+    : edgeindex_(edgeindex), incomplete_(!complete), hazmat_(0), spare_(0), max_height_(kNoLimit),
+      max_width_(kNoLimit), max_length_(kNoLimit), max_weight_(kNoLimit),
+      max_axle_load_(kNoLimit), spare2_(0) {
+}
+
+// Adds an access restriction to the summary.
+void TruckRestriction::Add(const AccessRestriction& restriction) {
+  if (!(restriction.modes() & kTruckAccess)) {
+    return;
+  }
+
+  // Keep the smallest limit, limits we cannot store leave it to the access restrictions
+  auto limit = [this, &restriction](uint16_t& max) {
+    if (restriction.value() >= kNoLimit) {
+      incomplete_ = 1;
+    } else {
+      max = std::min(max, static_cast<uint16_t>(restriction.value()));
+    }
+  };
+  switch (restriction.type()) {
+    case AccessType::kHazmat:
+      // a truck is denied unless its hazmat flag equals the value
+      if (restriction.value() != 1) {
+        hazmat_ |= kDeniesHazmat;
+      }
+      if (restriction.value() != 0) {
+        hazmat_ |= kRequiresHazmat;
+      }
+      break;
+    case AccessType::kMaxHeight:
+      limit(max_height_);
+      break;
+    case AccessType::kMaxWidth:
+      limit(max_width_);
+      break;
+    case AccessType::kMaxLength:
+      limit(max_length_);
+      break;
+    case AccessType::kMaxWeight:
+      limit(max_weight_);
+      break;
+    case AccessType::kMaxAxleLoad:
+      limit(max_axle_load_);
+      break;
+    default:
+      // timed restrictions depend on when the edge is reached
+      incomplete_ = 1;
+      break;
+  }
 }
 
 } // namespace baldr
@@ -1,9 +1,13 @@
+#include <algorithm>
+#include <fstream>
 #include <iomanip>
 #include <list>
 #include <random>
 #include <sstream>
 #include <unordered_set>
 
+#include <boost/filesystem/operations.hpp>
+
 #include "baldr/connectivity_map.h"
 #include "baldr/graphreader.h"
 #include "baldr/graphtile.h"
@@ -17,6 +21,42 @@ using namespace valhalla::baldr;
 using namespace valhalla::midgard;
 
 namespace {
+
+// the layout of the connectivity map file, the header is followed by one level header per level
+// and then the colors of each level in the same order
+const std::string kFileMagic = "valhconn";
+constexpr uint32_t kFileVersion = 2;
+struct file_header_t {
+  char magic[8];
+  uint32_t version;
+  uint32_t level_count;
+  uint64_t tile_set;
+};
+struct level_header_t {
+  uint32_t level;
+  uint32_t count;
+  uint64_t offset;
+};
+
+// identifies a set of tiles. the colors only depend on which tiles exist so a map made from a
+// set of tiles with the same id has the same colors
+uint64_t tile_set_id(const std::unordered_set<GraphId>& tiles) {
+  std::vector<uint64_t> ids;
+  ids.reserve(tiles.size());
+  for (const auto& tile : tiles) {
+    ids.push_back(tile.value);
+  }
+  std::sort(ids.begin(), ids.end());
+  // fnv-1a so that the id is the same no matter who computes it
+  uint64_t hash = 14695981039346656037ull;
+  for (auto id : ids) {
+    for (int i = 0; i < 8; ++i, id >>= 8) {
+      hash = (hash ^ (id & 0xff)) * 1099511628211ull;
+    }
+  }
+  return hash;
+}
+
 /*
    { "type": "FeatureCollection",
     "features": [
@@ -222,40 +262,117 @@ polygon_t to_boundary(const std::pair<size_t, std::unordered_set<uint32_t>>& reg
 
 namespace valhalla {
 namespace baldr {
-connectivity_map_t::connectivity_map_t(const boost::property_tree::ptree& pt) {
+connectivity_map_t::connectivity_map_t(const boost::property_tree::ptree& pt, bool use_file) {
+  transit_level = TileHierarchy::levels().rbegin()->second.level + 1;
+
   // See what kind of tiles we are dealing with here by getting a graphreader
   GraphReader reader(pt);
   auto tiles = reader.GetTileSet();
-  transit_level = TileHierarchy::levels().rbegin()->second.level + 1;
+  tile_set = tile_set_id(tiles);
+
+  // Load the precomputed colors if we have them
+  auto file_name = pt.get_optional<std::string>("connectivity_map");
+  if (use_file && file_name && boost::filesystem::is_regular_file(*file_name)) {
+    auto size = boost::filesystem::file_size(*file_name);
+    if (size < sizeof(file_header_t)) {
+      throw std::runtime_error(*file_name + " is not a connectivity map");
+    }
+    file.map(*file_name, size);
+    const auto* header = reinterpret_cast<const file_header_t*>(file.get());
+    if (std::string(header->magic, sizeof(header->magic)) != kFileMagic ||
+        header->version != kFileVersion ||
+        size < sizeof(file_header_t) + header->level_count * sizeof(level_header_t)) {
+      throw std::runtime_error(*file_name + " is not a connectivity map or the wrong version");
+    }
+    // The colors are only good for the tiles they were made from
+    if (header->tile_set == tile_set) {
+      const auto* level = reinterpret_cast<const level_header_t*>(header + 1);
+      for (uint32_t i = 0; i < header->level_count; ++i, ++level) {
+        if (level->offset + level->count * sizeof(uint32_t) > size) {
+          throw std::runtime_error(*file_name + " is truncated");
+        }
+        colors[level->level] = {reinterpret_cast<const uint32_t*>(file.get() + level->offset),
+                                level->count};
+      }
+      LOG_INFO("Loaded connectivity map from " + *file_name);
+      return;
+    }
+    LOG_WARN(*file_name + " was made from other tiles, computing the connectivity instead");
+    file.unmap();
+  }
 
   // Populate a map for each level of the tiles that exist
+  std::unordered_map<uint32_t, std::unordered_map<uint32_t, size_t>> level_tile_colors;
   for (const auto& t : tiles) {
     auto& level_colors =
-        colors.insert({t.level(), std::unordered_map<uint32_t, size_t>{}}).first->second;
+        level_tile_colors.insert({t.level(), std::unordered_map<uint32_t, size_t>{}}).first->second;
     level_colors.insert({t.tileid(), 0});
   }
 
   // All tiles have color 0 (not connected), go through and connect
-  // (build the ColorMap). Transit level uses local hierarchy tiles
-  for (auto& color : colors) {
-    if (color.first == transit_level) {
-      TileHierarchy::levels().rbegin()->second.tiles.ColorMap(color.second);
-    } else {
-      TileHierarchy::levels().find(color.first)->second.tiles.ColorMap(color.second);
+  // (build the ColorMap). Transit level uses local hierarchy tiles.
+  // Then flatten them to one color per possible tile
+  for (auto& level_colors : level_tile_colors) {
+    const auto& tiles = level_tiles(level_colors.first);
+    tiles.ColorMap(level_colors.second);
+    computed.emplace_back(tiles.nrows() * tiles.ncolumns(), 0);
+    for (const auto& color : level_colors.second) {
+      computed.back()[color.first] = static_cast<uint32_t>(color.second);
     }
+    colors[level_colors.first] = {computed.back().data(),
+                                  static_cast<uint32_t>(computed.back().size())};
   }
 }
 
-size_t connectivity_map_t::get_color(const GraphId& id) const {
-  auto level = colors.find(id.level());
-  if (level == colors.cend()) {
-    return 0;
+void connectivity_map_t::write(const std::string& file_name) const {
+  std::ofstream out(file_name, std::ios::binary | std::ios::out | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Unable to open output file: " + file_name);
+  }
+
+  // the header says where the colors of each level are
+  file_header_t header{};
+  std::copy(kFileMagic.cbegin(), kFileMagic.cend(), header.magic);
+  header.version = kFileVersion;
+  header.level_count = colors.size();
+  header.tile_set = tile_set;
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  uint64_t offset = sizeof(file_header_t) + colors.size() * sizeof(level_header_t);
+  for (const auto& level : colors) {
+    level_header_t level_header{level.first, level.second.count, offset};
+    out.write(reinterpret_cast<const char*>(&level_header), sizeof(level_header));
+    offset += level.second.count * sizeof(uint32_t);
+  }
+
+  // followed by the colors themselves in the same order
+  for (const auto& level : colors) {
+    out.write(reinterpret_cast<const char*>(level.second.colors),
+              level.second.count * sizeof(uint32_t));
+  }
+  if (!out) {
+    throw std::runtime_error("Failed to write " + file_name);
   }
-  auto color = level->second.find(id.tileid());
-  if (color == level->second.cend()) {
+}
+
+uint32_t connectivity_map_t::color(uint32_t hierarchy_level, uint32_t tile_id) const {
+  auto level = colors.find(hierarchy_level);
+  if (level == colors.cend() || tile_id >= level->second.count) {
     return 0;
   }
-  return color->second;
+  return level->second.colors[tile_id];
+}
+
+const Tiles<PointLL>& connectivity_map_t::level_tiles(uint32_t hierarchy_level) const {
+  uint32_t tile_level = (hierarchy_level == transit_level) ? transit_level - 1 : hierarchy_level;
+  auto level = TileHierarchy::levels().find(tile_level);
+  if (level == TileHierarchy::levels().cend()) {
+    throw std::runtime_error("hierarchy level not found");
+  }
+  return level->second.tiles;
+}
+
+size_t connectivity_map_t::get_color(const GraphId& id) const {
+  return color(id.level(), id.tileid());
 }
 
 std::unordered_set<size_t> connectivity_map_t::get_colors(uint32_t hierarchy_level,
@@ -263,11 +380,10 @@ std::unordered_set<size_t> connectivity_map_t::get_colors(uint32_t hierarchy_lev
                                                           float radius) const {
 
   std::unordered_set<size_t> result;
-  auto level = colors.find(hierarchy_level);
-  if (level == colors.cend()) {
+  if (colors.find(hierarchy_level) == colors.cend()) {
     return result;
   }
-  const auto& tiles = TileHierarchy::levels().find(hierarchy_level)->second.tiles;
+  const auto& tiles = level_tiles(hierarchy_level);
   for (const auto& edge : location.edges) {
     // Get a list of tiles required within the radius of the projected point
     const auto& ll = edge.projected;
@@ -278,9 +394,9 @@ std::unordered_set<size_t> connectivity_map_t::get_colors(uint32_t hierarchy_lev
                         Point2(ll.lng() + lngdeg, ll.lat() + latdeg));
     std::vector<int32_t> tilelist = tiles.TileList(bbox);
     for (auto& id : tilelist) {
-      auto color = level->second.find(id);
-      if (color != level->second.cend()) {
-        result.emplace(color->second);
+      auto tile_color = color(hierarchy_level, id);
+      if (tile_color != 0) {
+        result.emplace(tile_color);
       }
     }
   }
@@ -289,23 +405,23 @@ std::unordered_set<size_t> connectivity_map_t::get_colors(uint32_t hierarchy_lev
 
 std::string connectivity_map_t::to_geojson(const uint32_t hierarchy_level) const {
   // bail if we dont have the level
-  uint32_t tile_level = (hierarchy_level == transit_level) ? transit_level - 1 : hierarchy_level;
-  auto bbox = TileHierarchy::levels().find(tile_level);
-  if (bbox == TileHierarchy::levels().cend()) {
-    throw std::runtime_error("hierarchy level not found");
-  }
+  const auto& tiles = level_tiles(hierarchy_level);
 
   // make a region map (inverse mapping of color to lists of tiles)
   // could cache this but shouldnt need to call it much
   std::unordered_map<size_t, std::unordered_set<uint32_t>> regions;
   auto level = colors.find(hierarchy_level);
   if (level != colors.cend()) {
-    for (const auto& tile : level->second) {
-      auto region = regions.find(tile.second);
+    for (uint32_t tile = 0; tile < level->second.count; ++tile) {
+      auto tile_color = level->second.colors[tile];
+      if (tile_color == 0) {
+        continue;
+      }
+      auto region = regions.find(tile_color);
       if (region == regions.end()) {
-        regions.emplace(tile.second, std::unordered_set<uint32_t>{tile.first});
+        regions.emplace(tile_color, std::unordered_set<uint32_t>{tile});
       } else {
-        region->second.emplace(tile.first);
+        region->second.emplace(tile);
       }
     }
   }
@@ -321,7 +437,7 @@ std::string connectivity_map_t::to_geojson(const uint32_t hierarchy_level) const
   std::unordered_map<size_t, polygon_t> boundaries;
   for (const auto& arity : arities) {
     auto& region = *regions.find(arity.second);
-    boundaries.emplace(arity.second, to_boundary(region, bbox->second.tiles));
+    boundaries.emplace(arity.second, to_boundary(region, tiles));
   }
 
   // turn it into geojson
@@ -329,22 +445,11 @@ std::string connectivity_map_t::to_geojson(const uint32_t hierarchy_level) const
 }
 
 std::vector<size_t> connectivity_map_t::to_image(const uint32_t hierarchy_level) const {
-  uint32_t tile_level = (hierarchy_level == transit_level) ? transit_level - 1 : hierarchy_level;
-  auto bbox = TileHierarchy::levels().find(tile_level);
-  if (bbox == TileHierarchy::levels().cend()) {
-    throw std::runtime_error("hierarchy level not found");
-  }
-
-  std::vector<size_t> tiles(bbox->second.tiles.nrows() * bbox->second.tiles.ncolumns(),
+  const auto& level_tile_set = level_tiles(hierarchy_level);
+  std::vector<size_t> tiles(level_tile_set.nrows() * level_tile_set.ncolumns(),
                             static_cast<uint32_t>(0));
-  auto level = colors.find(hierarchy_level);
-  if (level != colors.cend()) {
-    for (size_t i = 0; i < tiles.size(); ++i) {
-      const auto color = level->second.find(static_cast<uint32_t>(i));
-      if (color != level->second.cend()) {
-        tiles[i] = color->second;
-      }
-    }
+  for (size_t i = 0; i < tiles.size(); ++i) {
+    tiles[i] = color(hierarchy_level, static_cast<uint32_t>(i));
   }
 
   return tiles;
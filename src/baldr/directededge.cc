@@ -2,6 +2,8 @@
 #include "baldr/nodeinfo.h"
 #include "midgard/logging.h"
 
+#include <algorithm>
+
 using namespace valhalla::baldr;
 
 namespace {
@@ -157,6 +159,12 @@ void DirectedEdge::set_shoulder(const bool shoulder) {
   shoulder_ = shoulder;
 }
 
+// Sets the reachability of this edge
+void DirectedEdge::set_reach(const uint32_t forward) {
+  forward_reach_ = std::min(forward, kMaxStoredReach);
+  has_reach_ = true;
+}
+
 // Set if bikers need to dismount along the edge
 void DirectedEdge::set_dismount(const bool dismount) {
   dismount_ = dismount;
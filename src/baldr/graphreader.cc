@@ -1,5 +1,6 @@
 #include "baldr/graphreader.h"
 
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <string>
@@ -17,6 +18,17 @@ namespace {
 constexpr size_t DEFAULT_MAX_CACHE_SIZE = 1073741824; // 1 gig
 constexpr size_t AVERAGE_TILE_SIZE = 2097152;         // 2 megs
 constexpr size_t AVERAGE_MM_TILE_SIZE = 1024;         // 1k
+
+// Extracts written by valhalla_build_extract start with an index of where each tile is in the
+// archive so that we dont have to rip through every header in the tar to find them. The index
+// is a regular file in the tar and is made up of one of these entries per tile
+constexpr char INDEX_FILE_NAME[] = "index.bin";
+struct tile_index_entry_t {
+  uint64_t offset;  // byte offset from the start of the archive to the tile's data
+  uint32_t tile_id; // just the level and tile id bits of the graph id
+  uint32_t size;    // size of the tile in bytes
+};
+static_assert(sizeof(tile_index_entry_t) == 16, "Unexpected tile index entry size");
 } // namespace
 
 namespace valhalla {
@@ -27,15 +39,18 @@ struct GraphReader::tile_extract_t {
     // if you really meant to load it
     if (pt.get_optional<std::string>("tile_extract")) {
       try {
-        // load the tar
-        archive.reset(new midgard::tar(pt.get<std::string>("tile_extract")));
-        // map files to graph ids
-        for (auto& c : archive->contents) {
-          try {
-            auto id = GraphTile::GetTileId(c.first);
-            tiles[id] = std::make_pair(const_cast<char*>(c.second.first), c.second.second);
-          } catch (...) {
-            // skip files we dont understand
+        // map the tar but only look through it if it doesnt come with an index
+        archive.reset(new midgard::tar(pt.get<std::string>("tile_extract"), true, false));
+        if (!load_index()) {
+          archive->traverse();
+          // map files to graph ids
+          for (auto& c : archive->contents) {
+            try {
+              auto id = GraphTile::GetTileId(c.first);
+              tiles[id] = std::make_pair(const_cast<char*>(c.second.first), c.second.second);
+            } catch (...) {
+              // skip files we dont understand
+            }
           }
         }
         // couldn't load it
@@ -56,6 +71,35 @@ struct GraphReader::tile_extract_t {
       }
     }
   }
+  // find the tiles using the index at the start of the archive, false if there isnt a usable one
+  bool load_index() {
+    const auto* header = archive->first();
+    if (header == nullptr ||
+        std::string(header->name, strnlen(header->name, sizeof(header->name))) != INDEX_FILE_NAME) {
+      return false;
+    }
+    auto index_size = header->get_file_size();
+    const char* begin = archive->mm.get() + sizeof(*header);
+    if (index_size % sizeof(tile_index_entry_t) != 0 ||
+        begin + index_size > archive->mm.get() + archive->mm.size()) {
+      LOG_WARN("Tile extract index is malformed, scanning the archive instead");
+      return false;
+    }
+
+    // the index says where each tile is, make sure it doesnt point outside the archive
+    const auto* entry = reinterpret_cast<const tile_index_entry_t*>(begin);
+    const auto* end = entry + index_size / sizeof(tile_index_entry_t);
+    tiles.reserve(end - entry);
+    for (; entry < end; ++entry) {
+      if (entry->offset + entry->size > archive->mm.size()) {
+        LOG_WARN("Tile extract index points past the end of the archive, scanning it instead");
+        tiles.clear();
+        return false;
+      }
+      tiles[entry->tile_id] = std::make_pair(archive->mm.get() + entry->offset, entry->size);
+    }
+    return true;
+  }
   // TODO: dont remove constness, and actually make graphtile read only?
   std::unordered_map<uint64_t, std::pair<char*, size_t>> tiles;
   std::shared_ptr<midgard::tar> archive;
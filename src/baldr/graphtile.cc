@@ -7,6 +7,7 @@
 #include "midgard/pointll.h"
 #include "midgard/tiles.h"
 
+#include <algorithm>
 #include <boost/algorithm/string.hpp>
 #include <cmath>
 #include <ctime>
@@ -40,8 +41,8 @@ namespace baldr {
 GraphTile::GraphTile()
     : header_(nullptr), nodes_(nullptr), directededges_(nullptr), departures_(nullptr),
       transit_stops_(nullptr), transit_routes_(nullptr), transit_schedules_(nullptr),
-      transit_transfers_(nullptr), access_restrictions_(nullptr), signs_(nullptr), admins_(nullptr),
-      edge_bins_(nullptr), complex_restriction_forward_(nullptr),
+      transit_transfers_(nullptr), access_restrictions_(nullptr), truck_restrictions_(nullptr),
+      signs_(nullptr), admins_(nullptr), edge_bins_(nullptr), complex_restriction_forward_(nullptr),
       complex_restriction_reverse_(nullptr), edgeinfo_(nullptr), textlist_(nullptr),
       complex_restriction_forward_size_(0), complex_restriction_reverse_size_(0), edgeinfo_size_(0),
       textlist_size_(0), traffic_segments_(nullptr), traffic_chunks_(nullptr), traffic_chunk_size_(0),
@@ -168,6 +169,14 @@ void GraphTile::Initialize(const GraphId& graphid, char* tile_ptr, const size_t
   access_restrictions_ = reinterpret_cast<AccessRestriction*>(ptr);
   ptr += header_->access_restriction_count() * sizeof(AccessRestriction);
 
+  // Set a pointer to the truck restriction summaries, older tiles do not have them
+  if (header_->format_version() >= kTruckRestrictionFormatVersion) {
+    truck_restrictions_ = reinterpret_cast<TruckRestriction*>(ptr);
+    ptr += header_->truck_restriction_count() * sizeof(TruckRestriction);
+  } else {
+    truck_restrictions_ = nullptr;
+  }
+
   // Set a pointer to the transit departure list
   departures_ = reinterpret_cast<TransitDeparture*>(ptr);
   ptr += header_->departurecount() * sizeof(TransitDeparture);
@@ -495,30 +504,14 @@ EdgeInfo GraphTile::edgeinfo(const size_t offset) const {
 
 // Get the complex restrictions in the forward or reverse order based on
 // the id and modes.
-std::vector<ComplexRestriction*>
+ComplexRestrictionView
 GraphTile::GetRestrictions(const bool forward, const GraphId id, const uint64_t modes) const {
-  size_t offset = 0;
-  std::vector<ComplexRestriction*> cr_vector;
   if (forward) {
-    while (offset < complex_restriction_forward_size_) {
-      ComplexRestriction* cr =
-          reinterpret_cast<ComplexRestriction*>(complex_restriction_forward_ + offset);
-      if (cr->to_graphid() == id && (cr->modes() & modes)) {
-        cr_vector.push_back(cr);
-      }
-      offset += cr->SizeOf();
-    }
-  } else {
-    while (offset < complex_restriction_reverse_size_) {
-      ComplexRestriction* cr =
-          reinterpret_cast<ComplexRestriction*>(complex_restriction_reverse_ + offset);
-      if (cr->from_graphid() == id && (cr->modes() & modes)) {
-        cr_vector.push_back(cr);
-      }
-      offset += cr->SizeOf();
-    }
+    return ComplexRestrictionView(complex_restriction_forward_, complex_restriction_forward_size_,
+                                  true, id, modes);
   }
-  return cr_vector;
+  return ComplexRestrictionView(complex_restriction_reverse_, complex_restriction_reverse_size_,
+                                false, id, modes);
 }
 
 // Get the directed edges outbound from the specified node index.
@@ -870,45 +863,35 @@ const TransitSchedule* GraphTile::GetTransitSchedule(const uint32_t idx) const {
 }
 
 // Get the access restriction given its directed edge index
-std::vector<AccessRestriction> GraphTile::GetAccessRestrictions(const uint32_t idx,
-                                                                const uint32_t access) const {
-
-  std::vector<AccessRestriction> restrictions;
-  uint32_t count = header_->access_restriction_count();
-  if (count == 0) {
-    return restrictions;
-  }
-
-  // Access restriction are sorted by edge Id.
-  // Binary search to find a access restriction with matching edge Id.
-  int32_t low = 0;
-  int32_t high = count - 1;
-  int32_t mid;
-  int32_t found = count;
-  while (low <= high) {
-    mid = (low + high) / 2;
-    const auto& res = access_restrictions_[mid];
-    // find the first matching index in the list
-    if (idx == res.edgeindex()) {
-      found = mid;
-      high = mid - 1;
-    } // need a smaller index
-    else if (idx < res.edgeindex()) {
-      high = mid - 1;
-    } // need a bigger index
-    else {
-      low = mid + 1;
-    }
-  }
-
-  // Add restrictions for only the access that we are interested in
-  for (; found < count && access_restrictions_[found].edgeindex() == idx; ++found) {
-    if (access_restrictions_[found].modes() & access) {
-      restrictions.emplace_back(access_restrictions_[found]);
-    }
-  }
-
-  return restrictions;
+AccessRestrictionView GraphTile::GetAccessRestrictions(const uint32_t idx,
+                                                       const uint32_t access) const {
+  // Access restriction are sorted by edge Id so binary search for the ones on this edge
+  const AccessRestriction* begin = access_restrictions_;
+  const AccessRestriction* end = access_restrictions_ + header_->access_restriction_count();
+  auto first = std::lower_bound(begin, end, idx, [](const AccessRestriction& res, uint32_t i) {
+    return res.edgeindex() < i;
+  });
+  auto last = std::upper_bound(first, end, idx, [](uint32_t i, const AccessRestriction& res) {
+    return i < res.edgeindex();
+  });
+  return AccessRestrictionView(first, last, access);
+}
+
+// Get the truck restriction summary of an edge.
+const TruckRestriction* GraphTile::GetTruckRestriction(const uint32_t idx) const {
+  // Tiles built before summaries existed have to check the access restrictions
+  static const TruckRestriction kIncomplete(0, false);
+  if (truck_restrictions_ == nullptr) {
+    return &kIncomplete;
+  }
+
+  // Summaries are sorted by edge Id so binary search for this edge
+  const TruckRestriction* begin = truck_restrictions_;
+  const TruckRestriction* end = truck_restrictions_ + header_->truck_restriction_count();
+  auto found = std::lower_bound(begin, end, idx, [](const TruckRestriction& res, uint32_t i) {
+    return res.edgeindex() < i;
+  });
+  return (found != end && found->edgeindex() == idx) ? found : nullptr;
 }
 
 // Get the array of graphids for this bin
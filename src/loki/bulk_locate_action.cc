@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <sstream>
+#include <thread>
+
+#include "loki/search.h"
+#include "loki/worker.h"
+#include "tyr/serializers.h"
+
+using namespace valhalla;
+using namespace valhalla::baldr;
+
+namespace {
+
+// how many locations a search thread takes at a time
+constexpr size_t kBulkChunkSize = 1024;
+
+} // namespace
+
+namespace valhalla {
+namespace loki {
+
+void loki_worker_t::init_bulk_locate(valhalla_request_t& request) {
+  // lots of points are cheaper to send as a shape or an encoded polyline
+  if (request.options.locations_size() == 0) {
+    request.options.mutable_locations()->Swap(request.options.mutable_shape());
+  }
+  parse_locations(request.options.mutable_locations(), valhalla_exception_t{120});
+  if (static_cast<size_t>(request.options.locations_size()) > max_bulk_locations) {
+    throw valhalla_exception_t{150, std::to_string(max_bulk_locations)};
+  }
+  if (request.options.has_costing()) {
+    parse_costing(request);
+  } else {
+    edge_filter = loki::PassThroughEdgeFilter;
+    node_filter = loki::PassThroughNodeFilter;
+    stored_reach = false;
+    filter_signature = 0;
+  }
+
+  // each search thread needs a reader of its own, we keep them around between requests. a machine
+  // usually runs several workers so we never go past the hardware threads and 0 means just one
+  if (bulk_readers.empty()) {
+    auto threads = std::max(std::min(bulk_locate_threads,
+                                     static_cast<size_t>(std::thread::hardware_concurrency())),
+                            static_cast<size_t>(1));
+    for (size_t i = 0; i < threads; ++i) {
+      bulk_readers.emplace_back(new baldr::GraphReader(config.get_child("mjolnir")));
+    }
+  }
+}
+
+std::string loki_worker_t::bulk_locate(valhalla_request_t& request) {
+  init_bulk_locate(request);
+  auto locations = PathLocation::fromPBF(request.options.locations());
+  std::vector<GraphReader*> readers;
+  for (const auto& bulk_reader : bulk_readers) {
+    readers.push_back(bulk_reader.get());
+  }
+
+  // serialize each result as soon as its ready, in the order of the input, so that only the json
+  // is kept around rather than all of the correlations. the response still goes out in one piece
+  std::stringstream ss;
+  ss << '[';
+  loki::BulkSearch(locations, readers,
+                   [&](size_t index, const PathLocation* projection) {
+                     if (index > 0) {
+                       ss << ',';
+                     }
+                     tyr::serializeLocation(request, locations[index], projection, *reader, ss);
+                   },
+                   edge_filter, node_filter, stored_reach, kBulkChunkSize, interrupt);
+  ss << ']';
+  return ss.str();
+}
+
+} // namespace loki
+} // namespace valhalla
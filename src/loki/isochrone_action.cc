@@ -81,7 +81,7 @@ void loki_worker_t::isochrones(valhalla_request_t& request) {
   try {
     // correlate the various locations to the underlying graph
     auto locations = PathLocation::fromPBF(request.options.locations());
-    const auto projections = loki::Search(locations, *reader, edge_filter, node_filter);
+    const auto projections = search(locations);
     for (size_t i = 0; i < locations.size(); ++i) {
       const auto& projection = projections.at(locations[i]);
       PathLocation::toPBF(projection, request.options.mutable_locations(i), *reader);
@@ -18,6 +18,8 @@ void loki_worker_t::init_locate(valhalla_request_t& request) {
   } else {
     edge_filter = loki::PassThroughEdgeFilter;
     node_filter = loki::PassThroughNodeFilter;
+    stored_reach = false;
+    filter_signature = 0;
   }
 }
 
@@ -25,7 +27,7 @@ std::string loki_worker_t::locate(valhalla_request_t& request) {
   // correlate the various locations to the underlying graph
   init_locate(request);
   auto locations = PathLocation::fromPBF(request.options.locations());
-  auto projections = loki::Search(locations, *reader, edge_filter, node_filter);
+  auto projections = search(locations);
   return tyr::serializeLocate(request, locations, projections, *reader);
 }
 
@@ -85,7 +85,7 @@ void loki_worker_t::route(valhalla_request_t& request) {
   std::unordered_map<size_t, size_t> color_counts;
   try {
     auto locations = PathLocation::fromPBF(request.options.locations());
-    const auto projections = loki::Search(locations, *reader, edge_filter, node_filter);
+    const auto projections = search(locations);
     for (size_t i = 0; i < locations.size(); ++i) {
       const auto& correlated = projections.at(locations[i]);
       PathLocation::toPBF(correlated, request.options.mutable_locations(i), *reader);
@@ -5,11 +5,21 @@
 #include "midgard/util.h"
 
 #include <algorithm>
+#include <chrono>
 #include <cmath>
+#include <condition_variable>
+#include <exception>
 #include <iterator>
 #include <list>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 using namespace valhalla::midgard;
 using namespace valhalla::baldr;
 using namespace valhalla::sif;
@@ -103,6 +113,92 @@ struct candidate_t {
   }
 };
 
+// The decoded shape of an edge. The coordinates are kept in separate arrays so that the
+// projection below can work on several segments at once
+struct shape_buffer_t {
+  void decode(Shape7Decoder<PointLL> shape) {
+    lngs.clear();
+    lats.clear();
+    while (!shape.empty()) {
+      auto point = shape.pop();
+      lngs.push_back(point.lng());
+      lats.push_back(point.lat());
+    }
+    if (lngs.empty()) {
+      return;
+    }
+    auto lng_range = std::minmax_element(lngs.cbegin(), lngs.cend());
+    auto lat_range = std::minmax_element(lats.cbegin(), lats.cend());
+    min_lng = *lng_range.first;
+    max_lng = *lng_range.second;
+    min_lat = *lat_range.first;
+    max_lat = *lat_range.second;
+    sq_distances.resize(segments());
+  }
+
+  size_t segments() const {
+    return lngs.size() > 1 ? lngs.size() - 1 : 0;
+  }
+
+  std::vector<float> lngs;
+  std::vector<float> lats;
+  std::vector<float> sq_distances;
+  float min_lng, max_lng;
+  float min_lat, max_lat;
+};
+
+// The squared distance from the point to each segment of the shape. The longitude is scaled
+// when projecting onto the segments the same way projector_t::project does. Where SSE is
+// available 4 segments are done per instruction
+void segment_sq_distances(const float* x,
+                          const float* y,
+                          const size_t count,
+                          const float px,
+                          const float py,
+                          const float lon_scale,
+                          const float m_per_lng,
+                          float* sq_distances) {
+  size_t i = 0;
+#if defined(__SSE2__)
+  const __m128 vpx = _mm_set1_ps(px);
+  const __m128 vpy = _mm_set1_ps(py);
+  const __m128 vscale = _mm_set1_ps(lon_scale);
+  const __m128 vmx = _mm_set1_ps(m_per_lng);
+  const __m128 vmy = _mm_set1_ps(kMetersPerDegreeLat);
+  const __m128 zero = _mm_setzero_ps();
+  const __m128 one = _mm_set1_ps(1.f);
+  for (; i + 4 <= count; i += 4) {
+    __m128 ux = _mm_loadu_ps(x + i);
+    __m128 uy = _mm_loadu_ps(y + i);
+    __m128 bx = _mm_sub_ps(_mm_loadu_ps(x + i + 1), ux);
+    __m128 by = _mm_sub_ps(_mm_loadu_ps(y + i + 1), uy);
+    __m128 bx2 = _mm_mul_ps(bx, vscale);
+    __m128 sq = _mm_add_ps(_mm_mul_ps(bx2, bx2), _mm_mul_ps(by, by));
+    __m128 dot = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_sub_ps(vpx, ux), vscale), bx2),
+                            _mm_mul_ps(_mm_sub_ps(vpy, uy), by));
+    // zero length segments project onto their start
+    __m128 nonzero = _mm_cmpgt_ps(sq, zero);
+    __m128 t = _mm_div_ps(dot, _mm_or_ps(_mm_and_ps(nonzero, sq), _mm_andnot_ps(nonzero, one)));
+    t = _mm_min_ps(_mm_max_ps(t, zero), one);
+    __m128 dx = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(ux, _mm_mul_ps(bx, t)), vpx), vmx);
+    __m128 dy = _mm_mul_ps(_mm_sub_ps(_mm_add_ps(uy, _mm_mul_ps(by, t)), vpy), vmy);
+    _mm_storeu_ps(sq_distances + i, _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)));
+  }
+#endif
+  // the rest of them or all of them without SSE
+  for (; i < count; ++i) {
+    float bx = x[i + 1] - x[i];
+    float by = y[i + 1] - y[i];
+    float bx2 = bx * lon_scale;
+    float sq = bx2 * bx2 + by * by;
+    float dot = (px - x[i]) * lon_scale * bx2 + (py - y[i]) * by;
+    float t = sq > 0.f ? std::min(std::max(dot / sq, 0.f), 1.f) : 0.f;
+    float dx = (x[i] + bx * t - px) * m_per_lng;
+    float dy = (y[i] + by * t - py) * kMetersPerDegreeLat;
+    sq_distances[i] = dx * dx + dy * dy;
+  }
+}
+
 // This structure contains the context of the projection of a
 // Location.  At the creation, a bin is affected to the point.  The
 // test() method should be called to each valid segment of the bin.
@@ -114,7 +210,8 @@ struct projector_t {
       : binner(make_binner(location.latlng_, reader)), location(location),
         sq_radius(location.radius_ * location.radius_),
         lon_scale(cosf(location.latlng_.lat() * kRadPerDeg)), lat(location.latlng_.lat()),
-        lng(location.latlng_.lng()), approx(location.latlng_) {
+        lng(location.latlng_.lng()), approx(location.latlng_),
+        m_per_lng(approx.GetLngScale() * kMetersPerDegreeLat) {
     // TODO: something more empirical based on radius
     unreachable.reserve(64);
     reachable.reserve(64);
@@ -168,10 +265,47 @@ struct projector_t {
     } while (!cur_tile);
   }
 
+  // Whether any point on the shape could be kept as a candidate. No point on the shape can be
+  // closer than its bounding box so if the box is outside of the radius and farther than the last
+  // candidates we already found there is no need to look at the shape at all
+  bool may_accept(const shape_buffer_t& shape) const {
+    if (shape.segments() == 0) {
+      return false;
+    }
+    float dx = std::max(std::max(shape.min_lng - lng, lng - shape.max_lng), 0.f) * m_per_lng;
+    float dy =
+        std::max(std::max(shape.min_lat - lat, lat - shape.max_lat), 0.f) * kMetersPerDegreeLat;
+    float bound = dx * dx + dy * dy;
+    auto rejects = [this, bound](const std::vector<candidate_t>& batch) {
+      return !batch.empty() && bound > sq_radius && bound > batch.back().sq_distance;
+    };
+    return !(rejects(reachable) && rejects(unreachable));
+  }
+
+  // Find the closest point on the shape. The distances to all of the segments are computed at once
+  // and only the closest segment is then projected onto exactly
+  void project(shape_buffer_t& shape, candidate_t& candidate) const {
+    const size_t count = shape.segments();
+    const float* x = shape.lngs.data();
+    const float* y = shape.lats.data();
+    const float* sq_distances = shape.sq_distances.data();
+    segment_sq_distances(x, y, count, lng, lat, lon_scale, m_per_lng, shape.sq_distances.data());
+
+    size_t best = 0;
+    for (size_t i = 1; i < count; ++i) {
+      if (sq_distances[i] < sq_distances[best]) {
+        best = i;
+      }
+    }
+    candidate.point = project(PointLL(x[best], y[best]), PointLL(x[best + 1], y[best + 1]));
+    candidate.sq_distance = approx.DistanceSquared(candidate.point);
+    candidate.index = best;
+  }
+
   // Test if a segment is a candidate to the projection.  This method
   // is performance critical.  Copy, function call, cache locality and
   // useless computation must be handled with care.
-  PointLL project(const PointLL& u, const PointLL& v) {
+  PointLL project(const PointLL& u, const PointLL& v) const {
     // we're done if this is a zero length segment
     if (u == v) {
       return u;
@@ -213,6 +347,7 @@ struct projector_t {
   float lat;
   float lng;
   DistanceApproximator approx;
+  float m_per_lng;
 };
 
 struct bin_handler_t {
@@ -220,8 +355,10 @@ struct bin_handler_t {
   valhalla::baldr::GraphReader& reader;
   const EdgeFilter& edge_filter;
   const NodeFilter& node_filter;
+  bool stored_reach;
   unsigned int max_reach_limit;
   std::vector<candidate_t> bin_candidates;
+  shape_buffer_t shape;
   std::unordered_set<uint64_t> correlated_edges;
 
   // key is the edge id, size_t is the index into the reachability number
@@ -237,14 +374,15 @@ struct bin_handler_t {
   struct reachability_t {
     size_t round;
     unsigned int forward_reach;
-    unsigned int backward_reach;
   };
 
   bin_handler_t(const std::vector<valhalla::baldr::Location>& locations,
                 valhalla::baldr::GraphReader& reader,
                 const EdgeFilter& edge_filter,
-                const NodeFilter& node_filter)
-      : reader(reader), edge_filter(edge_filter), node_filter(node_filter) {
+                const NodeFilter& node_filter,
+                bool stored_reach)
+      : reader(reader), edge_filter(edge_filter), node_filter(node_filter),
+        stored_reach(stored_reach) {
     // get the unique set of input locations and the max reachability of them all
     std::unordered_set<Location> uniq_locations(locations.begin(), locations.end());
     pps.reserve(uniq_locations.size());
@@ -262,8 +400,18 @@ struct bin_handler_t {
     reaches.reserve(std::max(max_reach_limit, static_cast<decltype(max_reach_limit)>(1)) * 1024);
   }
 
+  // whether the reach stored in the tile answers the question for this limit. below the cap its
+  // the exact reach but at the cap we only know that its at least that much
+  bool has_stored_reach(const DirectedEdge* edge) const {
+    return stored_reach && edge->has_reach() &&
+           (edge->forward_reach() < kMaxStoredReach || max_reach_limit <= kMaxStoredReach);
+  }
+
   // returns 0 when we dont know it
   unsigned int get_reach(const DirectedEdge* edge) {
+    if (has_stored_reach(edge)) {
+      return edge->forward_reach();
+    }
     auto itr = reach_indices.find(edge->endnode());
     if (itr == reach_indices.cend()) {
       return 0; // TODO: if we didnt find it should we run the reachability check
@@ -445,6 +593,11 @@ struct bin_handler_t {
       return 0;
     }
 
+    // the tile already knows
+    if (has_stored_reach(edge)) {
+      return edge->forward_reach();
+    }
+
     // do we already know about this one?
     auto found = reach_indices.find(edge->endnode());
     if (found != reach_indices.cend()) {
@@ -499,64 +652,53 @@ struct bin_handler_t {
         continue;
       }
 
-      // reset these so we know the best point along the edge
+      // get the shape of the edge, we only need to keep its info if it ends up as a candidate
+      auto edge_info = tile->edgeinfo(edge->edgeinfo_offset());
+      shape.decode(edge_info.lazy_shape());
+
+      // find the best point along the edge for each input unless the edge is too far away to matter
+      bool any = false;
       auto c_itr = bin_candidates.begin();
       decltype(begin) p_itr;
       for (p_itr = begin; p_itr != end; ++p_itr, ++c_itr) {
         c_itr->sq_distance = std::numeric_limits<float>::max();
-      }
-
-      // TODO: can we speed this up? the majority of edges will be short and far away enough
-      // such that the closest point on the edge will be one of the edges end points, we can get
-      // these coordinates them from the nodes in the graph. we can then find whichever end is
-      // closest to the input point p, call it n. we can then define an half plane h intersecting n
-      // so that its orthogonal to the ray from p to n. using h, we only need to test segments
-      // of the shape which are on the same side of h that p is. to make this fast we would need a
-      // a trivial half plane test as maybe a single dot product and comparison?
-
-      // get some shape of the edge
-      auto edge_info = std::make_shared<const EdgeInfo>(tile->edgeinfo(edge->edgeinfo_offset()));
-      auto shape = edge_info->lazy_shape();
-      PointLL v;
-      if (!shape.empty()) {
-        v = shape.pop();
-      }
-
-      // iterate along this edges segments projecting each of the points
-      for (size_t i = 0; !shape.empty(); ++i) {
-        auto u = v;
-        v = shape.pop();
-        // for each input point
-        c_itr = bin_candidates.begin();
-        for (p_itr = begin; p_itr != end; ++p_itr, ++c_itr) {
-          // how close is the input to this segment
-          auto point = p_itr->project(u, v);
-          auto sq_distance = p_itr->approx.DistanceSquared(point);
-          // do we want to keep it
-          if (sq_distance < c_itr->sq_distance) {
-            c_itr->sq_distance = sq_distance;
-            c_itr->point = std::move(point);
-            c_itr->index = i;
-          }
+        if (p_itr->may_accept(shape)) {
+          p_itr->project(shape, *c_itr);
+          any = true;
         }
       }
+      if (!any) {
+        continue;
+      }
 
       // if we already have a better reachable candidate we can just assume this one is reachable
       auto reachability = check_reachability(begin, end, tile, edge);
+      std::shared_ptr<const EdgeInfo> shared_info;
+      auto keep = [&](candidate_t& candidate) {
+        if (!shared_info) {
+          shared_info = std::make_shared<const EdgeInfo>(std::move(edge_info));
+        }
+        candidate.edge = edge;
+        candidate.edge_id = e;
+        candidate.edge_info = shared_info;
+        candidate.tile = tile;
+      };
 
       // keep the best point along this edge if it makes sense
       c_itr = bin_candidates.begin();
       for (p_itr = begin; p_itr != end; ++p_itr, ++c_itr) {
+        // this edge was too far away for this input
+        if (c_itr->sq_distance == std::numeric_limits<float>::max()) {
+          continue;
+        }
+
         // which batch of findings
         auto* batch = reachability < p_itr->location.minimum_reachability_ ? &p_itr->unreachable
                                                                            : &p_itr->reachable;
 
         // if its empty append
         if (batch->empty()) {
-          c_itr->edge = edge;
-          c_itr->edge_id = e;
-          c_itr->edge_info = edge_info;
-          c_itr->tile = tile;
+          keep(*c_itr);
           batch->emplace_back(std::move(*c_itr));
           continue;
         }
@@ -568,10 +710,7 @@ struct bin_handler_t {
 
         // it has to either be better or in the radius to move on
         if (in_radius || better) {
-          c_itr->edge = edge;
-          c_itr->edge_id = e;
-          c_itr->edge_info = edge_info;
-          c_itr->tile = tile;
+          keep(*c_itr);
           // the last one wasnt in the radius so replace it with this one because its better or is
           // in the radius
           if (!last_in_radius) {
@@ -719,18 +858,146 @@ namespace loki {
 std::unordered_map<Location, PathLocation> Search(const std::vector<Location>& locations,
                                                   GraphReader& reader,
                                                   const EdgeFilter& edge_filter,
-                                                  const NodeFilter& node_filter) {
+                                                  const NodeFilter& node_filter,
+                                                  bool stored_reach) {
   // trivially finished already
   if (locations.empty()) {
     return std::unordered_map<Location, PathLocation>{};
   };
   // setup the unique list of locations
-  bin_handler_t handler(locations, reader, edge_filter, node_filter);
+  bin_handler_t handler(locations, reader, edge_filter, node_filter, stored_reach);
   // search over the bins doing multiple locations per bin
   handler.search();
   // turn each locations candidate set into path locations
   return handler.finalize();
 }
 
+void BulkSearch(const std::vector<Location>& locations,
+                const std::vector<GraphReader*>& readers,
+                const std::function<void(size_t, const PathLocation*)>& callback,
+                const EdgeFilter& edge_filter,
+                const NodeFilter& node_filter,
+                bool stored_reach,
+                size_t chunk_size,
+                const std::function<void()>* interrupt) {
+  // trivially finished already
+  if (locations.empty()) {
+    return;
+  }
+  if (readers.empty()) {
+    throw std::runtime_error("At least one graph reader is required");
+  }
+  chunk_size = std::max(chunk_size, static_cast<size_t>(1));
+
+  // order the locations by the bin they start searching in so that the locations in a chunk share
+  // as many bins as possible and each of those bins is only scanned once for all of them
+  const auto& tiles = TileHierarchy::levels().rbegin()->second.tiles;
+  std::vector<std::pair<uint64_t, size_t>> order(locations.size());
+  for (size_t i = 0; i < locations.size(); ++i) {
+    const auto& ll = locations[i].latlng_;
+    auto tile_id = tiles.TileId(ll);
+    uint64_t bin = 0;
+    if (tile_id >= 0) {
+      auto base = tiles.Base(tile_id);
+      int32_t last = tiles.nsubdivisions() - 1;
+      auto column =
+          std::min(static_cast<int32_t>((ll.lng() - base.lng()) / tiles.SubdivisionSize()), last);
+      auto row =
+          std::min(static_cast<int32_t>((ll.lat() - base.lat()) / tiles.SubdivisionSize()), last);
+      bin = static_cast<uint64_t>(row) * tiles.nsubdivisions() + column;
+    }
+    order[i] = {(static_cast<uint64_t>(static_cast<uint32_t>(tile_id)) << 32) | bin, i};
+  }
+  std::sort(order.begin(), order.end());
+
+  // each thread takes the next chunk, searches it and marks its locations as done
+  std::vector<std::unique_ptr<PathLocation>> results(locations.size());
+  std::vector<char> done(locations.size(), false);
+  std::mutex mutex;
+  std::condition_variable searched;
+  std::exception_ptr error;
+  size_t next_chunk = 0;
+  auto work = [&](GraphReader& reader) {
+    std::vector<Location> chunk;
+    while (true) {
+      size_t begin, end;
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error || next_chunk >= order.size()) {
+          return;
+        }
+        begin = next_chunk;
+        end = next_chunk = std::min(next_chunk + chunk_size, order.size());
+      }
+
+      try {
+        chunk.clear();
+        for (size_t i = begin; i < end; ++i) {
+          chunk.push_back(locations[order[i].second]);
+        }
+        auto projections = Search(chunk, reader, edge_filter, node_filter, stored_reach);
+        for (size_t i = begin; i < end; ++i) {
+          auto found = projections.find(locations[order[i].second]);
+          if (found != projections.cend()) {
+            results[order[i].second].reset(new PathLocation(found->second));
+          }
+        }
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+        searched.notify_all();
+        return;
+      }
+
+      std::lock_guard<std::mutex> lock(mutex);
+      for (size_t i = begin; i < end; ++i) {
+        done[order[i].second] = true;
+      }
+      searched.notify_all();
+    }
+  };
+  std::list<std::thread> threads;
+  for (auto* reader : readers) {
+    threads.emplace_back(work, std::ref(*reader));
+  }
+
+  // hand back the results in the order of the input as soon as they are ready. the interrupt is
+  // only ever called from this thread, the search threads see it as an error and stop
+  for (size_t i = 0; i < locations.size(); ++i) {
+    try {
+      if (interrupt && i % chunk_size == 0) {
+        (*interrupt)();
+      }
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!searched.wait_for(lock, std::chrono::milliseconds(100),
+                                  [&]() { return done[i] || error; })) {
+          if (interrupt) {
+            lock.unlock();
+            (*interrupt)();
+            lock.lock();
+          }
+        }
+        if (error) {
+          break;
+        }
+      }
+      callback(i, results[i].get());
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = std::current_exception();
+      break;
+    }
+    results[i].reset();
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
 } // namespace loki
 } // namespace valhalla
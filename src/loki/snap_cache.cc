@@ -0,0 +1,125 @@
+#include "loki/snap_cache.h"
+
+#include <cmath>
+
+using namespace valhalla::baldr;
+
+namespace {
+
+template <typename T> void append(std::string& key, const T& value) {
+  key.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T> void append(std::string& key, const boost::optional<T>& value) {
+  key.push_back(static_cast<bool>(value));
+  if (value) {
+    append(key, *value);
+  }
+}
+
+// roughly what each entry costs on top of what it stores, list and hash table nodes etc
+constexpr size_t kEntryOverhead = 96;
+
+} // namespace
+
+namespace valhalla {
+namespace loki {
+
+SnapCache::SnapCache(size_t max_memory, uint32_t precision)
+    : max_memory_(max_memory), memory_(0), scale_(std::pow(10.0, precision)), hits_(0),
+      misses_(0) {
+}
+
+SnapCache::key_t SnapCache::make_key(const Location& location, uint64_t filter_signature) const {
+  key_t key;
+  key.reserve(64);
+  append(key, filter_signature);
+  append(key, static_cast<int64_t>(std::round(location.latlng_.lng() * scale_)));
+  append(key, static_cast<int64_t>(std::round(location.latlng_.lat() * scale_)));
+  append(key, location.stoptype_);
+  append(key, location.heading_);
+  append(key, location.heading_tolerance_);
+  append(key, location.node_snap_tolerance_);
+  append(key, location.way_id_);
+  append(key, location.minimum_reachability_);
+  append(key, location.radius_);
+  return key;
+}
+
+const PathLocation*
+SnapCache::Get(const Location& location, uint64_t filter_signature, GraphReader& reader) {
+  auto found = index_.find(make_key(location, filter_signature));
+  if (found == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+
+  // if the tile changed underneath us then none of the correlations can be trusted
+  const auto* tile = reader.GetGraphTile(found->second->tile_id);
+  if (!tile || tile->header()->dataset_id() != found->second->dataset_id) {
+    Clear();
+    ++misses_;
+    return nullptr;
+  }
+
+  // move it to the front since its the most recently used
+  lru_.splice(lru_.begin(), lru_, found->second);
+  ++hits_;
+  return &found->second->correlated;
+}
+
+void SnapCache::Put(const Location& location,
+                    uint64_t filter_signature,
+                    const PathLocation& correlated,
+                    GraphReader& reader) {
+  // nothing to remember the version of the tiles by
+  if (correlated.edges.empty()) {
+    return;
+  }
+  GraphId tile_id = correlated.edges.front().id.Tile_Base();
+  const auto* tile = reader.GetGraphTile(tile_id);
+  if (!tile) {
+    return;
+  }
+
+  // replace whatever was there
+  auto key = make_key(location, filter_signature);
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    evict(found->second);
+  }
+
+  // dont bother if it could never fit
+  size_t memory = sizeof(entry_t) + kEntryOverhead + 2 * key.capacity() +
+                  (correlated.edges.size() + correlated.filtered_edges.size()) *
+                      sizeof(PathLocation::PathEdge) +
+                  correlated.name_.capacity() + correlated.street_.capacity() +
+                  correlated.city_.capacity() + correlated.state_.capacity() +
+                  correlated.zip_.capacity() + correlated.country_.capacity();
+  if (memory > max_memory_) {
+    return;
+  }
+
+  // make room if we need to
+  while (memory_ + memory > max_memory_) {
+    evict(std::prev(lru_.end()));
+  }
+  lru_.emplace_front(entry_t{key, correlated, tile_id, tile->header()->dataset_id(), memory});
+  index_.emplace(std::move(key), lru_.begin());
+  memory_ += memory;
+}
+
+void SnapCache::Clear() {
+  index_.clear();
+  lru_.clear();
+  memory_ = 0;
+}
+
+void SnapCache::evict(std::list<entry_t>::iterator entry) {
+  memory_ -= entry->memory;
+  index_.erase(entry->key);
+  lru_.erase(entry);
+}
+
+} // namespace loki
+} // namespace valhalla
@@ -171,7 +171,7 @@ void loki_worker_t::locations_from_shape(valhalla_request_t& request) {
 
   // Add first and last correlated locations to request
   try {
-    auto projections = loki::Search(locations, *reader, edge_filter, node_filter);
+    auto projections = loki::Search(locations, *reader, edge_filter, node_filter, stored_reach);
     request.options.clear_locations();
     PathLocation::toPBF(projections.at(locations.front()), request.options.mutable_locations()->Add(),
                         *reader);
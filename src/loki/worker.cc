@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <boost/property_tree/ptree.hpp>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <sstream>
@@ -90,6 +92,14 @@ void loki_worker_t::parse_costing(valhalla_request_t& request) {
     cost_ptr_t c = factory.Create(costing, request.options);
     edge_filter = c->GetEdgeFilter();
     node_filter = c->GetNodeFilter();
+    // only these use exactly the filters the reachability in the tiles was computed with
+    stored_reach = costing == odin::Costing::auto_ || costing == odin::Costing::auto_shorter;
+    // the filters only depend on the costing and its options
+    std::string signature = costing_str;
+    if (request.options.costing_options_size() > static_cast<int>(costing)) {
+      signature += request.options.costing_options(static_cast<int>(costing)).SerializeAsString();
+    }
+    filter_signature = std::hash<std::string>()(signature);
   } catch (const std::runtime_error&) { throw valhalla_exception_t{125, "'" + costing_str + "'"}; }
 
   // See if we have avoids and take care of them
@@ -100,7 +110,8 @@ void loki_worker_t::parse_costing(valhalla_request_t& request) {
   if (request.options.avoid_locations_size()) {
     try {
       auto avoid_locations = PathLocation::fromPBF(request.options.avoid_locations());
-      auto results = loki::Search(avoid_locations, *reader, edge_filter, node_filter);
+      auto results =
+          loki::Search(avoid_locations, *reader, edge_filter, node_filter, stored_reach);
       std::unordered_set<uint64_t> avoids;
       for (const auto& result : results) {
         for (const auto& edge : result.second.edges) {
@@ -121,9 +132,41 @@ void loki_worker_t::parse_costing(valhalla_request_t& request) {
   }
 }
 
+std::unordered_map<Location, PathLocation>
+loki_worker_t::search(const std::vector<Location>& locations) {
+  if (!snap_cache) {
+    return loki::Search(locations, *reader, edge_filter, node_filter, stored_reach);
+  }
+
+  // hand back what we already found before and only search for the rest
+  std::unordered_map<Location, PathLocation> results;
+  std::vector<Location> misses;
+  for (const auto& location : locations) {
+    if (results.find(location) != results.cend()) {
+      continue;
+    }
+    const auto* cached = snap_cache->Get(location, filter_signature, *reader);
+    if (cached) {
+      // the cached one may have been searched for at slightly different coordinates
+      PathLocation correlated(*cached);
+      static_cast<Location&>(correlated) = location;
+      results.emplace(location, std::move(correlated));
+    } else {
+      misses.push_back(location);
+    }
+  }
+  if (!misses.empty()) {
+    for (auto& result : loki::Search(misses, *reader, edge_filter, node_filter, stored_reach)) {
+      snap_cache->Put(result.first, filter_signature, result.second, *reader);
+      results.emplace(std::move(result));
+    }
+  }
+  return results;
+}
+
 loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
                              const std::shared_ptr<baldr::GraphReader>& graph_reader)
-    : config(config), reader(graph_reader),
+    : config(config), stored_reach(false), filter_signature(0), reader(graph_reader),
       connectivity_map(config.get<bool>("loki.use_connectivity", true)
                            ? new connectivity_map_t(config.get_child("mjolnir"))
                            : nullptr),
@@ -155,7 +198,7 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
   // Build max_locations and max_distance maps
   for (const auto& kv : config.get_child("service_limits")) {
     if (kv.first == "max_avoid_locations" || kv.first == "max_reachability" ||
-        kv.first == "max_radius") {
+        kv.first == "max_radius" || kv.first == "max_bulk_locations") {
       continue;
     }
     if (kv.first != "skadi" && kv.first != "trace") {
@@ -196,6 +239,8 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
       config.get<size_t>("service_limits.pedestrian.max_transit_walking_distance");
 
   max_avoid_locations = config.get<size_t>("service_limits.max_avoid_locations");
+  max_bulk_locations = config.get<size_t>("service_limits.max_bulk_locations", 100000);
+  bulk_locate_threads = config.get<size_t>("loki.bulk_locate.threads", 1);
   max_reachability = config.get<unsigned int>("service_limits.max_reachability");
   default_reachability = config.get<unsigned int>("loki.service_defaults.minimum_reachability");
   max_radius = config.get<unsigned long>("service_limits.max_radius");
@@ -205,6 +250,13 @@ loki_worker_t::loki_worker_t(const boost::property_tree::ptree& config,
   max_best_paths = config.get<unsigned int>("service_limits.trace.max_best_paths");
   max_best_paths_shape = config.get<size_t>("service_limits.trace.max_best_paths_shape");
 
+  // Keep the correlations of recently searched for locations around if configured to
+  auto snap_cache_memory = config.get<size_t>("loki.snap_cache.max_memory", 0);
+  if (snap_cache_memory > 0) {
+    snap_cache.reset(
+        new SnapCache(snap_cache_memory, config.get<uint32_t>("loki.snap_cache.precision", 6)));
+  }
+
   // Register standard edge/node costing methods
   factory.RegisterStandardCostingModels();
 }
@@ -213,6 +265,67 @@ void loki_worker_t::cleanup() {
   if (reader->OverCommitted()) {
     reader->Clear();
   }
+  for (auto& bulk_reader : bulk_readers) {
+    if (bulk_reader->OverCommitted()) {
+      bulk_reader->Clear();
+    }
+  }
+}
+
+boost::optional<std::string> loki_worker_t::act(valhalla_request_t& request) {
+  switch (request.options.action()) {
+    case odin::DirectionsOptions::route:
+      route(request);
+      return boost::none;
+    case odin::DirectionsOptions::locate:
+      return locate(request);
+    case odin::DirectionsOptions::bulk_locate:
+      return bulk_locate(request);
+    case odin::DirectionsOptions::sources_to_targets:
+    case odin::DirectionsOptions::optimized_route:
+      matrix(request);
+      return boost::none;
+    case odin::DirectionsOptions::isochrone:
+      isochrones(request);
+      return boost::none;
+    case odin::DirectionsOptions::trace_attributes:
+    case odin::DirectionsOptions::trace_route:
+      trace(request);
+      return boost::none;
+    case odin::DirectionsOptions::height:
+      return height(request);
+    case odin::DirectionsOptions::transit_available:
+      return transit_available(request);
+    default:
+      // apparently you wanted something that we figured we'd support but havent written yet
+      throw valhalla_exception_t{107};
+  }
+}
+
+std::chrono::system_clock::time_point
+loki_worker_t::log_request(const valhalla_request_t& request,
+                           const std::chrono::system_clock::time_point& start) const {
+  // get processing time for loki
+  auto end = std::chrono::system_clock::now();
+  std::chrono::duration<float, std::milli> elapsed_time = end - start;
+  // log request if greater than X (ms)
+  auto work_units = request.options.locations_size()
+                        ? request.options.locations_size()
+                        : (request.options.sources_size()
+                               ? request.options.sources_size() + request.options.targets_size()
+                               : request.options.shape_size() * 20);
+  if (snap_cache) {
+    LOG_DEBUG("loki::snap_cache hit rate::" + std::to_string(snap_cache->hit_rate()) +
+              " size::" + std::to_string(snap_cache->size()) +
+              " memory::" + std::to_string(snap_cache->memory()));
+  }
+  if (!request.options.do_not_track() &&
+      elapsed_time.count() / std::max(work_units, 1) > long_request) {
+    LOG_WARN("loki::request elapsed time (ms)::" + std::to_string(elapsed_time.count()));
+    LOG_WARN("loki::request exceeded threshold::" + rapidjson::to_string(request.document));
+    midgard::logging::Log("valhalla_loki_long_request", " [ANALYTICS] ");
+  }
+  return end;
 }
 
 #ifdef HAVE_HTTP
@@ -252,59 +365,18 @@ worker_t::result_t loki_worker_t::work(const std::list<zmq::message_t>& job,
     // Set the interrupt function
     service_worker_t::set_interrupt(interrupt_function);
 
-    worker_t::result_t result{true};
     // do request specific processing
-    switch (request.options.action()) {
-      case odin::DirectionsOptions::route:
-        route(request);
-        result.messages.emplace_back(rapidjson::to_string(request.document));
-        result.messages.emplace_back(request.options.SerializeAsString());
-        break;
-      case odin::DirectionsOptions::locate:
-        result = to_response_json(locate(request), info, request);
-        break;
-      case odin::DirectionsOptions::sources_to_targets:
-      case odin::DirectionsOptions::optimized_route:
-        matrix(request);
-        result.messages.emplace_back(rapidjson::to_string(request.document));
-        result.messages.emplace_back(request.options.SerializeAsString());
-        break;
-      case odin::DirectionsOptions::isochrone:
-        isochrones(request);
-        result.messages.emplace_back(rapidjson::to_string(request.document));
-        result.messages.emplace_back(request.options.SerializeAsString());
-        break;
-      case odin::DirectionsOptions::trace_attributes:
-      case odin::DirectionsOptions::trace_route:
-        trace(request);
-        result.messages.emplace_back(rapidjson::to_string(request.document));
-        result.messages.emplace_back(request.options.SerializeAsString());
-        break;
-      case odin::DirectionsOptions::height:
-        result = to_response_json(height(request), info, request);
-        break;
-      case odin::DirectionsOptions::transit_available:
-        result = to_response_json(transit_available(request), info, request);
-        break;
-      default:
-        // apparently you wanted something that we figured we'd support but havent written yet
-        return jsonify_error({107}, info, request);
-    }
-    // get processing time for loki
-    auto e = std::chrono::system_clock::now();
-    std::chrono::duration<float, std::milli> elapsed_time = e - s;
-    // log request if greater than X (ms)
-    auto work_units = request.options.locations_size()
-                          ? request.options.locations_size()
-                          : (request.options.sources_size()
-                                 ? request.options.sources_size() + request.options.targets_size()
-                                 : request.options.shape_size() * 20);
-    if (!request.options.do_not_track() && elapsed_time.count() / work_units > long_request) {
-      LOG_WARN("loki::request elapsed time (ms)::" + std::to_string(elapsed_time.count()));
-      LOG_WARN("loki::request exceeded threshold::" + rapidjson::to_string(request.document));
-      midgard::logging::Log("valhalla_loki_long_request", " [ANALYTICS] ");
+    auto json = act(request);
+    worker_t::result_t result{true};
+    if (json) {
+      result = to_response_json(*json, info, request);
+    } else {
+      // hand the correlated request on to thor
+      result.messages.emplace_back(rapidjson::to_string(request.document));
+      result.messages.emplace_back(request.options.SerializeAsString());
     }
 
+    log_request(request, s);
     return result;
   } catch (const valhalla_exception_t& e) {
     valhalla::midgard::logging::Log("400::" + std::string(e.what()), " [ANALYTICS] ");
@@ -292,7 +292,9 @@ MapMatcher::MapMatcher(const boost::property_tree::ptree& config,
                        baldr::GraphReader& graphreader,
                        CandidateQuery& candidatequery,
                        const sif::cost_ptr_t* mode_costing,
-                       sif::TravelMode travelmode)
+                       sif::TravelMode travelmode,
+                       const std::shared_ptr<RouteCache>& route_cache,
+                       uint64_t costing_signature)
     : config_(config), graphreader_(graphreader), candidatequery_(candidatequery),
       mode_costing_(mode_costing), travelmode_(travelmode), interrupt_(nullptr), vs_(), ts_(vs_),
       container_(), emission_cost_model_(graphreader_, container_, config_),
@@ -303,6 +305,7 @@ MapMatcher::MapMatcher(const boost::property_tree::ptree& config,
                              mode_costing_,
                              travelmode_,
                              config_) {
+  transition_cost_model_.set_route_cache(route_cache, costing_signature);
   vs_.set_emission_cost_model(emission_cost_model_);
   vs_.set_transition_cost_model(transition_cost_model_);
 }
@@ -1,5 +1,7 @@
 #include <string>
 
+#include <boost/functional/hash.hpp>
+
 #include "baldr/graphreader.h"
 #include "baldr/tilehierarchy.h"
 #include "sif/autocost.h"
@@ -35,6 +37,7 @@ MapMatcherFactory::MapMatcherFactory(const boost::property_tree::ptree& root,
       new CandidateGridQuery(*graphreader_, local_tile_size() / root.get<size_t>("meili.grid.size"),
                              local_tile_size() / root.get<size_t>("meili.grid.size")));
   cost_factory_.RegisterStandardCostingModels();
+  route_cache_ = RouteCache::instance(config_);
 }
 
 MapMatcherFactory::~MapMatcherFactory() {
@@ -50,8 +53,21 @@ MapMatcher* MapMatcherFactory::Create(const odin::Costing costing,
 
   mode_costing_[static_cast<uint32_t>(mode)] = cost;
 
+  // Routes can only be shared between matchers with the same costing options and turn penalties.
+  // The search bounds are kept with each route and the search radius goes into each lookup instead
+  size_t costing_signature = 0;
+  if (route_cache_) {
+    boost::hash_combine(costing_signature, static_cast<int>(costing));
+    if (options.costing_options_size() > static_cast<int>(costing)) {
+      boost::hash_combine(costing_signature,
+                          options.costing_options(static_cast<int>(costing)).SerializeAsString());
+    }
+    boost::hash_combine(costing_signature, config.get<float>("turn_penalty_factor"));
+  }
+
   // TODO investigate exception safety
-  return new MapMatcher(config, *graphreader_, *candidatequery_, mode_costing_, mode);
+  return new MapMatcher(config, *graphreader_, *candidatequery_, mode_costing_, mode, route_cache_,
+                        costing_signature);
 }
 
 MapMatcher* MapMatcherFactory::Create(const odin::DirectionsOptions& options) {
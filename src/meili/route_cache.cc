@@ -0,0 +1,98 @@
+#include "meili/route_cache.h"
+
+namespace valhalla {
+namespace meili {
+
+constexpr size_t RouteCache::kShardCount;
+
+RouteCache::RouteCache(size_t max_size) : hits_(0), misses_(0) {
+  // spread the remainder over the first shards so that they add up to exactly max_size
+  for (size_t i = 0; i < kShardCount; ++i) {
+    shards_[i].max_size = max_size / kShardCount + (i < max_size % kShardCount ? 1 : 0);
+  }
+}
+
+std::shared_ptr<const cached_route_t>
+RouteCache::Get(const key_t& key, float max_dist, float max_time) {
+  auto& s = shard(key);
+  {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    auto found = s.index.find(key);
+    if (found != s.index.end() && found->second->second->covers(max_dist, max_time)) {
+      // move it to the front since its the most recently used
+      s.lru.splice(s.lru.begin(), s.lru, found->second);
+      return found->second->second;
+    }
+  }
+  return nullptr;
+}
+
+void RouteCache::Count(bool hit) {
+  if (hit) {
+    ++hits_;
+  } else {
+    ++misses_;
+  }
+}
+
+void RouteCache::Put(const key_t& key, const std::shared_ptr<const cached_route_t>& route) {
+  auto& s = shard(key);
+  std::lock_guard<std::mutex> lock(s.mutex);
+
+  // replace whatever was there
+  auto found = s.index.find(key);
+  if (found != s.index.end()) {
+    found->second->second = route;
+    s.lru.splice(s.lru.begin(), s.lru, found->second);
+    return;
+  }
+
+  // make room if we need to, a shard with no room at all never holds anything
+  if (s.max_size == 0) {
+    return;
+  }
+  while (s.lru.size() >= s.max_size) {
+    s.index.erase(s.lru.back().first);
+    s.lru.pop_back();
+  }
+  s.lru.emplace_front(key, route);
+  s.index.emplace(key, s.lru.begin());
+}
+
+void RouteCache::Clear() {
+  for (auto& s : shards_) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    s.index.clear();
+    s.lru.clear();
+  }
+  hits_ = 0;
+  misses_ = 0;
+}
+
+size_t RouteCache::size() const {
+  size_t total = 0;
+  for (auto& s : shards_) {
+    std::lock_guard<std::mutex> lock(s.mutex);
+    total += s.lru.size();
+  }
+  return total;
+}
+
+std::shared_ptr<RouteCache> RouteCache::instance(const boost::property_tree::ptree& config) {
+  static std::mutex instance_mutex;
+  static std::shared_ptr<RouteCache> instance;
+  static bool configured = false;
+
+  std::lock_guard<std::mutex> lock(instance_mutex);
+  if (!configured) {
+    size_t max_size = config.get<size_t>("route_cache.max_size", 0);
+    if (max_size > 0) {
+      instance = std::make_shared<RouteCache>(max_size);
+    }
+    configured = true;
+  }
+  return instance;
+}
+
+} // namespace meili
+} // namespace valhalla
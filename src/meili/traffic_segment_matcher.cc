@@ -7,6 +7,27 @@
 #include "midgard/util.h"
 #include "worker.h"
 
+namespace valhalla {
+namespace meili {
+
+struct merged_traffic_segment_t {
+  valhalla::baldr::TrafficSegment segment;
+  valhalla::baldr::GraphId begin_edge;
+  valhalla::baldr::GraphId end_edge;
+  bool internal;
+  bool turn_channel;
+  const valhalla::baldr::TrafficSegment* operator->() const {
+    return &segment;
+  }
+  valhalla::baldr::TrafficSegment* operator->() {
+    return &segment;
+  }
+  std::vector<uint64_t> way_ids;
+};
+
+} // namespace meili
+} // namespace valhalla
+
 namespace {
 
 void clean_edges(std::vector<valhalla::meili::EdgeSegment>& edges) {
@@ -34,33 +55,24 @@ bool is_turn_channel(const valhalla::baldr::DirectedEdge* edge) {
   return edge->use() == valhalla::baldr::Use::kTurnChannel;
 }
 
-struct merged_traffic_segment_t {
-  valhalla::baldr::TrafficSegment segment;
-  valhalla::baldr::GraphId begin_edge;
-  valhalla::baldr::GraphId end_edge;
-  bool internal;
-  bool turn_channel;
-  const valhalla::baldr::TrafficSegment* operator->() const {
-    return &segment;
-  }
-  valhalla::baldr::TrafficSegment* operator->() {
-    return &segment;
-  }
-  std::vector<uint64_t> way_ids;
-};
-std::vector<merged_traffic_segment_t>
-merge_segments(const std::vector<valhalla::meili::interpolation_t>& markers,
-               valhalla::baldr::GraphReader& reader) {
-  std::vector<merged_traffic_segment_t> merged;
+using valhalla::meili::merged_traffic_segment_t;
+
+// merges the segments of the edges covered by the markers into single entries per segment id. the
+// entries of merged are reused rather than reallocated and the number of valid ones is returned
+size_t merge_segments(std::vector<valhalla::meili::interpolation_t>::const_iterator begin,
+                      std::vector<valhalla::meili::interpolation_t>::const_iterator end,
+                      valhalla::baldr::GraphReader& reader,
+                      std::vector<merged_traffic_segment_t>& merged) {
+  size_t count = 0;
   const valhalla::baldr::GraphTile* tile = nullptr;
   valhalla::baldr::GraphId edge;
-  for (const auto& marker : markers) {
+  for (auto marker = begin; marker != end; ++marker) {
     // skip if its a repeat or we cant get the tile
-    if (marker.edge == edge || !reader.GetGraphTile(marker.edge, tile)) {
+    if (marker->edge == edge || !reader.GetGraphTile(marker->edge, tile)) {
       continue;
     }
     // get segments for this edge
-    edge = marker.edge;
+    edge = marker->edge;
     const auto* directed_edge = tile->directededge(edge);
     // if there were no segments we'll start an invalid one to serve
     // as a placeholder for the section of the path that has no ots's
@@ -73,27 +85,80 @@ merge_segments(const std::vector<valhalla::meili::interpolation_t>& markers,
     // merge them into single entries per segment id
     for (const auto& segment : segments) {
       // continue one
-      if (!merged.empty() && merged.back()->segment_id_ == segment.segment_id_) {
-        merged.back().end_edge = edge;
-        merged.back()->end_percent_ = segment.end_percent_;
-        merged.back()->ends_segment_ = segment.ends_segment_;
-        merged.back().internal = merged.back().internal && is_internal(directed_edge);
-        merged.back().turn_channel = merged.back().turn_channel && is_turn_channel(directed_edge);
-        if (merged.back().way_ids.size() == 0 || merged.back().way_ids.back() != way_id) {
-          merged.back().way_ids.push_back(way_id);
+      if (count > 0 && merged[count - 1]->segment_id_ == segment.segment_id_) {
+        auto& last = merged[count - 1];
+        last.end_edge = edge;
+        last->end_percent_ = segment.end_percent_;
+        last->ends_segment_ = segment.ends_segment_;
+        last.internal = last.internal && is_internal(directed_edge);
+        last.turn_channel = last.turn_channel && is_turn_channel(directed_edge);
+        if (last.way_ids.size() == 0 || last.way_ids.back() != way_id) {
+          last.way_ids.push_back(way_id);
         }
       } // new one
-      else {
+      else if (count == merged.size()) {
         merged.emplace_back(merged_traffic_segment_t{segment,
                                                      edge,
                                                      edge,
                                                      is_internal(directed_edge),
                                                      is_turn_channel(directed_edge),
                                                      {way_id}});
+        ++count;
+      } // reuse one
+      else {
+        auto& next = merged[count++];
+        next.segment = segment;
+        next.begin_edge = edge;
+        next.end_edge = edge;
+        next.internal = is_internal(directed_edge);
+        next.turn_channel = is_turn_channel(directed_edge);
+        next.way_ids.assign(1, way_id);
       }
     }
   }
-  return merged;
+  return count;
+}
+
+// fills in the time information for those points that dont have it
+void backfill_times(std::vector<valhalla::meili::interpolation_t>::iterator begin,
+                    std::vector<valhalla::meili::interpolation_t>::iterator end) {
+  auto backfill = begin;
+  while (backfill != end) {
+    // this one is done already
+    if (backfill->epoch_time != -1) {
+      ++backfill;
+      continue;
+    }
+    // find the range that have values (or the ends of the range
+    auto left = backfill != begin ? std::prev(backfill) : backfill;
+    auto right = std::next(backfill);
+    for (; right != end && right->epoch_time == -1; ++right) {
+      ;
+    }
+    // backfill between left and right
+    while (backfill != right) {
+      // if both indices are valid we interpolate
+      if (left != begin && right != end) {
+        double time_diff = right->epoch_time - left->epoch_time;
+        float distance_diff = right->total_distance - left->total_distance;
+        float distance_ratio =
+            distance_diff > 0 ? (backfill->total_distance - left->total_distance) / distance_diff
+                              : 0.f;
+        backfill->epoch_time = left->epoch_time + distance_ratio * time_diff;
+      } // if left index is valid we carry it forward if we can
+      else if (left != begin && backfill->total_distance == left->total_distance) {
+        backfill->epoch_time = left->epoch_time;
+        backfill->original_index = left->original_index;
+      }
+      // right index is valid we carry it forward if we can
+      else if (right != end && backfill->total_distance == right->total_distance) {
+        backfill->epoch_time = right->epoch_time;
+        backfill->original_index = right->original_index;
+      }
+      // next backfill
+      ++backfill;
+    }
+  }
 }
 
 /*
@@ -118,10 +183,25 @@ namespace meili {
 // Threshold speed below which we assume a queue occurs (meters/sec)
 constexpr float kQueueSpeedThreshold = 2.0f; // approx 4.3 MPH
 
+// Everything the binary matching interface keeps around between calls so that
+// steady state ingest does no allocation outside of the matcher itself
+struct TrafficSegmentMatcher::buffers_t {
+  std::shared_ptr<MapMatcher> matcher;
+  odin::Costing costing;
+  float default_accuracy;
+  float default_search_radius;
+  std::vector<Measurement> measurements;
+  std::vector<interpolation_t> interpolated;
+  std::vector<size_t> ends;
+  std::vector<merged_traffic_segment_t> merged;
+  std::vector<traffic_segment_t> segments;
+};
+
 TrafficSegmentMatcher::TrafficSegmentMatcher(const boost::property_tree::ptree& config)
     : matcher_factory(config),
       customizable(midgard::ToSet<boost::property_tree::ptree, std::unordered_set<std::string>>(
-          config.get_child("meili.customizable"))) {
+          config.get_child("meili.customizable"))),
+      buffers_(std::make_shared<buffers_t>()) {
 }
 
 std::string TrafficSegmentMatcher::match(const std::string& json) {
@@ -165,10 +245,118 @@ std::string TrafficSegmentMatcher::match(const std::string& json) {
   return serialize(traffic_segments);
 }
 
+size_t TrafficSegmentMatcher::match(const probe_batch_t& batch,
+                                    std::vector<packed_segment_t>& segments,
+                                    odin::Costing costing) {
+  segments.clear();
+
+  // check the columns line up
+  const size_t count = batch.size();
+  if (batch.lons.size() != count || batch.times.size() != count ||
+      (!batch.accuracies.empty() && batch.accuracies.size() != count)) {
+    throw std::runtime_error("Probe batch columns must all be the same length.");
+  }
+  if (count < 2) {
+    throw std::runtime_error("2 or more trace points are required.");
+  }
+
+  // the matcher only needs to be created again if the costing changes
+  auto& buffers = *buffers_;
+  if (!buffers.matcher || buffers.costing != costing) {
+    try {
+      // parsing an otherwise empty request fills in the default costing options
+      valhalla::valhalla_request_t request;
+      request.parse(R"({"costing":")" + odin::Costing_Name(costing) + R"("})",
+                    valhalla::odin::DirectionsOptions::trace_route);
+      buffers.matcher.reset(matcher_factory.Create(costing, request.options));
+      buffers.costing = costing;
+      buffers.default_accuracy = buffers.matcher->config().get<float>("gps_accuracy");
+      buffers.default_search_radius = buffers.matcher->config().get<float>("search_radius");
+    } catch (...) {
+      buffers.matcher.reset();
+      throw std::runtime_error("Couldn't create traffic matcher using configuration.");
+    }
+  }
+
+  // Populate the measurements keeping only the last of any points with the same time
+  auto& measurements = buffers.measurements;
+  measurements.clear();
+  for (size_t i = 0; i < count; ++i) {
+    if (i > 0 && batch.times[i - 1] > batch.times[i]) {
+      throw std::runtime_error("Trace points must be in chronological order.");
+    }
+    Measurement measurement{midgard::PointLL{batch.lons[i], batch.lats[i]},
+                            batch.accuracies.empty() ? buffers.default_accuracy
+                                                     : batch.accuracies[i],
+                            buffers.default_search_radius,
+                            batch.times[i]};
+    if (i > 0 && batch.times[i - 1] == batch.times[i]) {
+      measurements.back() = measurement;
+    } else {
+      measurements.push_back(measurement);
+    }
+  }
+
+  // Create the matched path results
+  auto topk_matches = buffers.matcher->OfflineMatch(measurements);
+  const auto& match_results = topk_matches.front().results;
+  auto& edge_segments = topk_matches.front().segments;
+  if (match_results.size() != measurements.size()) {
+    throw std::runtime_error("Sequence size not equal to match result size.");
+  }
+
+  // Interpolate along each connected portion of the path and form the segments for each
+  interpolate_matches(match_results, edge_segments, *buffers.matcher, buffers.interpolated,
+                      buffers.ends);
+  size_t formed = 0;
+  auto begin = buffers.interpolated.cbegin();
+  for (auto end : buffers.ends) {
+    formed = form_segments(begin, buffers.interpolated.cbegin() + end,
+                           buffers.matcher->graphreader(), buffers.merged, buffers.segments,
+                           formed);
+    begin = buffers.interpolated.cbegin() + end;
+  }
+
+  // Check if we are overcommitted on either cache and and clear if needed
+  matcher_factory.ClearFullCache();
+
+  // pack them up
+  segments.reserve(formed);
+  for (size_t i = 0; i < formed; ++i) {
+    const auto& seg = buffers.segments[i];
+    segments.emplace_back(packed_segment_t{seg.segment_id.value, seg.start_time, seg.end_time,
+                                           static_cast<int32_t>(seg.length),
+                                           static_cast<int32_t>(seg.queue_length)});
+  }
+  return formed;
+}
+
 std::list<std::vector<interpolation_t>>
 TrafficSegmentMatcher::interpolate_matches(const std::vector<MatchResult>& matches,
                                            std::vector<EdgeSegment>& edges,
                                            const std::shared_ptr<meili::MapMatcher>& matcher) const {
+  // do the work into flat buffers
+  std::vector<interpolation_t> interpolated;
+  std::vector<size_t> ends;
+  interpolate_matches(matches, edges, *matcher, interpolated, ends);
+
+  // split them back out into each set of continuous edges
+  std::list<std::vector<interpolation_t>> interpolations;
+  size_t begin = 0;
+  for (auto end : ends) {
+    interpolations.emplace_back(interpolated.cbegin() + begin, interpolated.cbegin() + end);
+    begin = end;
+  }
+  return interpolations;
+}
+
+void TrafficSegmentMatcher::interpolate_matches(const std::vector<MatchResult>& matches,
+                                                std::vector<EdgeSegment>& edges,
+                                                const MapMatcher& matcher,
+                                                std::vector<interpolation_t>& interpolated,
+                                                std::vector<size_t>& ends) const {
+  interpolated.clear();
+  ends.clear();
 
   // get all of the edges along the path from the state info
   clean_edges(edges);
@@ -178,24 +366,23 @@ TrafficSegmentMatcher::interpolate_matches(const std::vector<MatchResult>& match
   // otherwise the the timing reported here might be suspect
 
   // find each set of continuous edges
-  std::list<std::vector<interpolation_t>> interpolations;
   size_t idx = 0;
   for (auto begin_edge = edges.cbegin(), end_edge = edges.cbegin() + 1; begin_edge != edges.cend();
        begin_edge = end_edge, end_edge += 1) {
     // find the end of the this block
     while (end_edge != edges.cend()) {
-      if (!matcher->graphreader().AreEdgesConnectedForward(std::prev(end_edge)->edgeid,
-                                                           end_edge->edgeid)) {
+      if (!matcher.graphreader().AreEdgesConnectedForward(std::prev(end_edge)->edgeid,
+                                                          end_edge->edgeid)) {
         break;
       }
       ++end_edge;
     }
 
     // go through each edge and each match keeping the distance each point is along the entire trace
-    std::vector<interpolation_t> interpolated;
+    size_t first = interpolated.size();
     size_t last_idx = idx;
     for (auto segment = begin_edge; segment != end_edge; ++segment) {
-      float edge_length = matcher->graphreader()
+      float edge_length = matcher.graphreader()
                               .GetGraphTile(segment->edgeid)
                               ->directededge(segment->edgeid)
                               ->length();
@@ -224,50 +411,11 @@ TrafficSegmentMatcher::interpolate_matches(const std::vector<MatchResult>& match
     }
 
     // finally backfill the time information for those points that dont have it
-    auto backfill = interpolated.begin();
-    while (backfill != interpolated.end()) {
-      // this one is done already
-      if (backfill->epoch_time != -1) {
-        ++backfill;
-        continue;
-      }
-      // find the range that have values (or the ends of the range
-      auto left = backfill != interpolated.begin() ? std::prev(backfill) : backfill;
-      auto right = std::next(backfill);
-      for (; right != interpolated.end() && right->epoch_time == -1; ++right) {
-        ;
-      }
-      // backfill between left and right
-      while (backfill != right) {
-        // if both indices are valid we interpolate
-        if (left != interpolated.begin() && right != interpolated.end()) {
-          double time_diff = right->epoch_time - left->epoch_time;
-          float distance_diff = right->total_distance - left->total_distance;
-          float distance_ratio =
-              distance_diff > 0 ? (backfill->total_distance - left->total_distance) / distance_diff
-                                : 0.f;
-          backfill->epoch_time = left->epoch_time + distance_ratio * time_diff;
-        } // if left index is valid we carry it forward if we can
-        else if (left != interpolated.begin() && backfill->total_distance == left->total_distance) {
-          backfill->epoch_time = left->epoch_time;
-          backfill->original_index = left->original_index;
-        }
-        // right index is valid we carry it forward if we can
-        else if (right != interpolated.end() && backfill->total_distance == right->total_distance) {
-          backfill->epoch_time = right->epoch_time;
-          backfill->original_index = right->original_index;
-        }
-        // next backfill
-        ++backfill;
-      }
-    }
+    backfill_times(interpolated.begin() + first, interpolated.end());
 
     // keep this set of interpolations
-    interpolations.emplace_back(std::move(interpolated));
+    ends.push_back(interpolated.size());
   }
-
-  // give back the distances and updated match results
-  return interpolations;
 }
 
 // Compute queue length. Determine where (and if) speed drops below the
@@ -297,128 +445,156 @@ std::vector<traffic_segment_t>
 TrafficSegmentMatcher::form_segments(const std::list<std::vector<interpolation_t>>& interpolations,
                                      baldr::GraphReader& reader) const {
   // loop over each set of interpolations
+  std::vector<merged_traffic_segment_t> merged_segments;
   std::vector<traffic_segment_t> traffic_segments;
+  size_t count = 0;
   for (const auto& markers : interpolations) {
-    /*printf("\nInterpolations:\n");
-    for(const auto& marker : markers)
-      print(marker);*/
-
-    // get all the segments for this matched path merging them into single entries
-    auto merged_segments = merge_segments(markers, reader);
-
-    /*printf("\nMerged Segments:\n");
-    for(const auto& segment : merged_segments)
-      print(segment);
-    printf("\nReported Segments:\n");*/
-
-    // go over the segments and move the interpolation markers accordingly
-    float prior_start_acc_length = 0.0f;
-    float prior_end_acc_length = 0.0f;
-    auto left = markers.cbegin(), right = markers.cbegin();
-    for (const auto& segment : merged_segments) {
-      // move the left marker right until its adjacent to the segment begin
-      left = std::find_if(left, markers.cend(), [&segment](const interpolation_t& mark) {
-        return mark.edge == segment.begin_edge && mark.edge_distance >= segment->begin_percent_;
-      });
-      if (left->edge_distance > segment->begin_percent_) {
-        left = std::prev(left);
-      }
+    count = form_segments(markers.cbegin(), markers.cend(), reader, merged_segments,
+                          traffic_segments, count);
+  }
+  traffic_segments.resize(count);
+  return traffic_segments;
+}
 
-      // move the right marker right until its adjacent to the segment end
-      right = std::find_if(right, markers.cend(), [&segment](const interpolation_t& mark) {
-        return mark.edge == segment.end_edge && mark.edge_distance >= segment->end_percent_;
-      });
+size_t TrafficSegmentMatcher::form_segments(std::vector<interpolation_t>::const_iterator begin,
+                                            std::vector<interpolation_t>::const_iterator end,
+                                            baldr::GraphReader& reader,
+                                            std::vector<merged_traffic_segment_t>& merged_segments,
+                                            std::vector<traffic_segment_t>& traffic_segments,
+                                            size_t count) const {
+  /*printf("\nInterpolations:\n");
+  for(auto marker = begin; marker != end; ++marker)
+    print(*marker);*/
+
+  // get all the segments for this matched path merging them into single entries
+  auto merged_count = merge_segments(begin, end, reader, merged_segments);
+
+  /*printf("\nMerged Segments:\n");
+  for(size_t i = 0; i < merged_count; ++i)
+    print(merged_segments[i]);
+  printf("\nReported Segments:\n");*/
+
+  // go over the segments and move the interpolation markers accordingly
+  float prior_start_acc_length = 0.0f;
+  float prior_end_acc_length = 0.0f;
+  auto left = begin, right = begin;
+  for (size_t idx = 0; idx < merged_count; ++idx) {
+    const auto& segment = merged_segments[idx];
+    // move the left marker right until its adjacent to the segment begin
+    left = std::find_if(left, end, [&segment](const interpolation_t& mark) {
+      return mark.edge == segment.begin_edge && mark.edge_distance >= segment->begin_percent_;
+    });
+    if (left->edge_distance > segment->begin_percent_) {
+      left = std::prev(left);
+    }
 
-      // skip any segments composed entirely of transition edges (should only be one edge really)
-      // they should have no valid segment id, be marked internal and also have no way ids
-      if (!segment->segment_id_.Is_Valid() && segment.internal && segment.way_ids.empty()) {
-        continue;
-      }
+    // move the right marker right until its adjacent to the segment end
+    right = std::find_if(right, end, [&segment](const interpolation_t& mark) {
+      return mark.edge == segment.end_edge && mark.edge_distance >= segment->end_percent_;
+    });
 
-      // interpolate the length and time at the start
-      double start_time = -1;
-      float start_length = -1;
-      auto next = segment->begin_percent_ == left->edge_distance ? left : std::next(left);
-      if (segment->starts_segment_ && left->epoch_time != -1 && next->epoch_time != -1) {
-        float start_diff = next->edge_distance - left->edge_distance;
-        float ratio =
-            start_diff > 0.f ? (segment->begin_percent_ - left->edge_distance) / start_diff : 0.f;
-        start_length = left->total_distance + (next->total_distance - left->total_distance) * ratio;
-        start_time = left->epoch_time + (next->epoch_time - left->epoch_time) * ratio;
-      }
+    // skip any segments composed entirely of transition edges (should only be one edge really)
+    // they should have no valid segment id, be marked internal and also have no way ids
+    if (!segment->segment_id_.Is_Valid() && segment.internal && segment.way_ids.empty()) {
+      continue;
+    }
 
-      // interpolate the length and time at the end
-      double end_time = -1;
-      float end_length = -1;
-      auto prev = segment->end_percent_ == right->edge_distance ? right : std::prev(right);
-      if (segment->ends_segment_ && prev->epoch_time != -1 && right->epoch_time != -1) {
-        float end_diff = right->edge_distance - prev->edge_distance;
-        float ratio = end_diff > 0.f ? (segment->end_percent_ - prev->edge_distance) / end_diff : 0.f;
-        end_length = prev->total_distance + (right->total_distance - prev->total_distance) * ratio;
-        end_time = prev->epoch_time + (right->epoch_time - prev->epoch_time) * ratio;
-      }
+    // interpolate the length and time at the start
+    double start_time = -1;
+    float start_length = -1;
+    auto next = segment->begin_percent_ == left->edge_distance ? left : std::next(left);
+    if (segment->starts_segment_ && left->epoch_time != -1 && next->epoch_time != -1) {
+      float start_diff = next->edge_distance - left->edge_distance;
+      float ratio =
+          start_diff > 0.f ? (segment->begin_percent_ - left->edge_distance) / start_diff : 0.f;
+      start_length = left->total_distance + (next->total_distance - left->total_distance) * ratio;
+      start_time = left->epoch_time + (next->epoch_time - left->epoch_time) * ratio;
+    }
 
-      // figure out the total length of the segment
-      int length = start_length != -1 && end_length != -1 ? (end_length - start_length) + .5f : -1;
-
-      // Special cases for turn channels:
-      //   if the prior segment is a turn channel set start to end time of
-      //       the prior segment. Update length if segment has a valid end
-      //   if this segment is a turn channel set the prior segment end time to
-      //       the start of this turn channel segment and set the prior
-      //       segment length
-      size_t idx = &segment - &merged_segments[0];
-      if (idx > 0 && merged_segments[idx - 1].turn_channel && start_length == -1) {
-        // Set the segment start time to the end time of the turn channel
-        if (traffic_segments.size() > 0) {
-          start_time = traffic_segments.back().end_time;
-        }
+    // interpolate the length and time at the end
+    double end_time = -1;
+    float end_length = -1;
+    auto prev = segment->end_percent_ == right->edge_distance ? right : std::prev(right);
+    if (segment->ends_segment_ && prev->epoch_time != -1 && right->epoch_time != -1) {
+      float end_diff = right->edge_distance - prev->edge_distance;
+      float ratio = end_diff > 0.f ? (segment->end_percent_ - prev->edge_distance) / end_diff : 0.f;
+      end_length = prev->total_distance + (right->total_distance - prev->total_distance) * ratio;
+      end_time = prev->epoch_time + (right->epoch_time - prev->epoch_time) * ratio;
+    }
 
-        // Update length if this segment has a valid end
-        if (segment->ends_segment_ && end_length != -1) {
-          length = (end_length - prior_end_acc_length) + traffic_segments.back().length / 2;
-        }
-      } else if (segment.turn_channel && traffic_segments.size() > 0 &&
-                 traffic_segments.back().end_time == -1) {
-        traffic_segments.back().end_time = start_time;
-        if (length > 0 && traffic_segments.back().start_time > 0.0) {
-          traffic_segments.back().length = (start_length - prior_start_acc_length) + length / 2;
-        }
+    // figure out the total length of the segment
+    int length = start_length != -1 && end_length != -1 ? (end_length - start_length) + .5f : -1;
+
+    // Special cases for turn channels:
+    //   if the prior segment is a turn channel set start to end time of
+    //       the prior segment. Update length if segment has a valid end
+    //   if this segment is a turn channel set the prior segment end time to
+    //       the start of this turn channel segment and set the prior
+    //       segment length
+    if (idx > 0 && merged_segments[idx - 1].turn_channel && start_length == -1) {
+      // Set the segment start time to the end time of the turn channel
+      if (count > 0) {
+        start_time = traffic_segments[count - 1].end_time;
       }
 
-      // Store prior start and end accumulated length
-      prior_start_acc_length = start_length; // left->total_distance;
-      prior_end_acc_length = end_length;     // right->total_distance;
+      // Update length if this segment has a valid end
+      if (segment->ends_segment_ && end_length != -1) {
+        length = (end_length - prior_end_acc_length) + traffic_segments[count - 1].length / 2;
+      }
+    } else if (segment.turn_channel && count > 0 && traffic_segments[count - 1].end_time == -1) {
+      auto& last = traffic_segments[count - 1];
+      last.end_time = start_time;
+      if (length > 0 && last.start_time > 0.0) {
+        last.length = (start_length - prior_start_acc_length) + length / 2;
+      }
+    }
 
-      // compute queue length (skip if this is a partial segment)
-      int queue_length = (length == -1) ? 0 : compute_queue_length(left, right, kQueueSpeedThreshold);
+    // Store prior start and end accumulated length
+    prior_start_acc_length = start_length; // left->total_distance;
+    prior_end_acc_length = end_length;     // right->total_distance;
 
-      // this is what we know so far
-      // NOTE: in both cases we take the left most value for the shape index in an effort to be
-      // conservative
+    // compute queue length (skip if this is a partial segment)
+    int queue_length = (length == -1) ? 0 : compute_queue_length(left, right, kQueueSpeedThreshold);
+
+    // this is what we know so far
+    // NOTE: in both cases we take the left most value for the shape index in an effort to be
+    // conservative
+    if (count == traffic_segments.size()) {
       traffic_segments.emplace_back(traffic_segment_t{segment->segment_id_, start_time,
                                                       left->original_index, end_time,
                                                       prev->original_index, length, queue_length,
                                                       segment.internal, segment.way_ids});
+    } else {
+      auto& reused = traffic_segments[count];
+      reused.segment_id = segment->segment_id_;
+      reused.start_time = start_time;
+      reused.begin_shape_index = left->original_index;
+      reused.end_time = end_time;
+      reused.end_shape_index = prev->original_index;
+      reused.length = length;
+      reused.queue_length = queue_length;
+      reused.internal = segment.internal;
+      reused.way_ids.assign(segment.way_ids.cbegin(), segment.way_ids.cend());
+    }
+    ++count;
 
-      // print(traffic_segments.back());
+    // print(traffic_segments[count - 1]);
 
-      // Break out of the loop once we are past where we have interpolations
-      // (e.g. for a long edge with many segments).
-      if (idx > 0 && right->epoch_time == -1) {
-        break;
-      }
+    // Break out of the loop once we are past where we have interpolations
+    // (e.g. for a long edge with many segments).
+    if (idx > 0 && right->epoch_time == -1) {
+      break;
+    }
 
-      // if the right side of this was the end of this edge then at least we need to start from the
-      // next edge
-      if (segment->end_percent_ == 1.f) {
-        ++right;
-        left = right;
-      }
+    // if the right side of this was the end of this edge then at least we need to start from the
+    // next edge
+    if (segment->end_percent_ == 1.f) {
+      ++right;
+      left = right;
     }
   }
 
-  return traffic_segments;
+  return count;
 }
 
 std::vector<meili::Measurement>
@@ -1,11 +1,50 @@
 #include "meili/transition_cost_model.h"
 #include "meili/routing.h"
 
+#include <boost/functional/hash.hpp>
+
 namespace {
 inline float GreatCircleDistance(const valhalla::meili::Measurement& left,
                                  const valhalla::meili::Measurement& right) {
   return left.lnglat().Distance(right.lnglat());
 }
+
+// What we need to know about each edge of a candidate to reuse a cached route
+struct candidate_edge_t {
+  valhalla::baldr::GraphId id;
+  float percent_along;
+  const valhalla::baldr::DirectedEdge* edge;
+  float length;
+  float secs;
+};
+
+// Routes can only be reused between candidates in the middle of edges, candidates at nodes are
+// routed to and from the node itself
+bool get_candidate_edges(valhalla::baldr::GraphReader& reader,
+                         const valhalla::sif::cost_ptr_t& costing,
+                         const valhalla::baldr::PathLocation& location,
+                         std::vector<candidate_edge_t>& edges) {
+  edges.clear();
+  for (const auto& edge : location.edges) {
+    if (!edge.id.Is_Valid() || edge.begin_node() || edge.end_node()) {
+      return false;
+    }
+    const valhalla::baldr::GraphTile* tile = nullptr;
+    const auto* directededge = reader.directededge(edge.id, tile);
+    if (directededge == nullptr) {
+      return false;
+    }
+    edges.push_back({edge.id, edge.percent_along, directededge,
+                     static_cast<float>(directededge->length()),
+                     costing->EdgeCost(directededge, tile->GetSpeed(directededge)).secs});
+  }
+  return true;
+}
+
+// The bounds left for the part of a route between the origin and destination edge
+inline float middle_bound(float bound, float origin_offset, float destination_offset) {
+  return bound - origin_offset - destination_offset;
+}
 } // namespace
 
 namespace valhalla {
@@ -26,7 +65,7 @@ TransitionCostModel::TransitionCostModel(baldr::GraphReader& graphreader,
       travelmode_(travelmode), beta_(beta), inv_beta_(1.f / beta_),
       breakage_distance_(breakage_distance), max_route_distance_factor_(max_route_distance_factor),
       max_route_time_factor_(max_route_time_factor),
-      turn_penalty_factor_(turn_penalty_factor), turn_cost_table_{0.f} {
+      turn_penalty_factor_(turn_penalty_factor), turn_cost_table_{0.f}, costing_signature_(0) {
   if (beta_ <= 0.f) {
     throw std::invalid_argument("Expect beta to be positive");
   }
@@ -141,6 +180,13 @@ void TransitionCostModel::UpdateRoute(const StateId& lhs, const StateId& rhs) co
     max_route_time = std::ceil(max_route_time);
   }
 
+  // Reuse routes between the candidate edges if we have them
+  if (route_cache_ &&
+      UpdateRouteFromCache(left, locations, unreached_stateids, edgelabel, approximator,
+                           right_measurement.search_radius(), max_route_distance, max_route_time)) {
+    return;
+  }
+
   labelset_ptr_t labelset = std::make_shared<LabelSet>(max_route_distance);
   const auto& results = find_shortest_path(graphreader_, locations, 0, labelset, approximator,
                                            right_measurement.search_radius(),
@@ -150,5 +196,281 @@ void TransitionCostModel::UpdateRoute(const StateId& lhs, const StateId& rhs) co
   left.SetRoute(unreached_stateids, results, labelset);
 }
 
+bool TransitionCostModel::UpdateRouteFromCache(const State& left,
+                                               const std::vector<baldr::PathLocation>& locations,
+                                               const std::vector<StateId>& stateids,
+                                               const Label* edgelabel,
+                                               const midgard::DistanceApproximator& approximator,
+                                               float search_radius,
+                                               float max_route_distance,
+                                               float max_route_time) const {
+  const auto& costing = mode_costing_[static_cast<size_t>(travelmode_)];
+
+  // Get the edges of all the candidates, we can only do this if they are all mid edge
+  std::vector<std::vector<candidate_edge_t>> candidates(locations.size());
+  for (size_t i = 0; i < locations.size(); ++i) {
+    if (!get_candidate_edges(graphreader_, costing, locations[i], candidates[i])) {
+      route_cache_->Count(false);
+      return false;
+    }
+  }
+
+  // The origin label as the search would have it, its edge is the predecessor of the origin edges
+  Label origin = edgelabel ? *edgelabel : Label();
+  origin.InitAsOrigin(travelmode_, 0, {});
+
+  // The search radius shapes the search heuristic so routes are only shared between equal radii
+  size_t signature = costing_signature_;
+  boost::hash_combine(signature, search_radius);
+
+  // Which origin edges can be taken and their u-turn costs
+  std::vector<bool> allowed(candidates[0].size());
+  std::vector<float> uturn_costs(candidates[0].size(), 0.f);
+  for (size_t i = 0; i < candidates[0].size(); ++i) {
+    const auto& o = candidates[0][i];
+    const baldr::GraphTile* tile = nullptr;
+    graphreader_.directededge(o.id, tile);
+    allowed[i] = !origin.edgeid().Is_Valid() || o.id == origin.edgeid() ||
+                 costing->Allowed(o.edge, origin, tile, o.id, 0, 0);
+    if (origin.edgeid().Is_Valid() && origin.edgeid() != o.id &&
+        origin.opp_local_idx() == o.edge->localedgeidx()) {
+      uturn_costs[i] = turn_cost_table_[0];
+    }
+  }
+
+  // The time bound on the part of a route between the origin and destination edge
+  auto time_bound = [max_route_time](const sif::Cost& origin_cost,
+                                     const sif::Cost& destination_cost) {
+    return max_route_time < 0
+               ? -1.f
+               : middle_bound(max_route_time, origin_cost.secs, destination_cost.secs);
+  };
+
+  // Tries to answer every destination with what is in the cache
+  auto compose = [&]() -> bool {
+    // The best option for each destination
+    struct best_t {
+      size_t origin;
+      size_t destination;
+      sif::Cost cost;
+      std::shared_ptr<const cached_route_t> route;
+    };
+    std::vector<best_t> bests(locations.size(), best_t{0, 0, {}, nullptr});
+    std::vector<bool> found(locations.size(), false);
+
+    // Pairs of edges the cache could only answer against the best of the other pairs
+    struct deferred_t {
+      size_t origin;
+      size_t destination;
+      sif::Cost outside;
+      float max_time;
+    };
+    std::vector<deferred_t> deferred;
+
+    for (size_t j = 1; j < locations.size(); ++j) {
+      // Keep the best one
+      auto keep = [&](size_t i, size_t k, const sif::Cost& cost,
+                      const std::shared_ptr<const cached_route_t>& route) {
+        if (cost.cost < max_route_distance && (max_route_time < 0 || cost.secs < max_route_time) &&
+            (!found[j] || cost.cost < bests[j].cost.cost)) {
+          bests[j] = best_t{i, k, cost, route};
+          found[j] = true;
+        }
+      };
+
+      deferred.clear();
+      for (size_t i = 0; i < candidates[0].size(); ++i) {
+        if (!allowed[i]) {
+          continue;
+        }
+        const auto& o = candidates[0][i];
+        const sif::Cost origin_cost(o.length * (1.f - o.percent_along),
+                                    o.secs * (1.f - o.percent_along));
+        for (size_t k = 0; k < candidates[j].size(); ++k) {
+          const auto& d = candidates[j][k];
+          // Straight along the same edge, nothing can beat that
+          if (o.id == d.id && o.percent_along <= d.percent_along) {
+            float f = d.percent_along - o.percent_along;
+            keep(i, k, sif::Cost(o.length * f, o.secs * f), nullptr);
+            continue;
+          }
+          // Everything else goes through the cache
+          const sif::Cost destination_cost(d.length * d.percent_along, d.secs * d.percent_along);
+          float max_dist =
+              middle_bound(max_route_distance, origin_cost.cost, destination_cost.cost);
+          float max_time = time_bound(origin_cost, destination_cost);
+          // There's no way we can get there within the bounds
+          if (max_dist <= 0.f || (0 <= max_route_time && max_time <= 0.f)) {
+            continue;
+          }
+          const auto route =
+              route_cache_->Get({signature, origin.edgeid(), o.id, d.id}, max_dist, max_time);
+          if (!route) {
+            deferred.push_back({i, k, origin_cost + destination_cost, max_time});
+          } else if (route->within(max_dist, max_time)) {
+            keep(i, k, origin_cost + route->cost + destination_cost, route);
+          }
+        }
+      }
+
+      // What the cache knows about the rest may be enough to tell they cant beat the best one
+      for (const auto& pair : deferred) {
+        const auto& o = candidates[0][pair.origin];
+        const auto& d = candidates[j][pair.destination];
+        if (!found[j]) {
+          return false;
+        }
+        const float max_dist = bests[j].cost.cost - pair.outside.cost;
+        if (max_dist <= 0.f) {
+          continue;
+        }
+        const auto route =
+            route_cache_->Get({signature, origin.edgeid(), o.id, d.id}, max_dist, pair.max_time);
+        if (!route) {
+          return false;
+        }
+        if (route->within(max_dist, pair.max_time)) {
+          keep(pair.origin, pair.destination, pair.outside + route->cost, route);
+        }
+      }
+    }
+
+    // Rebuild the labels the search would have found
+    labelset_ptr_t labelset = std::make_shared<LabelSet>(max_route_distance);
+    const uint32_t origin_idx = labelset->append(origin);
+    std::unordered_map<uint16_t, uint32_t> results;
+    for (size_t j = 1; j < locations.size(); ++j) {
+      if (!found[j]) {
+        continue;
+      }
+      const auto& best = bests[j];
+      const auto& o = candidates[0][best.origin];
+      const auto& d = candidates[j][best.destination];
+      uint32_t predecessor = origin_idx;
+      float turn_cost = uturn_costs[best.origin];
+      if (best.route) {
+        // Along the origin edge
+        const sif::Cost origin_cost(o.length * (1.f - o.percent_along),
+                                    o.secs * (1.f - o.percent_along));
+        predecessor = labelset->append(Label(o.edge->endnode(), kInvalidDestination, o.id,
+                                             o.percent_along, 1.f, origin_cost,
+                                             best.route->origin_turn_cost, origin_cost.cost,
+                                             predecessor, o.edge, travelmode_));
+        // Between the edges
+        for (auto label : best.route->labels) {
+          const auto cost = label.cost() - best.route->base + origin_cost;
+          label.Update(predecessor, cost, cost.cost);
+          predecessor = labelset->append(label);
+        }
+        turn_cost = best.route->destination_turn_cost;
+      }
+      // Onto the destination edge
+      const float source = best.route ? 0.f : o.percent_along;
+      results[j] =
+          labelset->append(Label({}, static_cast<uint16_t>(j), d.id, source, d.percent_along,
+                                 best.cost, turn_cost, best.cost.cost, predecessor, d.edge,
+                                 travelmode_));
+    }
+
+    left.SetRoute(stateids, results, labelset);
+    return true;
+  };
+
+  // If everything was cached we are done
+  const bool cached = compose();
+  route_cache_->Count(cached);
+  if (cached) {
+    return true;
+  }
+
+  // Otherwise do the same search we would have done without the cache
+  labelset_ptr_t labelset = std::make_shared<LabelSet>(max_route_distance);
+  const auto results =
+      find_shortest_path(graphreader_, locations, 0, labelset, approximator, search_radius, costing,
+                         edgelabel, turn_cost_table_, max_route_distance, max_route_time);
+  left.SetRoute(stateids, results, labelset);
+
+  // And keep what it tells us about each pair of edges. The route it found to a destination is the
+  // best one between the edges it used. Every other pair of edges costs at least as much in total,
+  // otherwise the search would have found it first, and if the destination wasnt found at all
+  // there is nothing between any of the pairs within the bounds
+  for (size_t j = 1; j < locations.size(); ++j) {
+    const auto result = results.find(static_cast<uint16_t>(j));
+    size_t best_origin = candidates[0].size(), best_destination = candidates[j].size();
+    float total = max_route_distance;
+    if (result != results.end()) {
+      std::vector<Label> chain;
+      for (uint32_t idx = result->second; idx != baldr::kInvalidLabel;
+           idx = labelset->label(idx).predecessor()) {
+        chain.push_back(labelset->label(idx));
+      }
+      total = chain.front().cost().cost;
+      // destination, the ones between, origin edge and the origin itself
+      if (chain.size() >= 3) {
+        for (size_t i = 0; i < candidates[0].size(); ++i) {
+          if (candidates[0][i].id == chain[chain.size() - 2].edgeid()) {
+            best_origin = i;
+          }
+        }
+        for (size_t k = 0; k < candidates[j].size(); ++k) {
+          if (candidates[j][k].id == chain.front().edgeid()) {
+            best_destination = k;
+          }
+        }
+      }
+      if (best_origin < candidates[0].size() && best_destination < candidates[j].size()) {
+        const auto& o = candidates[0][best_origin];
+        const auto& d = candidates[j][best_destination];
+        const sif::Cost origin_cost(o.length * (1.f - o.percent_along),
+                                    o.secs * (1.f - o.percent_along));
+        const sif::Cost destination_cost(d.length * d.percent_along, d.secs * d.percent_along);
+        auto route = std::make_shared<cached_route_t>();
+        route->max_dist =
+            middle_bound(max_route_distance, origin_cost.cost, destination_cost.cost);
+        route->max_time = time_bound(origin_cost, destination_cost);
+        route->found = true;
+        route->base = chain[chain.size() - 2].cost();
+        route->origin_turn_cost = chain[chain.size() - 2].turn_cost();
+        route->destination_turn_cost = chain.front().turn_cost();
+        route->labels.assign(chain.rbegin() + 2, chain.rend() - 1);
+        route->cost =
+            route->labels.empty() ? sif::Cost() : route->labels.back().cost() - route->base;
+        route_cache_->Put({signature, origin.edgeid(), o.id, d.id}, route);
+      }
+    }
+
+    // Nothing between the other pairs costs less than what the search got to for this destination
+    for (size_t i = 0; i < candidates[0].size(); ++i) {
+      if (!allowed[i]) {
+        continue;
+      }
+      const auto& o = candidates[0][i];
+      const sif::Cost origin_cost(o.length * (1.f - o.percent_along),
+                                  o.secs * (1.f - o.percent_along));
+      for (size_t k = 0; k < candidates[j].size(); ++k) {
+        const auto& d = candidates[j][k];
+        // These dont need the cache and the best one was cached above
+        if ((o.id == d.id && o.percent_along <= d.percent_along) ||
+            (i == best_origin && k == best_destination)) {
+          continue;
+        }
+        const sif::Cost destination_cost(d.length * d.percent_along, d.secs * d.percent_along);
+        auto route = std::make_shared<cached_route_t>();
+        route->found = false;
+        route->max_dist = middle_bound(total, origin_cost.cost, destination_cost.cost);
+        route->max_time = time_bound(origin_cost, destination_cost);
+        // Dont replace something that already tells us more
+        const RouteCache::key_t key{signature, origin.edgeid(), o.id, d.id};
+        if (route->max_dist <= 0.f || (0 <= max_route_time && route->max_time <= 0.f) ||
+            route_cache_->Get(key, route->max_dist, route->max_time)) {
+          continue;
+        }
+        route_cache_->Put(key, route);
+      }
+    }
+  }
+  return true;
+}
+
 } // namespace meili
 } // namespace valhalla
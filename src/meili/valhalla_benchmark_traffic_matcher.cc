@@ -0,0 +1,79 @@
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "baldr/rapidjson_utils.h"
+#include <boost/property_tree/ptree.hpp>
+
+#include "meili/traffic_segment_matcher.h"
+
+using namespace valhalla::meili;
+
+// reads one trace of "lon lat time" lines, traces are separated by blank lines
+template <typename istream_t> probe_batch_t ReadBatch(istream_t& istream) {
+  std::string line;
+  probe_batch_t batch;
+  while (!istream.eof()) {
+    std::getline(istream, line);
+    if (line.empty()) {
+      if (batch.size() == 0) {
+        continue;
+      } else {
+        break;
+      }
+    }
+
+    double lon, lat, time;
+    std::stringstream stream(line);
+    stream >> lon >> lat >> time;
+    batch.lons.push_back(lon);
+    batch.lats.push_back(lat);
+    batch.times.push_back(time);
+  }
+  return batch;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 2) {
+    std::cout << "usage: valhalla_benchmark_traffic_matcher CONFIG [ITERATIONS] < TRACES"
+              << std::endl;
+    std::cout << "TRACES holds one \"lon lat time\" per line with blank lines between traces"
+              << std::endl;
+    return 1;
+  }
+
+  boost::property_tree::ptree config;
+  rapidjson::read_json(argv[1], config);
+  const size_t iterations = argc > 2 ? std::stoul(argv[2]) : 100;
+
+  // keep all the traces in memory so that only matching is timed
+  std::vector<probe_batch_t> batches;
+  for (auto batch = ReadBatch(std::cin); batch.size() > 0; batch = ReadBatch(std::cin)) {
+    batches.emplace_back(std::move(batch));
+  }
+  if (batches.empty()) {
+    std::cout << "No traces were read" << std::endl;
+    return 1;
+  }
+
+  // match them over and over through the binary interface
+  TrafficSegmentMatcher matcher(config);
+  std::vector<packed_segment_t> packed;
+  size_t points = 0, segments = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    for (const auto& batch : batches) {
+      segments += matcher.match(batch, packed);
+      points += batch.size();
+    }
+  }
+  double elapsed =
+      std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::cout << "Matched " << points << " points into " << segments << " segments in " << elapsed
+            << " seconds at " << points / elapsed << " points/sec" << std::endl;
+
+  return 0;
+}
@@ -3,214 +3,371 @@
 #include "midgard/logging.h"
 #include <boost/filesystem/operations.hpp>
 #include <spatialite.h>
+#include <algorithm>
+#include <cmath>
 #include <sqlite3.h>
 #include <unordered_map>
+#include <unordered_set>
 
-namespace valhalla {
-namespace mjolnir {
+namespace bgi = boost::geometry::index;
 
-// Get the dbhandle of a sqlite db.  Used for timezones and admins DBs.
-sqlite3* GetDBHandle(const std::string& database) {
+namespace {
 
-  // Initialize the admin DB (if it exists)
-  sqlite3* db_handle = nullptr;
-  if (!database.empty() && boost::filesystem::exists(database)) {
-    spatialite_init(0);
-    sqlite3_stmt* stmt = 0;
-    char* err_msg = nullptr;
-    std::string sql;
-    uint32_t ret = sqlite3_open_v2(database.c_str(), &db_handle, SQLITE_OPEN_READONLY, nullptr);
-    if (ret != SQLITE_OK) {
-      LOG_ERROR("cannot open " + database);
-      sqlite3_close(db_handle);
-      db_handle = nullptr;
-      return db_handle;
-    }
-
-    // loading SpatiaLite as an extension
-    sqlite3_enable_load_extension(db_handle, 1);
-#if SQLITE_VERSION_NUMBER > 3008007
-    sql = "SELECT load_extension('mod_spatialite')";
-#else
-    sql = "SELECT load_extension('libspatialite')";
-#endif
-    ret = sqlite3_exec(db_handle, sql.c_str(), nullptr, nullptr, &err_msg);
-    if (ret != SQLITE_OK) {
-      LOG_ERROR("load_extension() error: " + std::string(err_msg));
-      sqlite3_free(err_msg);
-      sqlite3_close(db_handle);
-    }
+// Get the text of a column or an empty string if its not text
+std::string column_text(sqlite3_stmt* stmt, int column) {
+  if (sqlite3_column_type(stmt, column) == SQLITE_TEXT) {
+    return (char*)sqlite3_column_text(stmt, column);
   }
-  return db_handle;
+  return "";
 }
 
-// Get the polygon index.  Used by tz and admin areas.  Checks if the pointLL is covered_by the
-// poly.
-uint32_t GetMultiPolyId(const std::unordered_map<uint32_t, multi_polygon_type>& polys,
-                        const PointLL& ll) {
-  uint32_t index = 0;
-  point_type p(ll.lng(), ll.lat());
-  for (const auto& poly : polys) {
-    if (boost::geometry::covered_by(p, poly.second)) {
-      return poly.first;
-    }
-  }
-  return index;
+using valhalla::mjolnir::point_type;
+
+// Which side of the line through a and b the point p is on, 0 if its on the line. This is the
+// same test boost uses so points boost sees on an edge are on it here too
+int side(const point_type& a, const point_type& b, const point_type& p) {
+  return boost::geometry::strategy::side::side_by_triangle<>::apply(a, b, p);
 }
 
-// Get the timezone polys from the db
-std::unordered_map<uint32_t, multi_polygon_type> GetTimeZones(sqlite3* db_handle,
-                                                              const AABB2<PointLL>& aabb) {
-  std::unordered_map<uint32_t, multi_polygon_type> polys;
-  if (!db_handle) {
-    return polys;
-  }
+// Whether a point that is on the line through a and b is also on the segment between them
+bool between(const point_type& a, const point_type& b, const point_type& p) {
+  return std::min(a.x(), b.x()) <= p.x() && p.x() <= std::max(a.x(), b.x()) &&
+         std::min(a.y(), b.y()) <= p.y() && p.y() <= std::max(a.y(), b.y());
+}
 
-  sqlite3_stmt* stmt = 0;
-  uint32_t ret;
-  char* err_msg = nullptr;
-  uint32_t result = 0;
+// 1 if the segments ab and cd cross each other and 0 if they dont. -1 if an end of one of them
+// is on the line through the other, which includes touching and overlapping, because boost
+// counts a point as on a line if it is close enough so it is not clear what it would say
+int crosses(const point_type& a, const point_type& b, const point_type& c, const point_type& d) {
+  int abc = side(a, b, c), abd = side(a, b, d), cda = side(c, d, a), cdb = side(c, d, b);
+  if (abc == 0 || abd == 0 || cda == 0 || cdb == 0) {
+    return -1;
+  }
+  return abc != abd && cda != cdb ? 1 : 0;
+}
 
-  std::string sql = "select TZID, st_astext(geom) from tz_world where ";
-  sql += "ST_Intersects(geom, BuildMBR(" + std::to_string(aabb.minx()) + ",";
-  sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-  sql += std::to_string(aabb.maxy()) + ")) ";
-  sql += "and rowid IN (SELECT rowid FROM SpatialIndex WHERE f_table_name = ";
-  sql += "'tz_world' AND search_frame = BuildMBR(" + std::to_string(aabb.minx()) + ",";
-  sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-  sql += std::to_string(aabb.maxy()) + "));";
+// below this many edges boost is quicker than the grid
+constexpr size_t kMinGridEdges = 512;
 
-  ret = sqlite3_prepare_v2(db_handle, sql.c_str(), sql.length(), &stmt, 0);
+} // namespace
 
-  if (ret == SQLITE_OK) {
-    result = sqlite3_step(stmt);
+namespace valhalla {
+namespace mjolnir {
 
-    while (result == SQLITE_ROW) {
-      std::string tz_id;
-      std::string geom;
+// Lay the grid over the polygon
+PreparedPolygon::PreparedPolygon(const polygon_type& polygon)
+    : polygon_(polygon), box_(boost::geometry::return_envelope<box_type>(polygon)) {
+  // the edges of the outer ring and the holes
+  auto add_ring = [this](const polygon_type::ring_type& ring) {
+    for (size_t i = 0; i + 1 < ring.size(); ++i) {
+      edges_.emplace_back(ring[i], ring[i + 1]);
+    }
+    if (ring.size() > 1 &&
+        (ring.front().x() != ring.back().x() || ring.front().y() != ring.back().y())) {
+      edges_.emplace_back(ring.back(), ring.front());
+    }
+  };
+  add_ring(polygon_.outer());
+  for (const auto& ring : polygon_.inners()) {
+    add_ring(ring);
+  }
+  if (edges_.size() < kMinGridEdges) {
+    columns_ = rows_ = 0;
+    cell_width_ = cell_height_ = 1.0;
+    edges_.clear();
+    edges_.shrink_to_fit();
+    return;
+  }
 
-      if (sqlite3_column_type(stmt, 0) == SQLITE_TEXT) {
-        tz_id = (char*)sqlite3_column_text(stmt, 0);
+  // a handful of edges per cell on average
+  auto size = static_cast<uint32_t>(std::sqrt(edges_.size() / 4.0));
+  columns_ = rows_ = std::max(1u, std::min(256u, size));
+  double width = box_.max_corner().x() - box_.min_corner().x();
+  double height = box_.max_corner().y() - box_.min_corner().y();
+  cell_width_ = width > 0 ? width / columns_ : 1.0;
+  cell_height_ = height > 0 ? height / rows_ : 1.0;
+
+  // put each edge in the cells it passes through. one extra cell on either side keeps edges on
+  // or right next to the border of a cell in both of the cells
+  std::vector<std::pair<uint32_t, uint32_t>> cell_edges;
+  for (uint32_t i = 0; i < edges_.size(); ++i) {
+    const auto& a = edges_[i].first;
+    const auto& b = edges_[i].second;
+    uint32_t column, row, first_row, last_row;
+    cell(point_type(a.x(), std::min(a.y(), b.y())), column, first_row);
+    cell(point_type(a.x(), std::max(a.y(), b.y())), column, last_row);
+    first_row = first_row > 0 ? first_row - 1 : 0;
+    last_row = std::min(last_row + 1, rows_ - 1);
+    for (row = first_row; row <= last_row; ++row) {
+      // the part of the edge within this row
+      double t0 = 0, t1 = 1;
+      if (a.y() != b.y()) {
+        double y = box_.min_corner().y() + row * cell_height_;
+        t0 = std::max(0.0, std::min(1.0, (y - a.y()) / (b.y() - a.y())));
+        t1 = std::max(0.0, std::min(1.0, (y + cell_height_ - a.y()) / (b.y() - a.y())));
       }
-      if (sqlite3_column_type(stmt, 1) == SQLITE_TEXT) {
-        geom = (char*)sqlite3_column_text(stmt, 1);
+      double x0 = a.x() + t0 * (b.x() - a.x());
+      double x1 = a.x() + t1 * (b.x() - a.x());
+      uint32_t first_column, last_column, r;
+      cell(point_type(std::min(x0, x1), a.y()), first_column, r);
+      cell(point_type(std::max(x0, x1), a.y()), last_column, r);
+      first_column = first_column > 0 ? first_column - 1 : 0;
+      last_column = std::min(last_column + 1, columns_ - 1);
+      for (column = first_column; column <= last_column; ++column) {
+        cell_edges.emplace_back(row * columns_ + column, i);
       }
+    }
+  }
+  std::sort(cell_edges.begin(), cell_edges.end());
+  cell_offsets_.resize(columns_ * rows_ + 1, 0);
+  cell_edges_.reserve(cell_edges.size());
+  for (const auto& cell_edge : cell_edges) {
+    ++cell_offsets_[cell_edge.first + 1];
+    cell_edges_.push_back(cell_edge.second);
+  }
+  for (size_t i = 1; i < cell_offsets_.size(); ++i) {
+    cell_offsets_[i] += cell_offsets_[i - 1];
+  }
 
-      uint32_t idx = DateTime::get_tz_db().to_index(tz_id);
-      if (idx == 0) {
-        result = sqlite3_step(stmt);
-        continue;
+  // walk each row from left of the polygon, where we are outside, to the middle of each cell in
+  // turn. the way from one middle to the next is split at the border between their cells so each
+  // part only crosses the edges of one cell
+  cell_states_.resize(columns_ * rows_, CellState::kUnknown);
+  for (uint32_t row = 0; row < rows_; ++row) {
+    bool known = true;
+    bool inside = false;
+    point_type from(box_.min_corner().x() - cell_width_ / 2, center(0, row).y());
+    for (uint32_t column = 0; column < columns_; ++column) {
+      uint32_t cell = row * columns_ + column;
+      point_type to = center(column, row);
+      point_type border(box_.min_corner().x() + column * cell_width_, to.y());
+      known = known && (column == 0 || flip(from, border, cell - 1, inside)) &&
+              flip(column == 0 ? from : border, to, cell, inside);
+
+      // something lines up with the middle of the cell, let boost work it out
+      if (!known) {
+        bool on_edge = false;
+        for (auto e = cell_offsets_[cell]; e < cell_offsets_[cell + 1] && !on_edge; ++e) {
+          const auto& edge = edges_[cell_edges_[e]];
+          on_edge = side(edge.first, edge.second, to) == 0 && between(edge.first, edge.second, to);
+        }
+        known = !on_edge;
+        inside = known && boost::geometry::within(to, polygon_);
       }
+      cell_states_[cell] = !known ? CellState::kUnknown
+                                  : (inside ? CellState::kInside : CellState::kOutside);
+      from = to;
+    }
+  }
+}
 
-      multi_polygon_type multi_poly;
-      boost::geometry::read_wkt(geom, multi_poly);
-      polys.emplace(idx, multi_poly);
+// Same as boost::geometry::covered_by
+bool PreparedPolygon::covers(const point_type& p) const {
+  if (!boost::geometry::covered_by(p, box_)) {
+    return false;
+  }
+  if (cell_states_.empty()) {
+    return boost::geometry::covered_by(p, polygon_);
+  }
 
-      result = sqlite3_step(stmt);
-    }
+  // count the edges between the point and the middle of its cell
+  uint32_t column, row;
+  uint32_t c = cell(p, column, row);
+  bool inside = cell_states_[c] == CellState::kInside;
+  if (cell_states_[c] == CellState::kUnknown || !flip(p, center(column, row), c, inside)) {
+    return boost::geometry::covered_by(p, polygon_);
   }
-  if (stmt) {
-    sqlite3_finalize(stmt);
-    stmt = 0;
+  return inside;
+}
+
+// The cell a point falls into, clamped to the grid
+uint32_t PreparedPolygon::cell(const point_type& p, uint32_t& column, uint32_t& row) const {
+  double x = std::floor((p.x() - box_.min_corner().x()) / cell_width_);
+  double y = std::floor((p.y() - box_.min_corner().y()) / cell_height_);
+  column = static_cast<uint32_t>(std::max(0.0, std::min(x, columns_ - 1.0)));
+  row = static_cast<uint32_t>(std::max(0.0, std::min(y, rows_ - 1.0)));
+  return row * columns_ + column;
+}
+
+point_type PreparedPolygon::center(const uint32_t column, const uint32_t row) const {
+  return point_type(box_.min_corner().x() + (column + 0.5) * cell_width_,
+                    box_.min_corner().y() + (row + 0.5) * cell_height_);
+}
+
+// Flip the state for each edge of the cell that crosses the segment
+bool PreparedPolygon::flip(const point_type& a,
+                           const point_type& b,
+                           const uint32_t cell,
+                           bool& state) const {
+  for (auto e = cell_offsets_[cell]; e < cell_offsets_[cell + 1]; ++e) {
+    const auto& edge = edges_[cell_edges_[e]];
+    int crossing = crosses(a, b, edge.first, edge.second);
+    if (crossing < 0) {
+      return false;
+    }
+    state = crossing ? !state : state;
   }
-  return polys;
+  return true;
 }
 
-// Get the admin polys that intersect with the tile bounding box.
-std::unordered_map<uint32_t, multi_polygon_type>
-GetAdminInfo(sqlite3* db_handle,
-             std::unordered_map<uint32_t, bool>& drive_on_right,
-             const AABB2<PointLL>& aabb,
-             GraphTileBuilder& tilebuilder) {
-  std::unordered_map<uint32_t, multi_polygon_type> polys;
-  if (!db_handle) {
-    return polys;
+// Add a polygon to the index
+void PolygonIndex::add(const uint32_t id, const multi_polygon_type& multi_poly) {
+  for (const auto& poly : multi_poly) {
+    parts_.emplace_back(id, PreparedPolygon(poly));
   }
+}
 
-  std::unordered_map<uint32_t, uint32_t> indexes;
-  sqlite3_stmt* stmt = 0;
-  uint32_t ret;
-  char* err_msg = nullptr;
-  uint32_t result = 0;
-  bool dor = true;
-  std::string geom;
-  std::string country_name, state_name, country_iso, state_iso;
-
-  std::string sql = "SELECT country.name, state.name, country.iso_code, ";
-  sql += "state.iso_code, state.drive_on_right, st_astext(state.geom) ";
-  sql += "from admins state, admins country where ";
-  sql += "ST_Intersects(state.geom, BuildMBR(" + std::to_string(aabb.minx()) + ",";
-  sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-  sql += std::to_string(aabb.maxy()) + ")) and ";
-  sql += "country.rowid = state.parent_admin and state.admin_level=4 ";
-  sql += "and state.rowid IN (SELECT rowid FROM SpatialIndex WHERE f_table_name = ";
-  sql += "'admins' AND search_frame = BuildMBR(" + std::to_string(aabb.minx()) + ",";
-  sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-  sql += std::to_string(aabb.maxy()) + "));";
+// Pack all the polygons added so far into the rtree
+void PolygonIndex::build() {
+  std::vector<value_type> values;
+  values.reserve(parts_.size());
+  for (uint32_t i = 0; i < parts_.size(); ++i) {
+    values.emplace_back(boost::geometry::return_envelope<box_type>(parts_[i].second.polygon()), i);
+  }
+  // the range constructor uses the packing algorithm which gives a better tree than inserting
+  rtree_ = rtree_type(values.begin(), values.end());
+}
 
-  ret = sqlite3_prepare_v2(db_handle, sql.c_str(), sql.length(), &stmt, 0);
+// Get the ids of the polygons that intersect the bounding box
+std::vector<uint32_t> PolygonIndex::intersects(const AABB2<PointLL>& aabb) const {
+  box_type box(point_type(aabb.minx(), aabb.miny()), point_type(aabb.maxx(), aabb.maxy()));
+  std::vector<value_type> candidates;
+  rtree_.query(bgi::intersects(box), std::back_inserter(candidates));
+  // keep the results in the order the polygons were added so they dont depend on the tree layout
+  std::sort(candidates.begin(), candidates.end(),
+            [](const value_type& a, const value_type& b) { return a.second < b.second; });
+
+  std::vector<uint32_t> ids;
+  std::unordered_set<uint32_t> seen;
+  for (const auto& candidate : candidates) {
+    const auto& part = parts_[candidate.second];
+    if (seen.find(part.first) == seen.end() &&
+        boost::geometry::intersects(box, part.second.polygon())) {
+      seen.insert(part.first);
+      ids.push_back(part.first);
+    }
+  }
+  return ids;
+}
 
-  if (ret == SQLITE_OK || ret == SQLITE_ERROR) {
-    result = sqlite3_step(stmt);
-    if (result == SQLITE_DONE) { // state/prov not found, try to find country
+// Get the id of a polygon that covers the point
+uint32_t PolygonIndex::covered_by(const PointLL& ll,
+                                  const std::function<bool(uint32_t)>& accept) const {
+  point_type p(ll.lng(), ll.lat());
+  std::vector<value_type> candidates;
+  rtree_.query(bgi::intersects(p), std::back_inserter(candidates));
+  std::sort(candidates.begin(), candidates.end(),
+            [](const value_type& a, const value_type& b) { return a.second < b.second; });
+
+  for (const auto& candidate : candidates) {
+    const auto& part = parts_[candidate.second];
+    if ((!accept || accept(part.first)) && part.second.covers(p)) {
+      return part.first;
+    }
+  }
+  return 0;
+}
 
-      sql = "SELECT name, \"\", iso_code, \"\", drive_on_right, st_astext(geom) from ";
-      sql += " admins where ST_Intersects(geom, BuildMBR(" + std::to_string(aabb.minx()) + ",";
-      sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-      sql += std::to_string(aabb.maxy()) + ")) and admin_level=2 ";
-      sql += "and rowid IN (SELECT rowid FROM SpatialIndex WHERE f_table_name = ";
-      sql += "'admins' AND search_frame = BuildMBR(" + std::to_string(aabb.minx()) + ",";
-      sql += std::to_string(aabb.miny()) + ", " + std::to_string(aabb.maxx()) + ",";
-      sql += std::to_string(aabb.maxy()) + "));";
+// Load all of the admins from the db and index them
+AdminIndex::AdminIndex(sqlite3* db_handle) {
+  if (!db_handle) {
+    return;
+  }
 
-      sqlite3_finalize(stmt);
-      stmt = 0;
-      ret = sqlite3_prepare_v2(db_handle, sql.c_str(), sql.length(), &stmt, 0);
+  // states have the country they belong to, countries have no state
+  std::vector<std::pair<std::string, PolygonIndex*>> queries{
+      {"SELECT country.name, state.name, country.iso_code, state.iso_code, state.drive_on_right, "
+       "st_astext(state.geom) from admins state, admins country where "
+       "country.rowid = state.parent_admin and state.admin_level=4;",
+       &states_},
+      {"SELECT name, \"\", iso_code, \"\", drive_on_right, st_astext(geom) from admins where "
+       "admin_level=2;",
+       &countries_},
+  };
+
+  for (const auto& query : queries) {
+    sqlite3_stmt* stmt = 0;
+    uint32_t ret =
+        sqlite3_prepare_v2(db_handle, query.first.c_str(), query.first.length(), &stmt, 0);
+    if (ret == SQLITE_OK) {
+      uint32_t result = sqlite3_step(stmt);
+      while (result == SQLITE_ROW) {
+        bool dor = true;
+        if (sqlite3_column_type(stmt, 4) == SQLITE_INTEGER) {
+          dor = sqlite3_column_int(stmt, 4);
+        }
+        info_.push_back({column_text(stmt, 0), column_text(stmt, 1), column_text(stmt, 2),
+                         column_text(stmt, 3), dor});
+
+        multi_polygon_type multi_poly;
+        boost::geometry::read_wkt(column_text(stmt, 5), multi_poly);
+        query.second->add(info_.size(), multi_poly);
 
-      if (ret == SQLITE_OK) {
-        result = 0;
         result = sqlite3_step(stmt);
       }
     }
-    while (result == SQLITE_ROW) {
-
-      country_name = "";
-      state_name = "";
-      country_iso = "";
-      state_iso = "";
+    if (stmt) {
+      sqlite3_finalize(stmt);
+      stmt = 0;
+    }
+    query.second->build();
+  }
+}
 
-      if (sqlite3_column_type(stmt, 0) == SQLITE_TEXT) {
-        country_name = (char*)sqlite3_column_text(stmt, 0);
-      }
+// Add the admins intersecting the bounding box to the tile
+AdminIndex::TileAdmins AdminIndex::AddAdmins(const AABB2<PointLL>& aabb,
+                                             GraphTileBuilder& tilebuilder) const {
+  TileAdmins admins;
+  if (info_.empty()) {
+    return admins;
+  }
 
-      if (sqlite3_column_type(stmt, 1) == SQLITE_TEXT) {
-        state_name = (char*)sqlite3_column_text(stmt, 1);
-      }
+  admins.polys = &states_;
+  auto ids = states_.intersects(aabb);
+  if (ids.empty()) { // state/prov not found, try to find country
+    admins.polys = &countries_;
+    ids = countries_.intersects(aabb);
+  }
 
-      if (sqlite3_column_type(stmt, 2) == SQLITE_TEXT) {
-        country_iso = (char*)sqlite3_column_text(stmt, 2);
-      }
+  for (auto id : ids) {
+    const auto& info = info_[id - 1];
+    uint32_t index = tilebuilder.AddAdmin(info.country_name, info.state_name, info.country_iso,
+                                          info.state_iso);
+    admins.indexes.emplace(id, index);
+    admins.drive_on_right.emplace(index, info.drive_on_right);
+  }
+  return admins;
+}
 
-      if (sqlite3_column_type(stmt, 3) == SQLITE_TEXT) {
-        state_iso = (char*)sqlite3_column_text(stmt, 3);
-      }
+// Get the tile admin index of the admin covering the point
+uint32_t AdminIndex::TileAdmins::GetAdminIndex(const PointLL& ll) const {
+  if (!polys || indexes.empty()) {
+    return 0;
+  }
+  auto id =
+      polys->covered_by(ll, [this](uint32_t admin_id) { return indexes.count(admin_id) > 0; });
+  return id ? indexes.find(id)->second : 0;
+}
 
-      dor = true;
-      if (sqlite3_column_type(stmt, 4) == SQLITE_INTEGER) {
-        dor = sqlite3_column_int(stmt, 4);
-      }
+// Load all of the timezone polys from the db into a spatial index
+PolygonIndex GetTimeZoneIndex(sqlite3* db_handle) {
+  PolygonIndex polys;
+  if (!db_handle) {
+    return polys;
+  }
 
-      geom = "";
-      if (sqlite3_column_type(stmt, 5) == SQLITE_TEXT) {
-        geom = (char*)sqlite3_column_text(stmt, 5);
+  sqlite3_stmt* stmt = 0;
+  std::string sql = "select TZID, st_astext(geom) from tz_world;";
+  uint32_t ret = sqlite3_prepare_v2(db_handle, sql.c_str(), sql.length(), &stmt, 0);
+  if (ret == SQLITE_OK) {
+    uint32_t result = sqlite3_step(stmt);
+    while (result == SQLITE_ROW) {
+      uint32_t idx = DateTime::get_tz_db().to_index(column_text(stmt, 0));
+      if (idx != 0) {
+        multi_polygon_type multi_poly;
+        boost::geometry::read_wkt(column_text(stmt, 1), multi_poly);
+        polys.add(idx, multi_poly);
       }
-
-      uint32_t index = tilebuilder.AddAdmin(country_name, state_name, country_iso, state_iso);
-      multi_polygon_type multi_poly;
-      boost::geometry::read_wkt(geom, multi_poly);
-      polys.emplace(index, multi_poly);
-      drive_on_right.emplace(index, dor);
-
       result = sqlite3_step(stmt);
     }
   }
@@ -218,10 +375,45 @@ GetAdminInfo(sqlite3* db_handle,
     sqlite3_finalize(stmt);
     stmt = 0;
   }
-
+  polys.build();
   return polys;
 }
 
+// Get the dbhandle of a sqlite db.  Used for timezones and admins DBs.
+sqlite3* GetDBHandle(const std::string& database) {
+
+  // Initialize the admin DB (if it exists)
+  sqlite3* db_handle = nullptr;
+  if (!database.empty() && boost::filesystem::exists(database)) {
+    spatialite_init(0);
+    sqlite3_stmt* stmt = 0;
+    char* err_msg = nullptr;
+    std::string sql;
+    uint32_t ret = sqlite3_open_v2(database.c_str(), &db_handle, SQLITE_OPEN_READONLY, nullptr);
+    if (ret != SQLITE_OK) {
+      LOG_ERROR("cannot open " + database);
+      sqlite3_close(db_handle);
+      db_handle = nullptr;
+      return db_handle;
+    }
+
+    // loading SpatiaLite as an extension
+    sqlite3_enable_load_extension(db_handle, 1);
+#if SQLITE_VERSION_NUMBER > 3008007
+    sql = "SELECT load_extension('mod_spatialite')";
+#else
+    sql = "SELECT load_extension('libspatialite')";
+#endif
+    ret = sqlite3_exec(db_handle, sql.c_str(), nullptr, nullptr, &err_msg);
+    if (ret != SQLITE_OK) {
+      LOG_ERROR("load_extension() error: " + std::string(err_msg));
+      sqlite3_free(err_msg);
+      sqlite3_close(db_handle);
+    }
+  }
+  return db_handle;
+}
+
 // Get all the country access records from the db and save them to a map.
 std::unordered_map<std::string, std::vector<int>> GetCountryAccess(sqlite3* db_handle) {
 
@@ -48,18 +48,22 @@ constexpr double kMinimumInterval = 10.0f;
  * we also need to then update the edges that pointed to them
  *
  */
-std::map<GraphId, size_t>
-SortGraph(const std::string& nodes_file, const std::string& edges_file, const uint8_t level) {
+std::map<GraphId, size_t> SortGraph(const std::string& nodes_file,
+                                    const std::string& edges_file,
+                                    const uint8_t level,
+                                    const unsigned int threads) {
   LOG_INFO("Sorting graph...");
 
   // Sort nodes by graphid then by osmid, so its basically a set of tiles
   sequence<Node> nodes(nodes_file, false);
-  nodes.sort([](const Node& a, const Node& b) {
-    if (a.graph_id == b.graph_id) {
-      return a.node.osmid < b.node.osmid;
-    }
-    return a.graph_id < b.graph_id;
-  });
+  nodes.sort(
+      [](const Node& a, const Node& b) {
+        if (a.graph_id == b.graph_id) {
+          return a.node.osmid < b.node.osmid;
+        }
+        return a.graph_id < b.graph_id;
+      },
+      sequence<Node>::kSortBufferSize, threads);
   // run through the sorted nodes, going back to the edges they reference and updating each edge
   // to point to the first (out of the duplicates) nodes index. at the end of this there will be
   // tons of nodes that no edges reference, but we need them because they are the means by which
@@ -379,6 +383,8 @@ void BuildTileSet(const std::string& ways_file,
                   std::map<GraphId, size_t>::const_iterator tile_start,
                   std::map<GraphId, size_t>::const_iterator tile_end,
                   const uint32_t tile_creation_date,
+                  const AdminIndex& admins,
+                  const PolygonIndex& timezones,
                   const boost::property_tree::ptree& pt,
                   std::promise<DataQuality>& result) {
 
@@ -388,24 +394,6 @@ void BuildTileSet(const std::string& ways_file,
   sequence<Node> nodes(nodes_file, false);
   sequence<OSMRestriction> complex_restrictions(complex_restriction_file, false);
 
-  auto database = pt.get_optional<std::string>("admin");
-  // Initialize the admin DB (if it exists)
-  sqlite3* admin_db_handle = database ? GetDBHandle(*database) : nullptr;
-  if (!database) {
-    LOG_WARN("Admin db not found.  Not saving admin information.");
-  } else if (!admin_db_handle) {
-    LOG_WARN("Admin db " + *database + " not found.  Not saving admin information.");
-  }
-
-  database = pt.get_optional<std::string>("timezone");
-  // Initialize the tz DB (if it exists)
-  sqlite3* tz_db_handle = database ? GetDBHandle(*database) : nullptr;
-  if (!database) {
-    LOG_WARN("Time zone db not found.  Not saving time zone information.");
-  } else if (!tz_db_handle) {
-    LOG_WARN("Time zone db " + *database + " not found.  Not saving time zone information.");
-  }
-
   const auto& tl = TileHierarchy::levels().rbegin();
   Tiles<PointLL> tiling = tl->second.tiles;
 
@@ -444,26 +432,14 @@ void BuildTileSet(const std::string& ways_file,
 
       // Get the admin polygons. If only one exists for the tile check if the
       // tile is entirely inside the polygon
-      bool tile_within_one_admin = false;
       uint32_t id = tile_id.tileid();
-      std::unordered_map<uint32_t, multi_polygon_type> admin_polys;
-      std::unordered_map<uint32_t, bool> drive_on_right;
-      if (admin_db_handle) {
-        admin_polys = GetAdminInfo(admin_db_handle, drive_on_right, tiling.TileBounds(id), graphtile);
-        if (admin_polys.size() == 1) {
-          // TODO - check if tile bounding box is entirely inside the polygon...
-          tile_within_one_admin = true;
-        }
-      }
+      auto tile_admins = admins.AddAdmins(tiling.TileBounds(id), graphtile);
+      auto& drive_on_right = tile_admins.drive_on_right;
+      // TODO - check if tile bounding box is entirely inside the polygon...
+      bool tile_within_one_admin = tile_admins.indexes.size() == 1;
 
-      bool tile_within_one_tz = false;
-      std::unordered_map<uint32_t, multi_polygon_type> tz_polys;
-      if (tz_db_handle) {
-        tz_polys = GetTimeZones(tz_db_handle, tiling.TileBounds(id));
-        if (tz_polys.size() == 1) {
-          tile_within_one_tz = true;
-        }
-      }
+      auto tz_ids = timezones.intersects(tiling.TileBounds(id));
+      bool tile_within_one_tz = tz_ids.size() == 1;
 
       // Iterate through the nodes
       uint32_t idx = 0; // Current directed edge index
@@ -492,8 +468,8 @@ void BuildTileSet(const std::string& ways_file,
         PointLL node_ll{node.lng, node.lat};
 
         // Get the admin index
-        uint32_t admin_index = (tile_within_one_admin) ? admin_polys.begin()->first
-                                                       : GetMultiPolyId(admin_polys, node_ll);
+        uint32_t admin_index = (tile_within_one_admin) ? tile_admins.indexes.begin()->second
+                                                       : tile_admins.GetAdminIndex(node_ll);
 
         // Look for potential duplicates
         // CheckForDuplicates(nodeid, node, edgelengths, nodes, edges, osmdata.ways, stats);
@@ -616,11 +592,13 @@ void BuildTileSet(const std::string& ways_file,
 
           // Check for updated ref from relations.
           std::string ref;
-          auto iter = osmdata.way_ref.find(w.way_id());
-          if (iter != osmdata.way_ref.end()) {
-            if (w.ref_index() != 0) {
-              ref = GraphBuilder::GetRef(osmdata.ref_offset_map.name(w.ref_index()), iter->second);
+          auto way_refs = osmdata.way_ref.equal_range(w.way_id());
+          if (way_refs.first != way_refs.second && w.ref_index() != 0) {
+            std::string relation_ref;
+            for (auto iter = way_refs.first; iter != way_refs.second; ++iter) {
+              relation_ref += (relation_ref.empty() ? "" : ";") + iter->second;
             }
+            ref = GraphBuilder::GetRef(osmdata.ref_offset_map.name(w.ref_index()), relation_ref);
           }
 
           // Get the shape for the edge and compute its length
@@ -970,7 +948,7 @@ void BuildTileSet(const std::string& ways_file,
 
         // Set the time zone index
         uint32_t tz_index =
-            (tile_within_one_tz) ? tz_polys.begin()->first : GetMultiPolyId(tz_polys, node_ll);
+            (tile_within_one_tz) ? tz_ids.front() : timezones.covered_by(node_ll);
         graphtile.nodes().back().set_timezone(tz_index);
 
         // Increment the counts in the histogram
@@ -998,14 +976,6 @@ void BuildTileSet(const std::string& ways_file,
     }
   }
 
-  if (admin_db_handle) {
-    sqlite3_close(admin_db_handle);
-  }
-
-  if (tz_db_handle) {
-    sqlite3_close(tz_db_handle);
-  }
-
   // Let the main thread see how this thread faired
   result.set_value(stats);
 }
@@ -1028,6 +998,33 @@ void BuildLocalTiles(const unsigned int thread_count,
   uint32_t tile_creation_date =
       DateTime::days_from_pivot_date(DateTime::get_formatted_date(DateTime::iso_date_time(tz)));
 
+  // Load the admin and time zone polygons once, all the threads share them read only
+  auto database = pt.get_optional<std::string>("mjolnir.admin");
+  // Initialize the admin DB (if it exists)
+  sqlite3* admin_db_handle = database ? GetDBHandle(*database) : nullptr;
+  if (!database) {
+    LOG_WARN("Admin db not found.  Not saving admin information.");
+  } else if (!admin_db_handle) {
+    LOG_WARN("Admin db " + *database + " not found.  Not saving admin information.");
+  }
+  AdminIndex admins(admin_db_handle);
+  if (admin_db_handle) {
+    sqlite3_close(admin_db_handle);
+  }
+
+  database = pt.get_optional<std::string>("mjolnir.timezone");
+  // Initialize the tz DB (if it exists)
+  sqlite3* tz_db_handle = database ? GetDBHandle(*database) : nullptr;
+  if (!database) {
+    LOG_WARN("Time zone db not found.  Not saving time zone information.");
+  } else if (!tz_db_handle) {
+    LOG_WARN("Time zone db " + *database + " not found.  Not saving time zone information.");
+  }
+  PolygonIndex timezones = GetTimeZoneIndex(tz_db_handle);
+  if (tz_db_handle) {
+    sqlite3_close(tz_db_handle);
+  }
+
   LOG_INFO("Building " + std::to_string(tiles.size()) + " tiles with " +
            std::to_string(thread_count) + " threads...");
 
@@ -1055,7 +1052,8 @@ void BuildLocalTiles(const unsigned int thread_count,
                                      std::cref(nodes_file), std::cref(edges_file),
                                      std::cref(complex_restriction_file), std::cref(tile_dir),
                                      std::cref(osmdata), std::cref(sample), tile_start, tile_end,
-                                     tile_creation_date, std::cref(pt.get_child("mjolnir")),
+                                     tile_creation_date, std::cref(admins), std::cref(timezones),
+                                     std::cref(pt.get_child("mjolnir")),
                                      std::ref(results[i])));
   }
 
@@ -1107,7 +1105,7 @@ void GraphBuilder::Build(const boost::property_tree::ptree& pt,
                  });
 
   // Line up the nodes and then re-map the edges that the edges to them
-  auto tiles = SortGraph(nodes_file, edges_file, level);
+  auto tiles = SortGraph(nodes_file, edges_file, level, threads);
 
   // Reclassify links (ramps). Cannot do this when building tiles since the
   // edge list needs to be modified
@@ -1195,7 +1193,7 @@ std::vector<SignInfo> GraphBuilder::CreateExitSignInfoList(const OSMNode& node,
       exit_list.emplace_back(Sign::Type::kExitNumber, false, j_ref);
     }
   } else if (node.ref() && !fork) {
-    std::vector<std::string> n_refs = GetTagTokens(osmdata.node_ref.find(node.osmid)->second);
+    std::vector<std::string> n_refs = GetTagTokens(osmdata.node_ref.at(node.osmid));
     for (auto& n_ref : n_refs) {
       exit_list.emplace_back(Sign::Type::kExitNumber, false, n_ref);
     }
@@ -1270,7 +1268,7 @@ std::vector<SignInfo> GraphBuilder::CreateExitSignInfoList(const OSMNode& node,
     if (node.exit_to() && !fork) {
       std::string tmp;
       std::size_t pos;
-      std::vector<std::string> exit_tos = GetTagTokens(osmdata.node_exit_to.find(node.osmid)->second);
+      std::vector<std::string> exit_tos = GetTagTokens(osmdata.node_exit_to.at(node.osmid));
       for (auto& exit_to : exit_tos) {
 
         tmp = exit_to;
@@ -1325,7 +1323,7 @@ std::vector<SignInfo> GraphBuilder::CreateExitSignInfoList(const OSMNode& node,
 
   // Exit sign name
   if (node.name() && !fork) {
-    std::vector<std::string> names = GetTagTokens(osmdata.node_name.find(node.osmid)->second);
+    std::vector<std::string> names = GetTagTokens(osmdata.node_name.at(node.osmid));
     for (auto& name : names) {
       exit_list.emplace_back(Sign::Type::kExitName, false, name);
     }
@@ -1291,19 +1291,17 @@ void enhance(const boost::property_tree::ptree& pt,
 
         // Update access restrictions (update weight units)
         if (directededge.access_restriction()) {
-          auto restrictions =
-              tilebuilder.GetAccessRestrictions(nodeinfo.edge_index() + j, kAllAccess);
-
-          // Convert any US weight values from short ton (U.S. customary)
-          // to metric and add to the tile's access restriction list
-          if (country_code == "US" || country_code == "MM" || country_code == "LR") {
-            for (auto& res : restrictions) {
-              if (res.type() == AccessType::kMaxWeight || res.type() == AccessType::kMaxAxleLoad) {
-                res.set_value(std::round(res.value() * kTonsShortToMetric));
-              }
+          // Copy them out of the tile, convert any US weight values from short
+          // ton (U.S. customary) to metric and add to the tile's access restriction list
+          const bool short_tons =
+              country_code == "US" || country_code == "MM" || country_code == "LR";
+          for (const auto& r :
+               tilebuilder.GetAccessRestrictions(nodeinfo.edge_index() + j, kAllAccess)) {
+            AccessRestriction res = r;
+            if (short_tons &&
+                (res.type() == AccessType::kMaxWeight || res.type() == AccessType::kMaxAxleLoad)) {
+              res.set_value(std::round(res.value() * kTonsShortToMetric));
             }
-          }
-          for (const auto& res : restrictions) {
             access_restrictions.emplace_back(std::move(res));
           }
         }
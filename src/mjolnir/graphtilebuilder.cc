@@ -206,6 +206,24 @@ void GraphTileBuilder::StoreTileData() {
     in_mem.write(reinterpret_cast<const char*>(access_restriction_builder_.data()),
                  access_restriction_builder_.size() * sizeof(AccessRestriction));
 
+    // Summarize the truck restrictions of each edge and write the summaries, the tile is
+    // written in the current layout whatever the layout of the tile it was loaded from
+    header_builder_.set_format_version(kTileFormatVersion);
+    std::vector<TruckRestriction> truck_restrictions;
+    for (const auto& restriction : access_restriction_builder_) {
+      if (!(restriction.modes() & kTruckAccess)) {
+        continue;
+      }
+      if (truck_restrictions.empty() ||
+          truck_restrictions.back().edgeindex() != restriction.edgeindex()) {
+        truck_restrictions.emplace_back(restriction.edgeindex());
+      }
+      truck_restrictions.back().Add(restriction);
+    }
+    header_builder_.set_truck_restriction_count(truck_restrictions.size());
+    in_mem.write(reinterpret_cast<const char*>(truck_restrictions.data()),
+                 truck_restrictions.size() * sizeof(TruckRestriction));
+
     // Sort and write the transit departures
     header_builder_.set_departurecount(departure_builder_.size());
     std::sort(departure_builder_.begin(), departure_builder_.end());
@@ -247,6 +265,7 @@ void GraphTileBuilder::StoreTileData() {
         (sizeof(GraphTileHeader)) + (nodes_builder_.size() * sizeof(NodeInfo)) +
         (directededges_builder_.size() * sizeof(DirectedEdge)) +
         (access_restriction_builder_.size() * sizeof(AccessRestriction)) +
+        (truck_restrictions.size() * sizeof(TruckRestriction)) +
         (departure_builder_.size() * sizeof(TransitDeparture)) +
         (stop_builder_.size() * sizeof(TransitStop)) +
         (route_builder_.size() * sizeof(TransitRoute)) +
@@ -369,8 +388,10 @@ void GraphTileBuilder::Update(const std::vector<NodeInfo>& nodes,
     boost::filesystem::create_directories(filename.parent_path());
   }
 
-  // Open file. Truncate so we replace the contents.
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  // Write next to the tile and move it into place when done so that other threads reading the
+  // tile while it is updated get either all of the old or all of the new contents
+  boost::filesystem::path staged(filename.string() + ".tmp");
+  std::ofstream file(staged.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   if (file.is_open()) {
     // Write the header
     file.write(reinterpret_cast<const char*>(header_), sizeof(GraphTileHeader));
@@ -393,6 +414,7 @@ void GraphTileBuilder::Update(const std::vector<NodeInfo>& nodes,
     auto end = reinterpret_cast<const char*>(header()) + header()->end_offset();
     file.write(begin, end - begin);
     file.close();
+    boost::filesystem::rename(staged, filename);
   } else {
     throw std::runtime_error("GraphTileBuilder::Update - Failed to open file " + filename.string());
   }
@@ -874,7 +896,9 @@ void GraphTileBuilder::AddBins(const std::string& tile_dir,
   if (!boost::filesystem::exists(filename.parent_path())) {
     boost::filesystem::create_directories(filename.parent_path());
   }
-  std::ofstream file(filename.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+  // like Update the tile is moved into place once it is written
+  boost::filesystem::path staged(filename.string() + ".tmp");
+  std::ofstream file(staged.c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
   // open it
   if (file.is_open()) {
     // new header
@@ -891,6 +915,8 @@ void GraphTileBuilder::AddBins(const std::string& tile_dir,
     begin = reinterpret_cast<const char*>(tile->GetBin(kBinsDim - 1, kBinsDim - 1).end());
     end = reinterpret_cast<const char*>(tile->header()) + tile->header()->end_offset();
     file.write(begin, end - begin);
+    file.close();
+    boost::filesystem::rename(staged, filename);
   } // failed
   else {
     throw std::runtime_error("Failed to open file " + filename.string());
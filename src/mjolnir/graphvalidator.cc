@@ -6,6 +6,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/format.hpp>
+#include <atomic>
 #include <future>
 #include <iostream>
 #include <list>
@@ -18,6 +19,8 @@
 #include <string>
 #include <thread>
 #include <tuple>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -295,6 +298,65 @@ uint32_t GetOpposingEdgeIndex(const GraphId& startnode,
   return opp_index;
 }
 
+// Count the nodes that can be reached from the given node with kReachAccess, the same way loki
+// expands the graph to check reachability. Transition edges are followed but the nodes on the
+// other level are not counted again. The counting stops once kMaxStoredReach nodes are found.
+// Tiles are written by moving them into place so the reader needs no locking here
+uint32_t CountReach(GraphReader& reader,
+                    const GraphId& start,
+                    std::unordered_set<GraphId>& visited,
+                    std::queue<GraphId>& queue) {
+  // If you cant get through the start node you cant go anywhere
+  const GraphTile* tile = reader.GetGraphTile(start);
+  if (tile == nullptr || !(tile->node(start)->access() & kReachAccess)) {
+    return 0;
+  }
+
+  visited.clear();
+  queue = {};
+  visited.insert(start);
+  queue.push(start);
+  uint32_t reach = 1;
+  while (!queue.empty() && reach < kMaxStoredReach) {
+    GraphId node_id = queue.front();
+    queue.pop();
+    if (tile->id() != node_id.Tile_Base()) {
+      tile = reader.GetGraphTile(node_id);
+      if (tile == nullptr) {
+        continue;
+      }
+    }
+
+    // Expand along the usable edges
+    const NodeInfo* node = tile->node(node_id);
+    const DirectedEdge* edge = tile->directededge(node->edge_index());
+    for (uint32_t i = 0; i < node->edge_count() && reach < kMaxStoredReach; ++i, ++edge) {
+      bool transition = edge->IsTransition();
+      if (!transition && (edge->is_shortcut() || !(edge->forwardaccess() & kReachAccess))) {
+        continue;
+      }
+      if (visited.find(edge->endnode()) != visited.end()) {
+        continue;
+      }
+
+      // The end node has to let us through
+      const GraphTile* end_tile = tile;
+      if (tile->id() != edge->endnode().Tile_Base()) {
+        end_tile = reader.GetGraphTile(edge->endnode());
+      }
+      if (end_tile == nullptr || !(end_tile->node(edge->endnode())->access() & kReachAccess)) {
+        continue;
+      }
+      visited.insert(edge->endnode());
+      queue.push(edge->endnode());
+      if (!transition) {
+        ++reach;
+      }
+    }
+  }
+  return reach;
+}
+
 using tweeners_t = GraphTileBuilder::tweeners_t;
 void validate(
     const boost::property_tree::ptree& pt,
@@ -308,7 +370,7 @@ void validate(
   GraphReader graph_reader(pt.get_child("mjolnir"));
   // Get some things we need throughout
   auto numLevels = TileHierarchy::levels().size() + 1; // To account for transit
-  auto transit_level = TileHierarchy::levels().rbegin()->second.level + 1;
+  uint32_t transit_level = TileHierarchy::levels().rbegin()->second.level + 1;
 
   // vector to hold densities for each level
   std::vector<std::vector<float>> densities(numLevels);
@@ -319,6 +381,11 @@ void validate(
   // Vector to hold problem ways
   std::set<uint64_t> problem_ways;
 
+  // Scratch space for the reachability expansions
+  std::unordered_set<GraphId> visited;
+  std::queue<GraphId> queue;
+  std::unordered_map<GraphId, uint32_t> forward_reach;
+
   // Check for more tiles
   while (true) {
     lock.lock();
@@ -349,15 +416,14 @@ void validate(
     std::vector<DirectedEdge> directededges;
 
     // Get this tile
-    lock.lock();
     const GraphTile* tile = graph_reader.GetGraphTile(tile_id);
-    lock.unlock();
 
     // Iterate through the nodes and the directed edges
     uint32_t dupcount = 0;
     float roadlength = 0.0f;
     uint32_t nodecount = tilebuilder.header()->nodecount();
     GraphId node = tile_id;
+    forward_reach.clear();
     for (uint32_t i = 0; i < nodecount; i++, ++node) {
       // The node we will modify
       NodeInfo nodeinfo = tilebuilder.node(i);
@@ -391,7 +457,7 @@ void validate(
         if (ar_modes) {
           // since only truck restrictions exist, we can still get all restrictions
           auto res = tile->GetAccessRestrictions(idx, kAllAccess);
-          if (res.size() == 0) {
+          if (res.empty()) {
             LOG_ERROR(
                 "Directed edge marked as having access restriction but none found ; tile level = " +
                 std::to_string(tile_id.level()));
@@ -422,9 +488,7 @@ void validate(
           directededge.set_leaves_tile(true);
 
           // Get the end node tile
-          lock.lock();
           endnode_tile = graph_reader.GetGraphTile(directededge.endnode());
-          lock.unlock();
           // make sure this is set to false as access tag logic could of set this to true.
         } else {
           directededge.set_leaves_tile(false);
@@ -458,7 +522,7 @@ void validate(
           uint32_t modes = 0;
           for (uint32_t mode = 1; mode < kAllAccess; mode *= 2) {
             if ((de->end_restriction() & mode) &&
-                tile->GetRestrictions(true, edgeid, mode).size() > 0) {
+                !tile->GetRestrictions(true, edgeid, mode).empty()) {
               modes |= mode;
             }
           }
@@ -468,13 +532,25 @@ void validate(
           uint32_t modes = 0;
           for (uint32_t mode = 1; mode < kAllAccess; mode *= 2) {
             if ((de->start_restriction() & mode) &&
-                tile->GetRestrictions(false, edgeid, mode).size() > 0) {
+                !tile->GetRestrictions(false, edgeid, mode).empty()) {
               modes |= mode;
             }
           }
           directededge.set_start_restriction(modes);
         }
 
+        // Store the reachability of the edge so loki doesnt have to expand the graph to find it
+        if (level != transit_level && !directededge.IsTransition() && !directededge.is_shortcut()) {
+          auto reach = forward_reach.find(directededge.endnode());
+          if (reach == forward_reach.end()) {
+            reach = forward_reach
+                        .emplace(directededge.endnode(),
+                                 CountReach(graph_reader, directededge.endnode(), visited, queue))
+                        .first;
+          }
+          directededge.set_reach(reach->second);
+        }
+
         // Add the directed edge to the local list
         directededges.emplace_back(std::move(directededge));
       }
@@ -502,19 +578,20 @@ void validate(
     }
     tilebuilder.header_builder().set_density(relative_density);
 
-    // Bin the edges
+    // Bin the edges. The tile's own bins go in front of the ones other tiles add to it so that
+    // all of its bins are written at once after every tile is validated
     auto bins = GraphTileBuilder::BinEdges(tile, tweeners);
+    if (tile->header()->graphid().level() == TileHierarchy::levels().rbegin()->first) {
+      auto& tile_bins = tweeners[tile_id];
+      for (size_t c = 0; c < kBinCount; ++c) {
+        tile_bins[c].insert(tile_bins[c].begin(), bins[c].cbegin(), bins[c].cend());
+      }
+    }
 
     // Write the new tile
     lock.lock();
     tilebuilder.Update(nodes, directededges);
 
-    // Write the bins to it
-    if (tile->header()->graphid().level() == TileHierarchy::levels().rbegin()->first) {
-      auto reloaded = GraphTile(graph_reader.tile_dir(), tile_id);
-      GraphTileBuilder::AddBins(graph_reader.tile_dir(), &reloaded, bins);
-    }
-
     // Check if we need to clear the tile cache
     if (graph_reader.OverCommitted()) {
       graph_reader.Clear();
@@ -534,52 +611,40 @@ void validate(
   result.set_value(std::make_tuple(std::move(duplicates), std::move(densities), std::move(tweeners)));
 }
 
-// take tweeners from different tiles' perspectives and merge into a single tweener
-// per tile that needs to update its bins
-void merge(const tweeners_t& in, tweeners_t& out) {
-  for (const auto& t : in) {
-    // shove it in
-    auto inserted = out.insert(t);
-    // had this tile already
-    if (!inserted.second) {
-      // so have to merge
-      for (size_t c = 0; c < kBinCount; ++c) {
-        auto& bin = inserted.first->second[c];
-        bin.insert(bin.end(), t.second[c].cbegin(), t.second[c].cend());
-      }
-    }
-  }
-}
-
-// crack open tiles and bin edges that pass through them but dont end or begin in them
+// crack open tiles and add their bins, both the tile's own edges and the ones that pass through
+// it but dont end or begin in it. each tile gathers what every validating thread binned into it
+// so that it is only written once
 void bin_tweeners(const std::string& tile_dir,
-                  tweeners_t::iterator& start,
-                  const tweeners_t::iterator& end,
-                  uint64_t dataset_id,
-                  std::mutex& lock) {
+                  const std::vector<GraphId>& tile_ids,
+                  std::atomic<size_t>& next,
+                  const std::vector<tweeners_t>& tweeners,
+                  uint64_t dataset_id) {
   // go while we have tiles to update
-  while (true) {
-    lock.lock();
-    if (start == end) {
-      lock.unlock();
-      break;
+  for (size_t i = next++; i < tile_ids.size(); i = next++) {
+    // merge this tile's bins from each thread
+    const auto& tile_id = tile_ids[i];
+    std::array<std::vector<GraphId>, kBinCount> bins;
+    for (const auto& thread_tweeners : tweeners) {
+      auto tile_bins = thread_tweeners.find(tile_id);
+      if (tile_bins == thread_tweeners.cend()) {
+        continue;
+      }
+      for (size_t c = 0; c < kBinCount; ++c) {
+        bins[c].insert(bins[c].end(), tile_bins->second[c].cbegin(), tile_bins->second[c].cend());
+      }
     }
-    // grab this tile and its extra bin edges
-    const auto& tile_bin = *start;
-    ++start;
-    lock.unlock();
 
     // if there is nothing there we need to make something
-    GraphTile tile(tile_dir, tile_bin.first);
+    GraphTile tile(tile_dir, tile_id);
 
     if (!tile.header()) {
-      GraphTileBuilder empty(tile_dir, tile_bin.first, false);
+      GraphTileBuilder empty(tile_dir, tile_id, false);
       empty.header_builder().set_dataset_id(dataset_id);
       empty.StoreTileData();
-      tile = GraphTile(tile_dir, tile_bin.first);
+      tile = GraphTile(tile_dir, tile_id);
     }
     // keep the extra binned edges
-    GraphTileBuilder::AddBins(tile_dir, &tile, tile_bin.second);
+    GraphTileBuilder::AddBins(tile_dir, &tile, bins);
   }
 }
 } // namespace
@@ -631,7 +696,8 @@ void GraphValidator::Validate(const boost::property_tree::ptree& pt) {
   // Get the promise from the future
   std::vector<uint32_t> duplicates(TileHierarchy::levels().size(), 0);
   std::vector<std::vector<float>> densities(3);
-  tweeners_t tweeners;
+  std::vector<tweeners_t> tweeners;
+  std::unordered_set<GraphId> binned_tiles;
   for (auto& result : results) {
     auto data = result.get_future().get();
     // Total up duplicates for each level
@@ -641,18 +707,21 @@ void GraphValidator::Validate(const boost::property_tree::ptree& pt) {
         densities[i].push_back(d);
       }
     }
-    // keep track of tweeners
-    merge(std::get<2>(data), tweeners);
+    // keep track of tweeners and which tiles they go to
+    tweeners.emplace_back(std::move(std::get<2>(data)));
+    for (const auto& tile_bins : tweeners.back()) {
+      binned_tiles.insert(tile_bins.first);
+    }
   }
   LOG_INFO("Finished");
 
-  // run a pass to add the edges that binned to tweener tiles
-  LOG_INFO("Binning inter-tile edges...");
-  auto start = tweeners.begin();
-  auto end = tweeners.end();
+  // run a pass to add the binned edges to their tiles
+  LOG_INFO("Binning edges...");
+  std::vector<GraphId> tile_ids(binned_tiles.cbegin(), binned_tiles.cend());
+  std::atomic<size_t> next(0);
   for (auto& thread : threads) {
-    thread.reset(new std::thread(bin_tweeners, std::cref(tile_dir), std::ref(start), std::cref(end),
-                                 dataset_id, std::ref(lock)));
+    thread.reset(new std::thread(bin_tweeners, std::cref(tile_dir), std::cref(tile_ids),
+                                 std::ref(next), std::cref(tweeners), dataset_id));
   }
   for (auto& thread : threads) {
     thread->join();
@@ -3,10 +3,17 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <condition_variable>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <list>
 #include <map>
+#include <mutex>
+#include <queue>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -93,23 +100,26 @@ bool AddUpwardTransition(const GraphId& node,
   }
 }
 
-void SortSequences() {
+void SortSequences(const unsigned int threads) {
   // Sort the new nodes. Sort so highway level is first
   sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
-  new_to_old.sort([](const std::pair<GraphId, GraphId>& a, const std::pair<GraphId, GraphId>& b) {
-    if (a.first.level() == b.first.level()) {
-      if (a.first.tileid() == b.first.tileid()) {
-        return a.first.id() < b.first.id();
-      }
-      return a.first.tileid() < b.first.tileid();
-    }
-    return a.first.level() < b.first.level();
-  });
+  new_to_old.sort(
+      [](const std::pair<GraphId, GraphId>& a, const std::pair<GraphId, GraphId>& b) {
+        if (a.first.level() == b.first.level()) {
+          if (a.first.tileid() == b.first.tileid()) {
+            return a.first.id() < b.first.id();
+          }
+          return a.first.tileid() < b.first.tileid();
+        }
+        return a.first.level() < b.first.level();
+      },
+      sequence<std::pair<GraphId, GraphId>>::kSortBufferSize, threads);
 
   // Sort old to new by node Id
   sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
   old_to_new.sort(
-      [](const OldToNewNodes& a, const OldToNewNodes& b) { return a.node_id < b.node_id; });
+      [](const OldToNewNodes& a, const OldToNewNodes& b) { return a.node_id < b.node_id; },
+      sequence<OldToNewNodes>::kSortBufferSize, threads);
 }
 
 // Convencience method to find the node association.
@@ -126,14 +136,19 @@ OldToNewNodes find_nodes(sequence<OldToNewNodes>& old_to_new, const GraphId& nod
   }
 }
 
-// Form tiles in the new level.
-void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
-  // Use the sequence that associate new nodes to old nodes
-  sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false);
-
-  // Use the sorted sequence that associates old nodes to new nodes
-  sequence<OldToNewNodes> old_to_new(old_to_new_file, false);
+// A range of the sorted new nodes that all belong to the same new tile
+struct NewTileRange {
+  GraphId tile_id;
+  uint64_t begin;
+  uint64_t end;
+};
 
+// Form one tile in the new level from its range of new nodes.
+void FormTileInNewLevel(GraphReader& reader,
+                        sequence<std::pair<GraphId, GraphId>>& new_to_old,
+                        sequence<OldToNewNodes>& old_to_new,
+                        const NewTileRange& range,
+                        bool has_elevation) {
   // lambda to indicate whether a directed edge should be included
   auto include_edge = [&old_to_new](const DirectedEdge* directededge, const GraphId& base_node,
                                     const uint8_t current_level) {
@@ -157,34 +172,13 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
     }
   };
 
-  // Iterate through the new nodes. They have been sorted by level so that
-  // highway level is done first.
-  reader.Clear();
+  // New tilebuilder for the tile
   bool added = false;
-  uint8_t current_level;
-  GraphId tile_id;
   std::hash<std::string> hasher;
-  GraphTileBuilder* tilebuilder = nullptr;
-  for (auto new_node = new_to_old.begin(); new_node != new_to_old.end(); new_node++) {
-    // Get the node - check if a new tile
+  uint8_t current_level = range.tile_id.level();
+  GraphTileBuilder tilebuilder(reader.tile_dir(), range.tile_id, false);
+  for (auto new_node = new_to_old[range.begin]; new_node != new_to_old[range.end]; new_node++) {
     GraphId nodea = (*new_node).first;
-    if (nodea.Tile_Base() != tile_id) {
-      // Store the prior tile
-      if (tilebuilder != nullptr) {
-        tilebuilder->StoreTileData();
-        delete tilebuilder;
-      }
-
-      // New tilebuilder for the next tile. Update current level.
-      tile_id = nodea.Tile_Base();
-      tilebuilder = new GraphTileBuilder(reader.tile_dir(), tile_id, false);
-      current_level = nodea.level();
-
-      // Check if we need to clear the base/local tile cache
-      if (reader.OverCommitted()) {
-        reader.Clear();
-      }
-    }
 
     // Get the node in the base level
     GraphId base_node = (*new_node).second;
@@ -195,23 +189,23 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
     }
 
     // Copy the data version
-    tilebuilder->header_builder().set_dataset_id(tile->header()->dataset_id());
+    tilebuilder.header_builder().set_dataset_id(tile->header()->dataset_id());
 
     // Copy node information
     NodeInfo baseni = *(tile->node(base_node.id()));
-    tilebuilder->nodes().push_back(baseni);
+    tilebuilder.nodes().push_back(baseni);
     const auto& admin = tile->admininfo(baseni.admin_index());
-    NodeInfo& node = tilebuilder->nodes().back();
-    node.set_edge_index(tilebuilder->directededges().size());
+    NodeInfo& node = tilebuilder.nodes().back();
+    node.set_edge_index(tilebuilder.directededges().size());
     node.set_timezone(baseni.timezone());
-    node.set_admin_index(tilebuilder->AddAdmin(admin.country_text(), admin.state_text(),
-                                               admin.country_iso(), admin.state_iso()));
+    node.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
+                                              admin.country_iso(), admin.state_iso()));
 
     // Density at this node
     uint32_t density1 = baseni.density();
 
     // Current edge count
-    size_t edge_count = tilebuilder->directededges().size();
+    size_t edge_count = tilebuilder.directededges().size();
 
     // Iterate through directed edges of the base node to get remaining
     // directed edges (based on classification/importance cutoff)
@@ -265,13 +259,13 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
         if (signs.size() == 0) {
           LOG_ERROR("Base edge should have signs, but none found");
         }
-        tilebuilder->AddSigns(tilebuilder->directededges().size(), signs);
+        tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
       }
 
       // Get turn lanes from the base directed edge
       if (directededge->turnlanes()) {
         uint32_t offset = tile->turnlanes_offset(base_edge_id.id());
-        tilebuilder->AddTurnLanes(tilebuilder->directededges().size(), tile->GetName(offset));
+        tilebuilder.AddTurnLanes(tilebuilder.directededges().size(), tile->GetName(offset));
       }
 
       // Get access restrictions from the base directed edge. Add these to
@@ -280,8 +274,8 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
       if (directededge->access_restriction()) {
         auto restrictions = tile->GetAccessRestrictions(base_edge_id.id(), kAllAccess);
         for (const auto& res : restrictions) {
-          tilebuilder->AddAccessRestriction(AccessRestriction(tilebuilder->directededges().size(),
-                                                              res.type(), res.modes(), res.value()));
+          tilebuilder.AddAccessRestriction(AccessRestriction(tilebuilder.directededges().size(),
+                                                             res.type(), res.modes(), res.value()));
         }
       }
 
@@ -292,9 +286,9 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
           LOG_ERROR("Base edge should have lane connectivity, but none found");
         }
         for (auto& lc : laneconnectivity) {
-          lc.set_to(tilebuilder->directededges().size());
+          lc.set_to(tilebuilder.directededges().size());
         }
-        tilebuilder->AddLaneConnectivity(laneconnectivity);
+        tilebuilder.AddLaneConnectivity(laneconnectivity);
       }
 
       // Get edge info, shape, and names from the old tile and add to the
@@ -306,20 +300,20 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
       std::string encoded_shape = edgeinfo.encoded_shape();
       uint32_t w = hasher(encoded_shape + std::to_string(edgeinfo.wayid()));
       uint32_t edge_info_offset =
-          tilebuilder->AddEdgeInfo(w, nodea, nodeb, edgeinfo.wayid(), encoded_shape,
-                                   tile->GetNames(idx), tile->GetTypes(idx), added);
+          tilebuilder.AddEdgeInfo(w, nodea, nodeb, edgeinfo.wayid(), encoded_shape,
+                                  tile->GetNames(idx), tile->GetTypes(idx), added);
       newedge.set_edgeinfo_offset(edge_info_offset);
 
       // Add directed edge
-      tilebuilder->directededges().emplace_back(std::move(newedge));
+      tilebuilder.directededges().emplace_back(std::move(newedge));
 
       // Add edge elevation
       if (has_elevation) {
         const EdgeElevation* elev = tile->edge_elevation(base_edge_id);
         if (elev == nullptr) {
-          tilebuilder->edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
+          tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
         } else {
-          tilebuilder->edge_elevations().emplace_back(std::move(*elev));
+          tilebuilder.edge_elevations().emplace_back(std::move(*elev));
         }
       }
     }
@@ -327,26 +321,165 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
     // Add transition edges
     auto new_nodes = find_nodes(old_to_new, base_node);
     if (current_level == 0) {
-      AddDownwardTransition(new_nodes.arterial_node, tilebuilder, has_elevation);
-      AddDownwardTransition(new_nodes.local_node, tilebuilder, has_elevation);
+      AddDownwardTransition(new_nodes.arterial_node, &tilebuilder, has_elevation);
+      AddDownwardTransition(new_nodes.local_node, &tilebuilder, has_elevation);
     } else if (current_level == 1) {
-      AddDownwardTransition(new_nodes.local_node, tilebuilder, has_elevation);
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder, has_elevation);
+      AddDownwardTransition(new_nodes.local_node, &tilebuilder, has_elevation);
+      AddUpwardTransition(new_nodes.highway_node, &tilebuilder, has_elevation);
     }
     if (current_level == 2) {
-      AddUpwardTransition(new_nodes.arterial_node, tilebuilder, has_elevation);
-      AddUpwardTransition(new_nodes.highway_node, tilebuilder, has_elevation);
+      AddUpwardTransition(new_nodes.arterial_node, &tilebuilder, has_elevation);
+      AddUpwardTransition(new_nodes.highway_node, &tilebuilder, has_elevation);
     }
 
     // Set the edge count for the new node
-    node.set_edge_count(tilebuilder->directededges().size() - edge_count);
+    node.set_edge_count(tilebuilder.directededges().size() - edge_count);
+  }
+
+  // Store the tile
+  tilebuilder.StoreTileData();
+}
+
+// Form tiles in the new level. Each thread takes the next tile from the queue and uses its own
+// graph reader and its own view of the node association sequences.
+void FormTilesInNewLevel(const boost::property_tree::ptree& hierarchy_properties,
+                         bool has_elevation,
+                         std::queue<NewTileRange>& tilequeue,
+                         std::mutex& lock,
+                         std::promise<void>& result) {
+  try {
+    GraphReader reader(hierarchy_properties);
+    sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false, 0);
+    sequence<OldToNewNodes> old_to_new(old_to_new_file, false, 0);
+    while (true) {
+      lock.lock();
+      if (tilequeue.empty()) {
+        lock.unlock();
+        break;
+      }
+      NewTileRange range = tilequeue.front();
+      tilequeue.pop();
+      lock.unlock();
+
+      FormTileInNewLevel(reader, new_to_old, old_to_new, range, has_elevation);
+
+      // Check if we need to clear the base/local tile cache
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
+    }
+  } catch (...) {
+    result.set_exception(std::current_exception());
+    return;
+  }
+  result.set_value();
+}
+
+// Form the tiles of all the new levels. The new nodes have been sorted by level so that the
+// highway level comes first. The local level tiles replace the base tiles they are formed from
+// so they are only formed once all the other levels, which read the base tiles, are done.
+void FormTilesInNewLevels(const boost::property_tree::ptree& hierarchy_properties,
+                          bool has_elevation,
+                          unsigned int thread_count) {
+  // Find the range of new nodes of each new tile
+  std::vector<std::queue<NewTileRange>> phases(2);
+  {
+    auto local_level = TileHierarchy::levels().rbegin()->second.level;
+    sequence<std::pair<GraphId, GraphId>> new_to_old(new_to_old_file, false, 0);
+    uint64_t i = 0;
+    GraphId tile_id;
+    for (auto new_node = new_to_old.begin(); new_node != new_to_old.end(); new_node++, i++) {
+      GraphId nodea = (*new_node).first;
+      if (nodea.Tile_Base() != tile_id) {
+        if (tile_id.Is_Valid()) {
+          phases[tile_id.level() == local_level].back().end = i;
+        }
+        tile_id = nodea.Tile_Base();
+        phases[tile_id.level() == local_level].push({tile_id, i, i});
+      }
+    }
+    if (tile_id.Is_Valid()) {
+      phases[tile_id.level() == local_level].back().end = i;
+    }
+  }
+
+  for (auto& tilequeue : phases) {
+    std::vector<std::shared_ptr<std::thread>> threads(thread_count);
+    std::list<std::promise<void>> results;
+    std::mutex lock;
+    for (auto& thread : threads) {
+      results.emplace_back();
+      thread.reset(new std::thread(FormTilesInNewLevel, std::cref(hierarchy_properties),
+                                   has_elevation, std::ref(tilequeue), std::ref(lock),
+                                   std::ref(results.back())));
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+    // If something bad went down this will rethrow it
+    for (auto& result : results) {
+      result.get_future().get();
+    }
   }
+}
+
+// The levels a base node exists on and the tiles it falls in on the highway and arterial levels
+struct NodeLevels {
+  bool levels[3];
+  GraphId highway_tile;
+  GraphId arterial_tile;
+  uint32_t density;
+};
+
+// The levels of all the nodes in a base tile
+struct BaseTileNodes {
+  bool has_elevation = false;
+  std::vector<NodeLevels> nodes;
+};
 
-  // Delete the tile builder
-  if (tilebuilder != nullptr) {
-    tilebuilder->StoreTileData();
-    delete tilebuilder;
+// Find on which levels the nodes of a base tile exist. Nodes are added to a new level when
+// their best road class <= the new level classification cutoff.
+BaseTileNodes GetNodeLevels(GraphReader& reader,
+                            const GraphId& base_tile_id,
+                            const TileLevel& arterial_level,
+                            const TileLevel& highway_level) {
+  // Get the graph tile. Skip if no tile exists or no nodes exist in the tile.
+  BaseTileNodes tile_nodes;
+  const GraphTile* tile = reader.GetGraphTile(base_tile_id);
+  if (tile == nullptr || tile->header()->nodecount() == 0) {
+    return tile_nodes;
+  }
+  tile_nodes.has_elevation = tile->header()->has_edge_elevation();
+
+  uint32_t nodecount = tile->header()->nodecount();
+  tile_nodes.nodes.resize(nodecount);
+  GraphId edgeid = base_tile_id;
+  const NodeInfo* nodeinfo = tile->node(base_tile_id);
+  for (uint32_t i = 0; i < nodecount; i++, nodeinfo++) {
+    // Iterate through the edges to see which levels this node exists.
+    auto& node = tile_nodes.nodes[i];
+    node.levels[0] = node.levels[1] = node.levels[2] = false;
+    for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, ++edgeid) {
+      // Update the flag for the level of this edge (skip transit
+      // connection edges)
+      const DirectedEdge* directededge = tile->directededge(edgeid);
+      if (directededge->use() != Use::kTransitConnection &&
+          directededge->use() != Use::kEgressConnection &&
+          directededge->use() != Use::kPlatformConnection) {
+        node.levels[TileHierarchy::get_level(directededge->classification())] = true;
+      }
+    }
+    if (node.levels[0]) {
+      node.highway_tile = GraphId(highway_level.tiles.TileId(nodeinfo->latlng()),
+                                  highway_level.level, 0);
+    }
+    if (node.levels[1]) {
+      node.arterial_tile = GraphId(arterial_level.tiles.TileId(nodeinfo->latlng()),
+                                   arterial_level.level, 0);
+    }
+    node.density = nodeinfo->density();
   }
+  return tile_nodes;
 }
 
 /**
@@ -355,9 +488,14 @@ void FormTilesInNewLevel(GraphReader& reader, bool has_elevation) {
  * associations go both ways: from the "old" nodes on the base/local level
  * to new nodes (using a mapping in memory) and from new nodes to old nodes
  * using a sequence (file).
+ *
+ * The base tiles are read by a pool of threads but the new node Ids depend
+ * on the order in which nodes are seen so the results are merged on this
+ * thread in the order of the tiles, just as if they were read serially.
  * @return  Returns true if any base tiles have edge elevation data.
  */
-bool CreateNodeAssociations(GraphReader& reader) {
+bool CreateNodeAssociations(const boost::property_tree::ptree& hierarchy_properties,
+                            unsigned int thread_count) {
   // Map of tiles vs. count of nodes. Used to construct new node Ids.
   std::unordered_map<GraphId, uint32_t> new_nodes;
 
@@ -390,81 +528,130 @@ bool CreateNodeAssociations(GraphReader& reader) {
   auto& highway_level = tile_level->second;
 
   // Get the set of tiles on the local level
-  auto local_tiles = reader.GetTileSet(base_level.level);
+  std::vector<GraphId> local_tiles;
+  {
+    GraphReader reader(hierarchy_properties);
+    auto tile_set = reader.GetTileSet(base_level.level);
+    local_tiles.assign(tile_set.begin(), tile_set.end());
+  }
 
-  // Iterate through all tiles in the local level
-  bool has_elevation = false;
-  uint32_t ntiles = base_level.tiles.TileCount();
-  uint32_t bl = static_cast<uint32_t>(base_level.level);
-  uint32_t al = static_cast<uint32_t>(arterial_level.level);
-  uint32_t hl = static_cast<uint32_t>(highway_level.level);
-  for (const auto& base_tile_id : local_tiles) {
-    // Get the graph tile. Skip if no tile exists or no nodes exist in the tile.
-    const GraphTile* tile = reader.GetGraphTile(base_tile_id);
-    if (tile == nullptr || tile->header()->nodecount() == 0) {
-      continue;
-    }
+  // The workers take the next tile and leave what they found for the merge. They only get so
+  // far ahead of the merge so that the results waiting for it stay bounded
+  const size_t max_ahead = thread_count * 16;
+  std::mutex lock;
+  std::condition_variable cv;
+  size_t next_tile = 0, merged = 0;
+  std::unordered_map<size_t, BaseTileNodes> done;
+  std::exception_ptr error;
+  auto work = [&]() {
+    try {
+      GraphReader reader(hierarchy_properties);
+      while (true) {
+        size_t i;
+        {
+          std::unique_lock<std::mutex> l(lock);
+          cv.wait(l, [&]() {
+            return error || next_tile == local_tiles.size() || next_tile < merged + max_ahead;
+          });
+          if (error || next_tile == local_tiles.size()) {
+            return;
+          }
+          i = next_tile++;
+        }
+        auto tile_nodes = GetNodeLevels(reader, local_tiles[i], arterial_level, highway_level);
+        {
+          std::unique_lock<std::mutex> l(lock);
+          done.emplace(i, std::move(tile_nodes));
+        }
+        cv.notify_all();
 
-    // Update the has_elevation flag
-    if (tile->header()->has_edge_elevation()) {
-      has_elevation = true;
+        // Check if we need to clear the tile cache
+        if (reader.OverCommitted()) {
+          reader.Clear();
+        }
+      }
+    } catch (...) {
+      std::unique_lock<std::mutex> l(lock);
+      if (!error) {
+        error = std::current_exception();
+      }
+      cv.notify_all();
     }
+  };
+  std::vector<std::shared_ptr<std::thread>> threads(thread_count);
+  for (auto& thread : threads) {
+    thread.reset(new std::thread(work));
+  }
 
-    // Iterate through the nodes. Add nodes to the new level when
-    // best road class <= the new level classification cutoff
-    bool levels[3];
-    uint32_t nodecount = tile->header()->nodecount();
-    GraphId basenode = base_tile_id;
-    GraphId edgeid = base_tile_id;
-    const NodeInfo* nodeinfo = tile->node(basenode);
-    for (uint32_t i = 0; i < nodecount; i++, nodeinfo++, ++basenode) {
-      // Iterate through the edges to see which levels this node exists.
-      levels[0] = levels[1] = levels[2] = false;
-      for (uint32_t j = 0; j < nodeinfo->edge_count(); j++, ++edgeid) {
-        // Update the flag for the level of this edge (skip transit
-        // connection edges)
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        if (directededge->use() != Use::kTransitConnection &&
-            directededge->use() != Use::kEgressConnection &&
-            directededge->use() != Use::kPlatformConnection) {
-          levels[TileHierarchy::get_level(directededge->classification())] = true;
+  // Iterate through all tiles in the local level
+  bool has_elevation = false;
+  try {
+    for (size_t t = 0; t < local_tiles.size(); ++t) {
+      // Wait for the workers to get to this tile
+      BaseTileNodes tile_nodes;
+      {
+        std::unique_lock<std::mutex> l(lock);
+        cv.wait(l, [&]() { return error || done.find(t) != done.end(); });
+        if (error) {
+          break;
         }
+        auto found = done.find(t);
+        tile_nodes = std::move(found->second);
+        done.erase(found);
+        merged = t + 1;
       }
+      cv.notify_all();
 
-      // Associate new nodes to base nodes and base node to new nodes
-      GraphId highway_node, arterial_node, local_node;
-      if (levels[0]) {
-        // New node is on the highway level. Associate back to base/local node
-        GraphId new_tile(highway_level.tiles.TileId(nodeinfo->latlng()), hl, 0);
-        highway_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(highway_node, basenode));
-      }
-      if (levels[1]) {
-        // New node is on the arterial level. Associate back to base/local node
-        GraphId new_tile(arterial_level.tiles.TileId(nodeinfo->latlng()), al, 0);
-        arterial_node = get_new_node(new_tile);
-        new_to_old.push_back(std::make_pair(arterial_node, basenode));
-      }
-      if (levels[2]) {
-        // New node is on the local level. Associate back to base/local node
-        local_node = get_new_node(base_tile_id);
-        new_to_old.push_back(std::make_pair(local_node, basenode));
+      // Update the has_elevation flag
+      if (tile_nodes.has_elevation) {
+        has_elevation = true;
       }
 
-      if (!levels[0] && !levels[1] && !levels[2]) {
-        LOG_ERROR("No valid level for this node!");
-      }
+      GraphId basenode = local_tiles[t];
+      for (const auto& node : tile_nodes.nodes) {
+        // Associate new nodes to base nodes and base node to new nodes
+        GraphId highway_node, arterial_node, local_node;
+        if (node.levels[0]) {
+          // New node is on the highway level. Associate back to base/local node
+          highway_node = get_new_node(node.highway_tile);
+          new_to_old.push_back(std::make_pair(highway_node, basenode));
+        }
+        if (node.levels[1]) {
+          // New node is on the arterial level. Associate back to base/local node
+          arterial_node = get_new_node(node.arterial_tile);
+          new_to_old.push_back(std::make_pair(arterial_node, basenode));
+        }
+        if (node.levels[2]) {
+          // New node is on the local level. Associate back to base/local node
+          local_node = get_new_node(local_tiles[t]);
+          new_to_old.push_back(std::make_pair(local_node, basenode));
+        }
 
-      // Associate the old node to the new node(s). Entries in the tuple
-      // that are invalid nodes indicate no node exists in the new level.
-      OldToNewNodes assoc(basenode, highway_node, arterial_node, local_node, nodeinfo->density());
-      old_to_new.push_back(assoc);
-    }
+        if (!node.levels[0] && !node.levels[1] && !node.levels[2]) {
+          LOG_ERROR("No valid level for this node!");
+        }
 
-    // Check if we need to clear the tile cache
-    if (reader.OverCommitted()) {
-      reader.Clear();
+        // Associate the old node to the new node(s). Entries in the tuple
+        // that are invalid nodes indicate no node exists in the new level.
+        OldToNewNodes assoc(basenode, highway_node, arterial_node, local_node, node.density);
+        old_to_new.push_back(assoc);
+        ++basenode;
+      }
     }
+  } catch (...) {
+    std::unique_lock<std::mutex> l(lock);
+    if (!error) {
+      error = std::current_exception();
+    }
+  }
+  cv.notify_all();
+
+  // Wait for the workers and pass on anything that went wrong
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
   }
   return has_elevation;
 }
@@ -563,33 +750,32 @@ namespace mjolnir {
 // base level. Each successive level of the hierarchy is based on
 // and connected to the next.
 void HierarchyBuilder::Build(const boost::property_tree::ptree& pt) {
-
-  // TODO: thread this. Might be more possible now that we don't create
-  // shortcuts in the HierarchyBuilder
-
   // Construct GraphReader
   LOG_INFO("HierarchyBuilder");
-  GraphReader reader(pt.get_child("mjolnir"));
+  auto hierarchy_properties = pt.get_child("mjolnir");
+  GraphReader reader(hierarchy_properties);
+  unsigned int threads =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
 
   // Association of old nodes to new nodes
-  bool has_elevation = CreateNodeAssociations(reader);
+  bool has_elevation = CreateNodeAssociations(hierarchy_properties, threads);
   if (has_elevation) {
     LOG_INFO("Base tiles have edge elevation information");
   }
 
   // Sort the sequences
-  SortSequences();
+  SortSequences(threads);
 
   // Iterate through the hierarchy (from highway down to local) and build
   // new tiles
-  FormTilesInNewLevel(reader, has_elevation);
+  FormTilesInNewLevels(hierarchy_properties, has_elevation, threads);
 
   // Remove any base tiles that no longer have any data (nodes and edges
   // only exist on arterial and highway levels)
   RemoveUnusedLocalTiles(reader.tile_dir());
 
   // Update the end nodes to all transit connections in the transit hierarchy
-  auto hierarchy_properties = pt.get_child("mjolnir");
   auto transit_dir = hierarchy_properties.get_optional<std::string>("transit_dir");
   if (transit_dir && boost::filesystem::exists(*transit_dir) &&
       boost::filesystem::is_directory(*transit_dir)) {
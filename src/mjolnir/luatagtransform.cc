@@ -2,8 +2,10 @@
 
 #include "midgard/logging.h"
 #include "mjolnir/osmdata.h"
+#include <algorithm>
 #include <boost/format.hpp>
 #include <stdexcept>
+#include <vector>
 
 using namespace valhalla::mjolnir;
 
@@ -12,6 +14,45 @@ namespace {
 const std::string LUA_NODE_PROC = "nodes_proc";
 const std::string LUA_WAY_PROC = "ways_proc";
 const std::string LUA_REL_PROC = "rels_proc";
+const std::string LUA_TRACK = "valhalla_track_tags";
+
+// hands the script the tags it is known to read in a table that looks through to the others.
+// the first read of any other key is noted so it can become part of the memo key, anything read
+// or written is moved into the table itself so lua only has to call back for the first read
+const std::string LUA_TRACK_FUNC = R"(
+valhalla_read_keys = {{}, {}, {}}
+function valhalla_track_tags(type, tags, hidden)
+  local known, new, assigned = valhalla_read_keys[type], {}, {}
+  return setmetatable(tags, {
+    __index = function(t, k)
+      if k == nil then return nil end
+      local v = hidden[k]
+      if v ~= nil then
+        hidden[k] = nil
+        rawset(t, k, v)
+      end
+      if not known[k] then
+        known[k] = true
+        new[#new + 1] = k
+      end
+      return v
+    end,
+    __newindex = function(t, k, v)
+      hidden[k] = nil
+      assigned[k] = true
+      rawset(t, k, v)
+    end,
+    __pairs = function(t)
+      new[#new + 1] = true
+      for k, v in next, hidden do
+        rawset(t, k, v)
+        hidden[k] = nil
+      end
+      return next, t, nil
+    end
+  }), new, assigned
+end
+)";
 
 void CheckLuaFuncExists(lua_State* state, const std::string& func_name) {
 
@@ -51,27 +92,227 @@ void stackdump_g(lua_State* l) {
   printf("\n"); /* end the listing */
 }
 
+// copy the keys and values of the table at the given stack index into the tags
+bool ToTags(lua_State* state, int index, Tags& tags, const std::string& lua_func) {
+  lua_pushnil(state);
+  while (lua_next(state, index) != 0) {
+    const char* key = lua_tostring(state, -2);
+    if (key == nullptr) {
+      LOG_ERROR((boost::format("Invalid key in Lua function: %1%.") % lua_func).str());
+      return false;
+    }
+    const char* value = lua_tostring(state, -1);
+    if (value == nullptr) {
+      LOG_ERROR((boost::format("Invalid value in Lua function: %1%.") % lua_func).str());
+      return false;
+    }
+    tags[key] = value;
+    lua_pop(state, 1);
+  }
+  return true;
+}
+
 } // namespace
 
-LuaTagTransform::LuaTagTransform(const std::string& lua) {
+LuaTagTransform::LuaTagTransform(const std::string& lua, size_t cache_size)
+    : cache_size_(cache_size) {
   // create a new lua state
   state_ = luaL_newstate();
   luaL_openlibs(state_);
   luaL_dostring(state_, lua.c_str());
+  luaL_dostring(state_, LUA_TRACK_FUNC.c_str());
 
   // check that various functions exist
   CheckLuaFuncExists(state_, LUA_NODE_PROC);
   CheckLuaFuncExists(state_, LUA_WAY_PROC);
   CheckLuaFuncExists(state_, LUA_REL_PROC);
+  CheckLuaFuncExists(state_, LUA_TRACK);
 }
 
 LuaTagTransform::~LuaTagTransform() {
   if (state_ != NULL) {
     lua_close(state_);
   }
+
+  // how well the memo worked out for each object type
+  const char* names[] = {"node", "way", "relation"};
+  for (size_t i = 0; i < memos_.size(); ++i) {
+    const auto& memo = memos_[i];
+    if (memo.hits + memo.misses == 0) {
+      continue;
+    }
+    LOG_INFO((boost::format("Lua %1% transforms: %2% hits %3% misses keyed on %4% tags") %
+              names[i] % memo.hits % memo.misses %
+              (memo.read_all ? std::string("all") : std::to_string(memo.read_keys.size())))
+                 .str());
+  }
 }
 
 Tags LuaTagTransform::Transform(OSMType type, const Tags& maptags) {
+  if (cache_size_ == 0) {
+    return Evaluate(type, maptags);
+  }
+
+  // did we already see these values for the tags the script looks at
+  auto& memo = memos_[static_cast<size_t>(type)];
+  MakeKey(memo, maptags);
+  auto cached = memo.cache.find(key_);
+  if (cached == memo.cache.cend()) {
+    ++memo.misses;
+
+    // watching what the script does is a lot slower than just running it and most values that
+    // are read, names refs and so on, never come back. so only the second time around is it worth
+    // finding out which tags the result depends on
+    if (memo.seen.insert(key_).second) {
+      if (memo.seen.size() >= cache_size_) {
+        memo.seen.clear();
+      }
+      return Evaluate(type, maptags);
+    }
+    Result result;
+    bool read_more = false;
+    if (!Record(type, maptags, result, memo, read_more)) {
+      return Evaluate(type, maptags);
+    }
+
+    // the script looked at tags it hadnt before so they have to be part of this key. older keys
+    // spell out the tags they were made of so they can stay, they just wont match as often
+    if (read_more) {
+      MakeKey(memo, maptags);
+    }
+
+    // we dont want it to grow forever, most of the common tag sets will come back quickly
+    if (memo.cache.size() >= cache_size_) {
+      memo.cache.clear();
+    }
+    cached = memo.cache.emplace(key_, std::move(result)).first;
+  } else {
+    ++memo.hits;
+  }
+
+  // apply what the script did to these tags
+  const auto& result = cached->second;
+  if (result.filtered) {
+    return {};
+  }
+  if (result.replaced) {
+    return result.written;
+  }
+  Tags transformed(maptags);
+  for (const auto& key : result.deleted) {
+    transformed.erase(key);
+  }
+  for (const auto& tag : result.written) {
+    transformed[tag.first] = tag.second;
+  }
+  return transformed;
+}
+
+void LuaTagTransform::MakeKey(const Memo& memo, const Tags& maptags) {
+  // the same tags in any order should hit the same cache entry so sort them to make the key
+  sorted_.clear();
+  for (const auto& tag : maptags) {
+    if (memo.read_all || memo.read_keys.count(tag.first)) {
+      sorted_.push_back(&tag);
+    }
+  }
+  std::sort(sorted_.begin(), sorted_.end(),
+            [](const Tags::value_type* a, const Tags::value_type* b) {
+              return a->first < b->first;
+            });
+
+  // the script is also told how many tags there are, whether there are any is all that matters
+  key_.assign(1, maptags.empty() ? '0' : '1');
+  for (const auto* tag : sorted_) {
+    key_.append(tag->first).push_back('\0');
+    key_.append(tag->second).push_back('\0');
+  }
+}
+
+bool LuaTagTransform::Record(OSMType type,
+                             const Tags& maptags,
+                             Result& result,
+                             Memo& memo,
+                             bool& read_more) {
+  const std::string& lua_func = type == OSMType::kNode
+                                    ? LUA_NODE_PROC
+                                    : (type == OSMType::kWay ? LUA_WAY_PROC : LUA_REL_PROC);
+
+  // the tags the script has never read are kept out of sight so we can see if it does
+  int base = lua_gettop(state_);
+  lua_newtable(state_);
+  lua_getglobal(state_, LUA_TRACK.c_str());
+  lua_pushinteger(state_, static_cast<size_t>(type) + 1);
+  lua_newtable(state_);
+  for (const auto& tag : maptags) {
+    lua_pushstring(state_, tag.first.c_str());
+    lua_pushstring(state_, tag.second.c_str());
+    lua_rawset(state_, memo.read_all || memo.read_keys.count(tag.first) ? -3 : base + 1);
+  }
+  lua_pushvalue(state_, base + 1);
+  if (lua_pcall(state_, 3, 3, 0)) {
+    LOG_ERROR("Failed to wrap the tags for lua tag processing.");
+    lua_settop(state_, base);
+    return false;
+  }
+
+  // call lua with the wrapped tags, osm2pgsql has extra results for ways which we dont care about
+  lua_getglobal(state_, lua_func.c_str());
+  lua_pushvalue(state_, base + 2);
+  lua_pushinteger(state_, maptags.size());
+  bool valid = lua_pcall(state_, 2, type == OSMType::kWay ? 4 : 2, 0) == 0;
+  if (!valid) {
+    LOG_ERROR("Failed to execute lua function for basic tag processing.");
+  }
+
+  // any key read for the first time has to be part of the cache key from now on, lua already
+  // counts it as known so this has to happen even if the script failed
+  for (lua_pushnil(state_); lua_next(state_, base + 3) != 0; lua_pop(state_, 1)) {
+    if (lua_type(state_, -1) == LUA_TSTRING) {
+      read_more = memo.read_keys.insert(lua_tostring(state_, -1)).second || read_more;
+    } else {
+      read_more = !memo.read_all || read_more;
+      memo.read_all = true;
+    }
+  }
+  if (!valid) {
+    lua_settop(state_, base);
+    return false;
+  }
+
+  // a filter of 1 means we dont care about this way/node, otherwise keep what the script did
+  result.filtered = lua_tointeger(state_, base + 5) != 0;
+  result.replaced = !lua_rawequal(state_, base + 2, base + 6);
+  if (!result.filtered) {
+    valid = ToTags(state_, result.replaced ? base + 6 : base + 2, result.written, lua_func);
+  }
+  if (valid && !result.filtered && !result.replaced) {
+    // whatever the script assigned that is not there anymore was deleted
+    for (lua_pushnil(state_); lua_next(state_, base + 4) != 0; lua_pop(state_, 1)) {
+      if (lua_type(state_, -2) == LUA_TSTRING && !result.written.count(lua_tostring(state_, -2))) {
+        result.deleted.emplace_back(lua_tostring(state_, -2));
+      }
+    }
+    // as were the tags it had in sight and then deleted, the ones it left alone dont need keeping
+    for (const auto& tag : maptags) {
+      auto written = result.written.find(tag.first);
+      if (written == result.written.cend()) {
+        lua_getfield(state_, base + 1, tag.first.c_str());
+        if (lua_isnil(state_, -1)) {
+          result.deleted.push_back(tag.first);
+        }
+        lua_pop(state_, 1);
+      } else if (written->second == tag.second) {
+        result.written.erase(written);
+      }
+    }
+  }
+
+  lua_settop(state_, base);
+  return valid;
+}
+
+Tags LuaTagTransform::Evaluate(OSMType type, const Tags& maptags) {
 
   // grab the proper function out of the lua code
   Tags result;
@@ -0,0 +1,193 @@
+#include "mjolnir/osmchange.h"
+
+#include <fstream>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <boost/filesystem/operations.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <boost/property_tree/xml_parser.hpp>
+
+#include "baldr/graphtile.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/logging.h"
+#include "midgard/sequence.h"
+#include "mjolnir/osmdata.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace valhalla {
+namespace mjolnir {
+
+// Parse an osmChange xml document
+OSMChange OSMChange::Parse(std::istream& stream) {
+  boost::property_tree::ptree pt;
+  try {
+    boost::property_tree::read_xml(stream, pt);
+  } catch (const std::exception& e) {
+    throw std::runtime_error(std::string("Could not parse osmChange: ") + e.what());
+  }
+  auto root = pt.get_child_optional("osmChange");
+  if (!root) {
+    throw std::runtime_error("Missing osmChange element");
+  }
+
+  // Every action (create, modify, delete) holds nodes, ways and relations
+  OSMChange change;
+  for (const auto& action : *root) {
+    if (action.first == "<xmlattr>" || action.first == "<xmlcomment>") {
+      continue;
+    }
+    for (const auto& object : action.second) {
+      auto id = object.second.get_optional<uint64_t>("<xmlattr>.id");
+      if (!id) {
+        continue;
+      }
+      if (object.first == "node") {
+        change.nodes.insert(*id);
+        auto lat = object.second.get_optional<float>("<xmlattr>.lat");
+        auto lon = object.second.get_optional<float>("<xmlattr>.lon");
+        if (lat && lon) {
+          change.locations.emplace_back(*lon, *lat);
+        }
+      } else if (object.first == "way") {
+        change.ways.insert(*id);
+        for (const auto& child : object.second) {
+          auto ref = child.second.get_optional<uint64_t>("<xmlattr>.ref");
+          if (child.first == "nd" && ref) {
+            change.member_nodes.insert(*ref);
+          }
+        }
+      } else if (object.first == "relation") {
+        change.relations.insert(*id);
+        for (const auto& child : object.second) {
+          auto ref = child.second.get_optional<uint64_t>("<xmlattr>.ref");
+          auto type = child.second.get<std::string>("<xmlattr>.type", "");
+          if (child.first != "member" || !ref) {
+            continue;
+          }
+          if (type == "node") {
+            change.member_nodes.insert(*ref);
+          } else if (type == "way") {
+            change.member_ways.insert(*ref);
+          }
+        }
+      }
+    }
+  }
+  return change;
+}
+
+// Parse an osmChange xml file
+OSMChange OSMChange::Parse(const std::string& file_name) {
+  std::ifstream file(file_name);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open " + file_name);
+  }
+  return Parse(file);
+}
+
+// Work out which tiles have to be rebuilt because of a change
+std::set<GraphId> AffectedTiles(GraphReader& reader,
+                                const OSMChange& change,
+                                const std::string& ways_file,
+                                const std::string& way_nodes_file) {
+  const auto& local_level = TileHierarchy::levels().rbegin()->second;
+  std::set<GraphId> local_tiles;
+  auto add_local = [&local_level, &local_tiles](const PointLL& ll) {
+    auto id = local_level.tiles.TileId(ll);
+    if (id >= 0) {
+      local_tiles.emplace(id, local_level.level, 0);
+    }
+  };
+
+  // The changed nodes we know the new location of
+  for (const auto& ll : change.locations) {
+    add_local(ll);
+  }
+
+  // The way nodes kept from the last build tell us where the changed nodes used to be, which
+  // matters for nodes that were moved or deleted. The ways through them changed shape too. They
+  // also tell us where the nodes of changed ways and relations are, which the change only refers
+  // to by id when the nodes themselves did not change
+  std::unordered_set<uint64_t> ways(change.ways);
+  ways.insert(change.member_ways.begin(), change.member_ways.end());
+  size_t old_nodes = 0;
+  bool any_nodes = !change.nodes.empty() || !change.member_nodes.empty();
+  if (any_nodes && boost::filesystem::exists(ways_file) &&
+      boost::filesystem::exists(way_nodes_file)) {
+    sequence<OSMWay> osm_ways(ways_file, false);
+    sequence<OSMWayNode> way_nodes(way_nodes_file, false);
+    for (const auto& way_node : way_nodes) {
+      bool changed = change.nodes.find(way_node.node.osmid) != change.nodes.end();
+      if (changed || change.member_nodes.find(way_node.node.osmid) != change.member_nodes.end()) {
+        add_local({way_node.node.lng, way_node.node.lat});
+        ++old_nodes;
+      }
+      if (changed) {
+        ways.insert(static_cast<OSMWay>(osm_ways[way_node.way_index]).way_id());
+      }
+    }
+  } else if (any_nodes) {
+    LOG_WARN("No way nodes from the last build, the old location of moved or deleted nodes "
+             "and of the nodes of changed ways and relations is not known");
+  }
+
+  // Find the edges of the changed ways in the current tiles, their old shape tells us where
+  // the way used to be even when none of its nodes moved
+  if (!ways.empty()) {
+    for (const auto& tile_id : reader.GetTileSet()) {
+      const GraphTile* tile = reader.GetGraphTile(tile_id);
+      if (tile == nullptr) {
+        continue;
+      }
+
+      // Both directions of an edge share the edge info so only look at it once
+      std::unordered_set<uint32_t> checked;
+      for (uint32_t i = 0; i < tile->header()->directededgecount(); ++i) {
+        const DirectedEdge* directededge = tile->directededge(i);
+        if (directededge->IsTransition() || directededge->is_shortcut() ||
+            !checked.insert(directededge->edgeinfo_offset()).second) {
+          continue;
+        }
+        auto edgeinfo = tile->edgeinfo(directededge->edgeinfo_offset());
+        if (ways.find(edgeinfo.wayid()) != ways.end()) {
+          for (const auto& ll : edgeinfo.shape()) {
+            add_local(ll);
+          }
+        }
+      }
+
+      // Check if we need to clear the tile cache
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
+    }
+  }
+
+  // The tiles on the other levels that each local tile belongs to and the transit tiles on top
+  std::set<GraphId> affected(local_tiles);
+  const auto& transit_level = TileHierarchy::GetTransitLevel();
+  for (const auto& tile_id : local_tiles) {
+    auto center = local_level.tiles.TileBounds(tile_id.tileid()).Center();
+    for (const auto& level : TileHierarchy::levels()) {
+      if (level.first != local_level.level) {
+        affected.emplace(level.second.tiles.TileId(center), level.first, 0);
+      }
+    }
+    GraphId transit_tile(transit_level.tiles.TileId(center), transit_level.level, 0);
+    if (reader.DoesTileExist(transit_tile)) {
+      affected.insert(transit_tile);
+    }
+  }
+
+  LOG_INFO("Change touches " + std::to_string(change.nodes.size()) + " nodes (" +
+           std::to_string(old_nodes) + " changed or member nodes on ways of the last build), " +
+           std::to_string(ways.size()) + " ways and " + std::to_string(change.relations.size()) +
+           " relations in " + std::to_string(local_tiles.size()) + " local tiles");
+  return affected;
+}
+
+} // namespace mjolnir
+} // namespace valhalla
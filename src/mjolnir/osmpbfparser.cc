@@ -33,6 +33,13 @@
 #else
 #include <netinet/in.h>
 #endif
+#include <condition_variable>
+#include <exception>
+#include <list>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_map>
 #include <vector>
 #include <zlib.h>
@@ -49,7 +56,7 @@ namespace {
 // the maximum size of an uncompressed blob in bytes 32 MB
 #define MAX_UNCOMPRESSED_BLOB_SIZE 33554432
 
-BlobHeader read_header(char* buffer, std::ifstream& file, bool& finished) {
+BlobHeader read_header(std::string& buffer, std::ifstream& file, bool& finished) {
   BlobHeader result;
 
   // read the first 4 bytes of the file, this is the size of the blob-header
@@ -67,13 +74,14 @@ BlobHeader read_header(char* buffer, std::ifstream& file, bool& finished) {
   }
 
   // grab the blob header bytes
-  file.read(buffer, sz);
+  buffer.resize(sz);
+  file.read(&buffer[0], sz);
   if (!file.good()) {
     throw std::runtime_error("unable to read blob-header from file");
   }
 
   // turn the bytes into a protobuf object
-  if (!result.ParseFromArray(buffer, sz)) {
+  if (!result.ParseFromArray(buffer.data(), sz)) {
     throw std::runtime_error("unable to parse blob header");
   }
 
@@ -81,9 +89,7 @@ BlobHeader read_header(char* buffer, std::ifstream& file, bool& finished) {
   return result;
 }
 
-int32_t read_blob(char* buffer, char* unpack_buffer, std::ifstream& file, const BlobHeader& header) {
-  Blob blob;
-
+void read_blob(std::string& buffer, std::ifstream& file, const BlobHeader& header) {
   // is the size of the following blob sane
   int32_t sz = header.datasize();
   if (sz > MAX_UNCOMPRESSED_BLOB_SIZE) {
@@ -91,31 +97,39 @@ int32_t read_blob(char* buffer, char* unpack_buffer, std::ifstream& file, const
   }
 
   // pull out the bytes
-  if (!file.read(buffer, sz)) {
+  buffer.resize(sz);
+  if (!file.read(&buffer[0], sz)) {
     throw std::runtime_error("unable to read blob from file");
   }
+}
+
+int32_t unpack_blob(const std::string& buffer, std::string& unpack_buffer) {
+  Blob blob;
 
   // turn it into a protobuf object
-  if (!blob.ParseFromArray(buffer, sz)) {
+  if (!blob.ParseFromString(buffer)) {
     throw std::runtime_error("unable to parse blob");
   }
 
   // if the blob was uncompressed
   if (blob.has_raw()) {
     // check that raw_size is set correctly and move it to the final buffer
-    sz = blob.raw().size();
+    int32_t sz = blob.raw().size();
     if (sz != blob.raw_size()) {
       LOG_WARN("blob reports wrong raw_size: " + std::to_string(blob.raw_size()) + " bytes");
     }
-    memcpy(unpack_buffer, buffer, sz);
+    unpack_buffer = std::move(*blob.mutable_raw());
     return sz;
   } // if the blob was zlib compressed
   else if (blob.has_zlib_data()) {
-    sz = blob.zlib_data().size();
+    if (blob.raw_size() > MAX_UNCOMPRESSED_BLOB_SIZE) {
+      throw std::runtime_error("blob-size is bigger than allowed");
+    }
+    unpack_buffer.resize(blob.raw_size());
     z_stream z;
     z.next_in = (unsigned char*)blob.zlib_data().c_str();
-    z.avail_in = sz;
-    z.next_out = (unsigned char*)unpack_buffer;
+    z.avail_in = blob.zlib_data().size();
+    z.next_out = (unsigned char*)&unpack_buffer[0];
     z.avail_out = blob.raw_size();
     z.zalloc = Z_NULL;
     z.zfree = Z_NULL;
@@ -151,16 +165,9 @@ template <class T> OSMPBF::Tags get_tags(const T& object, const OSMPBF::Primitiv
   return result;
 }
 
-void parse_primitive_block(char* unpack_buffer,
-                           int32_t sz,
+void parse_primitive_block(const PrimitiveBlock& primblock,
                            const Interest interest,
                            Callback& callback) {
-  // turn the blob bytes into a protobuf object
-  PrimitiveBlock primblock;
-  if (!primblock.ParseFromArray(unpack_buffer, sz)) {
-    throw std::runtime_error("unable to parse primitive block");
-  }
-
   // for each primitive group
   for (const auto& primitive_group : primblock.primitivegroup()) {
 
@@ -262,16 +269,36 @@ void parse_primitive_block(char* unpack_buffer,
   }
 }
 
-void parse_header_block(char* unpack_buffer, int32_t sz) {
+void parse_header_block(const std::string& unpack_buffer, int32_t sz) {
   // turn the blob bytes into a protobuf object
   HeaderBlock header_block;
-  if (!header_block.ParseFromArray(unpack_buffer, sz)) {
+  if (!header_block.ParseFromArray(unpack_buffer.data(), sz)) {
     throw std::runtime_error("unable to parse header block");
   }
 
   // TODO: do something with replication information?
 }
 
+// unpacks and decodes a blob giving back the primitive block if it was one
+std::unique_ptr<PrimitiveBlock>
+decode_blob(const BlobHeader& header, const std::string& buffer, std::string& unpack_buffer) {
+  int32_t sz = unpack_blob(buffer, unpack_buffer);
+  // if its data parse it
+  if (header.type() == "OSMData") {
+    std::unique_ptr<PrimitiveBlock> primblock(new PrimitiveBlock);
+    if (!primblock->ParseFromArray(unpack_buffer.data(), sz)) {
+      throw std::runtime_error("unable to parse primitive block");
+    }
+    return primblock;
+    // if its something other than a header
+  } else if (header.type() == "OSMHeader") {
+    parse_header_block(unpack_buffer, sz);
+  } else {
+    LOG_WARN("Unknown blob type: " + header.type());
+  }
+  return nullptr;
+}
+
 } // namespace
 
 // extend the protobuf osmpbf namespace
@@ -285,38 +312,126 @@ Member::Member(Member&& other)
     : member_type(other.member_type), member_id(other.member_id), role(std::move(other.role)) {
 }
 
-void Parser::parse(std::ifstream& file, const Interest interest, Callback& callback) {
-  char* buffer = new char[MAX_UNCOMPRESSED_BLOB_SIZE];
-  char* unpack_buffer = new char[MAX_UNCOMPRESSED_BLOB_SIZE];
+void Parser::parse(std::ifstream& file,
+                   const Interest interest,
+                   Callback& callback,
+                   unsigned int threads) {
+  std::string buffer, unpack_buffer;
 
   // start from the top
   file.clear();
   file.seekg(0, std::ios::beg);
 
-  // while there is more to read
-  while (!file.eof()) {
-    // grab the blob header
-    bool finished = false;
-    BlobHeader header = read_header(buffer, file, finished);
-    // if we didnt hit the end
-    if (!finished) {
-      // grab the blob that goes with the blob header
-      int32_t sz = read_blob(buffer, unpack_buffer, file, header);
-      // if its data parse it
-      if (header.type() == "OSMData") {
-        parse_primitive_block(unpack_buffer, sz, interest, callback);
-        // if its something other than a header
-      } else if (header.type() == "OSMHeader") {
-        parse_header_block(unpack_buffer, sz);
-      } else {
-        LOG_WARN("Unknown blob type: " + header.type());
+  // just one thread does everything in order
+  if (threads < 2) {
+    // while there is more to read
+    while (!file.eof()) {
+      // grab the blob header
+      bool finished = false;
+      BlobHeader header = read_header(buffer, file, finished);
+      // if we didnt hit the end
+      if (!finished) {
+        // grab the blob that goes with the blob header and decode it
+        read_blob(buffer, file, header);
+        auto primblock = decode_blob(header, buffer, unpack_buffer);
+        if (primblock) {
+          parse_primitive_block(*primblock, interest, callback);
+        }
       }
     }
+    return;
   }
 
-  // done with protobuf and buffers
-  delete[] buffer;
-  delete[] unpack_buffer;
+  // otherwise the threads take turns reading the next blob from the file and then decode it in
+  // parallel. this thread hands the decoded blocks to the callback in the order of the file. to
+  // keep the memory in check only so many blobs may be read ahead of the one the callback needs
+  const size_t max_ahead = threads * 4;
+  std::mutex mutex;
+  std::condition_variable can_read, can_parse;
+  std::map<size_t, std::unique_ptr<PrimitiveBlock>> decoded;
+  size_t blobs_read = 0, blobs_parsed = 0;
+  bool finished = false;
+  std::exception_ptr error;
+  auto decode = [&]() {
+    std::string buffer, unpack_buffer;
+    try {
+      while (true) {
+        // wait until we are allowed to read the next blob
+        std::unique_lock<std::mutex> lock(mutex);
+        can_read.wait(lock, [&]() {
+          return error || finished || blobs_read < blobs_parsed + max_ahead;
+        });
+        if (error || finished) {
+          return;
+        }
+        BlobHeader header;
+        if (!file.eof()) {
+          header = read_header(buffer, file, finished);
+        } else {
+          finished = true;
+        }
+        if (finished) {
+          can_parse.notify_all();
+          return;
+        }
+        read_blob(buffer, file, header);
+        size_t index = blobs_read++;
+        lock.unlock();
+
+        // decode it while the other threads read and decode
+        auto primblock = decode_blob(header, buffer, unpack_buffer);
+        lock.lock();
+        decoded.emplace(index, std::move(primblock));
+        can_parse.notify_all();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = std::current_exception();
+      can_read.notify_all();
+      can_parse.notify_all();
+    }
+  };
+  std::list<std::thread> decoders;
+  for (unsigned int i = 0; i < threads; ++i) {
+    decoders.emplace_back(decode);
+  }
+
+  // hand the blocks to the callback in the order they were in the file
+  while (true) {
+    std::unique_ptr<PrimitiveBlock> primblock;
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      can_parse.wait(lock, [&]() {
+        return error || decoded.find(blobs_parsed) != decoded.cend() ||
+               (finished && blobs_parsed == blobs_read);
+      });
+      if (error || (finished && blobs_parsed == blobs_read)) {
+        break;
+      }
+      auto next = decoded.find(blobs_parsed);
+      primblock = std::move(next->second);
+      decoded.erase(next);
+      ++blobs_parsed;
+      can_read.notify_all();
+    }
+    if (primblock) {
+      try {
+        parse_primitive_block(*primblock, interest, callback);
+      } catch (...) {
+        std::lock_guard<std::mutex> lock(mutex);
+        error = std::current_exception();
+        can_read.notify_all();
+        break;
+      }
+    }
+  }
+
+  for (auto& decoder : decoders) {
+    decoder.join();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
 }
 
 void Parser::free() {
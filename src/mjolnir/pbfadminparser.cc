@@ -50,7 +50,7 @@ public:
 
     ++osmdata_.osm_node_count;
 
-    osmdata_.shape_map.emplace(osmid, PointLL(lng, lat));
+    osmdata_.shape_map.set(osmid, PointLL(lng, lat));
 
     if (osmdata_.shape_map.size() % 500000 == 0) {
       LOG_INFO("Processed " + std::to_string(osmdata_.shape_map.size()) + " nodes on ways");
@@ -72,7 +72,7 @@ public:
       shape_.set(node);
     }
 
-    osmdata_.way_map.emplace(osmid, std::list<uint64_t>(nodes.begin(), nodes.end()));
+    osmdata_.way_map.set(osmid, nodes);
   }
 
   virtual void relation_callback(const uint64_t osmid,
@@ -146,6 +146,9 @@ OSMData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
   // methods can use it.
   OSMData osmdata{};
   admin_callback callback(pt, osmdata);
+  unsigned int threads =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
 
   LOG_INFO("Parsing files: " + boost::algorithm::join(input_files, ", "));
 
@@ -165,7 +168,7 @@ OSMData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::RELATIONS |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
   LOG_INFO("Finished with " + std::to_string(osmdata.admins_.size()) +
            " admin polygons comprised of " + std::to_string(osmdata.osm_way_count) + " ways");
@@ -176,8 +179,10 @@ OSMData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::WAYS |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
+  // each file is sorted on its own so the ways of all of them have to be sorted together
+  osmdata.way_map.sort();
   LOG_INFO("Finished with " + std::to_string(osmdata.way_map.size()) + " ways comprised of " +
            std::to_string(osmdata.node_count) + " nodes");
 
@@ -188,8 +193,9 @@ OSMData PBFAdminParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::NODES |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
+  osmdata.shape_map.sort();
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_node_count) + " nodes");
 
   // Return OSM data
@@ -117,19 +117,19 @@ public:
         bool hasTag = (tag.second.length() ? true : false);
         n.set_exit_to(hasTag);
         if (hasTag) {
-          osmdata_.node_exit_to[osmid] = tag.second;
+          osmdata_.node_exit_to.set(osmid, tag.second);
         }
       } else if (is_highway_junction && (tag.first == "ref")) {
         bool hasTag = (tag.second.length() ? true : false);
         n.set_ref(hasTag);
         if (hasTag) {
-          osmdata_.node_ref[osmid] = tag.second;
+          osmdata_.node_ref.set(osmid, tag.second);
         }
       } else if (is_highway_junction && (tag.first == "name")) {
         bool hasTag = (tag.second.length() ? true : false);
         n.set_name(hasTag);
         if (hasTag) {
-          osmdata_.node_name[osmid] = tag.second;
+          osmdata_.node_name.set(osmid, tag.second);
         }
       } else if (tag.first == "gate") {
         if (tag.second == "true") {
@@ -1285,12 +1285,7 @@ public:
              boost::starts_with(direction, "East (") || boost::starts_with(direction, "West (")) ||
             direction == "North" || direction == "South" || direction == "East" ||
             direction == "West") {
-          auto iter = osmdata_.way_ref.find(member.member_id);
-          if (iter != osmdata_.way_ref.end()) {
-            osmdata_.way_ref[member.member_id] = iter->second + ";" + reference + "|" + direction;
-          } else {
-            osmdata_.way_ref[member.member_id] = reference + "|" + direction;
-          }
+          osmdata_.way_ref.insert({member.member_id, reference + "|" + direction});
         }
       }
     } else if (isConnectivity && (!to_lanes.empty() || !to.empty()) &&
@@ -1540,9 +1535,8 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
                               const std::string& way_nodes_file,
                               const std::string& access_file,
                               const std::string& complex_restriction_file) {
-  // TODO: option 1: each one threads makes an osmdata and we splice them together at the end
-  // option 2: synchronize around adding things to a single osmdata. will have to test to see
-  // which is the least expensive (memory and speed). leaning towards option 2
+  // the callbacks rely on the file order so they run on this thread, the threads are used to
+  // decompress and decode the blobs of the file ahead of the callbacks
   unsigned int threads =
       std::max(static_cast<unsigned int>(1),
                pt.get<unsigned int>("concurrency", std::thread::hardware_concurrency()));
@@ -1575,7 +1569,7 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::WAYS |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
   callback.output_loops();
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_way_count) + " routable ways containing " +
@@ -1585,7 +1579,8 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
   LOG_INFO("Sorting osm access tags by way id...");
   {
     sequence<OSMAccess> access(access_file, false);
-    access.sort([](const OSMAccess& a, const OSMAccess& b) { return a.way_id() < b.way_id(); });
+    access.sort([](const OSMAccess& a, const OSMAccess& b) { return a.way_id() < b.way_id(); },
+                sequence<OSMAccess>::kSortBufferSize, threads);
   }
 
   // Parse relations.
@@ -1596,18 +1591,26 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::RELATIONS |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
   LOG_INFO("Finished with " + std::to_string(osmdata.restrictions.size()) + " simple restrictions");
   LOG_INFO("Finished with " + std::to_string(osmdata.lane_connectivity_map.size()) +
            " lane connections");
   callback.reset(nullptr, nullptr, nullptr, nullptr);
+  // relations and ways reference each other in no particular order so sort what they left behind
+  osmdata.restrictions.sort();
+  osmdata.access_restrictions.sort();
+  osmdata.bike_relations.sort();
+  osmdata.way_ref.sort();
+  osmdata.lane_connectivity_map.sort();
 
   // we need to sort the complex restrictions so that we can easily find them.
   LOG_INFO("Sorting complex restrictions by from id...");
   {
     sequence<OSMRestriction> complex_restrictions(complex_restriction_file, false);
-    complex_restrictions.sort([](const OSMRestriction& a, const OSMRestriction& b) { return a < b; });
+    complex_restrictions.sort([](const OSMRestriction& a,
+                                 const OSMRestriction& b) { return a < b; },
+                              sequence<OSMRestriction>::kSortBufferSize, threads);
   }
 
   // we need to sort the refs so that we can easily (sequentially) update them
@@ -1617,7 +1620,8 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
   {
     sequence<OSMWayNode> way_nodes(way_nodes_file, false);
     way_nodes.sort(
-        [](const OSMWayNode& a, const OSMWayNode& b) { return a.node.osmid < b.node.osmid; });
+        [](const OSMWayNode& a, const OSMWayNode& b) { return a.node.osmid < b.node.osmid; },
+        sequence<OSMWayNode>::kSortBufferSize, threads);
   }
   LOG_INFO("Finished");
 
@@ -1634,9 +1638,13 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
     OSMPBF::Parser::parse(file_handle,
                           static_cast<OSMPBF::Interest>(OSMPBF::Interest::NODES |
                                                         OSMPBF::Interest::CHANGESETS),
-                          callback);
+                          callback, threads);
   }
   callback.reset(nullptr, nullptr, nullptr, nullptr);
+  // each file is sorted on its own so the node tags of all of them have to be sorted together
+  osmdata.node_ref.sort();
+  osmdata.node_exit_to.sort();
+  osmdata.node_name.sort();
   LOG_INFO("Finished with " + std::to_string(osmdata.osm_node_count) +
            " nodes contained in routable ways");
 
@@ -1645,13 +1653,15 @@ OSMData PBFGraphParser::Parse(const boost::property_tree::ptree& pt,
   LOG_INFO("Sorting osm way node references by way index and node shape index...");
   {
     sequence<OSMWayNode> way_nodes(way_nodes_file, false);
-    way_nodes.sort([](const OSMWayNode& a, const OSMWayNode& b) {
-      if (a.way_index == b.way_index) {
-        // TODO: if its equal we have screwed something up, should we check and throw here?
-        return a.way_shape_node_index < b.way_shape_node_index;
-      }
-      return a.way_index < b.way_index;
-    });
+    way_nodes.sort(
+        [](const OSMWayNode& a, const OSMWayNode& b) {
+          if (a.way_index == b.way_index) {
+            // TODO: if its equal we have screwed something up, should we check and throw here?
+            return a.way_shape_node_index < b.way_shape_node_index;
+          }
+          return a.way_index < b.way_index;
+        },
+        sequence<OSMWayNode>::kSortBufferSize, threads);
   }
 
   LOG_INFO("Finished at changeset id " + std::to_string(osmdata.max_changeset_id_));
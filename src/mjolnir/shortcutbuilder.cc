@@ -4,12 +4,17 @@
 #include <boost/filesystem/operations.hpp>
 #include <boost/format.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <future>
 #include <iostream>
+#include <list>
 #include <map>
+#include <mutex>
 #include <ostream>
+#include <queue>
 #include <set>
 #include <sstream>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -18,6 +23,7 @@
 #include "baldr/graphreader.h"
 #include "baldr/graphtile.h"
 #include "baldr/tilehierarchy.h"
+#include "filesystem.h"
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
 #include "midgard/pointll.h"
@@ -556,153 +562,189 @@ uint32_t AddShortcutEdges(GraphReader& reader,
   return shortcut_count;
 }
 
-// Form shortcuts for tiles in this level.
+// Form shortcuts for a tile. The new tile is written to the staging directory so that other
+// threads, which may still need to read the tile, only ever see the tile without shortcuts.
 uint32_t FormShortcuts(GraphReader& reader,
-                       const TileLevel& level,
+                       const GraphId& new_tile,
+                       const std::string& staging_dir,
                        const std::unique_ptr<const valhalla::skadi::sample>& sample) {
-  // Iterate through the tiles at this level (TODO - can we mark the tiles
-  // the tiles that shortcuts end within?)
-  reader.Clear();
+  // Get the graph tile. Skip if no tile exists
   bool added = false;
   uint32_t shortcut_count = 0;
-  uint32_t ntiles = level.tiles.TileCount();
-  uint32_t tile_level = (uint32_t)level.level;
-  const GraphTile* tile = nullptr;
-  for (uint32_t tileid = 0; tileid < ntiles; tileid++) {
-    // Get the graph tile. Skip if no tile exists (common case)
-    tile = reader.GetGraphTile(GraphId(tileid, tile_level, 0));
-    if (tile == nullptr || tile->header()->nodecount() == 0) {
-      continue;
-    }
+  const GraphTile* tile = reader.GetGraphTile(new_tile);
+  if (tile == nullptr || tile->header()->nodecount() == 0) {
+    return shortcut_count;
+  }
 
-    // Create GraphTileBuilder for the new tile
-    GraphId new_tile(tileid, tile_level, 0);
-    GraphTileBuilder tilebuilder(reader.tile_dir(), new_tile, false);
-
-    // Iterate through the nodes in the tile
-    GraphId node_id(tileid, tile_level, 0);
-    for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
-      // Get the node info, copy node index and count from old tile
-      NodeInfo nodeinfo = *(tile->node(node_id));
-      uint32_t old_edge_index = nodeinfo.edge_index();
-      uint32_t old_edge_count = nodeinfo.edge_count();
-
-      // Update node information
-      const auto& admin = tile->admininfo(nodeinfo.admin_index());
-      nodeinfo.set_edge_index(tilebuilder.directededges().size());
-      nodeinfo.set_timezone(nodeinfo.timezone());
-      nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
-                                                    admin.country_iso(), admin.state_iso()));
-
-      // Current edge count
-      size_t edge_count = tilebuilder.directededges().size();
-
-      // Add shortcut edges first.
-      std::unordered_map<uint32_t, uint32_t> shortcuts;
-      shortcut_count += AddShortcutEdges(reader, tile, tilebuilder, node_id, old_edge_index,
-                                         old_edge_count, shortcuts, sample);
-
-      // Copy the rest of the directed edges from this node
-      GraphId edgeid(tileid, tile_level, old_edge_index);
-      for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
-        // Copy the directed edge information and update end node,
-        // edge data offset, and opp_index
-        const DirectedEdge* directededge = tile->directededge(edgeid);
-        DirectedEdge newedge = *directededge;
-
-        // Transition edges are stored as is (no need for EdgeInfo, signs,
-        // or restrictions).
-        if (!directededge->trans_down() && !directededge->trans_up()) {
-          // Get signs from the base directed edge
-          if (directededge->exitsign()) {
-            std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
-            if (signs.size() == 0) {
-              LOG_ERROR("Base edge should have signs, but none found");
-            }
-            tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
-          }
+  // Create GraphTileBuilder for the new tile. Since it is created in the staging directory the
+  // header of the existing tile has to be copied over explicitly
+  GraphTileBuilder tilebuilder(staging_dir, new_tile, false);
+  tilebuilder.header_builder() = *tile->header();
+  tilebuilder.header_builder().set_graphid(new_tile);
+
+  uint32_t tileid = new_tile.tileid();
+  uint32_t tile_level = new_tile.level();
+
+  // Iterate through the nodes in the tile
+  GraphId node_id(tileid, tile_level, 0);
+  for (uint32_t n = 0; n < tile->header()->nodecount(); n++, ++node_id) {
+    // Get the node info, copy node index and count from old tile
+    NodeInfo nodeinfo = *(tile->node(node_id));
+    uint32_t old_edge_index = nodeinfo.edge_index();
+    uint32_t old_edge_count = nodeinfo.edge_count();
+
+    // Update node information
+    const auto& admin = tile->admininfo(nodeinfo.admin_index());
+    nodeinfo.set_edge_index(tilebuilder.directededges().size());
+    nodeinfo.set_timezone(nodeinfo.timezone());
+    nodeinfo.set_admin_index(tilebuilder.AddAdmin(admin.country_text(), admin.state_text(),
+                                                  admin.country_iso(), admin.state_iso()));
+
+    // Current edge count
+    size_t edge_count = tilebuilder.directededges().size();
+
+    // Add shortcut edges first.
+    std::unordered_map<uint32_t, uint32_t> shortcuts;
+    shortcut_count += AddShortcutEdges(reader, tile, tilebuilder, node_id, old_edge_index,
+                                       old_edge_count, shortcuts, sample);
+
+    // Copy the rest of the directed edges from this node
+    GraphId edgeid(tileid, tile_level, old_edge_index);
+    for (uint32_t i = 0; i < old_edge_count; i++, ++edgeid) {
+      // Copy the directed edge information and update end node,
+      // edge data offset, and opp_index
+      const DirectedEdge* directededge = tile->directededge(edgeid);
+      DirectedEdge newedge = *directededge;
 
-          // Get turn lanes from the base directed edge
-          if (directededge->turnlanes()) {
-            uint32_t offset = tile->turnlanes_offset(edgeid.id());
-            tilebuilder.AddTurnLanes(tilebuilder.directededges().size(), tile->GetName(offset));
+      // Transition edges are stored as is (no need for EdgeInfo, signs,
+      // or restrictions).
+      if (!directededge->trans_down() && !directededge->trans_up()) {
+        // Get signs from the base directed edge
+        if (directededge->exitsign()) {
+          std::vector<SignInfo> signs = tile->GetSigns(edgeid.id());
+          if (signs.size() == 0) {
+            LOG_ERROR("Base edge should have signs, but none found");
           }
+          tilebuilder.AddSigns(tilebuilder.directededges().size(), signs);
+        }
 
-          // Get access restrictions from the base directed edge. Add these to
-          // the list of access restrictions in the new tile. Update the
-          // edge index in the restriction to be the current directed edge Id
-          if (directededge->access_restriction()) {
-            auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kAllAccess);
-            for (const auto& res : restrictions) {
-              tilebuilder.AddAccessRestriction(AccessRestriction(tilebuilder.directededges().size(),
-                                                                 res.type(), res.modes(),
-                                                                 res.value()));
-            }
-          }
+        // Get turn lanes from the base directed edge
+        if (directededge->turnlanes()) {
+          uint32_t offset = tile->turnlanes_offset(edgeid.id());
+          tilebuilder.AddTurnLanes(tilebuilder.directededges().size(), tile->GetName(offset));
+        }
 
-          // Copy lane connectivity
-          if (directededge->laneconnectivity()) {
-            auto laneconnectivity = tile->GetLaneConnectivity(edgeid.id());
-            if (laneconnectivity.size() == 0) {
-              LOG_ERROR("Base edge should have lane connectivity, but none found");
-            }
-            for (auto& lc : laneconnectivity) {
-              lc.set_to(tilebuilder.directededges().size());
-            }
-            tilebuilder.AddLaneConnectivity(laneconnectivity);
+        // Get access restrictions from the base directed edge. Add these to
+        // the list of access restrictions in the new tile. Update the
+        // edge index in the restriction to be the current directed edge Id
+        if (directededge->access_restriction()) {
+          auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kAllAccess);
+          for (const auto& res : restrictions) {
+            tilebuilder.AddAccessRestriction(AccessRestriction(tilebuilder.directededges().size(),
+                                                               res.type(), res.modes(),
+                                                               res.value()));
           }
+        }
 
-          // Get edge info, shape, and names from the old tile and add
-          // to the new. Use prior edgeinfo offset as the key to make sure
-          // edges that have the same end nodes are differentiated (this
-          // should be a valid key since tile sizes aren't changed)
-          auto edgeinfo = tile->edgeinfo(directededge->edgeinfo_offset());
-          uint32_t edge_info_offset =
-              tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(), node_id,
-                                      directededge->endnode(), edgeinfo.wayid(),
-                                      edgeinfo.encoded_shape(),
-                                      tile->GetNames(directededge->edgeinfo_offset()),
-                                      tile->GetTypes(directededge->edgeinfo_offset()), added);
-          newedge.set_edgeinfo_offset(edge_info_offset);
-
-          // Set the superseded mask - this is the shortcut mask that
-          // supersedes this edge (outbound from the node)
-          auto s = shortcuts.find(i);
-          uint32_t supersed_idx = (s != shortcuts.end()) ? s->second : 0;
-          newedge.set_superseded(supersed_idx);
+        // Copy lane connectivity
+        if (directededge->laneconnectivity()) {
+          auto laneconnectivity = tile->GetLaneConnectivity(edgeid.id());
+          if (laneconnectivity.size() == 0) {
+            LOG_ERROR("Base edge should have lane connectivity, but none found");
+          }
+          for (auto& lc : laneconnectivity) {
+            lc.set_to(tilebuilder.directededges().size());
+          }
+          tilebuilder.AddLaneConnectivity(laneconnectivity);
         }
 
-        // Add directed edge
-        tilebuilder.directededges().emplace_back(std::move(newedge));
+        // Get edge info, shape, and names from the old tile and add
+        // to the new. Use prior edgeinfo offset as the key to make sure
+        // edges that have the same end nodes are differentiated (this
+        // should be a valid key since tile sizes aren't changed)
+        auto edgeinfo = tile->edgeinfo(directededge->edgeinfo_offset());
+        uint32_t edge_info_offset =
+            tilebuilder.AddEdgeInfo(directededge->edgeinfo_offset(), node_id,
+                                    directededge->endnode(), edgeinfo.wayid(),
+                                    edgeinfo.encoded_shape(),
+                                    tile->GetNames(directededge->edgeinfo_offset()),
+                                    tile->GetTypes(directededge->edgeinfo_offset()), added);
+        newedge.set_edgeinfo_offset(edge_info_offset);
+
+        // Set the superseded mask - this is the shortcut mask that
+        // supersedes this edge (outbound from the node)
+        auto s = shortcuts.find(i);
+        uint32_t supersed_idx = (s != shortcuts.end()) ? s->second : 0;
+        newedge.set_superseded(supersed_idx);
+      }
 
-        // Add existing edge elevation (if the tile has elevation information)
-        if (tile->header()->has_edge_elevation()) {
-          const EdgeElevation* elev = tile->edge_elevation(edgeid);
-          if (elev == nullptr) {
-            tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
-          } else {
-            tilebuilder.edge_elevations().emplace_back(std::move(*elev));
-          }
+      // Add directed edge
+      tilebuilder.directededges().emplace_back(std::move(newedge));
+
+      // Add existing edge elevation (if the tile has elevation information)
+      if (tile->header()->has_edge_elevation()) {
+        const EdgeElevation* elev = tile->edge_elevation(edgeid);
+        if (elev == nullptr) {
+          tilebuilder.edge_elevations().emplace_back(0.0f, 0.0f, 0.0f);
+        } else {
+          tilebuilder.edge_elevations().emplace_back(std::move(*elev));
         }
       }
+    }
+
+    // Set the edge count for the new node
+    nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
+    tilebuilder.nodes().emplace_back(std::move(nodeinfo));
+  }
 
-      // Set the edge count for the new node
-      nodeinfo.set_edge_count(tilebuilder.directededges().size() - edge_count);
-      tilebuilder.nodes().emplace_back(std::move(nodeinfo));
+  // Store the new tile
+  tilebuilder.StoreTileData();
+  LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") % tile %
+             tilebuilder.header_builder().end_offset())
+                .str());
+  return shortcut_count;
+}
+
+// Form shortcuts for the tiles in the queue. Each thread has its own graph reader and its own
+// elevation sample since neither is safe to share.
+void FormShortcutsInTiles(const boost::property_tree::ptree& pt,
+                          const std::string& staging_dir,
+                          std::queue<GraphId>& tilequeue,
+                          std::mutex& lock,
+                          std::promise<uint32_t>& result) {
+  try {
+    GraphReader reader(pt.get_child("mjolnir"));
+
+    // Crack open some elevation data if its there
+    boost::optional<std::string> elevation =
+        pt.get_optional<std::string>("additional_data.elevation");
+    std::unique_ptr<const valhalla::skadi::sample> sample;
+    if (elevation && boost::filesystem::exists(*elevation)) {
+      sample.reset(new valhalla::skadi::sample(*elevation));
     }
 
-    // Store the new tile
-    tilebuilder.StoreTileData();
-    LOG_DEBUG((boost::format("ShortcutBuilder created tile %1%: %2% bytes") % tile %
-               tilebuilder.header_builder().end_offset())
-                  .str());
+    uint32_t shortcut_count = 0;
+    while (true) {
+      lock.lock();
+      if (tilequeue.empty()) {
+        lock.unlock();
+        break;
+      }
+      GraphId tile_id = tilequeue.front();
+      tilequeue.pop();
+      lock.unlock();
 
-    // Check if we need to clear the tile cache.
-    if (reader.OverCommitted()) {
-      reader.Clear();
+      shortcut_count += FormShortcuts(reader, tile_id, staging_dir, sample);
+
+      // Check if we need to clear the tile cache.
+      if (reader.OverCommitted()) {
+        reader.Clear();
+      }
     }
+    result.set_value(shortcut_count);
+  } catch (...) {
+    result.set_exception(std::current_exception());
   }
-  return shortcut_count;
 }
 
 } // namespace
@@ -714,28 +756,60 @@ namespace mjolnir {
 // only connect to 2 edges on the hierarchy level, and have compatible
 // attributes. Shortcut edges are inserted before regular edges.
 void ShortcutBuilder::Build(const boost::property_tree::ptree& pt) {
-
-  // TODO: thread this. would need to make sure we dont make shortcuts
-  // across tile boundaries so that we are only messing with one tile
-  // in one thread at a time
-
-  // Get GraphReader
+  // Tiles are formed in parallel. Since shortcuts never cross levels the tiles of a level only
+  // read tiles of the same level. The new tiles are staged until the whole level is done so
+  // that no thread reads a tile that has already been rewritten.
+  std::string tile_dir = pt.get<std::string>("mjolnir.tile_dir");
+  std::string staging_dir = tile_dir + filesystem::path::preferred_separator + "shortcuts_tmp";
+  unsigned int thread_count =
+      std::max(static_cast<unsigned int>(1),
+               pt.get<unsigned int>("mjolnir.concurrency", std::thread::hardware_concurrency()));
   GraphReader reader(pt.get_child("mjolnir"));
 
-  // Crack open some elevation data if its there
-  boost::optional<std::string> elevation = pt.get_optional<std::string>("additional_data.elevation");
-  std::unique_ptr<const skadi::sample> sample;
-  if (elevation && boost::filesystem::exists(*elevation)) {
-    sample.reset(new skadi::sample(*elevation));
-  }
-
   auto level = TileHierarchy::levels().rbegin();
   level++;
   for (; level != TileHierarchy::levels().rend(); ++level) {
     // Create shortcuts on this level
     auto tile_level = level->second;
     LOG_INFO("Creating shortcuts on level " + std::to_string(tile_level.level));
-    uint32_t count = FormShortcuts(reader, tile_level, sample);
+
+    // Queue up the tiles of this level in order
+    auto tile_set = reader.GetTileSet(tile_level.level);
+    std::vector<GraphId> tile_ids(tile_set.begin(), tile_set.end());
+    std::sort(tile_ids.begin(), tile_ids.end());
+    std::queue<GraphId> tilequeue;
+    for (const auto& tile_id : tile_ids) {
+      tilequeue.push(tile_id);
+    }
+
+    // Start the threads and wait for them to finish up their work
+    std::vector<std::shared_ptr<std::thread>> threads(thread_count);
+    std::list<std::promise<uint32_t>> results;
+    std::mutex lock;
+    for (auto& thread : threads) {
+      results.emplace_back();
+      thread.reset(new std::thread(FormShortcutsInTiles, std::cref(pt), std::cref(staging_dir),
+                                   std::ref(tilequeue), std::ref(lock), std::ref(results.back())));
+    }
+    for (auto& thread : threads) {
+      thread->join();
+    }
+
+    // If something bad went down this will rethrow it
+    uint32_t count = 0;
+    for (auto& result : results) {
+      count += result.get_future().get();
+    }
+
+    // Move the new tiles over the old ones
+    for (const auto& tile_id : tile_ids) {
+      auto suffix = filesystem::path::preferred_separator + GraphTile::FileSuffix(tile_id);
+      if (boost::filesystem::exists(staging_dir + suffix)) {
+        boost::filesystem::rename(staging_dir + suffix, tile_dir + suffix);
+      }
+    }
+    boost::filesystem::remove_all(staging_dir);
+    reader.Clear();
     LOG_INFO("Finished with " + std::to_string(count) + " shortcuts");
   }
 }
@@ -16,14 +16,157 @@
 #include "mjolnir/shortcutbuilder.h"
 #include "mjolnir/transitbuilder.h"
 
+#include "midgard/sequence.h"
+#include "midgard/util.h"
+
 #include <boost/algorithm/string/classification.hpp>
 #include <boost/algorithm/string/split.hpp>
+#include <boost/crc.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
 
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <unordered_map>
+
+namespace {
+
+const std::string CHECKPOINT_FILE = "build_stages.json";
+const std::string STAGING_DIR = "stage_tmp";
+
+// to way id and from way id of a complex restriction
+struct end_map_entry_t {
+  uint64_t to;
+  uint64_t from;
+};
+
+// checksum of a file so we know the flat files are still the ones the stages left behind
+uint32_t checksum(const std::string& file_name) {
+  std::ifstream file(file_name, std::ios::binary);
+  if (!file.is_open()) {
+    throw std::runtime_error("Could not open " + file_name);
+  }
+  boost::crc_32_type crc;
+  std::vector<char> buffer(1 << 20);
+  while (file) {
+    file.read(buffer.data(), buffer.size());
+    crc.process_bytes(buffer.data(), file.gcount());
+  }
+  return crc.checksum();
+}
+
+// the directories below the tile_dir that hold each level of tiles, including transit
+std::vector<std::string> level_dirs() {
+  std::vector<std::string> dirs;
+  for (const auto& level : valhalla::baldr::TileHierarchy::levels()) {
+    dirs.push_back(std::to_string(level.first));
+  }
+  auto transit_level = valhalla::baldr::TileHierarchy::levels().rbegin()->second.level + 1;
+  dirs.push_back(std::to_string(transit_level));
+  return dirs;
+}
+
+// copy every level of tiles from one directory to another
+void copy_tiles(const std::string& from_dir, const std::string& to_dir) {
+  for (const auto& level : level_dirs()) {
+    boost::filesystem::path from(from_dir + filesystem::path::preferred_separator + level);
+    if (!boost::filesystem::exists(from)) {
+      continue;
+    }
+    boost::filesystem::path to(to_dir + filesystem::path::preferred_separator + level);
+    boost::filesystem::create_directories(to);
+    boost::filesystem::recursive_directory_iterator i(from), end;
+    for (; i != end; ++i) {
+      auto target = to.string() + i->path().string().substr(from.string().size());
+      if (boost::filesystem::is_directory(i->path())) {
+        boost::filesystem::create_directories(target);
+      } else {
+        boost::filesystem::copy_file(i->path(), target);
+      }
+    }
+  }
+}
+
+// replace the levels of tiles in the tile_dir with the ones in the staging directory. levels that
+// were already moved are no longer staged so this can be run again if it was cut short
+void move_staged_tiles(const std::string& staging_dir, const std::string& tile_dir) {
+  for (const auto& level : level_dirs()) {
+    auto staged = staging_dir + filesystem::path::preferred_separator + level;
+    if (boost::filesystem::exists(staged)) {
+      auto target = tile_dir + filesystem::path::preferred_separator + level;
+      boost::filesystem::remove_all(target);
+      boost::filesystem::rename(staged, target);
+    }
+  }
+  boost::filesystem::remove_all(staging_dir);
+}
+
+// a flat file's name relative to the tile_dir if it is in there so that a build can be resumed
+// from another working directory, files elsewhere keep their absolute path
+std::string relative_to(const std::string& file_name, const std::string& tile_dir) {
+  auto file = boost::filesystem::absolute(file_name).string();
+  auto dir = boost::filesystem::absolute(tile_dir).string() + filesystem::path::preferred_separator;
+  return file.compare(0, dir.size(), dir) == 0 ? file.substr(dir.size()) : file;
+}
+
+// bytes read and written by this process so far, zeros where /proc isnt there to ask
+std::pair<uint64_t, uint64_t> io_bytes() {
+  std::pair<uint64_t, uint64_t> bytes{0, 0};
+  std::ifstream file("/proc/self/io");
+  std::string name;
+  uint64_t value;
+  while (file >> name >> value) {
+    if (name == "read_bytes:") {
+      bytes.first = value;
+    } else if (name == "write_bytes:") {
+      bytes.second = value;
+    }
+  }
+  return bytes;
+}
+
+} // namespace
+
 namespace valhalla {
 namespace mjolnir {
 
+// Get the name of a build stage
+std::string to_string(BuildStage stage) {
+  static const std::unordered_map<int8_t, std::string> BuildStageStrings = {
+      {static_cast<int8_t>(BuildStage::kInitialize), "initialize"},
+      {static_cast<int8_t>(BuildStage::kEnhance), "enhance"},
+      {static_cast<int8_t>(BuildStage::kTransit), "transit"},
+      {static_cast<int8_t>(BuildStage::kHierarchy), "hierarchy"},
+      {static_cast<int8_t>(BuildStage::kShortcuts), "shortcuts"},
+      {static_cast<int8_t>(BuildStage::kRestrictions), "restrictions"},
+      {static_cast<int8_t>(BuildStage::kValidate), "validate"},
+  };
+
+  auto i = BuildStageStrings.find(static_cast<int8_t>(stage));
+  if (i == BuildStageStrings.cend()) {
+    return "invalid";
+  }
+  return i->second;
+}
+
+// Get a build stage from its name
+BuildStage string_to_buildstage(const std::string& name) {
+  static const std::unordered_map<std::string, BuildStage> stringToBuildStage =
+      {{"initialize", BuildStage::kInitialize},    {"enhance", BuildStage::kEnhance},
+       {"transit", BuildStage::kTransit},          {"hierarchy", BuildStage::kHierarchy},
+       {"shortcuts", BuildStage::kShortcuts},      {"restrictions", BuildStage::kRestrictions},
+       {"validate", BuildStage::kValidate}};
+
+  auto i = stringToBuildStage.find(name);
+  if (i == stringToBuildStage.cend()) {
+    return BuildStage::kInvalid;
+  }
+  return i->second;
+}
+
 /**
  * Splits a tag into a vector of strings.  Delim defaults to ;
  */
@@ -80,82 +223,224 @@ uint32_t compute_curvature(const std::list<PointLL>& shape) {
 void build_tile_set(const boost::property_tree::ptree& config,
                     const std::vector<std::string>& input_files,
                     const std::string& bin_file_prefix,
-                    bool free_protobuf) {
+                    bool free_protobuf,
+                    BuildStage start_stage,
+                    BuildStage end_stage) {
   // cannot allow this when building tiles
   if (config.get_child("mjolnir").get_optional<std::string>("tile_extract")) {
     throw std::runtime_error("Tiles cannot be directly built into a tar extract");
   }
+  if (start_stage == BuildStage::kInvalid || end_stage == BuildStage::kInvalid ||
+      start_stage > end_stage) {
+    throw std::runtime_error("Invalid build stages " + to_string(start_stage) + " to " +
+                             to_string(end_stage));
+  }
 
-  // set up the directories and purge old tiles
+  // the flat files the stages write and read. the checkpoint records them relative to the tile_dir
+  // so that a build can be resumed from another working directory
   auto tile_dir = config.get<std::string>("mjolnir.tile_dir");
-  for (const auto& level : valhalla::baldr::TileHierarchy::levels()) {
-    auto level_dir = tile_dir + filesystem::path::preferred_separator + std::to_string(level.first);
-    if (boost::filesystem::exists(level_dir) && !boost::filesystem::is_empty(level_dir)) {
-      LOG_WARN("Non-empty " + level_dir + " will be purged of tiles");
-      boost::filesystem::remove_all(level_dir);
+  auto checkpoint_file = tile_dir + filesystem::path::preferred_separator + CHECKPOINT_FILE;
+  auto staging_dir = tile_dir + filesystem::path::preferred_separator + STAGING_DIR;
+  std::map<std::string, std::string> flat_files{
+      {"ways", bin_file_prefix + "ways.bin"},
+      {"way_nodes", bin_file_prefix + "way_nodes.bin"},
+      {"access", bin_file_prefix + "access.bin"},
+      {"complex_restrictions", bin_file_prefix + "complex_restrictions.bin"},
+      {"end_map", bin_file_prefix + "end_map.bin"}};
+
+  // starting over so set up the directories and purge old tiles
+  boost::property_tree::ptree checkpoint;
+  if (start_stage == BuildStage::kInitialize) {
+    for (const auto& level : level_dirs()) {
+      auto level_dir = tile_dir + filesystem::path::preferred_separator + level;
+      if (boost::filesystem::exists(level_dir) && !boost::filesystem::is_empty(level_dir)) {
+        LOG_WARN("Non-empty " + level_dir + " will be purged of tiles");
+        boost::filesystem::remove_all(level_dir);
+      }
     }
-  }
 
-  // check for transit level.
-  auto level_dir =
-      tile_dir + filesystem::path::preferred_separator +
-      std::to_string(valhalla::baldr::TileHierarchy::levels().rbegin()->second.level + 1);
-  if (boost::filesystem::exists(level_dir) && !boost::filesystem::is_empty(level_dir)) {
-    LOG_WARN("Non-empty " + level_dir + " will be purged of tiles");
-    boost::filesystem::remove_all(level_dir);
+    boost::filesystem::create_directories(tile_dir);
+    boost::filesystem::remove_all(staging_dir);
+    boost::filesystem::remove(checkpoint_file);
+  } // resuming so make sure the stages before this one finished and left their files alone
+  else {
+    if (!boost::filesystem::exists(checkpoint_file)) {
+      throw std::runtime_error("Cannot resume at " + to_string(start_stage) + " without " +
+                               checkpoint_file);
+    }
+    boost::property_tree::read_json(checkpoint_file, checkpoint);
+
+    // a stage that was stopped while its tiles were being moved into place has done its work so
+    // finish moving them. one that was stopped before then left the tiles as they were
+    auto moving = checkpoint.get_optional<std::string>("moving");
+    if (moving) {
+      LOG_INFO("Finishing moving the tiles of the " + *moving + " stage into place");
+      move_staged_tiles(staging_dir, tile_dir);
+      checkpoint.erase("moving");
+      checkpoint.put("completed", *moving);
+      boost::property_tree::write_json(checkpoint_file, checkpoint);
+    }
+    auto completed = string_to_buildstage(checkpoint.get<std::string>("completed", ""));
+    if (static_cast<int8_t>(completed) + 1 != static_cast<int8_t>(start_stage)) {
+      throw std::runtime_error("Cannot resume at " + to_string(start_stage) +
+                               " because the last completed stage was " + to_string(completed));
+    }
+    for (const auto& file : checkpoint.get_child("files")) {
+      boost::filesystem::path name(file.second.get<std::string>("name"));
+      if (!name.is_absolute()) {
+        name = boost::filesystem::path(tile_dir) / name;
+      }
+      if (!boost::filesystem::exists(name) ||
+          boost::filesystem::file_size(name) != file.second.get<uint64_t>("size") ||
+          checksum(name.string()) != file.second.get<uint32_t>("crc")) {
+        throw std::runtime_error("Cannot resume at " + to_string(start_stage) + " because " +
+                                 name.string() + " changed since it was written");
+      }
+      flat_files[file.first] = name.string();
+    }
+    LOG_INFO("Resuming the build at " + to_string(start_stage) + " after " +
+             to_string(completed));
   }
+  const auto& access_file = flat_files["access"];
+  const auto& complex_restriction_file = flat_files["complex_restrictions"];
+  const auto& end_map_file = flat_files["end_map"];
 
-  boost::filesystem::create_directories(tile_dir);
+  // runs a stage if its in range, reports what it cost and records that it started and completed.
+  // the stages after initialize rewrite tiles in place so they work on a copy of the tiles in the
+  // staging directory which replaces the tiles once the stage is done. that way a stage that is
+  // stopped part way through leaves the tiles of the previous stage and can be run again
+  auto run_stage = [&](BuildStage stage,
+                       const std::function<void(const boost::property_tree::ptree&)>& work) {
+    if (stage < start_stage || stage > end_stage) {
+      return;
+    }
+    auto stage_config = config;
+    if (stage != BuildStage::kInitialize) {
+      boost::filesystem::remove_all(staging_dir);
+      copy_tiles(tile_dir, staging_dir);
+      stage_config.put("mjolnir.tile_dir", staging_dir);
+    }
+    checkpoint.put("started", to_string(stage));
+    boost::property_tree::write_json(checkpoint_file, checkpoint);
+    auto start_time = std::chrono::steady_clock::now();
+    auto start_io = io_bytes();
+    work(stage_config);
+    if (stage != BuildStage::kInitialize) {
+      checkpoint.put("moving", to_string(stage));
+      boost::property_tree::write_json(checkpoint_file, checkpoint);
+      move_staged_tiles(staging_dir, tile_dir);
+      checkpoint.erase("moving");
+    }
+    auto seconds = std::chrono::duration_cast<std::chrono::duration<double>>(
+                       std::chrono::steady_clock::now() - start_time)
+                       .count();
+    auto end_io = io_bytes();
+    std::stringstream report;
+    report << "Stage " << to_string(stage) << " took " << seconds << "s, read "
+           << (end_io.first - start_io.first) << " bytes and wrote "
+           << (end_io.second - start_io.second) << " bytes";
+    if (midgard::memory_status::supported()) {
+      midgard::memory_status status({"VmHWM"});
+      if (!status.metrics.empty()) {
+        report << ", peak memory so far " << status.metrics.begin()->second.first
+               << status.metrics.begin()->second.second;
+      }
+    }
+    LOG_INFO(report.str());
 
-  // Read the OSM protocol buffer file. Callbacks for nodes, ways, and
-  // relations are defined within the PBFParser class
-  auto osm_data =
-      PBFGraphParser::Parse(config.get_child("mjolnir"), input_files, bin_file_prefix + "ways.bin",
-                            bin_file_prefix + "way_nodes.bin", bin_file_prefix + "access.bin",
-                            bin_file_prefix + "complex_restrictions.bin");
+    checkpoint.put("completed", to_string(stage));
+    boost::property_tree::write_json(checkpoint_file, checkpoint);
+  };
 
-  // Optionally free all protobuf memory but also you cant use the protobuffer lib after this!
-  if (free_protobuf) {
-    OSMPBF::Parser::free();
-  }
+  // Parse the osm data and build the local level of the graph from it
+  std::unordered_multimap<uint64_t, uint64_t> end_map;
+  run_stage(BuildStage::kInitialize, [&](const boost::property_tree::ptree& config) {
+    // Read the OSM protocol buffer file. Callbacks for nodes, ways, and
+    // relations are defined within the PBFParser class
+    auto osm_data = PBFGraphParser::Parse(config.get_child("mjolnir"), input_files,
+                                          flat_files["ways"], flat_files["way_nodes"], access_file,
+                                          complex_restriction_file);
+
+    // Optionally free all protobuf memory but also you cant use the protobuffer lib after this!
+    if (free_protobuf) {
+      OSMPBF::Parser::free();
+    }
+
+    // Build the graph using the OSMNodes and OSMWays from the parser
+    GraphBuilder::Build(config, osm_data, flat_files["ways"], flat_files["way_nodes"],
+                        complex_restriction_file);
 
-  // Build the graph using the OSMNodes and OSMWays from the parser
-  GraphBuilder::Build(config, osm_data, bin_file_prefix + "ways.bin",
-                      bin_file_prefix + "way_nodes.bin",
-                      bin_file_prefix + "complex_restrictions.bin");
+    // The restriction builder needs the end map long after the rest of the osm data is gone
+    // so keep it on disk for when we resume
+    end_map = std::move(osm_data.end_map);
+    boost::filesystem::remove(end_map_file);
+    {
+      midgard::sequence<end_map_entry_t> end_map_entries(end_map_file, true);
+      for (const auto& entry : end_map) {
+        end_map_entries.push_back({entry.first, entry.second});
+      }
+    }
+
+    // note what the flat files were when the parsing finished
+    boost::property_tree::ptree files;
+    for (const auto& flat_file : flat_files) {
+      boost::property_tree::ptree file;
+      file.put("name", relative_to(flat_file.second, tile_dir));
+      file.put("size", boost::filesystem::file_size(flat_file.second));
+      file.put("crc", checksum(flat_file.second));
+      files.push_back(std::make_pair(flat_file.first, file));
+    }
+    checkpoint.put_child("files", files);
+  });
+  if (start_stage > BuildStage::kInitialize && start_stage <= BuildStage::kRestrictions &&
+      end_stage >= BuildStage::kRestrictions) {
+    midgard::sequence<end_map_entry_t> end_map_entries(end_map_file, false);
+    for (const auto& entry : end_map_entries) {
+      end_map.emplace(entry.to, entry.from);
+    }
+  }
 
   // Enhance the local level of the graph. This adds information to the local
   // level that is usable across all levels (density, administrative
   // information (and country based attribution), edge transition logic, etc.
-  GraphEnhancer::Enhance(config, bin_file_prefix + "access.bin");
+  run_stage(BuildStage::kEnhance, [&](const boost::property_tree::ptree& config) {
+    GraphEnhancer::Enhance(config, access_file);
+  });
 
   // Add transit
-  TransitBuilder::Build(config);
+  run_stage(BuildStage::kTransit,
+            [&](const boost::property_tree::ptree& config) { TransitBuilder::Build(config); });
 
   // Builds additional hierarchies if specified within config file. Connections
   // (directed edges) are formed between nodes at adjacent levels.
   auto build_hierarchy = config.get<bool>("mjolnir.hierarchy", true);
-  if (build_hierarchy) {
-    HierarchyBuilder::Build(config);
+  run_stage(BuildStage::kHierarchy, [&](const boost::property_tree::ptree& config) {
+    if (build_hierarchy) {
+      HierarchyBuilder::Build(config);
+    } else {
+      LOG_INFO("Skipping hierarchy builder and shortcut builder");
+    }
+  });
 
-    // Build shortcuts if specified in the config file. Shortcuts can only be
-    // applied if hierarchies are also generated.
-    auto build_shortcuts = config.get<bool>("mjolnir.shortcuts", true);
-    if (build_shortcuts) {
+  // Build shortcuts if specified in the config file. Shortcuts can only be
+  // applied if hierarchies are also generated.
+  run_stage(BuildStage::kShortcuts, [&](const boost::property_tree::ptree& config) {
+    if (build_hierarchy && config.get<bool>("mjolnir.shortcuts", true)) {
       ShortcutBuilder::Build(config);
-    } else {
+    } else if (build_hierarchy) {
       LOG_INFO("Skipping shortcut builder");
     }
-  } else {
-    LOG_INFO("Skipping hierarchy builder and shortcut builder");
-  }
+  });
 
   // Build the Complex Restrictions
-  RestrictionBuilder::Build(config, bin_file_prefix + "complex_restrictions.bin", osm_data.end_map);
+  run_stage(BuildStage::kRestrictions, [&](const boost::property_tree::ptree& config) {
+    RestrictionBuilder::Build(config, complex_restriction_file, end_map);
+  });
 
   // Validate the graph and add information that cannot be added until
   // full graph is formed.
-  GraphValidator::Validate(config);
+  run_stage(BuildStage::kValidate,
+            [&](const boost::property_tree::ptree& config) { GraphValidator::Validate(config); });
 }
 
 } // namespace mjolnir
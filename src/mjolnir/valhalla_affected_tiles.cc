@@ -0,0 +1,125 @@
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "baldr/graphreader.h"
+#include "baldr/graphtile.h"
+#include "config.h"
+#include "mjolnir/osmchange.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::mjolnir;
+
+#include "baldr/rapidjson_utils.h"
+#include <boost/filesystem/operations.hpp>
+#include <boost/optional.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include "midgard/logging.h"
+#include "midgard/util.h"
+
+namespace bpo = boost::program_options;
+
+int main(int argc, char** argv) {
+  // Program options
+  boost::filesystem::path config_file_path;
+  std::string inline_config;
+  std::vector<std::string> input_files;
+  std::string ways_file = "ways.bin";
+  std::string way_nodes_file = "way_nodes.bin";
+  bpo::options_description options(
+      "valhalla_affected_tiles " VALHALLA_VERSION "\n\n"
+      "Usage: valhalla_affected_tiles [options] <osm_change_file>...\n\n"
+      "valhalla_affected_tiles is a program that works out which of the tiles in the configured "
+      "tile_dir or tile_extract a set of osmChange (.osc) files touch. It prints the path of each "
+      "affected tile, relative to the tile directory, one per line. These are the tiles that "
+      "have to be rebuilt to apply the changes, rebuilding them is left to the caller. The ways "
+      "and way nodes files kept from the last build are used to find where moved or deleted "
+      "nodes used to be.\n\n");
+
+  options.add_options()("help,h", "Print this help message.")("version,v",
+                                                              "Print the version of this software.")(
+      "config,c", boost::program_options::value<boost::filesystem::path>(&config_file_path),
+      "Path to the json configuration file.")("inline-config,i",
+                                              boost::program_options::value<std::string>(
+                                                  &inline_config),
+                                              "Inline json config.")(
+      "ways", boost::program_options::value<std::string>(&ways_file),
+      "Ways file of the last build, defaults to ways.bin.")(
+      "way-nodes", boost::program_options::value<std::string>(&way_nodes_file),
+      "Way nodes file of the last build, defaults to way_nodes.bin.")
+      // positional arguments
+      ("input_files",
+       boost::program_options::value<std::vector<std::string>>(&input_files)->multitoken());
+
+  bpo::positional_options_description pos_options;
+  pos_options.add("input_files", 16);
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(options).positional(pos_options).run(),
+               vm);
+    bpo::notify(vm);
+
+  } catch (std::exception& e) {
+    std::cerr << "Unable to parse command line options because: " << e.what() << "\n";
+    return EXIT_FAILURE;
+  }
+
+  // Print out help or version and return
+  if (vm.count("help")) {
+    std::cout << options << "\n";
+    return EXIT_SUCCESS;
+  }
+  if (vm.count("version")) {
+    std::cout << "valhalla_affected_tiles " << VALHALLA_VERSION << "\n";
+    return EXIT_SUCCESS;
+  }
+  if (input_files.size() == 0) {
+    std::cerr << "Input file is required\n\n" << options << "\n\n";
+    return EXIT_FAILURE;
+  }
+
+  // Read the config file
+  boost::property_tree::ptree pt;
+  if (vm.count("inline-config")) {
+    std::stringstream ss;
+    ss << inline_config;
+    rapidjson::read_json(ss, pt);
+  } else if (vm.count("config") && boost::filesystem::is_regular_file(config_file_path)) {
+    rapidjson::read_json(config_file_path.string(), pt);
+  } else {
+    std::cerr << "Configuration is required\n\n" << options << "\n\n";
+    return EXIT_FAILURE;
+  }
+
+  // configure logging
+  boost::optional<boost::property_tree::ptree&> logging_subtree =
+      pt.get_child_optional("mjolnir.logging");
+  if (logging_subtree) {
+    auto logging_config =
+        valhalla::midgard::ToMap<const boost::property_tree::ptree&,
+                                 std::unordered_map<std::string, std::string>>(logging_subtree.get());
+    valhalla::midgard::logging::Configure(logging_config);
+  }
+
+  // Gather up all the changes and find the tiles they touch
+  OSMChange change;
+  for (const auto& input_file : input_files) {
+    auto file_change = OSMChange::Parse(input_file);
+    change.nodes.insert(file_change.nodes.begin(), file_change.nodes.end());
+    change.ways.insert(file_change.ways.begin(), file_change.ways.end());
+    change.relations.insert(file_change.relations.begin(), file_change.relations.end());
+    change.locations.insert(change.locations.end(), file_change.locations.begin(),
+                            file_change.locations.end());
+    change.member_nodes.insert(file_change.member_nodes.begin(), file_change.member_nodes.end());
+    change.member_ways.insert(file_change.member_ways.begin(), file_change.member_ways.end());
+  }
+  GraphReader reader(pt.get_child("mjolnir"));
+  for (const auto& tile_id : AffectedTiles(reader, change, ways_file, way_nodes_file)) {
+    std::cout << GraphTile::FileSuffix(tile_id) << std::endl;
+  }
+
+  return EXIT_SUCCESS;
+}
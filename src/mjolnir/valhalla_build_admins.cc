@@ -438,11 +438,11 @@ void BuildAdminFromPBF(const boost::property_tree::ptree& pt,
 
       for (const auto memberid : admin.ways()) {
 
-        auto itr = osmdata.way_map.find(memberid);
+        OSMWayMap::Nodes nodes;
 
         // A relation may be included in an extract but it's members may not.
         // Example:  PA extract can contain a NY relation.
-        if (itr == osmdata.way_map.end()) {
+        if (!osmdata.way_map.find(memberid, nodes)) {
           has_data = false;
           break;
         }
@@ -451,7 +451,7 @@ void BuildAdminFromPBF(const boost::property_tree::ptree& pt,
             gf->getCoordinateSequenceFactory()->create((size_t)0, (size_t)2));
         size_t j = 0;
 
-        for (const auto ref_id : itr->second) {
+        for (const auto ref_id : nodes) {
 
           const PointLL ll = osmdata.shape_map.at(ref_id);
 
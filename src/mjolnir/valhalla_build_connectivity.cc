@@ -38,7 +38,8 @@ bool ParseArguments(int argc, char* argv[]) {
       " Usage: connectivitymap [options]\n"
       "\n"
       "connectivitymap is a program that creates a PPM image file representing "
-      "the connectivity between tiles."
+      "the connectivity between tiles. If mjolnir.connectivity_map is configured "
+      "it also writes the binary connectivity map there for the services to load."
       "\n"
       "\n");
 
@@ -114,8 +115,19 @@ int main(int argc, char** argv) {
   boost::property_tree::ptree pt;
   rapidjson::read_json(config_file_path.c_str(), pt);
 
-  // Get something we can use to fetch tiles
-  valhalla::baldr::connectivity_map_t connectivity_map(pt.get_child("mjolnir"));
+  // Get something we can use to fetch tiles, always computing it from the tiles
+  valhalla::baldr::connectivity_map_t connectivity_map(pt.get_child("mjolnir"), false);
+
+  // Write the binary version for the services so they dont need to compute it
+  auto binary_file = pt.get_optional<std::string>("mjolnir.connectivity_map");
+  if (binary_file) {
+    try {
+      connectivity_map.write(*binary_file);
+    } catch (const std::exception& e) {
+      std::cout << e.what() << std::endl;
+      return EXIT_FAILURE;
+    }
+  }
 
   uint32_t transit_level = TileHierarchy::levels().rbegin()->second.level + 1;
   for (uint32_t level = 0; level <= transit_level; level++) {
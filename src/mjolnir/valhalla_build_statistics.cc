@@ -428,7 +428,7 @@ void build(const boost::property_tree::ptree& pt,
           // since only truck restrictions exist, we can still get all restrictions
           // later we may only want to get just the truck ones for stats.
           auto res = tile->GetAccessRestrictions(idx, kAllAccess);
-          if (res.size() == 0) {
+          if (res.empty()) {
             LOG_ERROR(
                 "Directed edge marked as having access restriction but none found ; tile level = " +
                 std::to_string(tile_id.level()));
@@ -23,11 +23,18 @@ int main(int argc, char** argv) {
   boost::filesystem::path config_file_path;
   std::string inline_config;
   std::vector<std::string> input_files;
+  std::string start_stage_str = to_string(BuildStage::kInitialize);
+  std::string end_stage_str = to_string(BuildStage::kValidate);
   bpo::options_description options(
       "valhalla_build_tiles " VALHALLA_VERSION "\n\n"
       "Usage: valhalla_build_tiles [options] <protocolbuffer_input_file>\n\n"
       "valhalla_build_tiles is a program that creates the route graph from an osm.pbf "
-      "extract. Sample json configs are located in ../conf directory.\n\n");
+      "extract. Sample json configs are located in ../conf directory. The stages of the build "
+      "are initialize, enhance, transit, hierarchy, shortcuts, restrictions and validate. Each "
+      "completed stage is recorded in the tile_dir so a build that was stopped between stages "
+      "can be resumed at the next one. The stages after initialize work on a copy of the tiles "
+      "that only replaces them once the stage is done, so a build that was stopped part way "
+      "through one of them can be resumed at that stage.\n\n");
 
   options.add_options()("help,h", "Print this help message.")("version,v",
                                                               "Print the version of this software.")(
@@ -35,7 +42,11 @@ int main(int argc, char** argv) {
       "Path to the json configuration file.")("inline-config,i",
                                               boost::program_options::value<std::string>(
                                                   &inline_config),
-                                              "Inline json config.")
+                                              "Inline json config.")(
+      "start,s", boost::program_options::value<std::string>(&start_stage_str),
+      "Stage to start the build at, it must follow the last completed stage.")(
+      "end,e", boost::program_options::value<std::string>(&end_stage_str),
+      "Last stage of the build to run.")
       // positional arguments
       ("input_files",
        boost::program_options::value<std::vector<std::string>>(&input_files)->multitoken());
@@ -62,7 +73,15 @@ int main(int argc, char** argv) {
     std::cout << "valhalla_build_tiles " << VALHALLA_VERSION << "\n";
     return EXIT_SUCCESS;
   }
-  if (input_files.size() == 0) {
+  auto start_stage = string_to_buildstage(start_stage_str);
+  auto end_stage = string_to_buildstage(end_stage_str);
+  if (start_stage == BuildStage::kInvalid || end_stage == BuildStage::kInvalid ||
+      start_stage > end_stage) {
+    std::cerr << "Invalid stages " << start_stage_str << " to " << end_stage_str << "\n\n"
+              << options << "\n\n";
+    return EXIT_FAILURE;
+  }
+  if (input_files.size() == 0 && start_stage == BuildStage::kInitialize) {
     std::cerr << "Input file is required\n\n" << options << "\n\n";
     return EXIT_FAILURE;
   }
@@ -93,7 +112,7 @@ int main(int argc, char** argv) {
   // build some tiles
   pt.get_child("mjolnir").erase("tile_extract");
   pt.get_child("mjolnir").erase("tile_url");
-  build_tile_set(pt, input_files);
+  build_tile_set(pt, input_files, "", true, start_stage, end_stage);
 
   return EXIT_SUCCESS;
 }
@@ -1602,8 +1602,8 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
                 const std::vector<float>& distances,
                 const std::vector<uint32_t>& route_types,
                 std::vector<OneStopTest>& onestoptests,
-                bool tile_within_one_tz,
-                const std::unordered_map<uint32_t, multi_polygon_type>& tz_polys,
+                const std::vector<uint32_t>& tz_ids,
+                const PolygonIndex& timezones,
                 uint32_t& no_dir_edge_count) {
   auto t1 = std::chrono::high_resolution_clock::now();
 
@@ -1684,7 +1684,7 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
       if (timezone == 0) {
         // fallback to tz database.
         timezone =
-            (tile_within_one_tz) ? tz_polys.begin()->first : GetMultiPolyId(tz_polys, station_ll);
+            (tz_ids.size() == 1) ? tz_ids.front() : timezones.covered_by(station_ll);
 
         if (timezone == 0) {
           LOG_WARN("Timezone not found for station " + station.name());
@@ -1730,7 +1730,7 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
         if (timezone == 0) {
           // fallback to tz database.
           timezone =
-              (tile_within_one_tz) ? tz_polys.begin()->first : GetMultiPolyId(tz_polys, egress_ll);
+              (tz_ids.size() == 1) ? tz_ids.front() : timezones.covered_by(egress_ll);
           if (timezone == 0) {
             LOG_WARN("Timezone not found for egress " + egress.name());
           }
@@ -1908,7 +1908,7 @@ void AddToGraph(GraphTileBuilder& tilebuilder_transit,
     if (timezone == 0) {
       // fallback to tz database.
       timezone =
-          (tile_within_one_tz) ? tz_polys.begin()->first : GetMultiPolyId(tz_polys, platform_ll);
+          (tz_ids.size() == 1) ? tz_ids.front() : timezones.covered_by(platform_ll);
       if (timezone == 0) {
         LOG_WARN("Timezone not found for platform " + platform.name());
       }
@@ -2072,6 +2072,7 @@ void build_tiles(const boost::property_tree::ptree& pt,
                  std::unordered_set<GraphId>::const_iterator tile_start,
                  std::unordered_set<GraphId>::const_iterator tile_end,
                  std::vector<OneStopTest>& onestoptests,
+                 const PolygonIndex& timezones,
                  std::promise<builder_stats>& results) {
 
   builder_stats stats;
@@ -2080,12 +2081,6 @@ void build_tiles(const boost::property_tree::ptree& pt,
   stats.midnight_dep_count = 0;
 
   GraphReader reader_transit_level(pt);
-  auto database = pt.get_optional<std::string>("timezone");
-  // Initialize the tz DB (if it exists)
-  sqlite3* tz_db_handle = GetDBHandle(*database);
-  if (!tz_db_handle) {
-    LOG_WARN("Time zone db " + *database + " not found.  Not saving time zone information from db.");
-  }
 
   const auto& tiles = TileHierarchy::levels().rbegin()->second.tiles;
   // Iterate through the tiles in the queue and find any that include stops
@@ -2245,20 +2240,12 @@ void build_tiles(const boost::property_tree::ptree& pt,
 
     // Add routes to the tile. Get vector of route types.
     std::vector<uint32_t> route_types = AddRoutes(transit, tilebuilder_transit);
-    auto filter = tiles.TileBounds(tile_id.tileid());
-    bool tile_within_one_tz = false;
-    std::unordered_map<uint32_t, multi_polygon_type> tz_polys;
-    if (tz_db_handle) {
-      tz_polys = GetTimeZones(tz_db_handle, filter);
-      if (tz_polys.size() == 1) {
-        tile_within_one_tz = true;
-      }
-    }
+    auto tz_ids = timezones.intersects(tiles.TileBounds(tile_id.tileid()));
 
     // Add nodes, directededges, and edgeinfo
     AddToGraph(tilebuilder_transit, tile_id, file, transit_dir, lock, all_tiles, stop_edge_map,
-               stop_access, shapes, distances, route_types, onestoptests, tile_within_one_tz,
-               tz_polys, stats.no_dir_edge_count);
+               stop_access, shapes, distances, route_types, onestoptests, tz_ids,
+               timezones, stats.no_dir_edge_count);
 
     LOG_INFO("Tile " + std::to_string(tile_id.tileid()) + ": added " +
              std::to_string(transit.nodes_size()) + " stops, " +
@@ -2272,10 +2259,6 @@ void build_tiles(const boost::property_tree::ptree& pt,
     lock.unlock();
   }
 
-  if (tz_db_handle) {
-    sqlite3_close(tz_db_handle);
-  }
-
   // Send back the statistics
   results.set_value(stats);
 }
@@ -2300,6 +2283,18 @@ void build(const ptree& pt,
   // Second pass - for all tiles with transit stops get all transit information
   // and populate tiles
 
+  // Load the time zones once for all of the threads
+  auto database = pt.get_optional<std::string>("mjolnir.timezone");
+  sqlite3* tz_db_handle = database ? GetDBHandle(*database) : nullptr;
+  if (!tz_db_handle) {
+    LOG_WARN("Time zone db " + (database ? *database : std::string()) +
+             " not found.  Not saving time zone information from db.");
+  }
+  PolygonIndex timezones = GetTimeZoneIndex(tz_db_handle);
+  if (tz_db_handle) {
+    sqlite3_close(tz_db_handle);
+  }
+
   // A place to hold worker threads and their results
   std::vector<std::shared_ptr<std::thread>> threads(thread_count);
 
@@ -2327,7 +2322,8 @@ void build(const ptree& pt,
     results.emplace_back();
     threads[i].reset(new std::thread(build_tiles, std::cref(pt.get_child("mjolnir")), std::ref(lock),
                                      std::cref(all_tiles), tile_start, tile_end,
-                                     std::ref(onestoptests), std::ref(results.back())));
+                                     std::ref(onestoptests), std::cref(timezones),
+                                     std::ref(results.back())));
   }
 
   // Wait for them to finish up their work
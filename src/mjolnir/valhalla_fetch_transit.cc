@@ -29,7 +29,6 @@
 #include "midgard/encoded.h"
 #include "midgard/logging.h"
 #include "midgard/sequence.h"
-#include "mjolnir/admin.h"
 #include "mjolnir/servicedays.h"
 
 #include <valhalla/proto/transit_fetch.pb.h>
@@ -284,9 +283,7 @@ void get_stops(Transit_Fetch& tile,
                std::unordered_map<std::string, uint64_t>& stops,
                const GraphId& tile_id,
                const ptree& response,
-               const AABB2<PointLL>& filter,
-               bool tile_within_one_tz,
-               const std::unordered_map<uint32_t, multi_polygon_type>& tz_polys) {
+               const AABB2<PointLL>& filter) {
   for (const auto& stop_pt : response.get_child("stops")) {
     const auto& ll_pt = stop_pt.second.get_child("geometry_centroid.coordinates");
     auto lon = ll_pt.front().second.get_value<float>();
@@ -641,15 +638,6 @@ void fetch_tiles(const ptree& pt,
   utc->tm_year += 1900;
   ++utc->tm_mon; // TODO: use timezone code?
 
-  auto database = pt.get_optional<std::string>("mjolnir.timezone");
-  // Initialize the tz DB (if it exists)
-  sqlite3* tz_db_handle = database ? GetDBHandle(*database) : nullptr;
-  if (!database) {
-    LOG_WARN("Time zone db not found.  Not saving time zone information from db.");
-  } else if (!tz_db_handle) {
-    LOG_WARN("Time zone db " + *database + " not found.  Not saving time zone information from db.");
-  }
-
   // for each tile
   while (true) {
     GraphId current;
@@ -688,15 +676,6 @@ void fetch_tiles(const ptree& pt,
     std::string prefix = transit_tile.string();
     LOG_INFO("Fetching " + transit_tile.string());
 
-    bool tile_within_one_tz = false;
-    std::unordered_map<uint32_t, multi_polygon_type> tz_polys;
-    if (tz_db_handle) {
-      tz_polys = GetTimeZones(tz_db_handle, filter);
-      if (tz_polys.size() == 1) {
-        tile_within_one_tz = true;
-      }
-    }
-
     // pull out all the STOPS (you see what we did there?)
     std::unordered_map<std::string, uint64_t> stops;
     boost::optional<std::string> request =
@@ -710,7 +689,7 @@ void fetch_tiles(const ptree& pt,
       // grab some stuff
       response = curler(*request, "stops");
       // copy stops in, keeping map of stopid to graphid
-      get_stops(tile, stops, current, response, filter, tile_within_one_tz, tz_polys);
+      get_stops(tile, stops, current, response, filter);
       // please sir may i have some more?
       request = response.get_optional<std::string>("meta.next");
 
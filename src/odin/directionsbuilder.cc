@@ -69,8 +69,9 @@ DirectionsBuilder::DirectionsBuilder() {
 // NarrativeBuilder::Build to form the maneuver list. This method
 // calls PopulateTripDirections to transform the maneuver list into the
 // trip directions.
-TripDirections DirectionsBuilder::Build(const DirectionsOptions& directions_options,
-                                        TripPath& trip_path) {
+void DirectionsBuilder::Build(const DirectionsOptions& directions_options,
+                              TripPath& trip_path,
+                              TripDirections& trip_directions) {
   // Validate trip path node list
   if (trip_path.node_size() < 1) {
     throw valhalla_exception_t{210};
@@ -94,8 +95,8 @@ TripDirections DirectionsBuilder::Build(const DirectionsOptions& directions_opti
     narrative_builder->Build(directions_options, etp, maneuvers);
   }
 
-  // Return trip directions
-  return PopulateTripDirections(directions_options, etp, maneuvers);
+  // Fill in the trip directions
+  PopulateTripDirections(directions_options, etp, maneuvers, trip_directions);
 }
 
 // Update the heading of ~0 length edges.
@@ -123,12 +124,13 @@ void DirectionsBuilder::UpdateHeading(EnhancedTripPath* etp) {
   }
 }
 
-// Returns the trip directions based on the specified directions options,
+// Populates the trip directions based on the specified directions options,
 // trip path, and maneuver list.
-TripDirections DirectionsBuilder::PopulateTripDirections(const DirectionsOptions& directions_options,
-                                                         EnhancedTripPath* etp,
-                                                         std::list<Maneuver>& maneuvers) {
-  TripDirections trip_directions;
+void DirectionsBuilder::PopulateTripDirections(const DirectionsOptions& directions_options,
+                                               EnhancedTripPath* etp,
+                                               std::list<Maneuver>& maneuvers,
+                                               TripDirections& trip_directions) {
+  trip_directions.Clear();
 
   // Populate trip and leg IDs
   trip_directions.set_trip_id(etp->trip_id());
@@ -328,8 +330,6 @@ TripDirections DirectionsBuilder::PopulateTripDirections(const DirectionsOptions
 
   // Populate shape
   trip_directions.set_shape(etp->shape());
-
-  return trip_directions;
 }
 
 } // namespace odin
@@ -33,19 +33,20 @@ odin_worker_t::~odin_worker_t() {
 }
 
 void odin_worker_t::cleanup() {
+  arena.Reset();
 }
 
-std::list<TripDirections> odin_worker_t::narrate(const valhalla_request_t& request,
-                                                 std::list<TripPath>& legs) const {
+void odin_worker_t::narrate(const valhalla_request_t& request,
+                            google::protobuf::RepeatedPtrField<TripPath>& legs,
+                            google::protobuf::RepeatedPtrField<TripDirections>& narrated) const {
   // get some annotated directions
-  std::list<TripDirections> narrated;
   try {
     for (auto& leg : legs) {
-      narrated.emplace_back(odin::DirectionsBuilder().Build(request.options, leg));
-      LOG_INFO("maneuver_count::" + std::to_string(narrated.back().maneuver_size()));
+      auto* directions = narrated.Add();
+      odin::DirectionsBuilder().Build(request.options, leg, *directions);
+      LOG_INFO("maneuver_count::" + std::to_string(directions->maneuver_size()));
     }
   } catch (...) { throw valhalla_exception_t{202}; }
-  return narrated;
 }
 
 #ifdef HAVE_HTTP
@@ -65,19 +66,21 @@ worker_t::result_t odin_worker_t::work(const std::list<zmq::message_t>& job,
     // Set the interrupt function
     service_worker_t::set_interrupt(interrupt_function);
 
-    // parse each leg
-    std::list<TripPath> legs;
+    // parse each leg onto the arena
+    auto* legs = google::protobuf::Arena::CreateMessage<
+        google::protobuf::RepeatedPtrField<TripPath>>(&arena);
     for (auto leg = ++(++job.cbegin()); leg != job.cend(); ++leg) {
       // crack open the path
-      legs.emplace_back();
       try {
-        legs.back().ParseFromArray(leg->data(), static_cast<int>(leg->size()));
+        legs->Add()->ParseFromArray(leg->data(), static_cast<int>(leg->size()));
       } catch (...) { return jsonify_error({201}, info, request); }
     }
 
     // narrate them and serialize them along
-    auto narrated = narrate(request, legs);
-    auto response = tyr::serializeDirections(request, legs, narrated);
+    auto* narrated = google::protobuf::Arena::CreateMessage<
+        google::protobuf::RepeatedPtrField<TripDirections>>(&arena);
+    narrate(request, *legs, *narrated);
+    auto response = tyr::serializeDirections(request, *legs, *narrated);
     auto* to_response =
         request.options.format() == DirectionsOptions::gpx ? to_response_xml : to_response_json;
     return to_response(response, info, request);
@@ -95,11 +98,13 @@ void run_service(const boost::property_tree::ptree& config) {
 
   // listen for requests
   zmq::context_t context;
+  odin_worker_t odin_worker(config);
   prime_server::worker_t worker(context, upstream_endpoint, "ipc:///dev/null", loopback_endpoint,
                                 interrupt_endpoint,
-                                std::bind(&odin_worker_t::work, odin_worker_t(config),
+                                std::bind(&odin_worker_t::work, std::ref(odin_worker),
                                           std::placeholders::_1, std::placeholders::_2,
-                                          std::placeholders::_3));
+                                          std::placeholders::_3),
+                                std::bind(&odin_worker_t::cleanup, std::ref(odin_worker)));
   worker.work();
 
   // TODO: should we listen for SIGINT and terminate gracefully/exit(0)?
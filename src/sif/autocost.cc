@@ -415,8 +415,7 @@ bool AutoCost::Allowed(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kAutoAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kAutoAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -454,8 +453,7 @@ bool AutoCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kAutoAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kAutoAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -903,8 +901,7 @@ bool BusCost::Allowed(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kBusAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kBusAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -942,8 +939,7 @@ bool BusCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kBusAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kBusAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -1122,8 +1118,7 @@ bool HOVCost::Allowed(const baldr::DirectedEdge* edge,
     return false;
   }
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kHOVAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kHOVAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -1163,8 +1158,7 @@ bool HOVCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kHOVAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kHOVAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -562,8 +562,7 @@ bool BicycleCost::Allowed(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kBicycleAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kBicycleAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -604,8 +603,7 @@ bool BicycleCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kBicycleAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kBicycleAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
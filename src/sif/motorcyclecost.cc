@@ -431,8 +431,7 @@ bool MotorcycleCost::Allowed(const baldr::DirectedEdge* edge,
     return false;
   }
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kMotorcycleAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kMotorcycleAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -471,8 +470,7 @@ bool MotorcycleCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kMotorcycleAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kMotorcycleAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -444,8 +444,7 @@ bool MotorScooterCost::Allowed(const baldr::DirectedEdge* edge,
     return false;
   }
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kMopedAccess);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kMopedAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -484,8 +483,7 @@ bool MotorScooterCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kMopedAccess);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kMopedAccess);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -505,8 +505,7 @@ bool PedestrianCost::Allowed(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), access_mask_);
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), access_mask_);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
@@ -549,8 +548,7 @@ bool PedestrianCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), access_mask_);
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), access_mask_);
     for (const auto& restriction : restrictions) {
       if (restriction.type() == AccessType::kTimedAllowed) {
         // allowed at this range or allowed all the time
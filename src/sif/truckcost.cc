@@ -374,8 +374,16 @@ bool TruckCost::Allowed(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(edgeid.id(), kTruckAccess);
+    // The summary of the edge's truck restrictions decides unless some of them are timed
+    const TruckRestriction* summary = tile->GetTruckRestriction(edgeid.id());
+    if (summary == nullptr) {
+      return true;
+    }
+    if (summary->complete()) {
+      return summary->Allowed(height_, width_, length_, weight_, axle_load_, hazmat_);
+    }
+
+    auto restrictions = tile->GetAccessRestrictions(edgeid.id(), kTruckAccess);
 
     for (const auto& restriction : restrictions) {
       switch (restriction.type()) {
@@ -449,8 +457,16 @@ bool TruckCost::AllowedReverse(const baldr::DirectedEdge* edge,
   }
 
   if (edge->access_restriction()) {
-    const std::vector<baldr::AccessRestriction>& restrictions =
-        tile->GetAccessRestrictions(opp_edgeid.id(), kTruckAccess);
+    // The summary of the edge's truck restrictions decides unless some of them are timed
+    const TruckRestriction* summary = tile->GetTruckRestriction(opp_edgeid.id());
+    if (summary == nullptr) {
+      return true;
+    }
+    if (summary->complete()) {
+      return summary->Allowed(height_, width_, length_, weight_, axle_load_, hazmat_);
+    }
+
+    auto restrictions = tile->GetAccessRestrictions(opp_edgeid.id(), kTruckAccess);
 
     for (const auto& restriction : restrictions) {
       if (restriction.modes() & kTruckAccess) {
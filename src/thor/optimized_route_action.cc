@@ -17,7 +17,8 @@ using namespace valhalla::thor;
 namespace valhalla {
 namespace thor {
 
-std::list<valhalla::odin::TripPath> thor_worker_t::optimized_route(valhalla_request_t& request) {
+void thor_worker_t::optimized_route(valhalla_request_t& request,
+                                    google::protobuf::RepeatedPtrField<odin::TripPath>& legs) {
   parse_locations(request);
   auto costing = parse_costing(request);
 
@@ -61,7 +62,7 @@ std::list<valhalla::odin::TripPath> thor_worker_t::optimized_route(valhalla_requ
     request.options.mutable_locations()->Add()->CopyFrom(correlated.Get(optimal_order[i]));
   }
 
-  return path_depart_at(*request.options.mutable_locations(), costing);
+  path_depart_at(*request.options.mutable_locations(), costing, legs);
 }
 
 } // namespace thor
@@ -33,21 +33,23 @@ constexpr float kMaxTimeDependentDistance = 500000.0f; // 500 km
 // A* can take excessive time for longer paths - so exclude them to protect the service.
 constexpr float kPedestrianMultipassThreshold = 50000.0f; // 50km
 
-std::list<valhalla::odin::TripPath> thor_worker_t::route(valhalla_request_t& request) {
+void thor_worker_t::route(valhalla_request_t& request,
+                          google::protobuf::RepeatedPtrField<odin::TripPath>& legs) {
   parse_locations(request);
   auto costing = parse_costing(request);
 
-  auto trippaths = (request.options.has_date_time_type() &&
-                    request.options.date_time_type() == odin::DirectionsOptions::arrive_by)
-                       ? path_arrive_by(*request.options.mutable_locations(), costing)
-                       : path_depart_at(*request.options.mutable_locations(), costing);
+  if (request.options.has_date_time_type() &&
+      request.options.date_time_type() == odin::DirectionsOptions::arrive_by) {
+    path_arrive_by(*request.options.mutable_locations(), costing, legs);
+  } else {
+    path_depart_at(*request.options.mutable_locations(), costing, legs);
+  }
 
   if (!request.options.do_not_track()) {
-    for (const auto& tp : trippaths) {
+    for (const auto& tp : legs) {
       log_admin(tp);
     }
   }
-  return trippaths;
 }
 
 thor::PathAlgorithm* thor_worker_t::get_path_algorithm(const std::string& routetype,
@@ -150,12 +152,12 @@ std::vector<thor::PathInfo> thor_worker_t::get_path(PathAlgorithm* path_algorith
   return path;
 }
 
-std::list<valhalla::odin::TripPath> thor_worker_t::path_arrive_by(
+void thor_worker_t::path_arrive_by(
     google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
-    const std::string& costing) {
+    const std::string& costing,
+    google::protobuf::RepeatedPtrField<odin::TripPath>& trip_paths) {
   // Things we'll need
   std::vector<thor::PathInfo> path;
-  std::list<valhalla::odin::TripPath> trip_paths;
   correlated.begin()->set_type(odin::Location::kBreak);
   correlated.rbegin()->set_type(odin::Location::kBreak);
 
@@ -203,26 +205,21 @@ std::list<valhalla::odin::TripPath> thor_worker_t::path_arrive_by(
       // Create controller for default route attributes
       AttributesController controller;
 
-      // Form output information based on path edges
-      auto trip_path = thor::TripPathBuilder::Build(controller, *reader, mode_costing, path, *origin,
-                                                    *destination, throughs, interrupt);
+      // Form output information based on path edges, keeping the protobuf path on the arena
+      // of the trip paths
+      thor::TripPathBuilder::Build(controller, *reader, mode_costing, path, *origin, *destination,
+                                   throughs, *trip_paths.Add(), interrupt);
       path.clear();
-
-      // Keep the protobuf path
-      trip_paths.emplace_back(std::move(trip_path));
     }
   }
-
-  // return the trip paths
-  return trip_paths;
 }
 
-std::list<valhalla::odin::TripPath> thor_worker_t::path_depart_at(
+void thor_worker_t::path_depart_at(
     google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
-    const std::string& costing) {
+    const std::string& costing,
+    google::protobuf::RepeatedPtrField<odin::TripPath>& trip_paths) {
   // Things we'll need
   std::vector<thor::PathInfo> path;
-  std::list<valhalla::odin::TripPath> trip_paths;
   correlated.begin()->set_type(odin::Location::kBreak);
   correlated.rbegin()->set_type(odin::Location::kBreak);
 
@@ -272,18 +269,13 @@ std::list<valhalla::odin::TripPath> thor_worker_t::path_depart_at(
       // Create controller for default route attributes
       AttributesController controller;
 
-      // Form output information based on path edges
-      auto trip_path = thor::TripPathBuilder::Build(controller, *reader, mode_costing, path, *origin,
-                                                    *destination, throughs, interrupt);
+      // Form output information based on path edges, keeping the protobuf path on the arena
+      // of the trip paths
+      thor::TripPathBuilder::Build(controller, *reader, mode_costing, path, *origin, *destination,
+                                   throughs, *trip_paths.Add(), interrupt);
       path.clear();
-
-      // Keep the protobuf path
-      trip_paths.emplace_back(std::move(trip_path));
     }
   }
-
-  // return the trip paths
-  return trip_paths;
 }
 
 } // namespace thor
@@ -25,6 +25,7 @@ TimeDepForward::TimeDepForward() : AStarPathAlgorithm() {
   max_label_count_ = std::numeric_limits<uint32_t>::max();
   origin_tz_index_ = 0;
   seconds_of_week_ = 0;
+  use_speed_memo_ = true;
 }
 
 // Destructor
@@ -119,10 +120,10 @@ void TimeDepForward::ExpandForward(GraphReader& graphreader,
     }
 
     // Compute the cost to the end of this edge
-    Cost newcost =
-        pred.cost() +
-        costing_->EdgeCost(directededge, tile->GetSpeed(directededge, edgeid, seconds_of_week)) +
-        costing_->TransitionCost(directededge, nodeinfo, pred);
+    auto* memo = use_speed_memo_ ? &speed_memo_ : nullptr;
+    uint32_t speed = tile->GetSpeed(directededge, edgeid, seconds_of_week, memo);
+    Cost newcost = pred.cost() + costing_->EdgeCost(directededge, speed) +
+                   costing_->TransitionCost(directededge, nodeinfo, pred);
 
     // If this edge is a destination, subtract the partial/remainder cost
     // (cost from the dest. location to the end of the edge).
@@ -210,6 +211,7 @@ std::vector<PathInfo> TimeDepForward::GetBestPath(odin::Location& origin,
   PointLL origin_new(origin.path_edges(0).ll().lng(), origin.path_edges(0).ll().lat());
   PointLL destination_new(destination.path_edges(0).ll().lng(), destination.path_edges(0).ll().lat());
   Init(origin_new, destination_new);
+  speed_memo_.clear();
   float mindist = astarheuristic_.GetDistance(origin_new);
 
   // Initialize the origin and destination locations. Initialize the
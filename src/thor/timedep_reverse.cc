@@ -23,6 +23,7 @@ TimeDepReverse::TimeDepReverse() : AStarPathAlgorithm() {
   max_label_count_ = std::numeric_limits<uint32_t>::max();
   dest_tz_index_ = 0;
   seconds_of_week_ = 0;
+  use_speed_memo_ = true;
   access_mode_ = kAutoAccess;
 }
 
@@ -163,8 +164,9 @@ void TimeDepReverse::ExpandReverse(GraphReader& graphreader,
 
     Cost tc = costing_->TransitionCostReverse(directededge->localedgeidx(), nodeinfo, opp_edge,
                                               opp_pred_edge);
-    Cost newcost = pred.cost() +
-                   costing_->EdgeCost(opp_edge, t2->GetSpeed(directededge, edgeid, seconds_of_week));
+    auto* memo = use_speed_memo_ ? &speed_memo_ : nullptr;
+    uint32_t speed = t2->GetSpeed(directededge, edgeid, seconds_of_week, memo);
+    Cost newcost = pred.cost() + costing_->EdgeCost(opp_edge, speed);
     newcost.cost += tc.cost;
 
     // If this edge is a destination, subtract the partial/remainder cost
@@ -255,6 +257,7 @@ std::vector<PathInfo> TimeDepReverse::GetBestPath(odin::Location& origin,
   PointLL origin_new(origin.path_edges(0).ll().lng(), origin.path_edges(0).ll().lat());
   PointLL destination_new(destination.path_edges(0).ll().lng(), destination.path_edges(0).ll().lat());
   Init(origin_new, destination_new);
+  speed_memo_.clear();
   float mindist = astarheuristic_.GetDistance(origin_new);
 
   // Initialize the locations. For a reverse path search the destination location
@@ -95,7 +95,7 @@ std::string thor_worker_t::trace_attributes(valhalla_request_t& request) {
     // then we can traverse the exact shape to form a path by using edge-walking algorithm
     case odin::ShapeMatch::edge_walk:
       try {
-        trip_path = route_match(request, controller);
+        route_match(request, controller, trip_path);
         if (trip_path.node().size() == 0) {
           throw std::exception{};
         };
@@ -123,7 +123,7 @@ std::string thor_worker_t::trace_attributes(valhalla_request_t& request) {
     // network. No shortcuts are used and detailed information at every intersection becomes
     // available.
     case odin::ShapeMatch::walk_or_snap:
-      trip_path = route_match(request, controller);
+      route_match(request, controller, trip_path);
       if (trip_path.node().size() == 0) {
         LOG_WARN(odin::ShapeMatch_Name(request.options.shape_match()) +
                  " algorithm failed to find exact route match; Falling back to map_match...");
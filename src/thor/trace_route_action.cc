@@ -46,7 +46,7 @@ namespace thor {
 /*
  * The trace_route action takes a GPS trace and turns it into a route result.
  */
-odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
+void thor_worker_t::trace_route(valhalla_request_t& request, odin::TripPath& trip_path) {
 
   // Parse request
   parse_locations(request);
@@ -54,7 +54,7 @@ odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
   parse_measurements(request);
 
   // Initialize the controller
-  odin::TripPath trip_path;
+  trip_path.Clear();
   AttributesController controller;
 
   switch (request.options.shape_match()) {
@@ -62,7 +62,7 @@ odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
     // then we can traverse the exact shape to form a path by using edge-walking algorithm
     case odin::ShapeMatch::edge_walk:
       try {
-        trip_path = route_match(request, controller);
+        route_match(request, controller, trip_path);
         if (trip_path.node().size() == 0) {
           throw std::exception{};
         }
@@ -88,7 +88,7 @@ odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
     // network. No shortcuts are used and detailed information at every intersection becomes
     // available.
     case odin::ShapeMatch::walk_or_snap:
-      trip_path = route_match(request, controller);
+      route_match(request, controller, trip_path);
       if (trip_path.node().size() == 0) {
         LOG_WARN(odin::ShapeMatch_Name(request.options.shape_match()) +
                  " algorithm failed to find exact route match; Falling back to map_match...");
@@ -105,8 +105,6 @@ odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
   if (!request.options.do_not_track()) {
     log_admin(trip_path);
   }
-
-  return trip_path;
 }
 
 /*
@@ -116,20 +114,19 @@ odin::TripPath thor_worker_t::trace_route(valhalla_request_t& request) {
  * form the list of edges. It will return no nodes if path not found.
  *
  */
-odin::TripPath thor_worker_t::route_match(valhalla_request_t& request,
-                                          const AttributesController& controller) {
-  odin::TripPath trip_path;
+void thor_worker_t::route_match(valhalla_request_t& request,
+                                const AttributesController& controller,
+                                odin::TripPath& trip_path) {
+  trip_path.Clear();
   std::vector<PathInfo> path_infos;
   if (RouteMatcher::FormPath(mode_costing, mode, *reader, trace, request.options.locations(),
                              path_infos)) {
     // Form the trip path based on mode costing, origin, destination, and path edges
-    trip_path = thor::TripPathBuilder::Build(controller, *reader, mode_costing, path_infos,
-                                             *request.options.mutable_locations()->begin(),
-                                             *request.options.mutable_locations()->rbegin(),
-                                             std::list<odin::Location>{}, interrupt);
+    thor::TripPathBuilder::Build(controller, *reader, mode_costing, path_infos,
+                                 *request.options.mutable_locations()->begin(),
+                                 *request.options.mutable_locations()->rbegin(),
+                                 std::list<odin::Location>{}, trip_path, interrupt);
   }
-
-  return trip_path;
 }
 
 // Form the path from the map-matching results. This path gets sent to TripPathBuilder.
@@ -446,10 +443,9 @@ thor_worker_t::map_match(valhalla_request_t& request,
       // destination.edges contains path_edges.back()
 
       // Form the trip path based on mode costing, origin, destination, and path edges
-      trip_path =
-          thor::TripPathBuilder::Build(controller, matcher->graphreader(), mode_costing, path_edges,
-                                       origin, destination, std::list<odin::Location>{}, interrupt,
-                                       &route_discontinuities);
+      thor::TripPathBuilder::Build(controller, matcher->graphreader(), mode_costing, path_edges,
+                                   origin, destination, std::list<odin::Location>{}, trip_path,
+                                   interrupt, &route_discontinuities);
     } else {
       throw valhalla_exception_t{442};
     }
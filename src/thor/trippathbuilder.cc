@@ -530,24 +530,26 @@ TripPathBuilder::~TripPathBuilder() {
 // For now just find the length of the path!
 // TODO - probably need the location information passed in - to
 // add to the TripPath
-TripPath
-TripPathBuilder::Build(const AttributesController& controller,
-                       GraphReader& graphreader,
-                       const std::shared_ptr<sif::DynamicCost>* mode_costing,
-                       const std::vector<PathInfo>& path,
-                       odin::Location& origin,
-                       odin::Location& dest,
-                       const std::list<odin::Location>& through_loc,
-                       const std::function<void()>* interrupt_callback,
-                       std::unordered_map<size_t, std::pair<RouteDiscontinuity, RouteDiscontinuity>>*
-                           route_discontinuities) {
+void TripPathBuilder::Build(const AttributesController& controller,
+                            GraphReader& graphreader,
+                            const std::shared_ptr<sif::DynamicCost>* mode_costing,
+                            const std::vector<PathInfo>& path,
+                            odin::Location& origin,
+                            odin::Location& dest,
+                            const std::list<odin::Location>& through_loc,
+                            TripPath& trip_path,
+                            const std::function<void()>* interrupt_callback,
+                            std::unordered_map<size_t,
+                                               std::pair<RouteDiscontinuity, RouteDiscontinuity>>*
+                                route_discontinuities) {
   // Test interrupt prior to building trip path
   if (interrupt_callback) {
     (*interrupt_callback)();
   }
 
-  // TripPath is a protocol buffer that contains information about the trip
-  TripPath trip_path;
+  // TripPath is a protocol buffer that contains information about the trip, it is filled in
+  // place so that it can live on the caller's arena
+  trip_path.Clear();
 
   // Set origin, any through locations, and destination. Origin and
   // destination are assumed to be breaks.
@@ -750,7 +752,7 @@ TripPathBuilder::Build(const AttributesController& controller,
 
     // Assign the trip path admins
     AssignAdmins(controller, trip_path, admin_info_list);
-    return trip_path;
+    return;
   }
 
   // Iterate through path
@@ -1246,8 +1248,6 @@ TripPathBuilder::Build(const AttributesController& controller,
     trip_path.set_osm_changeset(osmchangeset);
   }
 
-  // hand it back
-  return trip_path;
 }
 
 // Add a trip edge to the trip node and set its attributes
@@ -1,3 +1,5 @@
+#include <algorithm>
+#include <chrono>
 #include <cstdint>
 #include <functional>
 #include <sstream>
@@ -7,6 +9,7 @@
 #include <vector>
 
 #include "baldr/json.h"
+#include "baldr/rapidjson_utils.h"
 #include "midgard/constants.h"
 #include "midgard/logging.h"
 #include <boost/property_tree/ptree.hpp>
@@ -62,7 +65,7 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
   auto conf_algorithm = config.get<std::string>("thor.source_to_target_algorithm", "select_optimal");
   for (const auto& kv : config.get_child("service_limits")) {
     if (kv.first == "max_avoid_locations" || kv.first == "max_reachability" ||
-        kv.first == "max_radius") {
+        kv.first == "max_radius" || kv.first == "max_bulk_locations") {
       continue;
     }
     if (kv.first != "skadi" && kv.first != "trace" && kv.first != "isochrone") {
@@ -83,6 +86,64 @@ thor_worker_t::thor_worker_t(const boost::property_tree::ptree& config,
 thor_worker_t::~thor_worker_t() {
 }
 
+boost::optional<std::string>
+thor_worker_t::act(valhalla_request_t& request,
+                   google::protobuf::RepeatedPtrField<odin::TripPath>& legs) {
+  switch (request.options.action()) {
+    case odin::DirectionsOptions::sources_to_targets:
+      return matrix(request);
+    case odin::DirectionsOptions::optimized_route:
+      optimized_route(request, legs);
+      return boost::none;
+    case odin::DirectionsOptions::isochrone:
+      return isochrones(request);
+    case odin::DirectionsOptions::route:
+      route(request, legs);
+      return boost::none;
+    case odin::DirectionsOptions::trace_route:
+      trace_route(request, *legs.Add());
+      return boost::none;
+    case odin::DirectionsOptions::trace_attributes:
+      return trace_attributes(request);
+    default:
+      throw valhalla_exception_t{400}; // this should never happen
+  }
+}
+
+void thor_worker_t::log_request(const valhalla_request_t& request,
+                                const std::chrono::system_clock::time_point& start) const {
+  double elapsed_time =
+      std::chrono::duration<float, std::milli>(std::chrono::system_clock::now() - start).count();
+  double denominator = 0;
+  switch (request.options.action()) {
+    case odin::DirectionsOptions::sources_to_targets:
+      denominator = request.options.sources_size() + request.options.targets_size();
+      break;
+    case odin::DirectionsOptions::optimized_route:
+      denominator = std::max(request.options.sources_size(), request.options.targets_size());
+      break;
+    case odin::DirectionsOptions::isochrone:
+      denominator = request.options.sources_size() * request.options.targets_size();
+      break;
+    case odin::DirectionsOptions::route:
+      denominator = request.options.locations_size();
+      break;
+    default:
+      // traces are measured in units of 1100 points, shorter ones count as a single unit
+      denominator = trace.size() / 1100.0;
+      break;
+  }
+  // dont let a request without any work units look infinitely long
+  denominator = std::max(denominator, 1.0);
+  if (!request.options.do_not_track() && elapsed_time / denominator > long_request) {
+    const auto& action = odin::DirectionsOptions_Action_Name(request.options.action());
+    LOG_WARN("thor::" + action + " request elapsed time (ms)::" + std::to_string(elapsed_time));
+    LOG_WARN("thor::" + action +
+             " request exceeded threshold::" + rapidjson::to_string(request.document));
+    midgard::logging::Log("valhalla_thor_long_request_" + action, " [ANALYTICS] ");
+  }
+}
+
 #ifdef HAVE_HTTP
 worker_t::result_t thor_worker_t::work(const std::list<zmq::message_t>& job,
                                        void* request_info,
@@ -101,69 +162,23 @@ worker_t::result_t thor_worker_t::work(const std::list<zmq::message_t>& job,
     // Set the interrupt function
     service_worker_t::set_interrupt(interrupt_function);
 
-    worker_t::result_t result{true};
-    double denominator = 0;
     // do request specific processing
-    switch (request.options.action()) {
-      case odin::DirectionsOptions::sources_to_targets:
-        result = to_response_json(matrix(request), info, request);
-        denominator = request.options.sources_size() + request.options.targets_size();
-        break;
-      case odin::DirectionsOptions::optimized_route: {
-        // Forward the original request
-        result.messages.emplace_back(std::move(request_str));
-        auto trip_paths = optimized_route(request);
-        result.messages.emplace_back(request.options.SerializeAsString());
-        for (auto& trippath : trip_paths) {
-          result.messages.emplace_back(trippath.SerializeAsString());
-        }
-        denominator = std::max(request.options.sources_size(), request.options.targets_size());
-        break;
-      }
-      case odin::DirectionsOptions::isochrone:
-        result = to_response_json(isochrones(request), info, request);
-        denominator = request.options.sources_size() * request.options.targets_size();
-        break;
-      case odin::DirectionsOptions::route: {
-        // Forward the original request
-        result.messages.emplace_back(std::move(request_str));
-        auto trip_paths = route(request);
-        result.messages.emplace_back(request.options.SerializeAsString());
-        for (const auto& trippath : trip_paths) {
-          result.messages.emplace_back(trippath.SerializeAsString());
-        }
-        denominator = request.options.locations_size();
-        break;
-      }
-      case odin::DirectionsOptions::trace_route: {
-        // Forward the original request
-        result.messages.emplace_back(std::move(request_str));
-        auto trip_path = trace_route(request);
-        result.messages.emplace_back(request.options.SerializeAsString());
-        result.messages.emplace_back(trip_path.SerializeAsString());
-        denominator = trace.size() / 1100;
-        break;
+    auto* trip_paths = google::protobuf::Arena::CreateMessage<
+        google::protobuf::RepeatedPtrField<odin::TripPath>>(&arena);
+    auto json = act(request, *trip_paths);
+    worker_t::result_t result{true};
+    if (json) {
+      result = to_response_json(*json, info, request);
+    } else {
+      // Forward the original request and the paths on to odin
+      result.messages.emplace_back(std::move(request_str));
+      result.messages.emplace_back(request.options.SerializeAsString());
+      for (const auto& trippath : *trip_paths) {
+        result.messages.emplace_back(trippath.SerializeAsString());
       }
-      case odin::DirectionsOptions::trace_attributes:
-        result = to_response_json(trace_attributes(request), info, request);
-        denominator = trace.size() / 1100;
-        break;
-      default:
-        throw valhalla_exception_t{400}; // this should never happen
-    }
-
-    double elapsed_time =
-        std::chrono::duration<float, std::milli>(std::chrono::system_clock::now() - s).count();
-    if (!request.options.do_not_track() && elapsed_time / denominator > long_request) {
-      LOG_WARN("thor::" + odin::DirectionsOptions_Action_Name(request.options.action()) +
-               " request elapsed time (ms)::" + std::to_string(elapsed_time));
-      LOG_WARN("thor::" + odin::DirectionsOptions_Action_Name(request.options.action()) +
-               " request exceeded threshold::" + request_str);
-      midgard::logging::Log("valhalla_thor_long_request_" +
-                                odin::DirectionsOptions_Action_Name(request.options.action()),
-                            " [ANALYTICS] ");
     }
 
+    log_request(request, s);
     return result;
   } catch (const valhalla_exception_t& e) {
     valhalla::midgard::logging::Log("400::" + std::string(e.what()), " [ANALYTICS] ");
@@ -319,6 +334,7 @@ void thor_worker_t::cleanup() {
   trace.clear();
   isochrone_gen.Clear();
   matcher_factory.ClearFullCache();
+  arena.Reset();
   if (reader->OverCommitted()) {
     reader->Clear();
   }
@@ -1,6 +1,9 @@
 #include "tyr/actor.h"
+#include <chrono>
+
 #include "baldr/rapidjson_utils.h"
 #include "loki/worker.h"
+#include "midgard/logging.h"
 #include "odin/worker.h"
 #include "thor/worker.h"
 #include "tyr/serializers.h"
@@ -10,6 +13,24 @@ using namespace valhalla::loki;
 using namespace valhalla::thor;
 using namespace valhalla::odin;
 
+namespace {
+
+// makes a list of legs on the arena so that the legs and all of their messages are on it too
+template <typename T>
+google::protobuf::RepeatedPtrField<T>* arena_legs(google::protobuf::Arena& arena) {
+  return google::protobuf::Arena::CreateMessage<google::protobuf::RepeatedPtrField<T>>(&arena);
+}
+
+// frees everything on the arena when the request is done with it, whether it succeeded or threw
+struct arena_reset_t {
+  ~arena_reset_t() {
+    arena.Reset();
+  }
+  google::protobuf::Arena& arena;
+};
+
+} // namespace
+
 namespace valhalla {
 namespace tyr {
 
@@ -27,11 +48,14 @@ struct actor_t::pimpl_t {
     loki_worker.cleanup();
     thor_worker.cleanup();
     odin_worker.cleanup();
+    arena.Reset();
   }
   std::shared_ptr<baldr::GraphReader> reader;
   loki::loki_worker_t loki_worker;
   thor::thor_worker_t thor_worker;
   odin::odin_worker_t odin_worker;
+  // holds the legs and directions of a route until it is serialized
+  google::protobuf::Arena arena;
 };
 
 actor_t::actor_t(const boost::property_tree::ptree& config, bool auto_cleanup)
@@ -50,11 +74,14 @@ std::string actor_t::route(const std::string& request_str, const std::function<v
   request.parse(request_str, odin::DirectionsOptions::route);
   // check the request and locate the locations in the graph
   pimpl->loki_worker.route(request);
-  auto legs = pimpl->thor_worker.route(request);
+  arena_reset_t arena_reset{pimpl->arena};
+  auto* legs = arena_legs<TripPath>(pimpl->arena);
+  pimpl->thor_worker.route(request, *legs);
   // get some directions back from them
-  auto directions = pimpl->odin_worker.narrate(request, legs);
-  // serialize them out to json string
-  auto bytes = tyr::serializeDirections(request, legs, directions);
+  auto* directions = arena_legs<TripDirections>(pimpl->arena);
+  pimpl->odin_worker.narrate(request, *legs, *directions);
+  // serialize them out to json string, they are all freed at once when we return
+  auto bytes = tyr::serializeDirections(request, *legs, *directions);
   // if they want you do to do the cleanup automatically
   if (auto_cleanup) {
     cleanup();
@@ -77,6 +104,22 @@ std::string actor_t::locate(const std::string& request_str, const std::function<
   return json;
 }
 
+std::string actor_t::bulk_locate(const std::string& request_str,
+                                 const std::function<void()>& interrupt) {
+  // set the interrupts
+  pimpl->set_interrupts(interrupt);
+  // parse the request
+  valhalla_request_t request;
+  request.parse(request_str, odin::DirectionsOptions::bulk_locate);
+  // check the request and locate all of the locations in the graph
+  auto json = pimpl->loki_worker.bulk_locate(request);
+  // if they want you do to do the cleanup automatically
+  if (auto_cleanup) {
+    cleanup();
+  }
+  return json;
+}
+
 std::string actor_t::matrix(const std::string& request_str, const std::function<void()>& interrupt) {
   // set the interrupts
   pimpl->set_interrupts(interrupt);
@@ -104,11 +147,14 @@ std::string actor_t::optimized_route(const std::string& request_str,
   // check the request and locate the locations in the graph
   pimpl->loki_worker.matrix(request);
   // compute compute all pairs and then the shortest path through them all
-  auto legs = pimpl->thor_worker.optimized_route(request);
+  arena_reset_t arena_reset{pimpl->arena};
+  auto* legs = arena_legs<TripPath>(pimpl->arena);
+  pimpl->thor_worker.optimized_route(request, *legs);
   // get some directions back from them
-  auto directions = pimpl->odin_worker.narrate(request, legs);
-  // serialize them out to json string
-  auto bytes = tyr::serializeDirections(request, legs, directions);
+  auto* directions = arena_legs<TripDirections>(pimpl->arena);
+  pimpl->odin_worker.narrate(request, *legs, *directions);
+  // serialize them out to json string, they are all freed at once when we return
+  auto bytes = tyr::serializeDirections(request, *legs, *directions);
   // if they want you do to do the cleanup automatically
   if (auto_cleanup) {
     cleanup();
@@ -144,11 +190,14 @@ std::string actor_t::trace_route(const std::string& request_str,
   // check the request and locate the locations in the graph
   pimpl->loki_worker.trace(request);
   // route between the locations in the graph to find the best path
-  std::list<TripPath> legs{pimpl->thor_worker.trace_route(request)};
+  arena_reset_t arena_reset{pimpl->arena};
+  auto* legs = arena_legs<TripPath>(pimpl->arena);
+  pimpl->thor_worker.trace_route(request, *legs->Add());
   // get some directions back from them
-  auto directions = pimpl->odin_worker.narrate(request, legs);
-  // serialize them out to json string
-  auto bytes = tyr::serializeDirections(request, legs, directions);
+  auto* directions = arena_legs<TripDirections>(pimpl->arena);
+  pimpl->odin_worker.narrate(request, *legs, *directions);
+  // serialize them out to json string, they are all freed at once when we return
+  auto bytes = tyr::serializeDirections(request, *legs, *directions);
   // if they want you do to do the cleanup automatically
   if (auto_cleanup) {
     cleanup();
@@ -205,5 +254,123 @@ std::string actor_t::transit_available(const std::string& request_str,
   return json;
 }
 
+#ifdef HAVE_HTTP
+namespace {
+
+// Does the work of all three stages of the pipeline for each request
+class fused_worker_t : public service_worker_t {
+public:
+  fused_worker_t(const boost::property_tree::ptree& config)
+      : reader(new baldr::GraphReader(config.get_child("mjolnir"))), loki_worker(config, reader),
+        thor_worker(config, reader), odin_worker(config) {
+    for (const auto& kv : config.get_child("loki.actions")) {
+      action_str.append("'/" + kv.second.get_value<std::string>() + "' ");
+    }
+  }
+
+  virtual worker_t::result_t work(const std::list<zmq::message_t>& job,
+                                  void* request_info,
+                                  const std::function<void()>& interrupt_function) override {
+    // get time for start of request
+    auto start = std::chrono::system_clock::now();
+    auto& info = *static_cast<http_request_info_t*>(request_info);
+    LOG_INFO("Got Request " + std::to_string(info.id));
+    valhalla_request_t request;
+    // the error code of the stage that is working when something unexpected goes wrong
+    unsigned unknown_error = 199;
+    try {
+      // request parsing, the only time the request is parsed
+      auto http_request = http_request_t::from_string(static_cast<const char*>(job.front().data()),
+                                                      job.front().size());
+      request.parse(http_request);
+
+      // check there is a valid action
+      if (!request.options.has_action()) {
+        return jsonify_error({106, action_str}, info, request);
+      }
+
+      // enforce some limits
+      loki_worker.limits(request);
+
+      // Set the interrupt function
+      service_worker_t::set_interrupt(interrupt_function);
+      loki_worker.set_interrupt(interrupt_function);
+      thor_worker.set_interrupt(interrupt_function);
+      odin_worker.set_interrupt(interrupt_function);
+
+      // do request specific processing, handing the request from stage to stage until one of them
+      // has the answer
+      auto json = loki_worker.act(request);
+      start = loki_worker.log_request(request, start);
+      if (json) {
+        return to_response_json(*json, info, request);
+      }
+      unknown_error = 499;
+      auto* legs = arena_legs<TripPath>(arena);
+      json = thor_worker.act(request, *legs);
+      thor_worker.log_request(request, start);
+      if (json) {
+        return to_response_json(*json, info, request);
+      }
+
+      // narrate the legs and serialize them
+      unknown_error = 299;
+      auto* narrated = arena_legs<TripDirections>(arena);
+      odin_worker.narrate(request, *legs, *narrated);
+      auto response = tyr::serializeDirections(request, *legs, *narrated);
+      auto* to_response = request.options.format() == odin::DirectionsOptions::gpx
+                              ? to_response_xml
+                              : to_response_json;
+      return to_response(response, info, request);
+    } catch (const valhalla_exception_t& e) {
+      valhalla::midgard::logging::Log("400::" + std::string(e.what()), " [ANALYTICS] ");
+      return jsonify_error(e, info, request);
+    } catch (const std::exception& e) {
+      valhalla::midgard::logging::Log("400::" + std::string(e.what()), " [ANALYTICS] ");
+      return jsonify_error({unknown_error, std::string(e.what())}, info, request);
+    }
+  }
+
+  virtual void cleanup() override {
+    loki_worker.cleanup();
+    thor_worker.cleanup();
+    odin_worker.cleanup();
+    arena.Reset();
+  }
+
+protected:
+  std::shared_ptr<baldr::GraphReader> reader;
+  loki::loki_worker_t loki_worker;
+  thor::thor_worker_t thor_worker;
+  odin::odin_worker_t odin_worker;
+  std::string action_str;
+  // holds the legs and directions of the request being worked on, reset after each request
+  google::protobuf::Arena arena;
+};
+
+} // namespace
+
+void run_service(const boost::property_tree::ptree& config) {
+  // gets requests from the http server
+  auto upstream_endpoint = config.get<std::string>("loki.service.proxy") + "_out";
+  // returns all results back to the server
+  auto loopback_endpoint = config.get<std::string>("httpd.service.loopback");
+  auto interrupt_endpoint = config.get<std::string>("httpd.service.interrupt");
+
+  // listen for requests
+  zmq::context_t context;
+  fused_worker_t fused_worker(config);
+  prime_server::worker_t worker(context, upstream_endpoint, "ipc:///dev/null", loopback_endpoint,
+                                interrupt_endpoint,
+                                std::bind(&fused_worker_t::work, std::ref(fused_worker),
+                                          std::placeholders::_1, std::placeholders::_2,
+                                          std::placeholders::_3),
+                                std::bind(&fused_worker_t::cleanup, std::ref(fused_worker)));
+  worker.work();
+
+  // TODO: should we listen for SIGINT and terminate gracefully/exit(0)?
+}
+#endif
+
 } // namespace tyr
 } // namespace valhalla
@@ -136,5 +136,17 @@ std::string serializeLocate(const valhalla_request_t& request,
   return ss.str();
 }
 
+void serializeLocation(const valhalla_request_t& request,
+                       const Location& location,
+                       const PathLocation* projection,
+                       GraphReader& reader,
+                       std::ostream& stream) {
+  if (projection) {
+    stream << *serialize(*projection, reader, request.options.verbose());
+  } else {
+    stream << *serialize(location.latlng_, "No data found for location", request.options.verbose());
+  }
+}
+
 } // namespace tyr
 } // namespace valhalla
@@ -27,7 +27,7 @@ namespace {
  * @param  legs  The legs of the route
  * @return the gpx string
  */
-std::string pathToGPX(const std::list<odin::TripPath>& legs) {
+std::string pathToGPX(const google::protobuf::RepeatedPtrField<odin::TripPath>& legs) {
   // start the gpx, we'll use 6 digits of precision
   std::stringstream gpx;
   gpx << std::setprecision(6) << std::fixed;
@@ -74,9 +74,10 @@ std::string pathToGPX(const std::list<odin::TripPath>& legs) {
 namespace valhalla {
 namespace tyr {
 
-std::string serializeDirections(const valhalla_request_t& request,
-                                const std::list<TripPath>& path_legs,
-                                const std::list<TripDirections>& directions_legs) {
+std::string serializeDirections(
+    const valhalla_request_t& request,
+    const google::protobuf::RepeatedPtrField<TripPath>& path_legs,
+    const google::protobuf::RepeatedPtrField<TripDirections>& directions_legs) {
   // serialize them
   switch (request.options.format()) {
     case DirectionsOptions_Format_osrm:
@@ -19,6 +19,7 @@ using namespace valhalla::baldr;
 using namespace valhalla::odin;
 using namespace valhalla::tyr;
 using namespace std;
+using google::protobuf::RepeatedPtrField;
 
 namespace {
 
@@ -141,7 +142,8 @@ static_cast<int>(valhalla::odin::TripDirections_Maneuver_Type_kDestinationLeft),
 **/
 
 // Add OSRM route summary information: distance, duration
-void route_summary(json::MapPtr& route, const std::list<valhalla::odin::TripDirections>& legs) {
+void route_summary(json::MapPtr& route,
+                   const RepeatedPtrField<valhalla::odin::TripDirections>& legs) {
   // Compute total distance and duration
   float duration = 0.0f;
   float distance = 0.0f;
@@ -163,13 +165,13 @@ void route_summary(json::MapPtr& route, const std::list<valhalla::odin::TripDire
 }
 
 // Generate full shape of the route. TODO - different encodings, generalization
-std::string full_shape(const std::list<valhalla::odin::TripDirections>& legs,
+std::string full_shape(const RepeatedPtrField<valhalla::odin::TripDirections>& legs,
                        const valhalla::odin::DirectionsOptions& directions_options) {
 
   // TODO - support 5 digit encoding, support generalization
 
   if (legs.size() == 1) {
-    return legs.front().shape();
+    return legs.Get(0).shape();
   }
 
   // TODO: there is a tricky way to do this... since the end of each leg is the same as the
@@ -243,7 +245,7 @@ struct IntersectionEdges {
 
 // Add intersections along a step/maneuver.
 json::ArrayPtr intersections(const valhalla::odin::TripDirections::Maneuver& maneuver,
-                             std::list<odin::TripPath>::const_iterator path_leg,
+                             RepeatedPtrField<odin::TripPath>::const_iterator path_leg,
                              const std::vector<PointLL>& shape,
                              uint32_t& count,
                              const bool arrive) {
@@ -451,7 +453,7 @@ std::string turn_modifier(const uint32_t in_brg, const uint32_t out_brg) {
 // in a motorway.
 std::string ramp_type(const odin::TripPath::Edge& prior_edge,
                       const uint32_t idx,
-                      std::list<odin::TripPath>::const_iterator path_leg) {
+                      RepeatedPtrField<odin::TripPath>::const_iterator path_leg) {
   if (prior_edge.use() == odin::TripPath_Use_kRoadUse) {
     if (prior_edge.road_class() == odin::TripPath_RoadClass_kMotorway) {
       return std::string("off ramp");
@@ -472,7 +474,7 @@ std::string ramp_type(const odin::TripPath::Edge& prior_edge,
 
 // Populate the OSRM maneuver record within a step.
 json::MapPtr osrm_maneuver(const valhalla::odin::TripDirections::Maneuver& maneuver,
-                           std::list<odin::TripPath>::const_iterator path_leg,
+                           RepeatedPtrField<odin::TripPath>::const_iterator path_leg,
                            const PointLL& man_ll,
                            const bool depart,
                            const bool arrive,
@@ -612,7 +614,7 @@ std::string maneuver_geometry(const uint32_t begin_idx,
 
 // Get the mode
 std::string get_mode(const valhalla::odin::TripDirections::Maneuver& maneuver,
-                     std::list<odin::TripPath>::const_iterator path_leg) {
+                     RepeatedPtrField<odin::TripPath>::const_iterator path_leg) {
   // Return ferry if the edge use is Ferry
   uint32_t idx = maneuver.begin_path_index();
   if (path_leg->node(idx).edge().use() == odin::TripPath::Use::TripPath_Use_kFerryUse) {
@@ -638,7 +640,7 @@ std::string get_mode(const valhalla::odin::TripDirections::Maneuver& maneuver,
 
 bool is_ref_name(const valhalla::odin::TripDirections::Maneuver& maneuver,
                  const std::string& name,
-                 std::list<odin::TripPath>::const_iterator path_leg) {
+                 RepeatedPtrField<odin::TripPath>::const_iterator path_leg) {
 
   for (uint32_t i = maneuver.begin_path_index(); i < maneuver.end_path_index(); i++) {
 
@@ -666,7 +668,7 @@ bool is_ref_name(const valhalla::odin::TripDirections::Maneuver& maneuver,
 // Get the names and ref names
 std::pair<std::string, std::string>
 names_and_refs(const valhalla::odin::TripDirections::Maneuver& maneuver,
-               std::list<odin::TripPath>::const_iterator path_leg) {
+               RepeatedPtrField<odin::TripPath>::const_iterator path_leg) {
   std::string names, refs;
 
   for (const auto& name : maneuver.street_name()) {
@@ -697,7 +699,7 @@ names_and_refs(const valhalla::odin::TripDirections::Maneuver& maneuver,
 }
 
 // Add annotations to the leg
-json::MapPtr annotations(std::list<odin::TripPath>::const_iterator path_leg) {
+json::MapPtr annotations(RepeatedPtrField<odin::TripPath>::const_iterator path_leg) {
   auto annotations = json::map({});
 
   // Create distance and duration arrays. Iterate through trip edges and
@@ -722,8 +724,8 @@ json::MapPtr annotations(std::list<odin::TripPath>::const_iterator path_leg) {
 }
 
 // Serialize each leg
-json::ArrayPtr serialize_legs(const std::list<valhalla::odin::TripDirections>& legs,
-                              const std::list<odin::TripPath>& path_legs) {
+json::ArrayPtr serialize_legs(const RepeatedPtrField<valhalla::odin::TripDirections>& legs,
+                              const RepeatedPtrField<odin::TripPath>& path_legs) {
   auto output_legs = json::array({});
 
   // TODO: verify that path_legs is same size as legs
@@ -864,8 +866,8 @@ json::ArrayPtr serialize_legs(const std::list<valhalla::odin::TripDirections>& l
 //     TripPath protocol buffer
 //     TripDirections protocol buffer
 std::string serialize(const valhalla::odin::DirectionsOptions& directions_options,
-                      const std::list<TripPath>& path_legs,
-                      const std::list<valhalla::odin::TripDirections>& legs) {
+                      const RepeatedPtrField<TripPath>& path_legs,
+                      const RepeatedPtrField<valhalla::odin::TripDirections>& legs) {
   auto json = json::map({});
 
   // If here then the route succeeded. Set status code to OK and serialize
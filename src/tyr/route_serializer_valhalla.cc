@@ -14,6 +14,7 @@ using namespace valhalla::midgard;
 using namespace valhalla::odin;
 using namespace valhalla::baldr;
 using namespace std;
+using google::protobuf::RepeatedPtrField;
 
 namespace {
 
@@ -93,7 +94,7 @@ valhalla output looks like this:
 */
 using namespace std;
 
-json::MapPtr summary(const std::list<valhalla::odin::TripDirections>& legs) {
+json::MapPtr summary(const RepeatedPtrField<valhalla::odin::TripDirections>& legs) {
 
   uint64_t time = 0;
   long double length = 0;
@@ -118,7 +119,7 @@ json::MapPtr summary(const std::list<valhalla::odin::TripDirections>& legs) {
   return route_summary;
 }
 
-json::ArrayPtr locations(const std::list<valhalla::odin::TripDirections>& legs) {
+json::ArrayPtr locations(const RepeatedPtrField<valhalla::odin::TripDirections>& legs) {
   auto locations = json::array({});
 
   int index = 0;
@@ -240,7 +241,7 @@ travel_mode_type(const valhalla::odin::TripDirections_Maneuver& maneuver) {
   }
 }
 
-json::ArrayPtr legs(const std::list<valhalla::odin::TripDirections>& directions_legs) {
+json::ArrayPtr legs(const RepeatedPtrField<valhalla::odin::TripDirections>& directions_legs) {
 
   // TODO: multiple legs.
   auto legs = json::array({});
@@ -549,7 +550,7 @@ json::ArrayPtr legs(const std::list<valhalla::odin::TripDirections>& directions_
 }
 
 std::string serialize(const valhalla::odin::DirectionsOptions& directions_options,
-                      const std::list<valhalla::odin::TripDirections>& directions_legs) {
+                      const RepeatedPtrField<valhalla::odin::TripDirections>& directions_legs) {
   // build up the json object
   auto json = json::map(
       {{"trip", json::map({{"locations", locations(directions_legs)},
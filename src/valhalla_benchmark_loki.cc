@@ -51,7 +51,7 @@ std::string geojson(const job_t& job) {
 }
 
 struct result_t {
-  std::chrono::milliseconds time;
+  std::chrono::microseconds time;
   bool pass;
   job_t job;
   bool cached;
@@ -160,11 +160,11 @@ void work(const boost::property_tree::ptree& config, std::promise<results_t>& pr
         // TODO: actually save the result
         auto result = valhalla::loki::Search(job, reader, valhalla::loki::PassThroughEdgeFilter);
         auto end = std::chrono::high_resolution_clock::now();
-        (*r) = result_t{std::chrono::duration_cast<std::chrono::milliseconds>(end - start), true, job,
+        (*r) = result_t{std::chrono::duration_cast<std::chrono::microseconds>(end - start), true, job,
                         cached};
       } catch (...) {
         auto end = std::chrono::high_resolution_clock::now();
-        (*r) = result_t{std::chrono::duration_cast<std::chrono::milliseconds>(end - start), false,
+        (*r) = result_t{std::chrono::duration_cast<std::chrono::microseconds>(end - start), false,
                         job, cached};
       }
       cached = true;
@@ -272,12 +272,14 @@ int main(int argc, char** argv) {
   for (const auto& stat_type : stat_types) {
     // grab the averages and the best and worst cases
     size_t count = 0;
+    size_t locations = 0;
     std::chrono::duration<double, std::milli> time(0);
     result_t first, last;
     for (const auto& result : results) {
       // are we interested in this result
       if (std::get<1>(stat_type) == result.pass && std::get<2>(stat_type) == result.cached) {
         time += result.time;
+        locations += result.job.size();
         if (count == 0) {
           first = result;
           last = result;
@@ -326,17 +328,19 @@ int main(int argc, char** argv) {
     if (count) {
       LOG_INFO("Total: " + std::to_string(count));
       auto fast =
-          std::chrono::duration_cast<std::chrono::duration<int, std::milli>>(first.time).count();
+          std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(first.time).count();
       auto fast_per = static_cast<double>(fast) / first.job.size();
       LOG_INFO("Fastest: " + std::to_string(fast) + "ms (" + std::to_string(fast_per) + "ms per)" +
                (extrema ? geojson(first.job) : ""));
       auto slow =
-          std::chrono::duration_cast<std::chrono::duration<int, std::milli>>(last.time).count();
+          std::chrono::duration_cast<std::chrono::duration<double, std::milli>>(last.time).count();
       auto slow_per = static_cast<double>(slow) / last.job.size();
       LOG_INFO("Slowest: " + std::to_string(slow) + "ms (" + std::to_string(slow_per) + "ms per)" +
                (extrema ? geojson(last.job) : ""));
       LOG_INFO("Median: " + std::to_string(median) + "ms");
       LOG_INFO("Standard Deviation: " + std::to_string(std_deviation) + "ms");
+      LOG_INFO("Throughput: " + std::to_string(locations / (time.count() * 1e-3 / threads)) +
+               " locations per second");
       LOG_INFO("Faster Than 1 Standard Deviation: " + std::to_string(faster));
       LOG_INFO("Slower Than 1 Standard Deviation: " + std::to_string(slower));
     } else {
@@ -0,0 +1,217 @@
+#include <boost/optional.hpp>
+#include <boost/program_options.hpp>
+#include <boost/property_tree/ptree.hpp>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "baldr/graphreader.h"
+#include "baldr/predictedspeeds.h"
+#include "baldr/rapidjson_utils.h"
+#include "loki/worker.h"
+#include "midgard/logging.h"
+#include "midgard/util.h"
+#include "sif/costfactory.h"
+#include "thor/timedep.h"
+#include "worker.h"
+
+#include "config.h"
+
+using namespace valhalla::midgard;
+using namespace valhalla::baldr;
+using namespace valhalla::loki;
+using namespace valhalla::sif;
+using namespace valhalla::thor;
+
+namespace bpo = boost::program_options;
+
+namespace {
+
+// The way every bucket used to be decoded, one term at a time
+float naive_speed(const int16_t* coefficients, const uint32_t bucket) {
+  const float* b = BucketCosTable::GetInstance().get(bucket);
+  float speed = 0.0f;
+  for (uint32_t k = 0; k < kCoefficientCount; ++k) {
+    speed += coefficients[k] * b[k];
+  }
+  return speed * kSpeedNormalization;
+}
+
+/**
+ * Decodes every bucket of a set of random speed profiles with the naive loop and with the
+ * vectorized kernel, reports the time each took and the largest difference between them.
+ */
+void BenchmarkDecoding(const uint32_t profile_count) {
+  std::mt19937 gen(2016);
+  std::uniform_int_distribution<int16_t> dis(-1500, 1500);
+  std::vector<int16_t> profiles(profile_count * kCoefficientCount);
+  for (auto& c : profiles) {
+    c = dis(gen);
+  }
+  BucketCosTable::GetInstance();
+
+  std::vector<float> naive(profile_count * kBucketsPerWeek);
+  auto t0 = std::chrono::high_resolution_clock::now();
+  for (uint32_t p = 0; p < profile_count; ++p) {
+    for (uint32_t bucket = 0; bucket < kBucketsPerWeek; ++bucket) {
+      naive[p * kBucketsPerWeek + bucket] = naive_speed(&profiles[p * kCoefficientCount], bucket);
+    }
+  }
+  auto t1 = std::chrono::high_resolution_clock::now();
+
+  std::vector<float> fast(profile_count * kBucketsPerWeek);
+  for (uint32_t p = 0; p < profile_count; ++p) {
+    for (uint32_t bucket = 0; bucket < kBucketsPerWeek; ++bucket) {
+      fast[p * kBucketsPerWeek + bucket] =
+          decompress_speed_bucket(&profiles[p * kCoefficientCount],
+                                  BucketCosTable::GetInstance().get(bucket)) *
+          kSpeedNormalization;
+    }
+  }
+  auto t2 = std::chrono::high_resolution_clock::now();
+
+  float max_diff = 0.0f;
+  for (size_t i = 0; i < naive.size(); ++i) {
+    max_diff = std::max(max_diff, std::fabs(naive[i] - fast[i]));
+  }
+  auto naive_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t1 - t0).count();
+  auto fast_ms = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
+  LOG_INFO("Decoded " + std::to_string(naive.size()) + " buckets of " +
+           std::to_string(profile_count) + " profiles: naive " +
+           std::to_string(naive_ms) + " ms, vectorized " + std::to_string(fast_ms) +
+           " ms, max difference " + std::to_string(max_diff) + " kph");
+}
+
+/**
+ * Runs the time dependent forward search of a set of depart_at routes with and without
+ * remembering the predicted speeds it decodes and reports the average time of each.
+ */
+void BenchmarkRoutes(const boost::property_tree::ptree& pt,
+                     const std::vector<std::string>& jsons,
+                     const uint32_t iterations) {
+  loki_worker_t lw(pt);
+  std::vector<valhalla::valhalla_request_t> requests(jsons.size());
+  for (size_t i = 0; i < jsons.size(); ++i) {
+    requests[i].parse(jsons[i], valhalla::odin::DirectionsOptions::route);
+    using valhalla::odin::DirectionsOptions_DateTimeType_depart_at;
+    if (requests[i].options.date_time_type() != DirectionsOptions_DateTimeType_depart_at) {
+      throw std::runtime_error("The route requests need a depart_at date_time");
+    }
+    lw.route(requests[i]);
+  }
+
+  GraphReader reader(pt.get_child("mjolnir"));
+  CostFactory<DynamicCost> factory;
+  factory.RegisterStandardCostingModels();
+  TimeDepForward timedep_forward;
+  for (bool use_memo : {false, true}) {
+    timedep_forward.set_speed_memo(use_memo);
+    size_t edges = 0;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (uint32_t i = 0; i < iterations; ++i) {
+      for (const auto& request : requests) {
+        auto cost = factory.Create(request.options.costing(), request.options);
+        auto mode = cost->travel_mode();
+        std::shared_ptr<DynamicCost> mode_costing[4];
+        mode_costing[static_cast<uint32_t>(mode)] = cost;
+        valhalla::odin::Location origin = request.options.locations(0);
+        valhalla::odin::Location dest = request.options.locations(1);
+        edges += timedep_forward.GetBestPath(origin, dest, reader, mode_costing, mode).size();
+        timedep_forward.Clear();
+      }
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+    LOG_INFO(std::string("TimeDepForward ") + (use_memo ? "with" : "without") +
+             " speed memo: " + std::to_string(requests.size()) + " routes, " +
+             std::to_string(edges / iterations) + " edges, " +
+             std::to_string(static_cast<float>(us) / 1000.0f / iterations) + " ms per route set");
+  }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+  std::string config, json, routes;
+  uint32_t iterations = 10;
+
+  bpo::options_description options(
+      "valhalla_benchmark_predicted_speeds " VALHALLA_VERSION "\n"
+      "\n"
+      " Usage: valhalla_benchmark_predicted_speeds [options]\n"
+      "\n"
+      "valhalla_benchmark_predicted_speeds compares decoding predicted speeds one term at a time "
+      "to the vectorized decoding used by the graph tiles. When given a config and a depart_at "
+      "route request, or a file of them, it also times the time dependent forward search "
+      "with and without remembering the speeds it decodes."
+      "\n"
+      "\n");
+
+  options.add_options()("help,h", "Print this help message.")("version,v",
+                                                              "Print the version of this software.")(
+      "config,c", bpo::value<std::string>(&config), "Valhalla configuration file")(
+      "json,j", bpo::value<std::string>(&json),
+      "Route request with a depart_at date_time, e.g. '{\"locations\":[{\"lat\":40.748174,"
+      "\"lon\":-73.984984},{\"lat\":40.749231,\"lon\":-73.968703}],\"costing\":\"auto\","
+      "\"date_time\":{\"type\":1,\"value\":\"2018-06-28T08:00\"}}'")(
+      "routes,r", bpo::value<std::string>(&routes),
+      "File with one route request with a depart_at date_time per line.")(
+      "iterations,n", bpo::value<uint32_t>(&iterations),
+      "Number of times to run the routes (default 10).");
+
+  bpo::variables_map vm;
+  try {
+    bpo::store(bpo::command_line_parser(argc, argv).options(options).run(), vm);
+    bpo::notify(vm);
+
+  } catch (std::exception& e) {
+    std::cerr << "Unable to parse command line options because: " << e.what() << "\n"
+              << "This is a bug, please report it at " PACKAGE_BUGREPORT << "\n";
+    return EXIT_FAILURE;
+  }
+
+  if (vm.count("help")) {
+    std::cout << options << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  if (vm.count("version")) {
+    std::cout << "valhalla_benchmark_predicted_speeds " << VALHALLA_VERSION << "\n";
+    return EXIT_SUCCESS;
+  }
+
+  BenchmarkDecoding(1000);
+
+  std::vector<std::string> jsons;
+  if (vm.count("json")) {
+    jsons.push_back(json);
+  }
+  if (vm.count("routes")) {
+    std::ifstream file(routes);
+    std::string line;
+    while (std::getline(file, line)) {
+      if (!line.empty()) {
+        jsons.push_back(line);
+      }
+    }
+  }
+
+  if (vm.count("config") && !jsons.empty()) {
+    boost::property_tree::ptree pt;
+    rapidjson::read_json(config, pt);
+    try {
+      BenchmarkRoutes(pt, jsons, std::max(iterations, 1u));
+    } catch (const std::exception& e) {
+      LOG_ERROR(std::string("Route benchmark failed: ") + e.what());
+      return EXIT_FAILURE;
+    }
+  }
+  LOG_INFO("Done Benchmark!");
+
+  return EXIT_SUCCESS;
+}
@@ -152,8 +152,9 @@ TripPath PathTest(GraphReader& reader,
   // Form trip path
   t1 = std::chrono::high_resolution_clock::now();
   AttributesController controller;
-  TripPath trip_path = TripPathBuilder::Build(controller, reader, mode_costing, pathedges, origin,
-                                              dest, std::list<valhalla::odin::Location>{});
+  TripPath trip_path;
+  TripPathBuilder::Build(controller, reader, mode_costing, pathedges, origin, dest,
+                         std::list<valhalla::odin::Location>{}, trip_path);
   t2 = std::chrono::high_resolution_clock::now();
   msecs = std::chrono::duration_cast<std::chrono::milliseconds>(t2 - t1).count();
   LOG_INFO("TripPathBuilder took " + std::to_string(msecs) + " ms");
@@ -322,7 +323,8 @@ TripDirections DirectionsTest(const DirectionsOptions& directions_options,
   const PathLocation& destination = PathLocation::fromPBF(dest);
 
   DirectionsBuilder directions;
-  TripDirections trip_directions = directions.Build(directions_options, trip_path);
+  TripDirections trip_directions;
+  directions.Build(directions_options, trip_path, trip_directions);
   std::string units = (directions_options.units() == DirectionsOptions::kilometers ? "km" : "mi");
   int m = 1;
   valhalla::midgard::logging::Log("From: " + std::to_string(origin), " [NARRATIVE] ");
@@ -21,6 +21,7 @@ using namespace prime_server;
 #include "loki/worker.h"
 #include "odin/worker.h"
 #include "thor/worker.h"
+#include "tyr/actor.h"
 
 int main(int argc, char** argv) {
 
@@ -80,30 +81,40 @@ int main(int argc, char** argv) {
   std::thread loki_proxy_thread(
       std::bind(&proxy_t::forward, proxy_t(context, loki_proxy + "_in", loki_proxy + "_out")));
   loki_proxy_thread.detach();
-  std::list<std::thread> loki_worker_threads;
-  for (size_t i = 0; i < worker_concurrency; ++i) {
-    loki_worker_threads.emplace_back(valhalla::loki::run_service, config);
-    loki_worker_threads.back().detach();
-  }
 
-  // thor layer
-  std::thread thor_proxy_thread(
-      std::bind(&proxy_t::forward, proxy_t(context, thor_proxy + "_in", thor_proxy + "_out")));
-  thor_proxy_thread.detach();
-  std::list<std::thread> thor_worker_threads;
-  for (size_t i = 0; i < worker_concurrency; ++i) {
-    thor_worker_threads.emplace_back(valhalla::thor::run_service, config);
-    thor_worker_threads.back().detach();
-  }
+  // fused workers do the work of every layer, taking requests from the loki layer's proxy
+  if (config.get<bool>("httpd.service.fused", false)) {
+    std::list<std::thread> fused_worker_threads;
+    for (size_t i = 0; i < worker_concurrency; ++i) {
+      fused_worker_threads.emplace_back(valhalla::tyr::run_service, config);
+      fused_worker_threads.back().detach();
+    }
+  } else {
+    std::list<std::thread> loki_worker_threads;
+    for (size_t i = 0; i < worker_concurrency; ++i) {
+      loki_worker_threads.emplace_back(valhalla::loki::run_service, config);
+      loki_worker_threads.back().detach();
+    }
 
-  // odin layer
-  std::thread odin_proxy_thread(
-      std::bind(&proxy_t::forward, proxy_t(context, odin_proxy + "_in", odin_proxy + "_out")));
-  odin_proxy_thread.detach();
-  std::list<std::thread> odin_worker_threads;
-  for (size_t i = 0; i < worker_concurrency; ++i) {
-    odin_worker_threads.emplace_back(valhalla::odin::run_service, config);
-    odin_worker_threads.back().detach();
+    // thor layer
+    std::thread thor_proxy_thread(
+        std::bind(&proxy_t::forward, proxy_t(context, thor_proxy + "_in", thor_proxy + "_out")));
+    thor_proxy_thread.detach();
+    std::list<std::thread> thor_worker_threads;
+    for (size_t i = 0; i < worker_concurrency; ++i) {
+      thor_worker_threads.emplace_back(valhalla::thor::run_service, config);
+      thor_worker_threads.back().detach();
+    }
+
+    // odin layer
+    std::thread odin_proxy_thread(
+        std::bind(&proxy_t::forward, proxy_t(context, odin_proxy + "_in", odin_proxy + "_out")));
+    odin_proxy_thread.detach();
+    std::list<std::thread> odin_worker_threads;
+    for (size_t i = 0; i < worker_concurrency; ++i) {
+      odin_worker_threads.emplace_back(valhalla::odin::run_service, config);
+      odin_worker_threads.back().detach();
+    }
   }
 
   // TODO: add multipoint accumulator
@@ -754,6 +754,7 @@ bool DirectionsOptions_Action_Parse(const std::string& action, odin::DirectionsO
       {"trace_attributes", odin::DirectionsOptions::trace_attributes},
       {"height", odin::DirectionsOptions::height},
       {"transit_available", odin::DirectionsOptions::transit_available},
+      {"bulk_locate", odin::DirectionsOptions::bulk_locate},
   };
   auto i = actions.find(action);
   if (i == actions.cend())
@@ -774,6 +775,7 @@ const std::string& DirectionsOptions_Action_Name(const odin::DirectionsOptions::
       {odin::DirectionsOptions::trace_attributes, "trace_attributes"},
       {odin::DirectionsOptions::height, "height"},
       {odin::DirectionsOptions::transit_available, "transit_available"},
+      {odin::DirectionsOptions::bulk_locate, "bulk_locate"},
   };
   auto i = actions.find(action);
   return i == actions.cend() ? empty : i->second;
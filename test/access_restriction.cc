@@ -12,6 +12,7 @@ using namespace valhalla::baldr;
 // Expected size is 16 bytes. We want to alert if somehow any change grows
 // this structure size as that indicates incompatible tiles.
 constexpr size_t kAccessRestrictionExpectedSize = 16;
+constexpr size_t kTruckRestrictionExpectedSize = 16;
 
 namespace {
 
@@ -20,6 +21,85 @@ void test_sizeof() {
     throw std::runtime_error("AccessRestriction size should be " +
                              std::to_string(kAccessRestrictionExpectedSize) + " bytes" + " but is " +
                              std::to_string(sizeof(AccessRestriction)));
+  if (sizeof(TruckRestriction) != kTruckRestrictionExpectedSize)
+    throw std::runtime_error("TruckRestriction size should be " +
+                             std::to_string(kTruckRestrictionExpectedSize) + " bytes" + " but is " +
+                             std::to_string(sizeof(TruckRestriction)));
+}
+
+void test_view() {
+  // restrictions sorted by edge index the way they are in a tile
+  std::vector<AccessRestriction> restrictions{
+      {1, AccessType::kMaxHeight, kTruckAccess, 4}, {2, AccessType::kMaxWeight, kTruckAccess, 10},
+      {2, AccessType::kTimedDenied, kAutoAccess, 5}, {2, AccessType::kMaxLength, kTruckAccess, 20},
+      {3, AccessType::kHazmat, kTruckAccess, 1}};
+  AccessRestrictionView view(&restrictions[1], &restrictions[4], kTruckAccess);
+  std::vector<AccessType> types;
+  for (const auto& restriction : view) {
+    types.push_back(restriction.type());
+  }
+  if (types != std::vector<AccessType>{AccessType::kMaxWeight, AccessType::kMaxLength})
+    throw std::runtime_error("The view should only have the restrictions for the access modes");
+
+  if (!AccessRestrictionView(&restrictions[1], &restrictions[4], kBicycleAccess).empty())
+    throw std::runtime_error("The view should be empty when no restriction has the access modes");
+  if (!AccessRestrictionView().empty())
+    throw std::runtime_error("A default view should be empty");
+}
+
+// the way TruckCost checks the restrictions of an edge without any timed ones
+bool truck_allowed(const std::vector<AccessRestriction>& restrictions,
+                   const float dimension,
+                   const bool hazmat) {
+  for (const auto& restriction : restrictions) {
+    if (!(restriction.modes() & kTruckAccess))
+      continue;
+    float limit = static_cast<float>(restriction.value() * 0.01);
+    bool denied = restriction.type() == AccessType::kHazmat ? hazmat != restriction.value()
+                                                            : dimension > limit;
+    if (denied)
+      return false;
+  }
+  return true;
+}
+
+void test_truck_restriction() {
+  std::vector<std::vector<AccessRestriction>> edges{
+      {},
+      {{0, AccessType::kMaxHeight, kTruckAccess, 420},
+       {0, AccessType::kMaxHeight, kTruckAccess, 380},
+       {0, AccessType::kMaxHeight, kAutoAccess, 200}},
+      {{0, AccessType::kMaxWeight, kTruckAccess | kBusAccess, 750}},
+      {{0, AccessType::kHazmat, kTruckAccess, 0}},
+      {{0, AccessType::kHazmat, kTruckAccess, 1}, {0, AccessType::kMaxWidth, kTruckAccess, 255}},
+      {{0, AccessType::kHazmat, kTruckAccess, 0}, {0, AccessType::kHazmat, kTruckAccess, 1}},
+  };
+  for (const auto& restrictions : edges) {
+    TruckRestriction summary(0);
+    for (const auto& restriction : restrictions) {
+      summary.Add(restriction);
+    }
+    if (!summary.complete())
+      throw std::runtime_error("Restrictions without timed ones should be summarized");
+    // a truck of the same size in every dimension so one reference check covers them all
+    for (float dimension = 0.f; dimension < 10.f; dimension += 0.05f) {
+      for (bool hazmat : {false, true}) {
+        if (summary.Allowed(dimension, dimension, dimension, dimension, dimension, hazmat) !=
+            truck_allowed(restrictions, dimension, hazmat))
+          throw std::runtime_error("Summary should allow the same trucks as the restrictions");
+      }
+    }
+  }
+
+  // timed restrictions and limits too large to store are left to the access restrictions
+  TruckRestriction timed(0);
+  timed.Add({0, AccessType::kTimedDenied, kTruckAccess, 12345});
+  TruckRestriction large(0);
+  large.Add({0, AccessType::kMaxLength, kTruckAccess, 100000});
+  TruckRestriction other_modes(0);
+  other_modes.Add({0, AccessType::kTimedDenied, kAutoAccess, 12345});
+  if (timed.complete() || large.complete() || !other_modes.complete())
+    throw std::runtime_error("Only truck restrictions that cannot be summarized are incomplete");
 }
 
 } // namespace
@@ -30,5 +110,11 @@ int main() {
   // Test sizeof the structure
   suite.test(TEST_CASE(test_sizeof));
 
+  // Test iterating the restrictions for an access mode
+  suite.test(TEST_CASE(test_view));
+
+  // Test summarizing the truck restrictions of an edge
+  suite.test(TEST_CASE(test_truck_restriction));
+
   return suite.tear_down();
 }
@@ -117,6 +117,40 @@ void test_interrupt() {
   // TODO: test the rest of them
 }
 
+void test_arena_reuse() {
+  // without auto cleanup the arena has to be freed by each request, even the ones that fail
+  auto conf = make_conf();
+  tyr::actor_t actor(conf);
+  struct test_exception_t {};
+  const std::string route_request =
+      R"({"locations":[{"lat":40.546115,"lon":-76.385076,"type":"break"},
+      {"lat":40.544232,"lon":-76.385752,"type":"break"}],"costing":"auto"})";
+  const std::string trace_request = R"({"shape":[{"lat":40.546115,"lon":-76.385076},
+      {"lat":40.544232,"lon":-76.385752}],"costing":"auto","shape_match":"map_snap"})";
+
+  auto route_json = actor.route(route_request);
+  auto trace_json = actor.trace_route(trace_request);
+  for (int i = 0; i < 3; ++i) {
+    try {
+      actor.route(route_request, []() -> void { throw test_exception_t{}; });
+      throw std::logic_error("this should have thrown already");
+    } catch (const test_exception_t& e) {}
+    try {
+      actor.trace_route(trace_request, []() -> void { throw test_exception_t{}; });
+      throw std::logic_error("this should have thrown already");
+    } catch (const test_exception_t& e) {}
+
+    // the next requests on the same arena should come out the same as the first ones
+    if (actor.route(route_request) != route_json)
+      throw std::logic_error("Route changed after reusing the arena");
+    if (actor.trace_route(trace_request) != trace_json)
+      throw std::logic_error("Trace route changed after reusing the arena");
+  }
+  actor.cleanup();
+  if (actor.route(route_request) != route_json)
+    throw std::logic_error("Route changed after cleaning up the actor");
+}
+
 } // namespace
 
 int main() {
@@ -126,5 +160,7 @@ int main() {
 
   suite.test(TEST_CASE(test_interrupt));
 
+  suite.test(TEST_CASE(test_arena_reuse));
+
   return suite.tear_down();
 }
@@ -377,18 +377,22 @@ void trivial_path_no_uturns(const std::string& config_file) {
       astar.GetBestPath(*directions_options.mutable_locations(0),
                         *directions_options.mutable_locations(1), graph_reader, mode_costing, mode);
 
+  // build the path and directions on an arena the way the workers do
+  google::protobuf::Arena arena;
   vt::AttributesController controller;
-  vo::TripPath trip_path =
-      vt::TripPathBuilder::Build(controller, graph_reader, mode_costing, path,
-                                 *directions_options.mutable_locations(0),
-                                 *directions_options.mutable_locations(1), std::list<vo::Location>{});
+  auto* trip_path = google::protobuf::Arena::CreateMessage<vo::TripPath>(&arena);
+  vt::TripPathBuilder::Build(controller, graph_reader, mode_costing, path,
+                             *directions_options.mutable_locations(0),
+                             *directions_options.mutable_locations(1), std::list<vo::Location>{},
+                             *trip_path);
   // really could of got the total of the elapsed_time.
   vo::DirectionsBuilder directions;
-  vo::TripDirections trip_directions = directions.Build(directions_options, trip_path);
+  auto* trip_directions = google::protobuf::Arena::CreateMessage<vo::TripDirections>(&arena);
+  directions.Build(directions_options, *trip_path, *trip_directions);
 
-  if (trip_directions.summary().time() != 0) {
+  if (trip_directions->summary().time() != 0) {
     std::ostringstream ostr;
-    ostr << "Expected 0, but got " << trip_directions.summary().time();
+    ostr << "Expected 0, but got " << trip_directions->summary().time();
     throw std::runtime_error(ostr.str());
   }
 
@@ -1,5 +1,7 @@
 #include "test.h"
 
+#include <sstream>
+
 #include "baldr/complexrestriction.h"
 #include "mjolnir/complexrestrictionbuilder.h"
 
@@ -124,6 +126,44 @@ void TestWriteRead() {
     throw runtime_error("ComplexRestriction end_mins failed");
   }
 }
+void TestView() {
+  // write restrictions of different sizes back to back the way they are in a tile
+  std::stringstream ss;
+  auto add = [&ss](const GraphId& from, const GraphId& to, const uint64_t modes,
+                   const std::vector<GraphId>& vias) {
+    ComplexRestrictionBuilder res;
+    res.set_from_id(from);
+    res.set_to_id(to);
+    res.set_modes(modes);
+    res.set_via_list(vias);
+    res.set_via_count(vias.size());
+    ss << res;
+  };
+  add(GraphId(1, 2, 1), GraphId(1, 2, 5), kAutoAccess, {GraphId(1, 2, 3), GraphId(1, 2, 4)});
+  add(GraphId(1, 2, 2), GraphId(1, 2, 5), kBicycleAccess, {});
+  add(GraphId(1, 2, 3), GraphId(1, 2, 6), kAutoAccess, {GraphId(1, 2, 7)});
+  add(GraphId(1, 2, 4), GraphId(1, 2, 5), kAutoAccess | kTruckAccess, {});
+  std::string data = ss.str();
+
+  // forward restrictions are found by their to edge
+  std::vector<uint32_t> from;
+  for (const auto& cr : ComplexRestrictionView(data.data(), data.size(), true, GraphId(1, 2, 5),
+                                               kAutoAccess)) {
+    from.push_back(cr->from_graphid().id());
+  }
+  if (from != std::vector<uint32_t>{1, 4})
+    throw runtime_error("Forward view should find the restrictions to the edge for the modes");
+
+  // reverse restrictions are found by their from edge
+  ComplexRestrictionView reverse(data.data(), data.size(), false, GraphId(1, 2, 3), kAutoAccess);
+  if (reverse.empty() || (*reverse.begin())->via_count() != 1 ||
+      (*reverse.begin())->to_graphid() != GraphId(1, 2, 6))
+    throw runtime_error("Reverse view should find the restriction from the edge");
+
+  if (!ComplexRestrictionView(data.data(), data.size(), true, GraphId(1, 2, 5), kPedestrianAccess)
+           .empty())
+    throw runtime_error("View should be empty when no restriction has the access modes");
+}
 } // namespace
 
 int main(void) {
@@ -134,5 +174,8 @@ int main(void) {
   // Write to file and read into ComplexRestriction
   suite.test(TEST_CASE(TestWriteRead));
 
+  // Walk the restrictions to or from an edge
+  suite.test(TEST_CASE(TestView));
+
   return suite.tear_down();
 }
@@ -1,6 +1,7 @@
 #include "midgard/sequence.h"
 #include "mjolnir/graphbuilder.h"
 #include "mjolnir/graphenhancer.h"
+#include "mjolnir/admin.h"
 #include "mjolnir/graphtilebuilder.h"
 #include "mjolnir/osmnode.h"
 #include "mjolnir/pbfgraphparser.h"
@@ -230,6 +231,76 @@ void TestCountryAccess() {
   CountryAccess(config_file);
 }
 
+void TestPolygonIndex() {
+  // two squares next to each other and one made of two parts
+  multi_polygon_type west, east, islands;
+  boost::geometry::read_wkt("MULTIPOLYGON(((0 0,0 1,1 1,1 0,0 0)))", west);
+  boost::geometry::read_wkt("MULTIPOLYGON(((1 0,1 1,2 1,2 0,1 0)))", east);
+  boost::geometry::read_wkt("MULTIPOLYGON(((5 5,5 6,6 6,6 5,5 5)),((8 8,8 9,9 9,9 8,8 8)))",
+                            islands);
+  PolygonIndex index;
+  index.add(1, west);
+  index.add(2, east);
+  index.add(3, islands);
+  index.build();
+  if (index.size() != 4)
+    throw std::runtime_error("Each polygon part should be indexed");
+
+  if (index.covered_by({0.5f, 0.5f}) != 1 || index.covered_by({1.5f, 0.5f}) != 2 ||
+      index.covered_by({8.5f, 8.5f}) != 3 || index.covered_by({7.f, 7.f}) != 0)
+    throw std::runtime_error("Wrong polygon covers point");
+
+  // on the shared border either is fine unless the caller restricts it
+  if (index.covered_by({1.f, 0.5f}, [](uint32_t id) { return id == 2; }) != 2)
+    throw std::runtime_error("Restricted lookup should only return accepted polygons");
+
+  auto ids = index.intersects(AABB2<PointLL>(0.25f, 0.25f, 1.5f, 0.5f));
+  if (ids != std::vector<uint32_t>{1, 2})
+    throw std::runtime_error("Bounding box should intersect both squares");
+  ids = index.intersects(AABB2<PointLL>(5.5f, 5.5f, 8.5f, 8.5f));
+  if (ids != std::vector<uint32_t>{3})
+    throw std::runtime_error("Multipolygon should only be reported once");
+  if (!index.intersects(AABB2<PointLL>(3.f, 3.f, 4.f, 4.f)).empty())
+    throw std::runtime_error("Nothing should intersect empty space");
+}
+
+void TestPreparedPolygon() {
+  // a square with teeth along the top and bottom and a square hole, enough edges for a proper
+  // grid. some of the points below land right on vertices and edges
+  polygon_type polygon;
+  const int teeth = 300;
+  for (int i = 0; i <= teeth * 2; ++i) {
+    polygon.outer().emplace_back(i / (teeth * 2.0), i % 2 ? 0.1 : 0.0);
+  }
+  for (int i = teeth * 2; i >= 0; --i) {
+    polygon.outer().emplace_back(i / (teeth * 2.0), i % 2 ? 0.9 : 1.0);
+  }
+  polygon.outer().push_back(polygon.outer().front());
+  polygon.inners().resize(1);
+  for (const auto& p : {point_type(0.4, 0.4), point_type(0.4, 0.6), point_type(0.6, 0.6),
+                        point_type(0.6, 0.4), point_type(0.4, 0.4)}) {
+    polygon.inners().back().push_back(p);
+  }
+  boost::geometry::correct(polygon);
+  if (!boost::geometry::is_valid(polygon))
+    throw std::runtime_error("Test polygon should be valid");
+
+  // the grid has to give the same answer as boost everywhere
+  PreparedPolygon prepared(polygon);
+  for (int x = -5; x <= 105; ++x) {
+    for (int y = -5; y <= 105; ++y) {
+      point_type p(x / 100.0, y / 100.0);
+      if (prepared.covers(p) != boost::geometry::covered_by(p, polygon))
+        throw std::runtime_error("Prepared polygon differs from boost at " + std::to_string(x) +
+                                 "," + std::to_string(y));
+    }
+  }
+  for (const auto& p : polygon.outer()) {
+    if (!prepared.covers(p))
+      throw std::runtime_error("Prepared polygon should cover its vertices");
+  }
+}
+
 void DoConfig() {
   // make a config file
   write_config(config_file);
@@ -243,6 +314,8 @@ int main() {
 
   suite.test(TEST_CASE(DoConfig));
   suite.test(TEST_CASE(TestCountryAccess));
+  suite.test(TEST_CASE(TestPolygonIndex));
+  suite.test(TEST_CASE(TestPreparedPolygon));
 
   return suite.tear_down();
 }
@@ -477,6 +477,25 @@ void TestIsRestricted() {
   TryIsRestricted(td, "2019-03-03T08:30", false);
 }
 
+void TestTimeDomainCache() {
+  // the cached answers have to match evaluating the time domain every time, also for times
+  // checked out of order and for times outside of the cached week
+  auto tz_index = DateTime::get_tz_db().to_index("America/New_York");
+  auto tz = DateTime::get_tz_db().from_index(tz_index);
+  uint64_t start = DateTime::seconds_since_epoch("2018-04-17T10:30", tz);
+  TimeDomainCache cache;
+  for (uint64_t value : {23622321788ull, 40802435968ull, 39610337986940ull, 11311813490642943ull}) {
+    for (int64_t offset : {0, 3599, -7200, 86400 * 2 + 17, -86400 * 3, 86400 * 9, 61, 0}) {
+      for (uint64_t t = start + offset; t < start + offset + 86400; t += 7 * 60 + 13) {
+        bool expected = TimeDomainCache::evaluate(value, t, tz_index);
+        if (cache.is_restricted(value, t, tz_index) != expected)
+          throw std::runtime_error("Cached time domain " + std::to_string(value) +
+                                   " does not match at " + std::to_string(t));
+      }
+    }
+  }
+}
+
 void TestTimezoneDiff() {
 
   // dst tests
@@ -566,6 +585,7 @@ int main(void) {
   suite.test(TEST_CASE(TestIsoDateTime));
   suite.test(TEST_CASE(TestIsValid));
   suite.test(TEST_CASE(TestIsRestricted));
+  suite.test(TEST_CASE(TestTimeDomainCache));
   suite.test(TEST_CASE(TestDST));
   suite.test(TEST_CASE(TestTimezoneDiff));
   suite.test(TEST_CASE(TestDayOfWeek));
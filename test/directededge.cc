@@ -55,6 +55,24 @@ void TestWriteRead() {
     throw runtime_error("DirectedEdge stopimpact for localidx 1 test failed");
   }
 }
+
+void TestReach() {
+  DirectedEdge directededge;
+  if (directededge.has_reach()) {
+    throw runtime_error("DirectedEdge should not have reach until it is set");
+  }
+
+  directededge.set_reach(12);
+  if (!directededge.has_reach() || directededge.forward_reach() != 12) {
+    throw runtime_error("DirectedEdge reach test failed");
+  }
+
+  // anything beyond what fits is capped
+  directededge.set_reach(kMaxStoredReach + 1);
+  if (directededge.forward_reach() != kMaxStoredReach) {
+    throw runtime_error("DirectedEdge reach should be capped");
+  }
+}
 } // namespace
 
 int main(void) {
@@ -65,5 +83,7 @@ int main(void) {
   // Write to file and read into DirectedEdge
   suite.test(TEST_CASE(TestWriteRead));
 
+  suite.test(TEST_CASE(TestReach));
+
   return suite.tear_down();
 }
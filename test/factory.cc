@@ -51,12 +51,51 @@ void test_register() {
   // TODO: then ask for some odin::DirectionsOptions& options
   auto car = factory.Create(valhalla::odin::Costing::auto_, directions_options);
 }
+
+void test_shared_options() {
+  valhalla::odin::DirectionsOptions directions_options;
+  create_costing_options(directions_options);
+
+  CostFactory<DynamicCost> factory;
+  factory.RegisterStandardCostingModels();
+
+  // the same options give each request its own cost
+  auto first = factory.Create(valhalla::odin::Costing::auto_, directions_options);
+  auto second = factory.Create(valhalla::odin::Costing::auto_, directions_options);
+  if (first == second || first->travel_mode() != second->travel_mode())
+    throw std::runtime_error("Each request should get its own cost");
+  first->set_pass(1);
+  if (second->pass() != 0)
+    throw std::runtime_error("Changing one cost should not change the other");
+
+  // but not the same edges to avoid
+  valhalla::baldr::GraphId avoid(744885, 2, 5);
+  directions_options.add_avoid_edges(avoid.value);
+  auto avoiding = factory.Create(valhalla::odin::Costing::auto_, directions_options);
+  if (!avoiding->IsUserAvoidEdge(avoid))
+    throw std::runtime_error("The edges to avoid of the request should be used");
+  directions_options.clear_avoid_edges();
+  auto not_avoiding = factory.Create(valhalla::odin::Costing::auto_, directions_options);
+  if (not_avoiding->IsUserAvoidEdge(avoid) || first->IsUserAvoidEdge(avoid))
+    throw std::runtime_error("The edges to avoid of another request should not be used");
+
+  // different options are different costs
+  auto hybrid = factory.Create(valhalla::odin::Costing::bicycle, directions_options);
+  directions_options.mutable_costing_options(static_cast<int>(valhalla::odin::Costing::bicycle))
+      ->set_transport_type("Road");
+  auto road = factory.Create(valhalla::odin::Costing::bicycle, directions_options);
+  if (hybrid->travel_type() != static_cast<uint8_t>(BicycleType::kHybrid) ||
+      road->travel_type() != static_cast<uint8_t>(BicycleType::kRoad))
+    throw std::runtime_error("Different costing options should give different costs");
+}
+
 } // namespace
 
 int main(void) {
   test::suite suite("factory");
 
   suite.test(TEST_CASE(test_register));
+  suite.test(TEST_CASE(test_shared_options));
   // TODO: many more
 
   return suite.tear_down();
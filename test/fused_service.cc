@@ -0,0 +1,200 @@
+#include "test.h"
+#include <cstdint>
+
+#include "baldr/rapidjson_utils.h"
+#include "midgard/logging.h"
+#include <boost/property_tree/ptree.hpp>
+#include <prime_server/http_protocol.hpp>
+#include <prime_server/prime_server.hpp>
+#include <thread>
+#include <unistd.h>
+
+#include "loki/worker.h"
+#include "odin/worker.h"
+#include "thor/worker.h"
+#include "tyr/actor.h"
+
+#if !defined(VALHALLA_SOURCE_DIR)
+#define VALHALLA_SOURCE_DIR
+#endif
+
+using namespace valhalla;
+using namespace prime_server;
+
+namespace {
+
+// requests against the pine grove traffic extract, one per stage the fused worker can stop at
+const std::vector<http_request_t> requests{
+    http_request_t(POST, "/route", R"({"locations":[{"lat":40.546115,"lon":-76.385076,"type":"break"},
+      {"lat":40.544232,"lon":-76.385752,"type":"break"}],"costing":"auto"})"),
+    http_request_t(POST, "/trace_route", R"({"shape":[{"lat":40.546115,"lon":-76.385076},
+      {"lat":40.544232,"lon":-76.385752}],"costing":"auto","shape_match":"map_snap"})"),
+    http_request_t(POST, "/trace_attributes", R"({"shape":[{"lat":40.546115,"lon":-76.385076},
+      {"lat":40.544232,"lon":-76.385752}],"costing":"auto","shape_match":"map_snap"})"),
+    http_request_t(POST, "/locate", R"({"locations":[{"lat":40.546115,"lon":-76.385076}],
+      "costing":"auto"})"),
+    http_request_t(POST, "/route", R"({"locations":[{"lon":0,"lat":90}]})"),
+    http_request_t(POST, "/route", "{"),
+    http_request_t(GET, ""),
+};
+
+// the expected status code and a piece of the body that must be in the response
+const std::vector<std::pair<uint16_t, std::string>> expected_responses{
+    {200, R"("trip":)"},
+    {200, R"("trip":)"},
+    {200, R"("edges":)"},
+    {200, R"("edges":)"},
+    {400, R"("error_code":120)"},
+    {400, R"("error_code":100)"},
+    {404, R"("error_code":106)"},
+};
+
+zmq::context_t context;
+// an http server and the proxy in front of the first worker, each service gets its own
+void start_server(const std::string& name) {
+  std::thread server(std::bind(&http_server_t::serve,
+                               http_server_t(context, "ipc:///tmp/test_" + name + "_server",
+                                             "ipc:///tmp/test_" + name + "_proxy_in",
+                                             "ipc:///tmp/test_" + name + "_results",
+                                             "ipc:///tmp/test_" + name + "_interrupt")));
+  server.detach();
+}
+
+// a proxy that balances the load between the workers of a stage
+void start_proxy(const std::string& name) {
+  std::thread proxy(std::bind(&proxy_t::forward, proxy_t(context, "ipc:///tmp/test_" + name + "_in",
+                                                         "ipc:///tmp/test_" + name + "_out")));
+  proxy.detach();
+}
+
+void start_service() {
+  // server and load balancer
+  start_server("fused");
+  start_proxy("fused_proxy");
+
+  // make the config file, the thresholds are 0 so every request takes the long request logging
+  boost::property_tree::ptree config;
+  std::stringstream json;
+  json << R"({
+      "mjolnir": { "tile_dir": "test/traffic_matcher_tiles" },
+      "loki": { "actions": [ "locate", "route", "sources_to_targets", "optimized_route", "isochrone", "trace_route", "trace_attributes" ],
+                "logging": { "long_request": 0.0 },
+                "service": { "proxy": "ipc:///tmp/test_fused_proxy" },
+                "service_defaults": { "minimum_reachability": 50, "radius": 0} },
+      "thor": { "logging": { "long_request": 0.0 },
+                "service": { "proxy": "ipc:///tmp/test_pipelined_thor" } },
+      "odin": { "service": { "proxy": "ipc:///tmp/test_pipelined_odin" } },
+      "meili": { "customizable": ["breakage_distance"],
+                 "mode": "auto", "grid": { "cache_size": 100240, "size": 500 },
+                 "default": { "beta": 3, "breakage_distance": 2000, "geometry": false, "gps_accuracy": 5.0, "interpolation_distance": 10,
+                              "max_route_distance_factor": 3, "max_route_time_factor": 3, "max_search_radius": 100, "route": true,
+                              "search_radius": 50, "sigma_z": 4.07, "turn_penalty_factor": 200 } },
+      "httpd": { "service": { "fused": true, "loopback": "ipc:///tmp/test_fused_results", "interrupt": "ipc:///tmp/test_fused_interrupt" } },
+      "service_limits": {
+        "auto": { "max_distance": 5000000.0, "max_locations": 20,
+                  "max_matrix_distance": 400000.0, "max_matrix_locations": 50 },
+        "isochrone": { "max_contours": 4, "max_time": 120, "max_distance": 25000, "max_locations": 1},
+        "trace": { "max_best_paths": 4, "max_best_paths_shape": 100, "max_distance": 200000.0, "max_gps_accuracy": 100.0, "max_search_radius": 100, "max_shape": 16000 },
+        "max_avoid_locations": 50,
+        "max_reachability": 100,
+        "max_radius": 200
+      }
+    })";
+  rapidjson::read_json(json, config);
+  config.get_child("mjolnir").put("tile_dir", VALHALLA_SOURCE_DIR "test/traffic_matcher_tiles");
+
+  // service worker, does every stage of the request in one place
+  std::thread worker(valhalla::tyr::run_service, config);
+  worker.detach();
+
+  // the same service as a pipeline of loki, thor and odin workers to compare against
+  start_server("pipelined");
+  start_proxy("pipelined_proxy");
+  start_proxy("pipelined_thor");
+  start_proxy("pipelined_odin");
+  config.put("loki.service.proxy", "ipc:///tmp/test_pipelined_proxy");
+  config.put("httpd.service.loopback", "ipc:///tmp/test_pipelined_results");
+  config.put("httpd.service.interrupt", "ipc:///tmp/test_pipelined_interrupt");
+  std::thread loki_worker(valhalla::loki::run_service, config);
+  loki_worker.detach();
+  std::thread thor_worker(valhalla::thor::run_service, config);
+  thor_worker.detach();
+  std::thread odin_worker(valhalla::odin::run_service, config);
+  odin_worker.detach();
+}
+
+// sends all of the requests to the service and gives back its responses in the same order
+std::vector<http_response_t> get_responses(const std::string& name) {
+  // client makes requests and gets back responses in a batch fashion
+  auto request = requests.cbegin();
+  std::string request_str;
+  std::vector<http_response_t> responses;
+  http_client_t client(context, "ipc:///tmp/test_" + name + "_server",
+                       [&request, &request_str]() {
+                         // we dont have any more requests so bail
+                         if (request == requests.cend())
+                           return std::make_pair<const void*, size_t>(nullptr, 0);
+                         // get the string of bytes to send formatted for http protocol
+                         request_str = request->to_string();
+                         ++request;
+                         return std::make_pair<const void*, size_t>(request_str.c_str(),
+                                                                    request_str.size());
+                       },
+                       [&request, &responses](const void* data, size_t size) {
+                         responses.push_back(
+                             http_response_t::from_string(static_cast<const char*>(data), size));
+                         return request != requests.cend();
+                       },
+                       1);
+  // request and receive
+  client.batch();
+  return responses;
+}
+
+void test_requests() {
+  auto responses = get_responses("fused");
+
+  // Make sure that all requests are tested
+  test::assert_bool(responses.size() == requests.size(),
+                    "Expected passed tests count: " + std::to_string(requests.size()) +
+                        " Actual passed tests count: " + std::to_string(responses.size()));
+
+  for (size_t i = 0; i < responses.size(); ++i) {
+    const auto& expected = expected_responses[i];
+    if (responses[i].code != expected.first)
+      throw std::runtime_error("Expected Response Code: " + std::to_string(expected.first) +
+                               ", Actual Response Code: " + std::to_string(responses[i].code));
+    if (responses[i].body.find(expected.second) == std::string::npos)
+      throw std::runtime_error("Expected Response To Contain: " + expected.second +
+                               ", Actual Response: " + responses[i].body);
+  }
+}
+
+void test_matches_pipelined() {
+  // doing the stages in one place shouldnt change any of the answers
+  auto fused = get_responses("fused");
+  auto pipelined = get_responses("pipelined");
+  test::assert_bool(fused.size() == requests.size() && pipelined.size() == requests.size(),
+                    "Expected a response to every request");
+  for (size_t i = 0; i < requests.size(); ++i) {
+    if (fused[i].code != pipelined[i].code || fused[i].body != pipelined[i].body)
+      throw std::runtime_error("Fused Response: " + std::to_string(fused[i].code) + " " +
+                               fused[i].body + ", Pipelined Response: " +
+                               std::to_string(pipelined[i].code) + " " + pipelined[i].body);
+  }
+}
+
+} // namespace
+
+int main(void) {
+  // make this whole thing bail if it doesnt finish fast
+  alarm(180);
+
+  test::suite suite("Fused Service");
+
+  suite.test(TEST_CASE(start_service));
+  suite.test(TEST_CASE(test_requests));
+  suite.test(TEST_CASE(test_matches_pipelined));
+
+  return suite.tear_down();
+}
@@ -1,10 +1,16 @@
 #include "test.h"
 
 #include "mjolnir/graphbuilder.h"
+#include "mjolnir/util.h"
 
 #include <algorithm>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
 #include <boost/optional.hpp>
+#include <boost/property_tree/json_parser.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <map>
 #include <memory>
 #include <sstream>
 #include <string>
@@ -13,13 +19,171 @@
 using namespace std;
 using namespace valhalla::mjolnir;
 
-namespace {}
+#if !defined(VALHALLA_SOURCE_DIR)
+#define VALHALLA_SOURCE_DIR
+#endif
+
+namespace {
+
+void TestBuildStages() {
+  for (int8_t i = static_cast<int8_t>(BuildStage::kInitialize);
+       i <= static_cast<int8_t>(BuildStage::kValidate); ++i) {
+    auto stage = static_cast<BuildStage>(i);
+    if (string_to_buildstage(to_string(stage)) != stage)
+      throw std::runtime_error("Build stage " + to_string(stage) + " did not round trip");
+  }
+  if (string_to_buildstage("parse") != BuildStage::kInvalid)
+    throw std::runtime_error("Unknown build stage should be invalid");
+}
+
+void TestResumeWithoutCheckpoint() {
+  // there is nothing to resume from in a tile_dir that was never built
+  boost::property_tree::ptree config;
+  config.put("mjolnir.tile_dir", "test/data/this_is_not_a_tile_dir");
+  try {
+    build_tile_set(config, {}, "", false, BuildStage::kValidate);
+    throw std::logic_error("Resuming without a checkpoint should fail");
+  } catch (const std::runtime_error&) {}
+
+  // nor can we run the stages backwards
+  try {
+    build_tile_set(config, {}, "", false, BuildStage::kValidate, BuildStage::kEnhance);
+    throw std::logic_error("The end stage cannot come before the start stage");
+  } catch (const std::runtime_error&) {}
+}
+
+// whether resuming at the given stage is refused
+bool refuses(const boost::property_tree::ptree& config, BuildStage start) {
+  try {
+    build_tile_set(config, {}, "", false, start, start);
+  } catch (const std::runtime_error&) { return true; }
+  return false;
+}
+
+void TestResumeAfterStoppedStage() {
+  // a checkpoint as the build leaves it when it has finished the enhance stage
+  const std::string tile_dir = "test/data/resume_tiles";
+  boost::filesystem::remove_all(tile_dir);
+  boost::filesystem::create_directories(tile_dir);
+  boost::property_tree::ptree checkpoint;
+  checkpoint.put("started", "enhance");
+  checkpoint.put("completed", "enhance");
+  checkpoint.put_child("files", {});
+  boost::property_tree::write_json(tile_dir + "/build_stages.json", checkpoint);
+
+  // stop the build part way through the transit stage, a badly named transit tile makes it throw
+  const std::string transit_dir = "test/data/resume_transit";
+  boost::filesystem::remove_all(transit_dir);
+  boost::filesystem::create_directories(transit_dir + "/3");
+  std::ofstream(transit_dir + "/3/not_a_tile.gph") << "bad";
+  boost::property_tree::ptree config;
+  config.put("mjolnir.tile_dir", tile_dir);
+  config.put("mjolnir.transit_dir", transit_dir);
+  config.put("mjolnir.hierarchy", false);
+  if (!refuses(config, BuildStage::kTransit))
+    throw std::logic_error("The transit stage should have failed");
+  boost::property_tree::read_json(tile_dir + "/build_stages.json", checkpoint);
+  if (checkpoint.get<std::string>("started") != "transit" ||
+      checkpoint.get<std::string>("completed") != "enhance")
+    throw std::logic_error("The checkpoint should show transit started but not completed");
+
+  // the stage worked on staged copies of the tiles so it can be run again but not skipped
+  if (!refuses(config, BuildStage::kHierarchy))
+    throw std::logic_error("Resuming after a stage that was cut short should fail");
+  boost::filesystem::remove_all(transit_dir);
+  build_tile_set(config, {}, "", false, BuildStage::kTransit, BuildStage::kTransit);
+
+  // without a hierarchy the next stage is a no-op that completes right away
+  build_tile_set(config, {}, "", false, BuildStage::kHierarchy, BuildStage::kHierarchy);
+
+  // a stage that already completed cant be run again and no stage can be skipped
+  if (!refuses(config, BuildStage::kHierarchy))
+    throw std::logic_error("Resuming at a completed stage should fail");
+  if (!refuses(config, BuildStage::kRestrictions))
+    throw std::logic_error("Resuming past the next stage should fail");
+  build_tile_set(config, {}, "", false, BuildStage::kShortcuts, BuildStage::kShortcuts);
+
+  // stop the build while the restrictions stage was moving its tiles into place
+  boost::filesystem::create_directories(tile_dir + "/stage_tmp/2/000");
+  std::ofstream(tile_dir + "/stage_tmp/2/000/000.gph") << "moved";
+  boost::property_tree::read_json(tile_dir + "/build_stages.json", checkpoint);
+  checkpoint.put("started", "restrictions");
+  checkpoint.put("moving", "restrictions");
+  boost::property_tree::write_json(tile_dir + "/build_stages.json", checkpoint);
+
+  // resuming finishes the move so the next stage can go on from there
+  if (!refuses(config, BuildStage::kRestrictions))
+    throw std::logic_error("Resuming at a stage whose tiles were moved should fail");
+  if (!boost::filesystem::exists(tile_dir + "/2/000/000.gph") ||
+      boost::filesystem::exists(tile_dir + "/stage_tmp"))
+    throw std::logic_error("The staged tiles should have been moved into place");
+  boost::property_tree::read_json(tile_dir + "/build_stages.json", checkpoint);
+  if (checkpoint.get<std::string>("completed") != "restrictions" ||
+      checkpoint.get_optional<std::string>("moving"))
+    throw std::logic_error("The checkpoint should show restrictions completed");
+  boost::filesystem::remove_all(tile_dir);
+}
+
+// build the utrecht tiles up to and including the shortcuts with the given number of threads
+void build_utrecht(const std::string& tile_dir, unsigned int concurrency) {
+  boost::property_tree::ptree config;
+  config.put("mjolnir.tile_dir", tile_dir);
+  config.put("mjolnir.concurrency", concurrency);
+  config.put("mjolnir.hierarchy", true);
+  config.put("mjolnir.shortcuts", true);
+  build_tile_set(config, {VALHALLA_SOURCE_DIR "test/data/utrecht_netherlands.osm.pbf"},
+                 tile_dir + "/", false, BuildStage::kInitialize, BuildStage::kShortcuts);
+}
+
+// every tile in one directory and its contents
+std::map<std::string, std::string> read_tiles(const std::string& tile_dir) {
+  std::map<std::string, std::string> tiles;
+  boost::filesystem::recursive_directory_iterator itr(tile_dir), end;
+  for (; itr != end; ++itr) {
+    if (itr->path().extension() == ".gph") {
+      std::ifstream file(itr->path().string(), std::ios::binary);
+      tiles.emplace(itr->path().string().substr(tile_dir.size()),
+                    std::string(std::istreambuf_iterator<char>(file), {}));
+    }
+  }
+  return tiles;
+}
+
+void TestThreadedHierarchyMatchesSerial() {
+  // the hierarchy and shortcut builders merge the work of their threads in tile order so the
+  // tiles they make should not depend on how many threads there were
+  const std::string serial_dir = "test/data/utrecht_serial_tiles";
+  const std::string threaded_dir = "test/data/utrecht_threaded_tiles";
+  boost::filesystem::remove_all(serial_dir);
+  boost::filesystem::remove_all(threaded_dir);
+  build_utrecht(serial_dir, 1);
+  build_utrecht(threaded_dir, 4);
+  const auto serial = read_tiles(serial_dir);
+  const auto threaded = read_tiles(threaded_dir);
+  if (serial.empty())
+    throw std::logic_error("No tiles were built");
+  if (serial.size() != threaded.size())
+    throw std::logic_error("Threaded build made a different number of tiles");
+  for (const auto& tile : serial) {
+    auto other = threaded.find(tile.first);
+    if (other == threaded.cend())
+      throw std::logic_error("Threaded build is missing tile " + tile.first);
+    if (other->second != tile.second)
+      throw std::logic_error("Threaded build made a different tile " + tile.first);
+  }
+  boost::filesystem::remove_all(serial_dir);
+  boost::filesystem::remove_all(threaded_dir);
+}
+
+} // namespace
 
 int main() {
   test::suite suite("graphbuilder");
 
-  // Test setting and getting on random sizes of bit tables
-  // suite.test(TEST_CASE(some_test));
+  suite.test(TEST_CASE(TestBuildStages));
+  suite.test(TEST_CASE(TestResumeWithoutCheckpoint));
+  suite.test(TEST_CASE(TestResumeAfterStoppedStage));
+  suite.test(TEST_CASE(TestThreadedHierarchyMatchesSerial));
   // TODO: sweet jesus add more tests of this class!
 
   return suite.tear_down();
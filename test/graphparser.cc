@@ -225,17 +225,17 @@ void Exits(const std::string& config_file) {
 
   auto node = GetNode(33698177, way_nodes);
 
-  if (!node.intersection() || !node.ref() || osmdata.node_ref[33698177] != "51A-B")
+  if (!node.intersection() || !node.ref() || osmdata.node_ref.at(33698177) != "51A-B")
     throw std::runtime_error("Ref not set correctly .");
 
   node = GetNode(1901353894, way_nodes);
 
-  if (!node.intersection() || !node.ref() || osmdata.node_name[1901353894] != "Harrisburg East")
+  if (!node.intersection() || !node.ref() || osmdata.node_name.at(1901353894) != "Harrisburg East")
     throw std::runtime_error("Ref not set correctly .");
 
   node = GetNode(462240654, way_nodes);
 
-  if (!node.intersection() || osmdata.node_exit_to[462240654] != "PA441")
+  if (!node.intersection() || osmdata.node_exit_to.at(462240654) != "PA441")
     throw std::runtime_error("Ref not set correctly .");
 
   boost::filesystem::remove(ways_file);
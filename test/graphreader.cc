@@ -124,6 +124,23 @@ void TestConnectivityMap() {
   if (conn.get_color({a2, 2, 0}) == conn.get_color({d0, 2, 0}))
     throw std::runtime_error("a is disjoint from d");
 
+  // write it out and load it back in, it should be the same
+  pt.put("connectivity_map", tile_dir + "/connectivity.bin");
+  conn.write(pt.get<std::string>("connectivity_map"));
+  connectivity_map_t loaded(pt);
+  for (auto tile : {a0, a1, a2, b0, c0, d0, d1, a0 + 2}) {
+    if (conn.get_color({tile, 2, 0}) != loaded.get_color({tile, 2, 0}))
+      throw std::runtime_error("Loaded connectivity map should have the same colors");
+  }
+  if (conn.to_geojson(2) != loaded.to_geojson(2))
+    throw std::runtime_error("Loaded connectivity map should have the same regions");
+
+  // once the tiles change the file is not used anymore
+  boost::filesystem::remove(tile_dir + "/" + GraphTile::FileSuffix({d1, 2, 0}));
+  connectivity_map_t changed(pt);
+  if (changed.get_color({d1, 2, 0}) != 0 || changed.get_color({d0, 2, 0}) == 0)
+    throw std::runtime_error("A connectivity map made from other tiles should not be used");
+
   boost::filesystem::remove_all(tile_dir);
 }
 
@@ -5,6 +5,7 @@
 #include "midgard/encoded.h"
 #include "midgard/pointll.h"
 #include "mjolnir/graphtilebuilder.h"
+#include <boost/filesystem/operations.hpp>
 #include <fstream>
 #include <streambuf>
 #include <string>
@@ -256,6 +257,60 @@ void TestBinEdges() {
     throw std::logic_error("This edge leaves a tile for 1 other tile and comes back.");
 }
 
+void TestTruckRestrictionFormat() {
+  // one edge restricted for bicycles and one for trucks
+  std::string test_dir = "test/data/truck_restriction_tiles";
+  GraphId id(0, 2, 0);
+  {
+    GraphTileBuilder builder(test_dir, id, false);
+    builder.directededges().resize(2);
+    builder.AddAccessRestriction(AccessRestriction(0, AccessType::kMaxHeight, kBicycleAccess, 300));
+    builder.AddAccessRestriction(AccessRestriction(1, AccessType::kMaxHeight, kTruckAccess, 300));
+    builder.StoreTileData();
+  }
+  {
+    GraphTile tile(test_dir, id);
+    if (tile.header()->format_version() != kTileFormatVersion)
+      throw std::logic_error("New tiles should have the current format version");
+    if (tile.GetTruckRestriction(0) != nullptr)
+      throw std::logic_error("The bicycle restriction should not be summarized for trucks");
+    auto summary = tile.GetTruckRestriction(1);
+    if (summary == nullptr || !summary->complete() ||
+        summary->Allowed(4.f, 2.f, 10.f, 10.f, 5.f, false) ||
+        !summary->Allowed(2.f, 2.f, 10.f, 10.f, 5.f, false))
+      throw std::logic_error("The truck restriction should be summarized");
+  }
+
+  // a tile from before the summaries existed has the same layout without them, it has to fall
+  // back to the access restrictions rather than read whatever follows them as summaries
+  {
+    GraphTileBuilder builder(test_dir, id, false);
+    builder.directededges().resize(2);
+    builder.AddAccessRestriction(AccessRestriction(0, AccessType::kMaxHeight, kBicycleAccess, 300));
+    builder.StoreTileData();
+  }
+  std::string file_name = test_dir + "/" + GraphTile::FileSuffix(id);
+  std::string bytes;
+  {
+    std::ifstream file(file_name, std::ios::binary);
+    bytes.assign(std::istreambuf_iterator<char>(file), {});
+  }
+  reinterpret_cast<GraphTileHeader*>(&bytes[0])->set_format_version(0);
+  {
+    std::ofstream file(file_name, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), bytes.size());
+  }
+  {
+    GraphTile tile(test_dir, id);
+    auto summary = tile.GetTruckRestriction(1);
+    if (summary == nullptr || summary->complete())
+      throw std::logic_error("Old tiles should always check the access restrictions");
+    if (tile.GetAccessRestrictions(0, kBicycleAccess).empty())
+      throw std::logic_error("Old tiles should still have their access restrictions");
+  }
+  boost::filesystem::remove_all(test_dir);
+}
+
 } // namespace
 
 int main() {
@@ -270,5 +325,8 @@ int main() {
   // Test bin edges of some tricky edges
   suite.test(TEST_CASE(TestBinEdges));
 
+  // Test that truck restriction summaries are only read from tiles that have them
+  suite.test(TEST_CASE(TestTruckRestrictionFormat));
+
   return suite.tear_down();
 }
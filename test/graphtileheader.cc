@@ -36,6 +36,13 @@ void TestWriteRead() {
   if (hdr.version() != ver) {
     throw runtime_error("Header version test failed");
   }
+  if (hdr.format_version() != 0) {
+    throw runtime_error("Header format version should start out at 0");
+  }
+  hdr.set_format_version(kTileFormatVersion);
+  if (hdr.format_version() != kTileFormatVersion) {
+    throw runtime_error("Header format version test failed");
+  }
   hdr.set_dataset_id(5678);
   if (hdr.dataset_id() != 5678) {
     throw runtime_error("Header dataset Id test failed");
@@ -0,0 +1,183 @@
+#include "test.h"
+
+#include <string>
+#include <vector>
+
+#include "mjolnir/luatagtransform.h"
+
+using namespace valhalla::mjolnir;
+
+namespace {
+
+// returns every tag along with one that depends on all of them so any mix up of tag sets shows
+const std::string lua = R"(
+function describe(kv, n)
+  local keys = {}
+  for k, _ in pairs(kv) do keys[#keys + 1] = k end
+  table.sort(keys)
+  local out = {}
+  local all = ""
+  for _, k in ipairs(keys) do
+    out[k] = kv[k]
+    all = all .. "[" .. k .. "=" .. kv[k] .. "]"
+  end
+  out["all"] = all
+  out["count"] = tostring(n)
+  return out
+end
+
+function nodes_proc(kv, n)
+  if kv["skip"] then return 1, {} end
+  return 0, describe(kv, n)
+end
+
+function ways_proc(kv, n)
+  if kv["skip"] then return 1, {}, 0, 0 end
+  return 0, describe(kv, n), 0, 0
+end
+
+function rels_proc(kv, n)
+  return 0, describe(kv, n)
+end
+)";
+
+// lets the test look at how many tag sets were remembered
+struct TestTransform : public LuaTagTransform {
+  using LuaTagTransform::LuaTagTransform;
+  size_t cached(OSMType type) const {
+    return memos_[static_cast<size_t>(type)].cache.size();
+  }
+  size_t hits(OSMType type) const {
+    return memos_[static_cast<size_t>(type)].hits;
+  }
+};
+
+// the same tags inserted in another order
+Tags reversed(const std::vector<std::pair<std::string, std::string>>& tags) {
+  Tags result;
+  for (auto tag = tags.rbegin(); tag != tags.rend(); ++tag) {
+    result.insert(*tag);
+  }
+  return result;
+}
+
+void TestCachedMatchesUncached() {
+  TestTransform cached(lua);
+  TestTransform uncached(lua, 0);
+
+  // tag sets that would share a key if keys and values were simply run together
+  std::vector<std::vector<std::pair<std::string, std::string>>> tag_sets{
+      {},
+      {{"highway", "residential"}},
+      {{"highway", "residential"}, {"name", "Main"}},
+      {{"highway", "residential"}, {"name", "Main"}, {"oneway", "yes"}},
+      {{"highway", "residential"}, {"name", "Mainoneway"}, {"yes", ""}},
+      {{"ab", "c"}},
+      {{"a", "bc"}},
+      {{"a", ""}, {"bc", ""}},
+      {{"a", "b"}, {"c", "d"}},
+      {{"a", "bc"}, {"d", ""}},
+      {{"a", "d"}, {"c", "b"}},
+      {{"skip", "yes"}, {"highway", "primary"}},
+  };
+
+  // every set more than once and in both insertion orders
+  for (int pass = 0; pass < 3; ++pass) {
+    for (const auto& tag_set : tag_sets) {
+      for (const auto& tags : {Tags(tag_set.begin(), tag_set.end()), reversed(tag_set)}) {
+        for (auto type : {OSMType::kNode, OSMType::kWay, OSMType::kRelation}) {
+          auto expected = uncached.Transform(type, tags);
+          if (cached.Transform(type, tags) != expected)
+            throw std::logic_error("Cached transform differs from lua");
+          bool skipped = tags.count("skip") && type != OSMType::kRelation;
+          if (skipped != expected.empty())
+            throw std::logic_error("Filtered objects should come back without tags");
+        }
+      }
+    }
+  }
+
+  // one entry per distinct set and type, whatever the order the tags came in
+  for (auto type : {OSMType::kNode, OSMType::kWay, OSMType::kRelation}) {
+    if (cached.cached(type) != tag_sets.size())
+      throw std::logic_error("Expected one cache entry per distinct tag set");
+    if (uncached.cached(type) != 0)
+      throw std::logic_error("A cache size of 0 should not remember anything");
+  }
+
+  // a full cache starts over rather than growing
+  TestTransform small(lua, 4);
+  for (const auto& tag_set : tag_sets) {
+    Tags tags(tag_set.begin(), tag_set.end());
+    if (small.Transform(OSMType::kWay, tags) != uncached.Transform(OSMType::kWay, tags))
+      throw std::logic_error("Cached transform differs from lua after clearing");
+    if (small.cached(OSMType::kWay) > 4)
+      throw std::logic_error("Cache grew past its size");
+  }
+}
+
+// only looks at a few of the tags, the way graph.lua does, and edits the table it is given
+const std::string partial_lua = R"(
+function nodes_proc(kv, n)
+  return 0, kv
+end
+
+function ways_proc(kv, n)
+  if n == 0 or kv["highway"] == nil then return 1, kv, 0, 0 end
+  kv["road_class"] = kv["highway"] == "motorway" and "0" or "1"
+  kv["fixme"] = nil
+  if kv["highway"] == "track" then kv["surface"] = kv["surface"] or "dirt" end
+  return 0, kv, 0, 0
+end
+
+function rels_proc(kv, n)
+  return 0, kv
+end
+)";
+
+void TestKeyedOnReadTags() {
+  TestTransform cached(partial_lua);
+  TestTransform uncached(partial_lua, 0);
+  auto check = [&](const Tags& tags) {
+    auto expected = uncached.Transform(OSMType::kWay, tags);
+    if (cached.Transform(OSMType::kWay, tags) != expected)
+      throw std::logic_error("Cached transform differs from lua");
+  };
+
+  // names are never read so all of these share one entry but keep their own names. the entry is
+  // only made the second time around so the first two are misses
+  for (const auto& name : {"Main", "Oak", "Elm", "Pine"}) {
+    check({{"highway", "residential"}, {"name", name}, {"fixme", "check"}});
+  }
+  if (cached.cached(OSMType::kWay) != 1 || cached.hits(OSMType::kWay) != 2)
+    throw std::logic_error("Tags the script never reads should not be part of the key");
+
+  // surface is only read for tracks, once it is it has to be part of every key
+  std::vector<Tags> tag_sets{
+      {{"highway", "residential"}, {"surface", "paved"}},
+      {{"highway", "track"}, {"surface", "gravel"}},
+      {{"highway", "track"}},
+      {{"highway", "residential"}, {"surface", "gravel"}},
+      {{"highway", "track"}, {"surface", "gravel"}, {"name", "Back"}},
+      {{"highway", "motorway"}},
+      {{"name", "Nowhere"}},
+      {},
+  };
+  for (int pass = 0; pass < 3; ++pass) {
+    for (const auto& tags : tag_sets) {
+      check(tags);
+    }
+  }
+}
+
+} // namespace
+
+int main() {
+  test::suite suite("luatagtransform");
+
+  suite.test(TEST_CASE(TestCachedMatchesUncached));
+
+  suite.test(TEST_CASE(TestKeyedOnReadTags));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,202 @@
+#include "test.h"
+
+#include <cstdio>
+#include <sstream>
+
+#include "baldr/graphreader.h"
+#include "baldr/tilehierarchy.h"
+#include "midgard/sequence.h"
+#include "mjolnir/osmchange.h"
+#include "mjolnir/osmdata.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+using namespace valhalla::mjolnir;
+
+namespace {
+
+const std::string osc = R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="test">
+  <create>
+    <node id="10" version="1" lat="52.0938" lon="5.1185"/>
+    <way id="20" version="1">
+      <nd ref="10"/>
+      <nd ref="11"/>
+    </way>
+  </create>
+  <modify>
+    <node id="11" version="2" lat="52.0940" lon="5.1190"/>
+    <relation id="30" version="3">
+      <member type="way" ref="20" role=""/>
+    </relation>
+  </modify>
+  <delete>
+    <node id="12" version="4"/>
+    <way id="21" version="5"/>
+  </delete>
+</osmChange>)";
+
+void TestParse() {
+  std::stringstream stream(osc);
+  auto change = OSMChange::Parse(stream);
+  if (change.nodes != std::unordered_set<uint64_t>{10, 11, 12})
+    throw std::runtime_error("Wrong nodes parsed");
+  if (change.ways != std::unordered_set<uint64_t>{20, 21})
+    throw std::runtime_error("Wrong ways parsed");
+  if (change.relations != std::unordered_set<uint64_t>{30})
+    throw std::runtime_error("Wrong relations parsed");
+  // the deleted node has no location
+  if (change.locations.size() != 2)
+    throw std::runtime_error("Only nodes with a location should have one");
+  // what the changed way and relation are made of
+  if (change.member_nodes != std::unordered_set<uint64_t>{10, 11})
+    throw std::runtime_error("Wrong way nodes parsed");
+  if (change.member_ways != std::unordered_set<uint64_t>{20})
+    throw std::runtime_error("Wrong relation members parsed");
+
+  std::stringstream bad("<osm></osm>");
+  try {
+    OSMChange::Parse(bad);
+    throw std::logic_error("Not a change file");
+  } catch (const std::runtime_error&) {}
+}
+
+void TestAffectedTiles() {
+  std::stringstream stream(osc);
+  auto change = OSMChange::Parse(stream);
+
+  // without any tiles only the locations of the changed nodes count
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", "test/data/this_is_not_a_tile_dir");
+  GraphReader reader(conf);
+  auto affected = AffectedTiles(reader, change);
+
+  // both nodes are in the same tile so there should be one tile per level
+  std::set<GraphId> expected;
+  for (const auto& level : TileHierarchy::levels()) {
+    expected.emplace(level.second.tiles.TileId(change.locations.front()), level.first, 0);
+  }
+  if (affected != expected)
+    throw std::runtime_error("Expected one affected tile per hierarchy level");
+}
+
+void TestMovedAndDeletedNodes() {
+  std::stringstream stream(osc);
+  auto change = OSMChange::Parse(stream);
+
+  // the last build had node 11 far from where it was moved to and node 12, which is now deleted,
+  // even further away. neither way through them is part of the change
+  const std::string ways_file = "test_osmchange_ways.bin";
+  const std::string way_nodes_file = "test_osmchange_way_nodes.bin";
+  const PointLL moved_from(4.9, 52.37), deleted_at(4.47, 51.92);
+  {
+    sequence<OSMWay> ways(ways_file, true);
+    sequence<OSMWayNode> way_nodes(way_nodes_file, true);
+    OSMWay way{};
+    way.set_way_id(40);
+    ways.push_back(way);
+    way.set_way_id(41);
+    ways.push_back(way);
+    OSMWayNode way_node{};
+    way_node.node.osmid = 11;
+    way_node.node.set_latlng({moved_from.lng(), moved_from.lat()});
+    way_nodes.push_back(way_node);
+    way_node.node.osmid = 12;
+    way_node.node.set_latlng({deleted_at.lng(), deleted_at.lat()});
+    way_node.way_index = 1;
+    way_nodes.push_back(way_node);
+    way_node.node.osmid = 13;
+    way_node.node.set_latlng({5.5, 51.4});
+    way_nodes.push_back(way_node);
+  }
+
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", "test/data/this_is_not_a_tile_dir");
+  GraphReader reader(conf);
+  auto affected = AffectedTiles(reader, change, ways_file, way_nodes_file);
+  std::remove(ways_file.c_str());
+  std::remove(way_nodes_file.c_str());
+
+  // the tiles of the new locations and the old ones but not of the untouched node
+  std::set<GraphId> expected;
+  for (const auto& ll : {change.locations.front(), moved_from, deleted_at}) {
+    for (const auto& level : TileHierarchy::levels()) {
+      expected.emplace(level.second.tiles.TileId(ll), level.first, 0);
+    }
+  }
+  if (affected != expected)
+    throw std::runtime_error("Expected the old locations of moved and deleted nodes");
+}
+
+void TestMemberNodes() {
+  // a way and a relation changed but none of the nodes they are made of did
+  std::stringstream stream(R"(<?xml version="1.0" encoding="UTF-8"?>
+<osmChange version="0.6" generator="test">
+  <modify>
+    <way id="22" version="2">
+      <nd ref="15"/>
+    </way>
+    <relation id="31" version="2">
+      <member type="node" ref="16" role="via"/>
+      <member type="way" ref="23" role="from"/>
+      <member type="relation" ref="32" role=""/>
+    </relation>
+  </modify>
+</osmChange>)");
+  auto change = OSMChange::Parse(stream);
+  if (change.member_nodes != std::unordered_set<uint64_t>{15, 16} ||
+      change.member_ways != std::unordered_set<uint64_t>{23})
+    throw std::runtime_error("Wrong members parsed");
+
+  // the last build knows where those nodes are
+  const std::string ways_file = "test_osmchange_member_ways.bin";
+  const std::string way_nodes_file = "test_osmchange_member_way_nodes.bin";
+  const PointLL way_node_at(4.9, 52.37), via_node_at(4.47, 51.92);
+  {
+    sequence<OSMWay> ways(ways_file, true);
+    sequence<OSMWayNode> way_nodes(way_nodes_file, true);
+    OSMWay way{};
+    way.set_way_id(42);
+    ways.push_back(way);
+    OSMWayNode way_node{};
+    way_node.node.osmid = 15;
+    way_node.node.set_latlng({way_node_at.lng(), way_node_at.lat()});
+    way_nodes.push_back(way_node);
+    way_node.node.osmid = 16;
+    way_node.node.set_latlng({via_node_at.lng(), via_node_at.lat()});
+    way_nodes.push_back(way_node);
+    way_node.node.osmid = 17;
+    way_node.node.set_latlng({5.5, 51.4});
+    way_nodes.push_back(way_node);
+  }
+
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", "test/data/this_is_not_a_tile_dir");
+  GraphReader reader(conf);
+  auto affected = AffectedTiles(reader, change, ways_file, way_nodes_file);
+  std::remove(ways_file.c_str());
+  std::remove(way_nodes_file.c_str());
+
+  // the tiles of the member nodes but not of the other node on their way
+  std::set<GraphId> expected;
+  for (const auto& ll : {way_node_at, via_node_at}) {
+    for (const auto& level : TileHierarchy::levels()) {
+      expected.emplace(level.second.tiles.TileId(ll), level.first, 0);
+    }
+  }
+  if (affected != expected)
+    throw std::runtime_error("Expected the tiles of the members of the changed way and relation");
+}
+
+} // namespace
+
+int main() {
+  test::suite suite("osmchange");
+
+  suite.test(TEST_CASE(TestParse));
+  suite.test(TEST_CASE(TestAffectedTiles));
+  suite.test(TEST_CASE(TestMovedAndDeletedNodes));
+  suite.test(TEST_CASE(TestMemberNodes));
+
+  return suite.tear_down();
+}
@@ -0,0 +1,136 @@
+#include "test.h"
+
+#include <string>
+#include <vector>
+
+#include "mjolnir/osmdata.h"
+
+using namespace valhalla::mjolnir;
+
+namespace {
+
+// ids the way two pbf files would hand them over, each file sorted on its own
+const std::vector<std::pair<uint64_t, int>> two_files{{1, 10}, {4, 40}, {4, 41}, {7, 70},
+                                                      {2, 20}, {4, 42}, {9, 90}};
+
+void TestSortAcrossFiles() {
+  OSMIdMap<int> map;
+  for (const auto& entry : two_files) {
+    map.set(entry.first, entry.second);
+  }
+
+  // the second file starts over so nothing can be found until it is sorted
+  try {
+    map.find(1);
+    throw std::logic_error("Finding before sorting should throw");
+  } catch (const std::logic_error& e) {
+    if (std::string(e.what()).find("sorted") == std::string::npos)
+      throw;
+  }
+
+  map.sort();
+  if (map.size() != 5)
+    throw std::logic_error("Duplicate ids should only be kept once");
+  for (const auto& expected : std::vector<std::pair<uint64_t, int>>{{1, 10},
+                                                                    {2, 20},
+                                                                    {4, 42},
+                                                                    {7, 70},
+                                                                    {9, 90}}) {
+    if (map.at(expected.first) != expected.second)
+      throw std::logic_error("Wrong value for id " + std::to_string(expected.first));
+  }
+  if (map.find(3) != nullptr || map.find(0) != nullptr || map.find(10) != nullptr)
+    throw std::logic_error("Ids that were never set should not be found");
+  try {
+    map.at(3);
+    throw std::logic_error("at should throw for missing ids");
+  } catch (const std::out_of_range&) {}
+}
+
+void TestKeepFirst() {
+  OSMIdMap<int> map(true);
+  for (const auto& entry : two_files) {
+    map.set(entry.first, entry.second);
+  }
+  map.sort();
+  if (map.size() != 5 || map.at(4) != 40 || map.at(9) != 90)
+    throw std::logic_error("The first value of an id should be kept");
+
+  // the same holds for the shapes and ways the admin builder keeps
+  OSMData osmdata{};
+  osmdata.shape_map.set(5, {1.f, 2.f});
+  osmdata.shape_map.set(5, {3.f, 4.f});
+  osmdata.shape_map.set(3, {5.f, 6.f});
+  osmdata.shape_map.set(5, {7.f, 8.f});
+  osmdata.shape_map.sort();
+  if (osmdata.shape_map.size() != 2 || osmdata.shape_map.at(5).lng() != 1.f)
+    throw std::logic_error("The first shape of a node should be kept");
+
+  osmdata.way_map.set(8, {1, 2, 3});
+  osmdata.way_map.set(6, {4, 5});
+  osmdata.way_map.set(8, {6});
+  osmdata.way_map.sort();
+  OSMWayMap::Nodes nodes;
+  if (!osmdata.way_map.find(8, nodes) ||
+      std::vector<uint64_t>(nodes.begin(), nodes.end()) != std::vector<uint64_t>{1, 2, 3})
+    throw std::logic_error("The first nodes of a way should be kept");
+
+  // nodes of a way that is added again right away are not stored at all
+  struct way_map_t : public OSMWayMap {
+    size_t node_count() const {
+      return nodes_.size();
+    }
+  } way_map;
+  way_map.set(2, {1, 2});
+  way_map.set(2, {3, 4, 5});
+  way_map.set(3, {6});
+  way_map.sort();
+  if (way_map.node_count() != 3 || !way_map.find(2, nodes) ||
+      std::vector<uint64_t>(nodes.begin(), nodes.end()) != std::vector<uint64_t>{1, 2})
+    throw std::logic_error("The nodes of a way that is kept should be the only ones stored");
+}
+
+void TestMultiMap() {
+  OSMIdMultiMap<int> map;
+  for (const auto& entry : two_files) {
+    map.insert(entry);
+  }
+  try {
+    map.equal_range(4);
+    throw std::logic_error("Finding before sorting should throw");
+  } catch (const std::logic_error& e) {
+    if (std::string(e.what()).find("sorted") == std::string::npos)
+      throw;
+  }
+
+  // every value is kept in the order it was added
+  map.sort();
+  if (map.size() != two_files.size())
+    throw std::logic_error("Every value should be kept");
+  auto range = map.equal_range(4);
+  std::vector<int> values;
+  for (auto value = range.first; value != range.second; ++value) {
+    values.push_back(value->second);
+  }
+  if (values != std::vector<int>{40, 41, 42})
+    throw std::logic_error("Values of an id should stay in the order they were added");
+
+  // missing ids come back as end like they do for the standard multimaps
+  for (uint64_t id : {0, 3, 10}) {
+    range = map.equal_range(id);
+    if (range.first != map.end() || range.second != map.end())
+      throw std::logic_error("Missing ids should give an empty range at the end");
+  }
+}
+
+} // namespace
+
+int main() {
+  test::suite suite("osmdata");
+
+  suite.test(TEST_CASE(TestSortAcrossFiles));
+  suite.test(TEST_CASE(TestKeepFirst));
+  suite.test(TEST_CASE(TestMultiMap));
+
+  return suite.tear_down();
+}
@@ -248,6 +248,26 @@ void test_negative_speeds() {
   }
 }
 
+void test_speed_memo() {
+  PredictedSpeedMemo memo;
+  float speed = 0.0f;
+  if (memo.find(1234, 0, speed))
+    throw std::runtime_error("An empty memo should not find anything");
+
+  // the speed is remembered for the whole bucket but not the next one or another edge
+  memo.insert(1234, 600, 42.5f);
+  if (!memo.find(1234, 600 + kSpeedBucketSizeSeconds - 1, speed) || speed != 42.5f)
+    throw std::runtime_error("Speed should be found anywhere in the same bucket");
+  if (memo.find(1234, 600 + kSpeedBucketSizeSeconds, speed))
+    throw std::runtime_error("Speed should not be found in the next bucket");
+  if (memo.find(1235, 600, speed))
+    throw std::runtime_error("Speed should not be found for another edge");
+
+  memo.clear();
+  if (memo.find(1234, 600, speed))
+    throw std::runtime_error("A cleared memo should not find anything");
+}
+
 } // namespace
 
 int main(void) {
@@ -259,5 +279,7 @@ int main(void) {
 
   suite.test(TEST_CASE(test_negative_speeds));
 
+  suite.test(TEST_CASE(test_speed_memo));
+
   return suite.tear_down();
 }
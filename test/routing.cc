@@ -1,5 +1,6 @@
 #include <cstdint>
 // -*- mode: c++ -*-
+#include "meili/route_cache.h"
 #include "meili/routing.h"
 #include "test.h"
 
@@ -210,6 +211,63 @@ void TestRoutePathIterator() {
   test::assert_bool(it5 == the_end, "TestRoutePathIterator: wrong advance");
 }
 
+void TestRouteCache() {
+  RouteCache cache(RouteCache::kShardCount);
+  const RouteCache::key_t key{1, baldr::GraphId(), baldr::GraphId(1, 2, 3), baldr::GraphId(1, 2, 4)};
+
+  // nothing there yet
+  test::assert_bool(!cache.Get(key, 100.f, -1.f), "TestRouteCache: expected a miss");
+
+  // a route found with a distance bound of 100 and no time bound
+  auto route = std::make_shared<cached_route_t>();
+  route->cost = sif::Cost(50.f, 5.f);
+  route->max_dist = 100.f;
+  route->max_time = -1.f;
+  route->found = true;
+  cache.Put(key, route);
+
+  // it can answer tighter bounds but not looser ones
+  auto hit = cache.Get(key, 60.f, 10.f);
+  test::assert_bool(hit && hit->within(60.f, 10.f), "TestRouteCache: expected a usable route");
+  hit = cache.Get(key, 40.f, -1.f);
+  test::assert_bool(hit && !hit->within(40.f, -1.f), "TestRouteCache: route should be too long");
+  test::assert_bool(!cache.Get(key, 200.f, -1.f), "TestRouteCache: bounds are too loose");
+
+  // lookups dont count towards the metrics, each transition counts once
+  test::assert_bool(cache.hits() == 0 && cache.misses() == 0, "TestRouteCache: wrong metrics");
+  cache.Count(true);
+  cache.Count(false);
+  cache.Count(true);
+  test::assert_bool(cache.hits() == 2 && cache.misses() == 1, "TestRouteCache: wrong metrics");
+
+  // a time bounded route cant answer an unbounded search
+  auto timed = std::make_shared<cached_route_t>(*route);
+  timed->max_time = 20.f;
+  cache.Put(key, timed);
+  test::assert_bool(!cache.Get(key, 60.f, -1.f), "TestRouteCache: time bounds are too loose");
+  test::assert_bool(cache.size() == 1, "TestRouteCache: put should replace the route");
+
+  // its bounded so the least recently used ones get evicted
+  for (uint32_t i = 0; i < 100; ++i) {
+    cache.Put({2, baldr::GraphId(), baldr::GraphId(1, 2, i), baldr::GraphId(1, 2, i + 1)}, route);
+  }
+  test::assert_bool(cache.size() <= RouteCache::kShardCount,
+                    "TestRouteCache: cache should be bounded");
+
+  cache.Clear();
+  test::assert_bool(cache.size() == 0 && cache.hits() == 0 && cache.misses() == 0,
+                    "TestRouteCache: clear should reset everything");
+
+  // caches smaller than the number of shards are still bounded by their size
+  for (size_t max_size : {1, 5, 17}) {
+    RouteCache small(max_size);
+    for (uint32_t i = 0; i < 100; ++i) {
+      small.Put({3, baldr::GraphId(), baldr::GraphId(1, 2, i), baldr::GraphId(1, 2, i + 1)}, route);
+    }
+    test::assert_bool(small.size() <= max_size, "TestRouteCache: small cache should be bounded");
+  }
+}
+
 int main(int argc, char* argv[]) {
   test::suite suite("routing");
 
@@ -221,5 +279,7 @@ int main(int argc, char* argv[]) {
 
   suite.test(TEST_CASE(TestRoutePathIterator));
 
+  suite.test(TEST_CASE(TestRouteCache));
+
   return suite.tear_down();
 }
@@ -1,9 +1,11 @@
 #include "loki/search.h"
+#include "loki/snap_cache.h"
 #include "test.h"
 #include <cstdint>
 
 #include <boost/filesystem.hpp>
 #include <boost/property_tree/ptree.hpp>
+#include <tuple>
 #include <unordered_set>
 
 #include "baldr/graphid.h"
@@ -19,6 +21,7 @@ using namespace valhalla::loki;
 
 #include "mjolnir/directededgebuilder.h"
 #include "mjolnir/graphtilebuilder.h"
+#include "mjolnir/graphvalidator.h"
 
 namespace {
 
@@ -176,14 +179,18 @@ void search(const valhalla::baldr::Location& location,
     throw std::logic_error("Got more edges than expected");
 }
 
-void search(const valhalla::baldr::Location& location, size_t result_count, int reachability) {
+void search(const valhalla::baldr::Location& location,
+            size_t result_count,
+            int reachability,
+            bool stored_reach = false) {
   // make the config file
   boost::property_tree::ptree conf;
   conf.put("tile_dir", tile_dir);
 
   valhalla::baldr::GraphReader reader(conf);
-  const auto p =
-      Search({location}, reader, PassThroughEdgeFilter, PassThroughNodeFilter).at(location);
+  const auto p = Search({location}, reader, PassThroughEdgeFilter, PassThroughNodeFilter,
+                        stored_reach)
+                     .at(location);
 
   if (p.edges.size() != result_count)
     throw std::logic_error("Wrong number of edges");
@@ -290,6 +297,212 @@ void test_reachability_radius() {
   search({ob, Location::StopType::BREAK, 3, 0}, 2, 3);
 }
 
+void test_bulk_search() {
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", tile_dir);
+  valhalla::baldr::GraphReader reader(conf), first(conf), second(conf);
+
+  // a mix of locations, some repeated and one that cant be found, in no particular order
+  std::vector<Location> locations;
+  for (int i = 0; i < 20; ++i) {
+    const auto& other = i % 2 ? a.second : b.second;
+    locations.emplace_back(d.second.AffineCombination(i / 20.f, 1.f - i / 20.f, other));
+  }
+  locations.emplace_back(a.second);
+  locations.emplace_back(PointLL{-70, 40});
+  locations.emplace_back(a.second);
+
+  // the results should be handed back in order and match what a normal search finds
+  auto expected = Search(locations, reader);
+  size_t next = 0;
+  BulkSearch(locations, {&first, &second},
+             [&](size_t index, const PathLocation* result) {
+               if (index != next++)
+                 throw std::logic_error("Results should be in the order of the input");
+               auto found = expected.find(locations[index]);
+               if ((found == expected.cend()) != (result == nullptr))
+                 throw std::logic_error("Bulk search should find the same locations as search");
+               if (result && (result->edges.size() != found->second.edges.size() ||
+                              !result->shares_edges(found->second)))
+                 throw std::logic_error("Bulk search should find the same edges as search");
+             },
+             PassThroughEdgeFilter, PassThroughNodeFilter, false, 3);
+  if (next != locations.size())
+    throw std::logic_error("Every location should have a result");
+
+  // failures are passed back to the caller
+  try {
+    BulkSearch(locations, {&first, &second},
+               [](size_t index, const PathLocation*) {
+                 if (index == 5)
+                   throw std::runtime_error("stop");
+               },
+               PassThroughEdgeFilter, PassThroughNodeFilter, false, 3);
+    throw std::logic_error("Bulk search should pass on failures");
+  } catch (const std::runtime_error& e) {
+    if (std::string(e.what()) != "stop")
+      throw std::logic_error("Bulk search should pass on the original failure");
+  }
+
+  // it checks for an interrupt as it hands back each chunk of results
+  size_t polls = 0;
+  std::function<void()> interrupt = [&polls]() {
+    if (++polls == 2)
+      throw std::runtime_error("interrupted");
+  };
+  size_t handed_back = 0;
+  try {
+    BulkSearch(locations, {&first, &second},
+               [&handed_back](size_t, const PathLocation*) { ++handed_back; },
+               PassThroughEdgeFilter, PassThroughNodeFilter, false, 3, &interrupt);
+    throw std::logic_error("Bulk search should stop when interrupted");
+  } catch (const std::runtime_error& e) {
+    if (std::string(e.what()) != "interrupted" || handed_back != 3)
+      throw std::logic_error("Bulk search should stop at the interrupt");
+  }
+}
+
+void test_snap_cache() {
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", tile_dir);
+  valhalla::baldr::GraphReader reader(conf);
+
+  Location x{a.second.MidPoint(d.second)};
+  auto correlated = Search({x}, reader).at(x);
+  SnapCache cache(1 << 20, 6);
+  if (cache.Get(x, 1, reader) || cache.misses() != 1)
+    throw std::logic_error("Nothing should be cached yet");
+  cache.Put(x, 1, correlated, reader);
+
+  // close enough locations with the same filters are the same
+  Location y{{x.latlng_.lng() + 1e-7f, x.latlng_.lat()}};
+  const auto* cached = cache.Get(y, 1, reader);
+  if (!cached || !cached->shares_edges(correlated) || cache.hits() != 1)
+    throw std::logic_error("Should have found the cached location");
+
+  // but not with different filters or search parameters
+  y.radius_ = 10;
+  if (cache.Get(x, 2, reader) || cache.Get(y, 1, reader) || cache.misses() != 3)
+    throw std::logic_error("Should not have found a location searched for differently");
+
+  // dont go over the memory limit
+  size_t per_entry = cache.memory();
+  SnapCache small(per_entry * 2, 6);
+  for (unsigned long radius = 0; radius < 3; ++radius) {
+    y.radius_ = radius;
+    small.Put(y, 1, correlated, reader);
+  }
+  y.radius_ = 0;
+  if (small.size() != 2 || small.memory() > per_entry * 2 || small.Get(y, 1, reader))
+    throw std::logic_error("The least recently used location should have been evicted");
+
+  // when the tiles change everything is dropped
+  boost::property_tree::ptree other;
+  other.put("tile_dir", "test/search_tiles_missing");
+  valhalla::baldr::GraphReader other_reader(other);
+  if (cache.Get(x, 1, other_reader) || cache.size() != 0)
+    throw std::logic_error("The cache should be dropped when the tiles change");
+}
+
+void test_stored_reachability() {
+  // store a reach in the tile that differs from what expanding the graph would find
+  {
+    using namespace valhalla::mjolnir;
+    GraphTileBuilder tile(tile_dir, tile_id, false);
+    std::vector<NodeInfo> nodes;
+    std::vector<DirectedEdge> edges;
+    for (uint32_t i = 0; i < tile.header()->nodecount(); ++i) {
+      nodes.push_back(tile.node(i));
+    }
+    for (uint32_t i = 0; i < tile.header()->directededgecount(); ++i) {
+      edges.push_back(tile.directededge(i));
+      edges.back().set_reach(2);
+    }
+    tile.Update(nodes, edges);
+  }
+
+  PointLL ob(b.second.first - .001f, b.second.second - .01f);
+
+  // without asking for it the graph is expanded as before
+  search({ob, Location::StopType::BREAK, 5, 0}, 2, 4);
+
+  // the reach in the tile is used instead of expanding the graph
+  search({ob, Location::StopType::BREAK, 5, 0}, 2, 2, true);
+  search({ob, Location::StopType::BREAK, 1, 0}, 2, 2, true);
+}
+
+void test_built_reachability() {
+  using namespace valhalla::mjolnir;
+
+  // a line of nodes where the middle edge is one way to the east
+  //    p0 <-0/1-> p1 -2/3-> p2 <-4/5-> p3
+  const std::string reach_dir = "test/reach_tiles";
+  if (boost::filesystem::is_directory(reach_dir)) {
+    boost::filesystem::remove_all(reach_dir);
+  }
+  {
+    GraphTileBuilder tile(reach_dir, tile_id, false);
+    std::vector<PointLL> points{{.01, .01}, {.02, .01}, {.03, .01}, {.04, .01}};
+    std::vector<uint32_t> edge_counts{1, 2, 2, 1};
+    // start, end, forward access, reverse access
+    std::vector<std::tuple<uint32_t, uint32_t, uint32_t, uint32_t>> edges{
+        std::make_tuple(0, 1, kAllAccess, kAllAccess), std::make_tuple(1, 0, kAllAccess, kAllAccess),
+        std::make_tuple(1, 2, kAllAccess, 0),          std::make_tuple(2, 1, 0, kAllAccess),
+        std::make_tuple(2, 3, kAllAccess, kAllAccess), std::make_tuple(3, 2, kAllAccess, kAllAccess)};
+    uint32_t edge_index = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+      NodeInfo node;
+      node.set_latlng(points[i]);
+      node.set_access(kAllAccess);
+      node.set_edge_index(edge_index);
+      node.set_edge_count(edge_counts[i]);
+      edge_index += edge_counts[i];
+      tile.nodes().emplace_back(std::move(node));
+    }
+    for (const auto& e : edges) {
+      const auto& u = points[std::get<0>(e)];
+      const auto& v = points[std::get<1>(e)];
+      bool forward = std::get<0>(e) < std::get<1>(e);
+      GraphId start(tile_id.tileid(), tile_id.level(), std::get<0>(e));
+      GraphId end(tile_id.tileid(), tile_id.level(), std::get<1>(e));
+      DirectedEdgeBuilder edge({}, end, forward, u.Distance(v), 1, 1, 1, {}, {}, 0, false, 0, 0);
+      edge.set_forwardaccess(std::get<2>(e));
+      edge.set_reverseaccess(std::get<3>(e));
+      // the opposing edges share their edge info
+      bool added;
+      std::vector<PointLL> shape{forward ? u : v, forward ? v : u};
+      edge.set_edgeinfo_offset(tile.AddEdgeInfo(std::min(std::get<0>(e), std::get<1>(e)),
+                                                forward ? start : end, forward ? end : start, 123,
+                                                shape, {}, 0, added));
+      tile.directededges().emplace_back(std::move(edge));
+    }
+    tile.StoreTileData();
+  }
+
+  // let the validator store the reach of each edge
+  boost::property_tree::ptree conf;
+  conf.put("mjolnir.tile_dir", reach_dir);
+  conf.put("concurrency", 1);
+  valhalla::mjolnir::GraphValidator::Validate(conf);
+
+  // from p1 you can get everywhere but from p2 or p3 you cant get past the one way
+  GraphReader reader(conf.get_child("mjolnir"));
+  const GraphTile* tile = reader.GetGraphTile(tile_id);
+  std::vector<uint32_t> expected{4, 4, 2, 4, 2, 2};
+  for (uint32_t i = 0; i < expected.size(); ++i) {
+    const auto* edge = tile->directededge(i);
+    if (!edge->has_reach() || edge->forward_reach() != expected[i])
+      throw std::logic_error("Expected reach " + std::to_string(expected[i]) + " for edge " +
+                             std::to_string(i) + " but got " +
+                             std::to_string(edge->forward_reach()));
+  }
+
+  // the validator also binned the three edges into the tile
+  if (tile->GetBin(0, 0).size() != 3)
+    throw std::logic_error("Expected the 3 edges in the first bin but got " +
+                           std::to_string(tile->GetBin(0, 0).size()));
+}
+
 } // namespace
 
 int main() {
@@ -301,5 +514,13 @@ int main() {
 
   suite.test(TEST_CASE(test_reachability_radius));
 
+  suite.test(TEST_CASE(test_bulk_search));
+
+  suite.test(TEST_CASE(test_snap_cache));
+
+  suite.test(TEST_CASE(test_stored_reachability));
+
+  suite.test(TEST_CASE(test_built_reachability));
+
   return suite.tear_down();
 }
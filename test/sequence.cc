@@ -1,6 +1,8 @@
 #include "midgard/sequence.h"
 #include "test.h"
+#include <algorithm>
 #include <cstdint>
+#include <random>
 
 using namespace valhalla::midgard;
 
@@ -72,6 +74,36 @@ void test_iterator() {
     throw std::runtime_error("Pre-decrement operator wasn't right");
 }
 
+void test_parallel_sort() {
+  // a bunch of nodes in random order with some repeats
+  std::vector<osm_node> nodes;
+  std::default_random_engine generator(17);
+  std::uniform_int_distribution<uint64_t> distribution(0, 200000);
+  for (size_t i = 0; i < 300000; ++i) {
+    nodes.push_back({distribution(generator), 0.f, 0.f, static_cast<uint32_t>(i)});
+  }
+  auto less_than = [](const osm_node& a, const osm_node& b) { return a.id < b.id; };
+  auto expected = nodes;
+  std::stable_sort(expected.begin(), expected.end(), less_than);
+
+  // sorted in memory by several threads and sorted in runs which are merged
+  for (size_t buffer_size : {nodes.size(), static_cast<size_t>(70000)}) {
+    {
+      sequence<osm_node> sequence("nodes.nd", true);
+      for (const auto& node : nodes)
+        sequence.push_back(node);
+      sequence.sort(less_than, buffer_size, 3);
+    }
+    sequence<osm_node> sequence("nodes.nd", false);
+    if (sequence.size() != expected.size())
+      throw std::runtime_error("Sorting should not change the size");
+    for (size_t i = 0; i < expected.size(); ++i) {
+      if ((*sequence[i]).id != expected[i].id)
+        throw std::runtime_error("Found wrong node at: " + std::to_string(i));
+    }
+  }
+}
+
 int main() {
   test::suite suite("sequence");
 
@@ -79,5 +111,7 @@ int main() {
 
   suite.test(TEST_CASE(test_iterator));
 
+  suite.test(TEST_CASE(test_parallel_sort));
+
   return suite.tear_down();
 }
@@ -22,7 +22,7 @@ void ExitToTest() {
 
   node.set_exit_to(true);
 
-  osmdata.node_exit_to[node.osmid] = "US 11;To I 81;Carlisle;Harrisburg";
+  osmdata.node_exit_to.set(node.osmid, "US 11;To I 81;Carlisle;Harrisburg");
 
   std::vector<SignInfo> exitsigns;
   exitsigns = GraphBuilder::CreateExitSignInfoList(node, way, osmdata, fork, forward);
@@ -41,7 +41,7 @@ void ExitToTest() {
                              std::to_string(exitsigns.size()));
 
   exitsigns.clear();
-  osmdata.node_exit_to[node.osmid] = "US 11;Toward I 81;Carlisle;Harrisburg";
+  osmdata.node_exit_to.set(node.osmid, "US 11;Toward I 81;Carlisle;Harrisburg");
 
   exitsigns = GraphBuilder::CreateExitSignInfoList(node, way, osmdata, fork, forward);
 
@@ -57,7 +57,7 @@ void ExitToTest() {
     throw std::runtime_error("US 11;Toward I 81;Carlisle;Harrisburg failed to be parsed.");
 
   exitsigns.clear();
-  osmdata.node_exit_to[node.osmid] = "I 95 To I 695";
+  osmdata.node_exit_to.set(node.osmid, "I 95 To I 695");
 
   exitsigns = GraphBuilder::CreateExitSignInfoList(node, way, osmdata, fork, forward);
 
@@ -74,7 +74,7 @@ void ExitToTest() {
     throw std::runtime_error("I 95 To I 695 failed to be parsed.");
 
   exitsigns.clear();
-  osmdata.node_exit_to[node.osmid] = "I 495 Toward I 270";
+  osmdata.node_exit_to.set(node.osmid, "I 495 Toward I 270");
 
   exitsigns = GraphBuilder::CreateExitSignInfoList(node, way, osmdata, fork, forward);
 
@@ -91,8 +91,8 @@ void ExitToTest() {
     throw std::runtime_error("I 495 Toward I 270 failed to be parsed.");
 
   exitsigns.clear();
-  osmdata.node_exit_to[node.osmid] =
-      "I 495 Toward I 270 To I 95"; // default to toward.  Punt on parsing.
+  osmdata.node_exit_to.set(node.osmid,
+                          "I 495 Toward I 270 To I 95"); // default to toward.  Punt on parsing.
 
   exitsigns = GraphBuilder::CreateExitSignInfoList(node, way, osmdata, fork, forward);
 
@@ -0,0 +1,78 @@
+#include "test.h"
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "baldr/graphreader.h"
+#include "midgard/sequence.h"
+
+using namespace valhalla::baldr;
+using namespace valhalla::midgard;
+
+namespace {
+
+const std::string tile_file = "test/data/bin_tiles/no_bin/2/000/744/885.gph";
+const std::string extract_file = "test/tile_extract_with_index.tar";
+
+// writes a ustar entry padded out to whole blocks
+void write_entry(std::ofstream& out, const std::string& name, const std::string& data) {
+  tar::header_t header{};
+  strncpy(header.name, name.c_str(), sizeof(header.name) - 1);
+  snprintf(header.mode, sizeof(header.mode), "%07o", 0644);
+  snprintf(header.size, sizeof(header.size), "%011o", static_cast<unsigned>(data.size()));
+  header.typeflag = '0';
+  memcpy(header.magic, "ustar", 6);
+  memcpy(header.version, "00", 2);
+  memset(header.chksum, ' ', sizeof(header.chksum));
+  unsigned sum = 0;
+  for (size_t i = 0; i < sizeof(header); ++i) {
+    sum += reinterpret_cast<const unsigned char*>(&header)[i];
+  }
+  snprintf(header.chksum, sizeof(header.chksum), "%06o", sum);
+  out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  out << data << std::string((sizeof(header) - data.size() % sizeof(header)) % sizeof(header), '\0');
+}
+
+void TestIndexedExtract() {
+  std::ifstream in(tile_file, std::ios::binary);
+  std::stringstream tile;
+  tile << in.rdbuf();
+  GraphId tile_id = GraphTile::GetTileId(tile_file);
+
+  // the index comes first and points at the tile in the next entry, the tile gets a name that
+  // the scan wouldnt understand so that we know the index was used to find it
+  struct {
+    uint64_t offset;
+    uint32_t tile_id;
+    uint32_t size;
+  } entry{3 * sizeof(tar::header_t), static_cast<uint32_t>(tile_id.value),
+          static_cast<uint32_t>(tile.str().size())};
+  {
+    std::ofstream out(extract_file, std::ios::binary);
+    write_entry(out, "index.bin", std::string(reinterpret_cast<const char*>(&entry), sizeof(entry)));
+    write_entry(out, "not_a_tile_name", tile.str());
+    out << std::string(2 * sizeof(tar::header_t), '\0');
+  }
+
+  boost::property_tree::ptree conf;
+  conf.put("tile_dir", "test/data/this_is_not_a_tile_dir");
+  conf.put("tile_extract", extract_file);
+  GraphReader reader(conf);
+  if (reader.GetTileSet() != std::unordered_set<GraphId>{tile_id})
+    throw std::runtime_error("The extract should have exactly the indexed tile");
+  const GraphTile* graph_tile = reader.GetGraphTile(tile_id);
+  if (graph_tile == nullptr || graph_tile->header()->graphid() != tile_id)
+    throw std::runtime_error("The indexed tile should be loaded from the extract");
+}
+
+} // namespace
+
+int main() {
+  test::suite suite("tileextract");
+
+  suite.test(TEST_CASE(TestIndexedExtract));
+
+  return suite.tear_down();
+}
@@ -7,7 +7,10 @@
 
 #include "baldr/graphid.h"
 #include "baldr/graphreader.h"
+#include "meili/map_matcher_factory.h"
 #include "meili/traffic_segment_matcher.h"
+#include "sif/autocost.h"
+#include "worker.h"
 
 #if !defined(VALHALLA_SOURCE_DIR)
 #define VALHALLA_SOURCE_DIR
@@ -159,6 +162,141 @@ void test_matcher() {
   }
 }
 
+// the binary interface has no per request options so we bake the breakage distance of the
+// test cases into the config instead
+boost::property_tree::ptree batch_config() {
+  std::stringstream conf_json;
+  conf_json << R"({
+      "mjolnir":{"tile_dir":"test/traffic_matcher_tiles"},
+      "meili":{"customizable": ["breakage_distance"],
+               "mode":"auto","grid":{"cache_size":100240,"size":500},
+               "default":{"beta":3,"breakage_distance":10000,"geometry":false,"gps_accuracy":5.0,"interpolation_distance":10,
+               "max_route_distance_factor":5,"max_route_time_factor":5,"max_search_radius":100,"route":true,
+               "search_radius":50,"sigma_z":4.07,"turn_penalty_factor":200}}
+    })";
+  boost::property_tree::ptree conf;
+  rapidjson::read_json(conf_json, conf);
+  conf.get_child("mjolnir").put("tile_dir", VALHALLA_SOURCE_DIR "test/traffic_matcher_tiles");
+  return conf;
+}
+
+std::vector<meili::probe_batch_t> batches() {
+  std::vector<meili::probe_batch_t> batches;
+  for (const auto& test_case : test_cases) {
+    std::stringstream json_ss;
+    json_ss << test_case.first;
+    boost::property_tree::ptree request;
+    rapidjson::read_json(json_ss, request);
+    batches.emplace_back();
+    for (const auto& point : request.get_child("trace")) {
+      batches.back().lats.push_back(point.second.get<double>("lat"));
+      batches.back().lons.push_back(point.second.get<double>("lon"));
+      batches.back().times.push_back(point.second.get<double>("time"));
+    }
+  }
+  return batches;
+}
+
+void test_batch_matcher() {
+  // the json and binary interfaces should give the same answers
+  testable_matcher matcher(batch_config());
+  auto probes = batches();
+  std::vector<meili::packed_segment_t> packed;
+  for (size_t i = 0; i < probes.size(); ++i) {
+    matcher.match(test_cases[i].first);
+    const auto& b_segs = matcher.segments;
+    // do it twice so that the second time goes through the reused buffers
+    for (int j = 0; j < 2; ++j) {
+      auto count = matcher.match(probes[i], packed);
+      if (count != packed.size() || count != b_segs.size())
+        throw std::logic_error("wrong number of packed segments matched");
+      for (size_t k = 0; k < count; ++k) {
+        const auto& a = packed[k];
+        const auto& b = b_segs[k];
+        if (a.segment_id != b.segment_id.value)
+          throw std::logic_error("segment id mismatch");
+        if (a.start_time != b.start_time || a.end_time != b.end_time)
+          throw std::logic_error("time mismatch");
+        if (a.length != b.length || a.queue_length != b.queue_length)
+          throw std::logic_error("length mismatch");
+      }
+    }
+    // and the json interface should be unaffected by the binary one sharing the matcher
+    matcher.match(test_cases[i].first);
+    if (matcher.segments.size() != packed.size())
+      throw std::logic_error("json segments changed after binary matching");
+    for (size_t k = 0; k < packed.size(); ++k) {
+      if (matcher.segments[k].segment_id.value != packed[k].segment_id ||
+          matcher.segments[k].start_time != packed[k].start_time ||
+          matcher.segments[k].end_time != packed[k].end_time)
+        throw std::logic_error("json segment mismatch after binary matching");
+    }
+  }
+
+  // the columns must line up
+  meili::probe_batch_t bad = probes.front();
+  bad.times.pop_back();
+  test::assert_throw<std::runtime_error>([&]() { matcher.match(bad, packed); },
+                                         "mismatched columns should throw");
+}
+
+void test_route_cache() {
+  // matching with the route cache should find the same routes at the same costs as the searches
+  meili::MapMatcherFactory factory(batch_config());
+  valhalla::valhalla_request_t request;
+  request.parse(R"({"costing":"auto"})", valhalla::odin::DirectionsOptions::trace_route);
+  std::shared_ptr<meili::MapMatcher> searched(
+      factory.Create(odin::Costing::auto_, request.options));
+  test::assert_bool(!factory.routecache(), "the test config should not enable the route cache");
+
+  // the same matcher but with its own cache
+  const auto config = factory.MergeConfig(request.options);
+  sif::cost_ptr_t mode_costing[meili::MapMatcherFactory::kModeCostingCount];
+  auto costing = sif::CreateAutoCost(odin::Costing::auto_, request.options);
+  const auto mode = costing->travel_mode();
+  mode_costing[static_cast<size_t>(mode)] = costing;
+  auto cache = std::make_shared<meili::RouteCache>(1000);
+  meili::MapMatcher cached(config, *factory.graphreader(), factory.candidatequery(), mode_costing,
+                           mode, cache, 1);
+
+  const auto accuracy = config.get<float>("gps_accuracy");
+  const auto radius = config.get<float>("search_radius");
+  for (const auto& probe : batches()) {
+    std::vector<meili::Measurement> measurements;
+    for (size_t i = 0; i < probe.size(); ++i) {
+      measurements.emplace_back(midgard::PointLL{probe.lons[i], probe.lats[i]}, accuracy, radius,
+                                probe.times[i]);
+    }
+    const auto expected_matches = searched->OfflineMatch(measurements);
+    const auto& expected = expected_matches.front();
+    // the first time fills the cache and the second time is answered by it
+    for (int pass = 0; pass < 2; ++pass) {
+      const auto actual_matches = cached.OfflineMatch(measurements);
+      const auto& actual = actual_matches.front();
+      if (std::fabs(expected.score - actual.score) > 1e-3f * std::max(1.f, expected.score))
+        throw std::logic_error("cached routes cost something else");
+      if (expected.results.size() != actual.results.size())
+        throw std::logic_error("wrong number of match results with the route cache");
+      for (size_t i = 0; i < expected.results.size(); ++i) {
+        const auto& a = expected.results[i];
+        const auto& b = actual.results[i];
+        if (a.edgeid != b.edgeid || std::fabs(a.distance_along - b.distance_along) > 1e-3f)
+          throw std::logic_error("match results differ with the route cache");
+      }
+      if (expected.segments.size() != actual.segments.size())
+        throw std::logic_error("wrong number of route segments with the route cache");
+      for (size_t i = 0; i < expected.segments.size(); ++i) {
+        if (expected.segments[i].edgeid != actual.segments[i].edgeid ||
+            std::fabs(expected.segments[i].source - actual.segments[i].source) > 1e-3f ||
+            std::fabs(expected.segments[i].target - actual.segments[i].target) > 1e-3f)
+          throw std::logic_error("routes differ with the route cache");
+      }
+    }
+  }
+  if (cache->hits() == 0)
+    throw std::logic_error("the route cache should have answered some transitions");
+}
+
 } // namespace
 
 int main() {
@@ -166,5 +304,9 @@ int main() {
 
   suite.test(TEST_CASE(test_matcher));
 
+  suite.test(TEST_CASE(test_batch_matcher));
+
+  suite.test(TEST_CASE(test_route_cache));
+
   return suite.tear_down();
 }
@@ -55,9 +55,10 @@ public:
   void set_value(const uint64_t v);
 
   /**
-   * operator < - for sorting. Sort by edge Id.
+   * operator < - for sorting. Sort by edge Id, then by type, modes and value so that the
+   * order within an edge does not depend on the order the restrictions were added in.
    * @param  other  Other access restriction to compare to.
-   * @return  Returns true if edgeid < other edgeid.
+   * @return  Returns true if this restriction sorts before the other.
    */
   bool operator<(const AccessRestriction& other) const;
 
@@ -72,6 +73,189 @@ protected:
                    // different meanings per type
 };
 
+/**
+ * Summary of the access restrictions of one directed edge that apply to trucks: the smallest
+ * limit of each dimension and the hazmat values it requires. Tiles hold one per edge that has
+ * truck restrictions, sorted by edge index, so that TruckCost can check an edge with a single
+ * record instead of walking its access restrictions. Restrictions that cannot be summarized
+ * (timed ones or limits too large to store) mark the summary incomplete, the access
+ * restrictions of such edges must be checked instead.
+ */
+class TruckRestriction {
+public:
+  /**
+   * Constructor of a summary without any restrictions.
+   * @param  edgeindex  Directed edge index within the tile.
+   * @param  complete   False if the access restrictions must be checked instead.
+   */
+  TruckRestriction(const uint32_t edgeindex, const bool complete = true);
+
+  /**
+   * Get the internal edge index to which this summary applies.
+   * @return  Returns the directed edge index within the tile.
+   */
+  uint32_t edgeindex() const {
+    return edgeindex_;
+  }
+
+  /**
+   * Does the summary hold all of the truck restrictions of the edge.
+   * @return  Returns false if the access restrictions must be checked instead.
+   */
+  bool complete() const {
+    return !incomplete_;
+  }
+
+  /**
+   * Adds an access restriction to the summary. Restrictions that do not apply to trucks are
+   * ignored.
+   * @param  restriction  Access restriction of the same directed edge.
+   */
+  void Add(const AccessRestriction& restriction);
+
+  /**
+   * Checks if a truck is allowed on the edge. Only valid when the summary is complete. Limits
+   * are compared the same way as TruckCost compares the access restriction values.
+   * @param  height     Truck height (meters).
+   * @param  width      Truck width (meters).
+   * @param  length     Truck length (meters).
+   * @param  weight     Truck weight (metric tons).
+   * @param  axle_load  Truck axle load (metric tons).
+   * @param  hazmat     Does the truck carry hazardous materials.
+   * @return  Returns true if none of the restrictions exclude the truck.
+   */
+  bool Allowed(const float height,
+               const float width,
+               const float length,
+               const float weight,
+               const float axle_load,
+               const bool hazmat) const {
+    return !(hazmat_ & (hazmat ? kDeniesHazmat : kRequiresHazmat)) &&
+           !Exceeds(height, max_height_) && !Exceeds(width, max_width_) &&
+           !Exceeds(length, max_length_) && !Exceeds(weight, max_weight_) &&
+           !Exceeds(axle_load, max_axle_load_);
+  }
+
+  /**
+   * operator < - for sorting. Sort by edge index.
+   * @param  other  Other summary to compare to.
+   * @return  Returns true if edgeindex < other edgeindex.
+   */
+  bool operator<(const TruckRestriction& other) const {
+    return edgeindex() < other.edgeindex();
+  }
+
+protected:
+  // Limits are in hundredths like the access restriction values, this one means no limit
+  static constexpr uint16_t kNoLimit = 0xffff;
+
+  // Hazmat restriction values seen on the edge, trucks that differ from either are denied
+  static constexpr uint32_t kDeniesHazmat = 1;
+  static constexpr uint32_t kRequiresHazmat = 2;
+
+  static bool Exceeds(const float dimension, const uint16_t limit) {
+    return limit != kNoLimit && dimension > static_cast<float>(limit * 0.01);
+  }
+
+  uint32_t edgeindex_ : 22; // Directed edge index. Max index is:
+                            // kMaxTileEdgeCount in nodeinfo.h: 22 bits.
+  uint32_t incomplete_ : 1; // Check the access restrictions instead
+  uint32_t hazmat_ : 2;     // Hazmat values that deny trucks
+  uint32_t spare_ : 7;
+
+  uint16_t max_height_;    // Smallest limits in hundredths of the unit
+  uint16_t max_width_;     // TruckCost uses for the dimension
+  uint16_t max_length_;
+  uint16_t max_weight_;
+  uint16_t max_axle_load_;
+  uint16_t spare2_;
+};
+
+static_assert(sizeof(TruckRestriction) == 16, "TruckRestriction is stored in tiles as 16 bytes");
+
+/**
+ * A view of the access restrictions of one directed edge that apply to a set of access modes.
+ * It points into the restrictions of a graph tile so it is only valid while the tile is. Use
+ * this instead of copying the restrictions out when they are only iterated over.
+ */
+class AccessRestrictionView {
+public:
+  class iterator {
+  public:
+    iterator(const AccessRestriction* current, const AccessRestriction* end, const uint32_t access)
+        : current_(current), end_(end), access_(access) {
+      skip();
+    }
+    const AccessRestriction& operator*() const {
+      return *current_;
+    }
+    const AccessRestriction* operator->() const {
+      return current_;
+    }
+    iterator& operator++() {
+      ++current_;
+      skip();
+      return *this;
+    }
+    bool operator==(const iterator& other) const {
+      return current_ == other.current_;
+    }
+    bool operator!=(const iterator& other) const {
+      return current_ != other.current_;
+    }
+
+  protected:
+    // move past the restrictions for other modes
+    void skip() {
+      while (current_ != end_ && !(current_->modes() & access_)) {
+        ++current_;
+      }
+    }
+
+    const AccessRestriction* current_;
+    const AccessRestriction* end_;
+    uint32_t access_;
+  };
+
+  /**
+   * Constructor of an empty view.
+   */
+  AccessRestrictionView() : begin_(nullptr), end_(nullptr), access_(0) {
+  }
+
+  /**
+   * Constructor.
+   * @param  begin   First access restriction of the edge.
+   * @param  end     One past the last access restriction of the edge.
+   * @param  access  Access modes that the restrictions must apply to.
+   */
+  AccessRestrictionView(const AccessRestriction* begin,
+                        const AccessRestriction* end,
+                        const uint32_t access)
+      : begin_(begin), end_(end), access_(access) {
+  }
+
+  iterator begin() const {
+    return iterator(begin_, end_, access_);
+  }
+  iterator end() const {
+    return iterator(end_, end_, access_);
+  }
+
+  /**
+   * Are there no restrictions for the access modes.
+   * @return  Returns true if there are none.
+   */
+  bool empty() const {
+    return begin() == end();
+  }
+
+protected:
+  const AccessRestriction* begin_;
+  const AccessRestriction* end_;
+  uint32_t access_;
+};
+
 } // namespace baldr
 } // namespace valhalla
 
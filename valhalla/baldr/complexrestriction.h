@@ -221,6 +221,99 @@ protected:
   // TODO - Maybe but need to consider the fact that we may add more date time data.
 };
 
+/**
+ * A view of the complex restrictions of a graph tile that end (forward) or start (reverse) at
+ * one edge and apply to a set of access modes. Complex restrictions vary in size so they are
+ * walked in place rather than copied out. The view points into the tile so it is only valid
+ * while the tile is.
+ */
+class ComplexRestrictionView {
+public:
+  class iterator {
+  public:
+    iterator(const char* current,
+             const char* end,
+             const bool forward,
+             const GraphId& id,
+             const uint64_t modes)
+        : current_(current), end_(end), forward_(forward), id_(id), modes_(modes) {
+      skip();
+    }
+    ComplexRestriction* operator*() const {
+      return reinterpret_cast<ComplexRestriction*>(const_cast<char*>(current_));
+    }
+    iterator& operator++() {
+      current_ += (**this)->SizeOf();
+      skip();
+      return *this;
+    }
+    bool operator==(const iterator& other) const {
+      return current_ == other.current_;
+    }
+    bool operator!=(const iterator& other) const {
+      return current_ != other.current_;
+    }
+
+  protected:
+    // move past the restrictions for other edges or modes
+    void skip() {
+      while (current_ < end_) {
+        const ComplexRestriction* cr = **this;
+        if ((forward_ ? cr->to_graphid() : cr->from_graphid()) == id_ && (cr->modes() & modes_)) {
+          return;
+        }
+        current_ += cr->SizeOf();
+      }
+      current_ = end_;
+    }
+
+    const char* current_;
+    const char* end_;
+    bool forward_;
+    GraphId id_;
+    uint64_t modes_;
+  };
+
+  /**
+   * Constructor.
+   * @param  begin    Start of the tile's forward or reverse complex restrictions.
+   * @param  size     Size in bytes of those restrictions.
+   * @param  forward  true if these are the forward restrictions, matched on their to edge.
+   *                  Reverse restrictions are matched on their from edge.
+   * @param  id       Edge Id to match.
+   * @param  modes    Access modes that the restrictions must apply to.
+   */
+  ComplexRestrictionView(const char* begin,
+                         const size_t size,
+                         const bool forward,
+                         const GraphId& id,
+                         const uint64_t modes)
+      : begin_(begin), end_(begin + size), forward_(forward), id_(id), modes_(modes) {
+  }
+
+  iterator begin() const {
+    return iterator(begin_, end_, forward_, id_, modes_);
+  }
+  iterator end() const {
+    return iterator(end_, end_, forward_, id_, modes_);
+  }
+
+  /**
+   * Are there no matching restrictions.
+   * @return  Returns true if there are none.
+   */
+  bool empty() const {
+    return begin() == end();
+  }
+
+protected:
+  const char* begin_;
+  const char* end_;
+  bool forward_;
+  GraphId id_;
+  uint64_t modes_;
+};
+
 } // namespace baldr
 } // namespace valhalla
 
@@ -2,8 +2,12 @@
 #define VALHALLA_BALDR_CONNECTIVITY_MAP_H_
 
 #include <valhalla/baldr/pathlocation.h>
+#include <valhalla/midgard/pointll.h>
+#include <valhalla/midgard/sequence.h>
+#include <valhalla/midgard/tiles.h>
 
 #include <cstdint>
+#include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
@@ -14,10 +18,22 @@ namespace baldr {
 class connectivity_map_t {
 public:
   /**
-   * Constructs the connectivity map
-   * @param pt   the ptree sub child labeled mjolnir in the valhalla json config
+   * Constructs the connectivity map. If the config points at a connectivity_map file
+   * which exists and was made from the tiles that exist now it is memory mapped so that
+   * processes share it and nothing needs to be computed, otherwise the colors are
+   * computed from the tiles that exist
+   * @param pt        the ptree sub child labeled mjolnir in the valhalla json config
+   * @param use_file  whether to load the connectivity_map file if there is one
    */
-  connectivity_map_t(const boost::property_tree::ptree& pt);
+  connectivity_map_t(const boost::property_tree::ptree& pt, bool use_file = true);
+
+  /**
+   * Writes the connectivity map to a compact binary file which can be memory mapped,
+   * it holds one color per possible tile at each level
+   *
+   * @param file_name  the file to write the map to
+   */
+  void write(const std::string& file_name) const;
 
   /**
    * Returns the color for the given graphid
@@ -55,9 +71,30 @@ public:
   std::vector<size_t> to_image(const uint32_t hierarchy_level) const;
 
 private:
+  /**
+   * Returns the color of a tile, 0 if the tile doesnt exist
+   */
+  uint32_t color(uint32_t hierarchy_level, uint32_t tile_id) const;
+
+  /**
+   * Returns the tiles used at the given hierarchy level
+   */
+  const midgard::Tiles<midgard::PointLL>& level_tiles(uint32_t hierarchy_level) const;
+
+  // the colors of a level, one per possible tile id where 0 means the tile doesnt exist
+  struct level_colors_t {
+    const uint32_t* colors;
+    uint32_t count;
+  };
+
   uint32_t transit_level;
-  // this is a map(tile_level, map(tile_id, tile_color))
-  std::unordered_map<uint32_t, std::unordered_map<uint32_t, size_t>> colors;
+  // identifies the tiles the colors are for
+  uint64_t tile_set;
+  // this is a map(tile_level, tile colors)
+  std::unordered_map<uint32_t, level_colors_t> colors;
+  // what the colors point into, either the computed colors or the memory mapped file
+  std::vector<std::vector<uint32_t>> computed;
+  midgard::mem_map<char> file;
 };
 } // namespace baldr
 } // namespace valhalla
@@ -768,6 +768,32 @@ public:
    */
   void set_shoulder(const bool shoulder);
 
+  /**
+   * Was the reachability of this edge computed when building the tiles. If not
+   * the reach below is 0 and has to be found by expanding the graph.
+   * @return  Returns true if the edge has reachability stored
+   */
+  bool has_reach() const {
+    return has_reach_;
+  }
+
+  /**
+   * Get the number of nodes, including the end node, that can be reached from
+   * the end node of this edge with kReachAccess. Values are capped at
+   * kMaxStoredReach so a value equal to it means at least that many.
+   * @return  Returns the forward reach
+   */
+  uint32_t forward_reach() const {
+    return forward_reach_;
+  }
+
+  /**
+   * Sets the reachability of this edge. Values larger than kMaxStoredReach are
+   * capped.
+   * @param  forward   Number of nodes reachable from the end node
+   */
+  void set_reach(const uint32_t forward);
+
   /**
    * Get if cyclists should dismount their bikes along this edge
    * @return  Returns true if edge is a dismount edge, false if it is not.
@@ -1157,7 +1183,8 @@ protected:
   uint64_t classification_ : 3; // Classification/importance of the road/path
   uint64_t surface_ : 3;        // representation of smoothness
   uint64_t shoulder_ : 1;       // Does the edge have a shoulder?
-  uint64_t spare2_ : 7;
+  uint64_t forward_reach_ : 6;  // Nodes reachable from the end node (kReachAccess)
+  uint64_t has_reach_ : 1;      // Was reachability computed for this edge
   uint64_t use_sidepath_ : 1; // Is there a cycling path to the side that should be preferred?
   uint64_t dismount_ : 1;     // Do you need to dismount when biking on this edge?
   uint64_t density_ : 4;      // Density along the edge
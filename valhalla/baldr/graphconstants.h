@@ -30,6 +30,11 @@ constexpr uint16_t kAllAccess = 4095;
 constexpr uint32_t kVehicularAccess = kAutoAccess | kTruckAccess | kMopedAccess | kMotorcycleAccess |
                                       kTaxiAccess | kBusAccess | kHOVAccess;
 
+// Reachability (the number of nodes that can be reached from or can reach an edge) is computed
+// when building tiles for this access type and stored in each directed edge up to a maximum
+constexpr uint16_t kReachAccess = kAutoAccess;
+constexpr uint32_t kMaxStoredReach = 63;
+
 // Maximum number of transit records per tile and other max. transit
 // field values.
 constexpr uint32_t kMaxTransitDepartures = 16777215;
@@ -205,10 +205,10 @@ public:
    * @param   forward - do we want the restrictions in reverse order?
    * @param   id - edge id
    * @param   modes - access modes
-   * @return  Returns the vector of complex restrictions in the order requested
+   * @return  Returns a view of the complex restrictions in the order requested
    *          based on the id and modes.
    */
-  std::vector<ComplexRestriction*>
+  ComplexRestrictionView
   GetRestrictions(const bool forward, const GraphId id, const uint64_t modes) const;
 
   /**
@@ -357,10 +357,20 @@ public:
    * @param   edgeid  Directed edge Id.
    * @param   access  Access.  Used to obtain the restrictions for the access
    *                   that we are interested in (see graphconstants.h)
-   * @return  Returns a list (vector) of AccessRestrictions.
+   * @return  Returns a view of the AccessRestrictions, found by binary search
+   *          on the edge index. It is only valid while this tile is.
    */
-  std::vector<AccessRestriction> GetAccessRestrictions(const uint32_t edgeid,
-                                                       const uint32_t access) const;
+  AccessRestrictionView GetAccessRestrictions(const uint32_t edgeid, const uint32_t access) const;
+
+  /**
+   * Get the summary of the truck restrictions of an edge. Call this only for edges that have
+   * access restrictions.
+   * @param   edgeid  Directed edge index within the tile.
+   * @return  Returns the summary, nullptr if no restriction applies to trucks. The summary is
+   *          incomplete when the access restrictions must be checked instead, including for
+   *          every edge of tiles built without summaries.
+   */
+  const TruckRestriction* GetTruckRestriction(const uint32_t edgeid) const;
 
   /**
    * Get an iteratable list of GraphIds given a bin in the tile
@@ -431,12 +441,21 @@ public:
    * edge index and a time (seconds since start of the week).
    * @param  de               Directed edge information.
    * @param  seconds_of_week  Seconds since midnight.
+   * @param  memo             Optional memo of predicted speeds already decoded during a search.
    * @return Returns the speed for the edge.
    */
-  uint32_t
-  GetSpeed(const DirectedEdge* de, const GraphId& edgeid, const uint32_t seconds_of_week) const {
+  uint32_t GetSpeed(const DirectedEdge* de,
+                    const GraphId& edgeid,
+                    const uint32_t seconds_of_week,
+                    PredictedSpeedMemo* memo = nullptr) const {
     if (de->predicted_speed()) {
-      float spd = predictedspeeds_.speed(edgeid.id(), seconds_of_week);
+      float spd;
+      if (memo == nullptr || !memo->find(edgeid.value, seconds_of_week, spd)) {
+        spd = predictedspeeds_.speed(edgeid.id(), seconds_of_week);
+        if (memo != nullptr) {
+          memo->insert(edgeid.value, seconds_of_week, spd);
+        }
+      }
       if (spd > 0.0f && spd < kMaxSpeedKph) {
         return static_cast<uint32_t>(spd);
       } else if (spd < 0) {
@@ -515,6 +534,9 @@ protected:
   // Access restrictions, 1 or more per edge id
   AccessRestriction* access_restrictions_;
 
+  // Truck restriction summaries, 1 per edge id with truck restrictions
+  TruckRestriction* truck_restrictions_;
+
   // Signs (indexed by directed edge index)
   Sign* signs_;
 
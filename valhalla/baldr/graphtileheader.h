@@ -20,6 +20,13 @@ constexpr size_t kEmptySlots = 11;
 // character array so the GraphTileHeader size remains fixed).
 constexpr size_t kMaxVersionSize = 16;
 
+// Version of the tile layout. Tiles written before a section was added have an older format
+// version and leave that section out, bump this when adding a section in the middle of the tile
+constexpr uint32_t kTileFormatVersion = 1;
+
+// First format version with the truck restriction summaries
+constexpr uint32_t kTruckRestrictionFormatVersion = 1;
+
 // Maximum value used for quality metrics
 constexpr uint32_t kMaxQualityMeasure = 15;
 
@@ -80,6 +87,22 @@ public:
    */
   void set_version(const std::string& version);
 
+  /**
+   * Gets the layout version of this tile. Tiles from before the layout was versioned have 0.
+   * @return  Returns the format version of this tile.
+   */
+  uint32_t format_version() const {
+    return format_version_;
+  }
+
+  /**
+   * Sets the layout version of this tile.
+   * @param  version  Format version.
+   */
+  void set_format_version(const uint32_t version) {
+    format_version_ = version;
+  }
+
   /**
    * Returns the data set Id (latest OSM changeset Id).
    * @return  Returns the data set Id.
@@ -276,6 +299,23 @@ public:
    */
   void set_access_restriction_count(const uint32_t restrictions);
 
+  /**
+   * Gets the number of truck restriction summaries in this tile. Only set in tiles with a
+   * format version of at least kTruckRestrictionFormatVersion.
+   * @return  Returns the number of truck restriction summaries.
+   */
+  uint32_t truck_restriction_count() const {
+    return truck_restriction_count_;
+  }
+
+  /**
+   * Sets the number of truck restriction summaries in this tile.
+   * @param  count   The number of truck restriction summaries.
+   */
+  void set_truck_restriction_count(const uint32_t count) {
+    truck_restriction_count_ = count;
+  }
+
   /**
    * Gets the number of admin records in this tile.
    * @return  Returns the number of admin records.
@@ -553,7 +593,8 @@ protected:
   uint64_t speed_quality_ : 4;
   uint64_t exit_quality_ : 4;
   uint64_t predictedspeeds_count_ : 22;
-  uint64_t spare1_ : 26;
+  uint64_t truck_restriction_count_ : 22;
+  uint64_t format_version_ : 4;
 
   // Number of transit records
   uint64_t departurecount_ : 24;
@@ -1,9 +1,18 @@
 #ifndef VALHALLA_BALDR_PREDICTEDSPEEDS_H_
 #define VALHALLA_BALDR_PREDICTEDSPEEDS_H_
 
+#include <algorithm>
+#include <cstdint>
+#include <limits>
 #include <valhalla/midgard/util.h>
 #include <vector>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace valhalla {
 namespace baldr {
 
@@ -43,10 +52,12 @@ public:
 private:
   // Construct the cos table
   BucketCosTable() {
-    // Fill out the table in bucket order.
+    // Fill out the table in bucket order. The first term of the DCT-III is scaled by 1/sqrt(2)
+    // instead of the cos (which is always 1) so that decoding is a plain dot product
     float* t = &table_[0];
     for (uint32_t bucket = 0; bucket < kBucketsPerWeek; ++bucket) {
-      for (uint32_t c = 0; c < kCoefficientCount; ++c) {
+      *t++ = k1OverSqrt2;
+      for (uint32_t c = 1; c < kCoefficientCount; ++c) {
         *t++ = cosf(kPiBucketConstant * (bucket + 0.5f) * c);
       }
     }
@@ -58,8 +69,144 @@ private:
   BucketCosTable(BucketCosTable&&) = delete;
   BucketCosTable& operator=(BucketCosTable&&) = delete;
 
-  // cos table (this uses about 1.6MB of memory)
-  float table_[kCosBucketTableSize];
+  // cos table (this uses about 1.6MB of memory), each bucket's row starts on a 32 byte boundary
+  alignas(32) float table_[kCosBucketTableSize];
+};
+static_assert((kCoefficientCount * sizeof(float)) % 32 == 0,
+              "Cos table rows should stay aligned for vector loads");
+
+/**
+ * Decode the speed of one bucket from the compressed profile of an edge. This is the dot product
+ * of the DCT-III coefficients and the cos values of the bucket, done 8 or 4 lanes at a time
+ * where the target has vector instructions.
+ * @param  coefficients  compressed speed profile
+ * @param  b             cos values of the bucket
+ * @return the speed, not yet normalized
+ */
+inline float decompress_speed_bucket(const int16_t* coefficients, const float* b) {
+#if defined(__AVX2__)
+  __m256 sum = _mm256_setzero_ps();
+  for (uint32_t k = 0; k < kCoefficientCount; k += 8) {
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + k));
+    __m256 cf = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(c));
+#if defined(__FMA__)
+    sum = _mm256_fmadd_ps(cf, _mm256_load_ps(b + k), sum);
+#else
+    sum = _mm256_add_ps(sum, _mm256_mul_ps(cf, _mm256_load_ps(b + k)));
+#endif
+  }
+  __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+  half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+  half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 1));
+  return _mm_cvtss_f32(half);
+#elif defined(__SSE2__)
+  __m128 sum_lo = _mm_setzero_ps();
+  __m128 sum_hi = _mm_setzero_ps();
+  for (uint32_t k = 0; k < kCoefficientCount; k += 8) {
+    // sign extend the 16 bit coefficients by unpacking them into the high halves and shifting
+    __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coefficients + k));
+    __m128 lo = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(c, c), 16));
+    __m128 hi = _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(c, c), 16));
+    sum_lo = _mm_add_ps(sum_lo, _mm_mul_ps(lo, _mm_load_ps(b + k)));
+    sum_hi = _mm_add_ps(sum_hi, _mm_mul_ps(hi, _mm_load_ps(b + k + 4)));
+  }
+  __m128 sum = _mm_add_ps(sum_lo, sum_hi);
+  sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+  sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+  return _mm_cvtss_f32(sum);
+#elif defined(__ARM_NEON)
+  float32x4_t sum_lo = vdupq_n_f32(0.0f);
+  float32x4_t sum_hi = vdupq_n_f32(0.0f);
+  for (uint32_t k = 0; k < kCoefficientCount; k += 8) {
+    int16x8_t c = vld1q_s16(coefficients + k);
+    float32x4_t lo = vcvtq_f32_s32(vmovl_s16(vget_low_s16(c)));
+    float32x4_t hi = vcvtq_f32_s32(vmovl_s16(vget_high_s16(c)));
+    sum_lo = vmlaq_f32(sum_lo, lo, vld1q_f32(b + k));
+    sum_hi = vmlaq_f32(sum_hi, hi, vld1q_f32(b + k + 4));
+  }
+  float32x4_t sum = vaddq_f32(sum_lo, sum_hi);
+  float32x2_t pair = vadd_f32(vget_low_f32(sum), vget_high_f32(sum));
+  return vget_lane_f32(vpadd_f32(pair, pair), 0);
+#else
+  // independent partial sums so the compiler is free to vectorize this
+  float sums[8] = {};
+  for (uint32_t k = 0; k < kCoefficientCount; k += 8) {
+    for (uint32_t i = 0; i < 8; ++i) {
+      sums[i] += coefficients[k + i] * b[k + i];
+    }
+  }
+  return ((sums[0] + sums[1]) + (sums[2] + sums[3])) + ((sums[4] + sums[5]) + (sums[6] + sums[7]));
+#endif
+}
+static_assert(kCoefficientCount % 8 == 0, "Speed decoding works on 8 coefficients at a time");
+
+/**
+ * Remembers decoded speeds by directed edge and 5 minute bucket. A time dependent search asks
+ * for the speed of an edge each time a label at its start node is settled, usually within the
+ * same bucket. This is a direct mapped cache so a collision simply replaces the older entry.
+ */
+class PredictedSpeedMemo {
+public:
+  PredictedSpeedMemo() : entries_(kMemoSize) {
+    clear();
+  }
+
+  /**
+   * Forget all the speeds, do this before each search.
+   */
+  void clear() {
+    std::fill(entries_.begin(), entries_.end(), entry_t{kInvalidKey, 0.0f});
+  }
+
+  /**
+   * Find the speed of an edge in the bucket of the given time.
+   * @param  edgeid           graph id value of the directed edge
+   * @param  seconds_of_week  seconds from the start of the week (local time)
+   * @param  speed            set to the speed if it was found
+   * @return true if the speed was found
+   */
+  bool find(const uint64_t edgeid, const uint32_t seconds_of_week, float& speed) const {
+    auto k = key(edgeid, seconds_of_week);
+    const auto& entry = entries_[slot(k)];
+    if (entry.key != k) {
+      return false;
+    }
+    speed = entry.speed;
+    return true;
+  }
+
+  /**
+   * Remember the speed of an edge in the bucket of the given time.
+   * @param  edgeid           graph id value of the directed edge
+   * @param  seconds_of_week  seconds from the start of the week (local time)
+   * @param  speed            the speed
+   */
+  void insert(const uint64_t edgeid, const uint32_t seconds_of_week, const float speed) {
+    auto k = key(edgeid, seconds_of_week);
+    entries_[slot(k)] = entry_t{k, speed};
+  }
+
+protected:
+  static constexpr uint32_t kMemoBits = 12;
+  static constexpr size_t kMemoSize = 1 << kMemoBits;
+  static constexpr uint64_t kInvalidKey = std::numeric_limits<uint64_t>::max();
+
+  struct entry_t {
+    uint64_t key;
+    float speed;
+  };
+
+  // graph ids use 46 bits and there are 2016 buckets in a week so both fit in one key
+  static uint64_t key(const uint64_t edgeid, const uint32_t seconds_of_week) {
+    return (edgeid << 11) | (seconds_of_week / kSpeedBucketSizeSeconds);
+  }
+
+  // fibonacci hashing spreads the neighbouring edges of a tile over the slots
+  static size_t slot(const uint64_t key) {
+    return (key * 0x9E3779B97F4A7C15ull) >> (64 - kMemoBits);
+  }
+
+  std::vector<entry_t> entries_;
 };
 
 /**
@@ -106,13 +253,7 @@ public:
     const float* b = BucketCosTable::GetInstance().get(seconds_of_week / kSpeedBucketSizeSeconds);
 
     // DTC-III with speed normalization
-    float speed = *coefficients * k1OverSqrt2;
-    ++coefficients;
-    ++b;
-    for (uint32_t k = 1; k < kCoefficientCount; ++k, ++coefficients, ++b) {
-      speed += *coefficients * *b;
-    }
-    return speed * kSpeedNormalization;
+    return decompress_speed_bucket(coefficients, b) * kSpeedNormalization;
   }
 
 protected:
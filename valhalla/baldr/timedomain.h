@@ -1,6 +1,10 @@
 #ifndef VALHALLA_BALDR_TIMEDOMAIN_H_
 #define VALHALLA_BALDR_TIMEDOMAIN_H_
 
+#include <bitset>
+#include <unordered_map>
+#include <utility>
+#include <valhalla/baldr/datetime.h>
 #include <valhalla/baldr/graphconstants.h>
 #include <vector>
 
@@ -330,6 +334,78 @@ protected:
   uint64_t value; // Single 64 bit value representing the date range.
 };
 
+/**
+ * Remembers when time domains are in effect. DateTime::is_restricted looks at the local time to
+ * the minute so its answer for a time domain in a timezone holds for the whole minute. The first
+ * check of a time domain gives it bitmaps of the week of minutes around that time, filled in as
+ * later checks reach each minute, so checking the same time domain again is a bit test. Checks
+ * outside of that week are evaluated every time. This is meant to live as long as one request
+ * and is not thread safe.
+ */
+class TimeDomainCache {
+public:
+  /**
+   * Is the time domain in effect at the given time.
+   * @param  value         time domain value (see TimeDomain)
+   * @param  current_time  seconds since epoch
+   * @param  tz_index      index of the timezone in the timezone database
+   * @return true if the time domain is in effect
+   */
+  bool is_restricted(const uint64_t value, const uint64_t current_time, const uint32_t tz_index) {
+    uint64_t minute = current_time / midgard::kSecondsPerMinute;
+    auto window = windows_.find(std::make_pair(value, tz_index));
+    if (window == windows_.end()) {
+      // arrive by searches go back in time so start the window half a week early
+      uint64_t start = minute > kWindowMinutes / 2 ? minute - kWindowMinutes / 2 : 0;
+      window = windows_.emplace(std::make_pair(value, tz_index), window_t{start, {}, {}}).first;
+    }
+
+    if (minute < window->second.start || minute - window->second.start >= kWindowMinutes) {
+      return evaluate(value, current_time, tz_index);
+    }
+    size_t bit = minute - window->second.start;
+    if (!window->second.known.test(bit)) {
+      window->second.restricted.set(bit, evaluate(value, current_time, tz_index));
+      window->second.known.set(bit);
+    }
+    return window->second.restricted.test(bit);
+  }
+
+  /**
+   * Is the time domain in effect at the given time, without remembering the answer.
+   * @param  value         time domain value (see TimeDomain)
+   * @param  current_time  seconds since epoch
+   * @param  tz_index      index of the timezone in the timezone database
+   * @return true if the time domain is in effect
+   */
+  static bool evaluate(const uint64_t value, const uint64_t current_time, const uint32_t tz_index) {
+    TimeDomain td(value);
+    return DateTime::is_restricted(td.type(), td.begin_hrs(), td.begin_mins(), td.end_hrs(),
+                                   td.end_mins(), td.dow(), td.begin_week(), td.begin_month(),
+                                   td.begin_day_dow(), td.end_week(), td.end_month(),
+                                   td.end_day_dow(), current_time,
+                                   DateTime::get_tz_db().from_index(tz_index));
+  }
+
+protected:
+  static constexpr uint32_t kWindowMinutes = 7 * 24 * 60;
+
+  struct window_t {
+    uint64_t start; // first minute (since epoch) of the window
+    std::bitset<kWindowMinutes> known;
+    std::bitset<kWindowMinutes> restricted;
+  };
+
+  struct key_hash {
+    size_t operator()(const std::pair<uint64_t, uint32_t>& key) const {
+      return std::hash<uint64_t>()(key.first) ^ (std::hash<uint32_t>()(key.second) << 1);
+    }
+  };
+
+  // one window per time domain and timezone
+  std::unordered_map<std::pair<uint64_t, uint32_t>, window_t, key_hash> windows_;
+};
+
 } // namespace baldr
 } // namespace valhalla
 
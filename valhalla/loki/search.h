@@ -42,6 +42,8 @@ const sif::NodeFilter PassThroughNodeFilter = [](const baldr::NodeInfo* node) {
  * through filter
  * @param node_filter    a function/functor to be used in the rejection of nodes used in graph
  * traversal. defaults to a pass through filter
+ * @param stored_reach   whether the filters are those of a costing that uses baldr::kReachAccess in
+ * which case the reachability stored in the tiles is used instead of expanding the graph
  * @return pathLocations the correlated data with in the tile that matches the inputs. If a
  * projection is not found, it will not have any entry in the returned value.
  */
@@ -49,7 +51,37 @@ std::unordered_map<baldr::Location, baldr::PathLocation>
 Search(const std::vector<baldr::Location>& locations,
        baldr::GraphReader& reader,
        const sif::EdgeFilter& edge_filter = PassThroughEdgeFilter,
-       const sif::NodeFilter& node_filter = PassThroughNodeFilter);
+       const sif::NodeFilter& node_filter = PassThroughNodeFilter,
+       bool stored_reach = false);
+
+/**
+ * Find a large number of locations within the route network at once. The locations
+ * are sorted by the bins they fall in so that nearby locations are searched together
+ * in chunks, and the chunks are spread over one thread per graph reader. The results
+ * are handed back in the order of the input as soon as they are available so that
+ * they can be streamed out without holding all of them in memory.
+ *
+ * @param locations      the positions which need to be correlated to the route network
+ * @param readers        one thread searches with each of these, they must not be used elsewhere
+ * until the search is finished
+ * @param callback       called on the calling thread for each location in input order with its
+ * index and its correlation, or nullptr if it could not be correlated
+ * @param edge_filter    a function/functor to be used in the rejection of edges
+ * @param node_filter    a function/functor to be used in the rejection of nodes
+ * @param stored_reach   whether to use the reachability stored in the tiles, see Search
+ * @param chunk_size     how many locations a thread searches at a time
+ * @param interrupt      called on the calling thread while waiting for results and once per chunk
+ * of results handed back, it throws to stop the search. the search threads finish the chunk they
+ * are on and take no more
+ */
+void BulkSearch(const std::vector<baldr::Location>& locations,
+                const std::vector<baldr::GraphReader*>& readers,
+                const std::function<void(size_t, const baldr::PathLocation*)>& callback,
+                const sif::EdgeFilter& edge_filter = PassThroughEdgeFilter,
+                const sif::NodeFilter& node_filter = PassThroughNodeFilter,
+                bool stored_reach = false,
+                size_t chunk_size = 1024,
+                const std::function<void()>* interrupt = nullptr);
 
 } // namespace loki
 } // namespace valhalla
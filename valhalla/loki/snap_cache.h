@@ -0,0 +1,128 @@
+#ifndef VALHALLA_LOKI_SNAP_CACHE_H_
+#define VALHALLA_LOKI_SNAP_CACHE_H_
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/baldr/location.h>
+#include <valhalla/baldr/pathlocation.h>
+
+namespace valhalla {
+namespace loki {
+
+/**
+ * A bounded cache of locations that were already correlated to the graph. Lots of
+ * requests start or end at the same few places so rather than searching the bins
+ * again for those we can hand back what we found the last time. Locations are
+ * considered the same when all of the inputs to the search are, with their
+ * coordinates rounded to a given precision, and the same edge filter is used.
+ * Like the graph reader its used with, this is not thread safe.
+ */
+class SnapCache {
+public:
+  /**
+   * Constructor.
+   * @param max_memory  the approximate maximum number of bytes the cache may use
+   * @param precision   the number of decimal places coordinates are rounded to
+   */
+  SnapCache(size_t max_memory, uint32_t precision);
+
+  /**
+   * Get the correlation of a location that was searched for before. If the tiles it
+   * was found in have changed since the whole cache is dropped.
+   * @param location          the location to get the correlation of
+   * @param filter_signature  identifies the edge and node filters the location is searched with
+   * @param reader            used to check that the tiles have not changed
+   * @return the correlation, only valid until the cache is next modified, or nullptr if its
+   * not in the cache
+   */
+  const baldr::PathLocation* Get(const baldr::Location& location,
+                                 uint64_t filter_signature,
+                                 baldr::GraphReader& reader);
+
+  /**
+   * Put the correlation of a location into the cache evicting the least recently used
+   * ones until it fits.
+   * @param location          the location that was searched for
+   * @param filter_signature  identifies the edge and node filters the location was searched with
+   * @param correlated        what was found for the location
+   * @param reader            used to remember the version of the tiles it was found in
+   */
+  void Put(const baldr::Location& location,
+           uint64_t filter_signature,
+           const baldr::PathLocation& correlated,
+           baldr::GraphReader& reader);
+
+  /**
+   * Removes all of the entries from the cache, the metrics are kept.
+   */
+  void Clear();
+
+  /**
+   * @return the number of correlated locations in the cache
+   */
+  size_t size() const {
+    return lru_.size();
+  }
+
+  /**
+   * @return the approximate number of bytes used by the cache
+   */
+  size_t memory() const {
+    return memory_;
+  }
+
+  /**
+   * @return the number of locations that were found in the cache
+   */
+  uint64_t hits() const {
+    return hits_;
+  }
+
+  /**
+   * @return the number of locations that were not found in the cache
+   */
+  uint64_t misses() const {
+    return misses_;
+  }
+
+  /**
+   * @return the fraction of locations that were found in the cache
+   */
+  float hit_rate() const {
+    uint64_t total = hits_ + misses_;
+    return total == 0 ? 0.f : static_cast<float>(hits_) / total;
+  }
+
+protected:
+  // The inputs of the search, serialized so that it can be hashed and compared easily
+  using key_t = std::string;
+  key_t make_key(const baldr::Location& location, uint64_t filter_signature) const;
+
+  struct entry_t {
+    key_t key;
+    baldr::PathLocation correlated;
+    // the tile the correlation was found in and the version of the data that tile had
+    baldr::GraphId tile_id;
+    uint64_t dataset_id;
+    size_t memory;
+  };
+  void evict(std::list<entry_t>::iterator entry);
+
+  std::list<entry_t> lru_;
+  std::unordered_map<key_t, std::list<entry_t>::iterator> index_;
+  size_t max_memory_;
+  size_t memory_;
+  double scale_;
+  uint64_t hits_;
+  uint64_t misses_;
+};
+
+} // namespace loki
+} // namespace valhalla
+
+#endif // VALHALLA_LOKI_SNAP_CACHE_H_
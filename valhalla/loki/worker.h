@@ -1,9 +1,12 @@
 #ifndef __VALHALLA_LOKI_SERVICE_H__
 #define __VALHALLA_LOKI_SERVICE_H__
 
+#include <chrono>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
+#include <boost/optional.hpp>
 #include <boost/property_tree/ptree.hpp>
 
 #include <valhalla/baldr/connectivity_map.h>
@@ -11,6 +14,7 @@
 #include <valhalla/baldr/location.h>
 #include <valhalla/baldr/pathlocation.h>
 #include <valhalla/baldr/rapidjson_utils.h>
+#include <valhalla/loki/snap_cache.h>
 #include <valhalla/midgard/pointll.h>
 #include <valhalla/proto/directions_options.pb.h>
 #include <valhalla/sif/costfactory.h>
@@ -38,6 +42,7 @@ public:
   virtual void cleanup() override;
 
   std::string locate(valhalla_request_t& request);
+  std::string bulk_locate(valhalla_request_t& request);
   void route(valhalla_request_t& request);
   void matrix(valhalla_request_t& request);
   void isochrones(valhalla_request_t& request);
@@ -45,6 +50,15 @@ public:
   std::string height(valhalla_request_t& request);
   std::string transit_available(valhalla_request_t& request);
 
+  // does loki's part of the request. the actions loki answers itself get their json back while
+  // the rest are left correlated in the request for thor and get nothing back
+  boost::optional<std::string> act(valhalla_request_t& request);
+  // logs the request if loki took longer on it than the long request threshold allows and gives
+  // back when loki was done with it
+  std::chrono::system_clock::time_point
+  log_request(const valhalla_request_t& request,
+              const std::chrono::system_clock::time_point& start) const;
+
 protected:
   void parse_locations(
       google::protobuf::RepeatedPtrField<odin::Location>* locations,
@@ -52,8 +66,11 @@ protected:
   void parse_trace(valhalla_request_t& request);
   void parse_costing(valhalla_request_t& request);
   void locations_from_shape(valhalla_request_t& request);
+  std::unordered_map<baldr::Location, baldr::PathLocation>
+  search(const std::vector<baldr::Location>& locations);
 
   void init_locate(valhalla_request_t& request);
+  void init_bulk_locate(valhalla_request_t& request);
   void init_route(valhalla_request_t& request);
   void init_matrix(valhalla_request_t& request);
   void init_isochrones(valhalla_request_t& request);
@@ -65,14 +82,20 @@ protected:
   sif::CostFactory<sif::DynamicCost> factory;
   sif::EdgeFilter edge_filter;
   sif::NodeFilter node_filter;
+  bool stored_reach;
+  uint64_t filter_signature;
   std::shared_ptr<baldr::GraphReader> reader;
   std::shared_ptr<baldr::connectivity_map_t> connectivity_map;
+  std::vector<std::shared_ptr<baldr::GraphReader>> bulk_readers;
+  std::unique_ptr<SnapCache> snap_cache;
   std::string action_str;
   std::unordered_map<std::string, size_t> max_locations;
   std::unordered_map<std::string, float> max_distance;
   std::unordered_map<std::string, float> max_matrix_distance;
   std::unordered_map<std::string, float> max_matrix_locations;
   size_t max_avoid_locations;
+  size_t max_bulk_locations;
+  size_t bulk_locate_threads;
   unsigned int max_reachability;
   unsigned int default_reachability;
   unsigned long max_radius;
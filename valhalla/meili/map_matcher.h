@@ -13,6 +13,7 @@
 #include <valhalla/meili/emission_cost_model.h>
 #include <valhalla/meili/match_result.h>
 #include <valhalla/meili/measurement.h>
+#include <valhalla/meili/route_cache.h>
 #include <valhalla/meili/routing.h>
 #include <valhalla/meili/state.h>
 #include <valhalla/meili/topk_search.h>
@@ -29,7 +30,9 @@ public:
              baldr::GraphReader& graphreader,
              CandidateQuery& candidatequery,
              const sif::cost_ptr_t* mode_costing,
-             sif::TravelMode travelmode);
+             sif::TravelMode travelmode,
+             const std::shared_ptr<RouteCache>& route_cache = nullptr,
+             uint64_t costing_signature = 0);
 
   ~MapMatcher();
 
@@ -14,6 +14,7 @@
 
 #include <valhalla/meili/candidate_search.h>
 #include <valhalla/meili/map_matcher.h>
+#include <valhalla/meili/route_cache.h>
 
 namespace valhalla {
 namespace meili {
@@ -47,6 +48,14 @@ public:
 
   void ClearCache();
 
+  /**
+   * The routes shared by all of the matchers in this process
+   * @return the route cache or nullptr if it is disabled
+   */
+  const std::shared_ptr<RouteCache>& routecache() const {
+    return route_cache_;
+  }
+
   static constexpr size_t kModeCostingCount = 8;
 
 private:
@@ -62,6 +71,8 @@ private:
 
   std::shared_ptr<CandidateGridQuery> candidatequery_;
 
+  std::shared_ptr<RouteCache> route_cache_;
+
   float max_grid_cache_size_;
 };
 
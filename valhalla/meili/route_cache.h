@@ -0,0 +1,197 @@
+// -*- mode: c++ -*-
+#ifndef MMP_ROUTE_CACHE_H_
+#define MMP_ROUTE_CACHE_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+#include <boost/property_tree/ptree.hpp>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/meili/routing.h>
+#include <valhalla/sif/costconstants.h>
+
+namespace valhalla {
+namespace meili {
+
+/**
+ * The part of a route between two candidate edges that does not depend on where
+ * along those edges the candidates are. Besides the origin and destination edge
+ * the path found by the transition cost model only depends on the predecessor of
+ * the origin edge (u-turns and restrictions) and the costing, so the same part can
+ * be reused for any candidates on the same pair of edges.
+ */
+struct cached_route_t {
+  // Labels of the edges strictly between the origin and destination edge in route order
+  std::vector<Label> labels;
+  // Cost of the origin edge label when the labels above were found, subtract it from their
+  // costs to get the cost relative to the end of the origin edge
+  sif::Cost base;
+  // Cost (distance) and secs from the end of the origin edge to the start of the destination edge
+  sif::Cost cost;
+  // Turn cost accumulated along the origin edge and on arrival at the destination edge
+  float origin_turn_cost;
+  float destination_turn_cost;
+  // The bounds, from the end of the origin edge to the start of the destination edge, under which
+  // this route was searched for. A negative max_time means the time was not bounded
+  float max_dist;
+  float max_time;
+  // Whether a route was found within the bounds above
+  bool found;
+
+  /**
+   * Whether or not this result can answer a search with the given bounds. That
+   * is the case when the bounds are at least as tight as the ones it was found with
+   * @param  max_dist  the distance bound of the search
+   * @param  max_time  the time bound of the search, negative if unbounded
+   * @return true if a search with these bounds would give the same answer
+   */
+  bool covers(float max_dist, float max_time) const {
+    return max_dist <= this->max_dist &&
+           (this->max_time < 0 || (0 <= max_time && max_time <= this->max_time));
+  }
+
+  /**
+   * Whether or not the route is within the given bounds
+   * @param  max_dist  the distance bound of the search
+   * @param  max_time  the time bound of the search, negative if unbounded
+   * @return true if the route was found and is within the bounds
+   */
+  bool within(float max_dist, float max_time) const {
+    return found && cost.cost < max_dist && (max_time < 0 || cost.secs < max_time);
+  }
+};
+
+/**
+ * A bounded, thread safe cache of routes between pairs of candidate edges that
+ * can be shared by all of the map matchers in a process. Traces along the same
+ * corridors keep asking for the routes between the same edges so once they are
+ * cached those transitions need no search at all.
+ */
+class RouteCache {
+public:
+  // What a cached route depends on
+  struct key_t {
+    uint64_t costing;           // signature of the costing and its options
+    baldr::GraphId prior;       // the edge before the origin edge, invalid if none
+    baldr::GraphId origin;      // the edge the route starts on
+    baldr::GraphId destination; // the edge the route ends on
+
+    bool operator==(const key_t& other) const {
+      return costing == other.costing && prior == other.prior && origin == other.origin &&
+             destination == other.destination;
+    }
+  };
+
+  // The cache is split into this many independently locked shards
+  static constexpr size_t kShardCount = 16;
+
+  /**
+   * Constructor.
+   * @param max_size  the maximum number of routes to keep in the cache
+   */
+  RouteCache(size_t max_size);
+
+  /**
+   * Get a route that can answer a search with the given bounds.
+   * @param key       what the route depends on
+   * @param max_dist  the distance bound of the search between the two edges
+   * @param max_time  the time bound of the search between the two edges, negative if unbounded
+   * @return the cached route or nullptr if there is none that can answer the search
+   */
+  std::shared_ptr<const cached_route_t> Get(const key_t& key, float max_dist, float max_time);
+
+  /**
+   * Record whether a transition was answered by the cache. A transition asks for the
+   * routes between several pairs of edges so the callers count hits per transition
+   * rather than per lookup.
+   * @param hit  true if every route the transition needed was in the cache
+   */
+  void Count(bool hit);
+
+  /**
+   * Put a route into the cache evicting the least recently used ones if its full.
+   * @param key    what the route depends on
+   * @param route  the route
+   */
+  void Put(const key_t& key, const std::shared_ptr<const cached_route_t>& route);
+
+  /**
+   * Removes all of the routes from the cache and resets the metrics.
+   */
+  void Clear();
+
+  /**
+   * @return the number of routes in the cache
+   */
+  size_t size() const;
+
+  /**
+   * @return the number of transitions that were answered by the cache
+   */
+  uint64_t hits() const {
+    return hits_;
+  }
+
+  /**
+   * @return the number of transitions that could not be answered by the cache
+   */
+  uint64_t misses() const {
+    return misses_;
+  }
+
+  /**
+   * @return the fraction of transitions that were answered by the cache
+   */
+  float hit_rate() const {
+    uint64_t total = hits_ + misses_;
+    return total == 0 ? 0.f : static_cast<float>(hits_) / total;
+  }
+
+  /**
+   * Get the cache shared by the whole process. It is configured by the first caller
+   * from meili.route_cache.max_size, if that is missing or 0 no cache is used.
+   * @param config  the meili config
+   * @return the process wide cache or nullptr if caching is disabled
+   */
+  static std::shared_ptr<RouteCache> instance(const boost::property_tree::ptree& config);
+
+private:
+  struct key_hash_t {
+    size_t operator()(const key_t& key) const {
+      size_t seed = 0;
+      boost::hash_combine(seed, key.costing);
+      boost::hash_combine(seed, key.prior.value);
+      boost::hash_combine(seed, key.origin.value);
+      boost::hash_combine(seed, key.destination.value);
+      return seed;
+    }
+  };
+
+  // Each shard is its own lru with its own lock to keep contention between threads down
+  struct shard_t {
+    using entry_t = std::pair<key_t, std::shared_ptr<const cached_route_t>>;
+    mutable std::mutex mutex;
+    std::list<entry_t> lru;
+    std::unordered_map<key_t, std::list<entry_t>::iterator, key_hash_t> index;
+    size_t max_size;
+  };
+  shard_t& shard(const key_t& key) {
+    return shards_[key_hash_t()(key) % kShardCount];
+  }
+
+  shard_t shards_[kShardCount];
+  std::atomic<uint64_t> hits_;
+  std::atomic<uint64_t> misses_;
+};
+
+} // namespace meili
+} // namespace valhalla
+#endif // MMP_ROUTE_CACHE_H_
@@ -217,6 +217,18 @@ public:
            const baldr::DirectedEdge* edge,
            const sif::TravelMode mode);
 
+  /**
+   * Append a label without queueing it or tracking its status. This is used to
+   * rebuild routes found by earlier searches so the predecessor of the label
+   * must already be in the set.
+   * @param  label  The label to append.
+   * @return  Returns the index of the label in the label set.
+   */
+  uint32_t append(const Label& label) {
+    labels_.push_back(label);
+    return labels_.size() - 1;
+  }
+
   /**
    * Get the next label from the priority queue. Marks the popped label
    * as permanent (best path found).
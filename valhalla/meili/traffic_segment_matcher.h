@@ -38,6 +38,38 @@ struct traffic_segment_t {
   std::vector<uint64_t> way_ids; // A list of way ids from the directed edge
 };
 
+// Columnar batch of probe points for the binary matching interface. All columns
+// must be the same length except accuracies which may be left empty to use the
+// configured default gps accuracy for every point.
+struct probe_batch_t {
+  std::vector<double> lats;      // Latitude of each probe point
+  std::vector<double> lons;      // Longitude of each probe point
+  std::vector<double> times;     // Seconds from epoch of each probe point
+  std::vector<float> accuracies; // Optional gps accuracy in meters of each probe point
+
+  size_t size() const {
+    return lats.size();
+  }
+  void clear() {
+    lats.clear();
+    lons.clear();
+    times.clear();
+    accuracies.clear();
+  }
+};
+
+// Packed matched traffic segment as returned by the binary matching interface
+struct packed_segment_t {
+  uint64_t segment_id;  // Traffic segment unique Id, kInvalidGraphId if no segment covers it
+  double start_time;    // Begin time along this segment, if < 0 then no begin match
+  double end_time;      // End time along this segment, if < 0 then no end match
+  int32_t length;       // Length in meters along this segment, if < 0 then no match
+  int32_t queue_length; // Length of any queue from the end of the segment
+};
+
+// The segments of consecutive edges merged into one entry per segment id, see the implementation
+struct merged_traffic_segment_t;
+
 /**
  * Traffic segment matcher. Allows matching GPS traces to Valhalla edges and
  * then forms the traffic segments associated to those edges.
@@ -64,6 +96,21 @@ public:
    */
   virtual std::string match(const std::string& json);
 
+  /**
+   * Matches a columnar batch of probe points to Valhalla edges and then associates
+   * those to traffic segments. Neither the input nor the output goes through json
+   * and the matcher and intermediate buffers are reused from call to call which
+   * makes this suitable for high throughput probe ingest. Note that this is not
+   * safe to call concurrently on the same instance.
+   * @param   batch     the probe points to match, in chronological order
+   * @param   segments  cleared and then filled with the matched traffic segments
+   * @param   costing   the costing to use when matching the probe points
+   * @return  Returns the number of traffic segments written to segments
+   */
+  size_t match(const probe_batch_t& batch,
+               std::vector<packed_segment_t>& segments,
+               odin::Costing costing = odin::Costing::auto_);
+
   /**
    * Parses the input to the traffic matcher, mainly the trace array
    * @param  request request with data {"trace":[{"lat":0,"lon":0,time:0},...]}
@@ -95,6 +142,22 @@ protected:
                       std::vector<EdgeSegment>& edges,
                       const std::shared_ptr<MapMatcher>& matcher) const;
 
+  /**
+   * Same as above but writes into caller owned buffers so that they can be reused. The
+   * interpolations for each continuous set of edges are stored back to back in interpolated
+   * and ends holds one past the last index of each set.
+   * @param  matches       the matched results of the input measurements
+   * @param  edges         the edges of the matched path
+   * @param  matcher       the matcher used to generate the match
+   * @param  interpolated  cleared and filled with the interpolation points
+   * @param  ends          cleared and filled with the end of each continuous set
+   */
+  void interpolate_matches(const std::vector<MatchResult>& matches,
+                           std::vector<EdgeSegment>& edges,
+                           const MapMatcher& matcher,
+                           std::vector<interpolation_t>& interpolated,
+                           std::vector<size_t>& ends) const;
+
   /**
    * Compute queue length. Determine where (and if) speed drops below the
    * threshold along a segment.
@@ -119,8 +182,32 @@ protected:
   form_segments(const std::list<std::vector<interpolation_t>>& interpolations,
                 baldr::GraphReader& reader) const;
 
+  /**
+   * Turns one continuous set of interpolations into traffic segments appending them after
+   * the first count segments of the output. Existing entries past count are overwritten
+   * rather than reallocated so that the output can be reused from call to call.
+   * @param begin     the first interpolation point of the set
+   * @param end       one past the last interpolation point of the set
+   * @param reader    the graph reader with which we can get access to the segments for an edge
+   * @param merged    scratch space for the merged segments, owned by the caller
+   * @param segments  the output traffic segments
+   * @param count     the number of valid traffic segments already in the output
+   * @return the number of valid traffic segments in the output
+   */
+  size_t form_segments(std::vector<interpolation_t>::const_iterator begin,
+                       std::vector<interpolation_t>::const_iterator end,
+                       baldr::GraphReader& reader,
+                       std::vector<merged_traffic_segment_t>& merged,
+                       std::vector<traffic_segment_t>& segments,
+                       size_t count) const;
+
   valhalla::meili::MapMatcherFactory matcher_factory;
   std::unordered_set<std::string> customizable;
+
+private:
+  // scratch space reused across calls, see the implementation for its contents
+  struct buffers_t;
+  std::shared_ptr<buffers_t> buffers_;
 };
 
 } // namespace meili
@@ -5,6 +5,7 @@
 
 #include <valhalla/baldr/graphreader.h>
 #include <valhalla/meili/measurement.h>
+#include <valhalla/meili/route_cache.h>
 #include <valhalla/meili/state.h>
 #include <valhalla/meili/topk_search.h>
 #include <valhalla/meili/viterbi_search.h>
@@ -50,9 +51,28 @@ public:
 
   float operator()(const StateId& lhs, const StateId& rhs) const;
 
+  /**
+   * Share routes between pairs of candidate edges with other matchers through a cache
+   * @param route_cache         the cache, nullptr to stop caching
+   * @param costing_signature   identifies the costing and its options within the cache
+   */
+  void set_route_cache(const std::shared_ptr<RouteCache>& route_cache, uint64_t costing_signature) {
+    route_cache_ = route_cache;
+    costing_signature_ = costing_signature;
+  }
+
 private:
   void UpdateRoute(const StateId& lhs, const StateId& rhs) const;
 
+  bool UpdateRouteFromCache(const State& left,
+                            const std::vector<baldr::PathLocation>& locations,
+                            const std::vector<StateId>& stateids,
+                            const Label* edgelabel,
+                            const midgard::DistanceApproximator& approximator,
+                            float search_radius,
+                            float max_route_distance,
+                            float max_route_time) const;
+
   float ClockDistance(const StateId::Time& lhs, const StateId::Time& rhs) const {
     double clk_dist = -1.0;
 
@@ -90,6 +110,10 @@ private:
 
   // Cost for each degree in [0, 180]
   float turn_cost_table_[181];
+
+  // Routes shared with other matchers, may be null
+  std::shared_ptr<RouteCache> route_cache_;
+  uint64_t costing_signature_;
 };
 
 } // namespace meili
@@ -5,6 +5,7 @@
 #include <cerrno>
 #include <cmath>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
@@ -14,8 +15,10 @@
 #include <list>
 #include <map>
 #include <memory>
+#include <queue>
 #include <stdexcept>
 #include <string>
+#include <thread>
 #include <type_traits>
 #include <unordered_map>
 #include <utility>
@@ -284,19 +287,83 @@ public:
     return npos;
   }
 
-  // sort the file based on the predicate
-  void sort(const std::function<bool(const T&, const T&)>& predicate,
-            size_t buffer_size = 1024 * 1024 * 512 / sizeof(T)) {
-    using queue_t =
-        std::map<T, std::list<std::fstream>::iterator, std::function<bool(const T&, const T&)>>;
+  // how many elements are sorted in memory at once by default
+  static constexpr size_t kSortBufferSize = 1024 * 1024 * 512 / sizeof(T);
 
+  // sort the file based on the predicate. the buffer size is how many elements can be held in memory
+  // at once, if the sequence is larger than that it is sorted in runs of that size which are then
+  // merged. the sorting of each run is spread over the given number of threads so the predicate
+  // must be safe to call from multiple threads at once. it defaults to one thread so that sorts
+  // done from threads that are already busy dont start more, callers pass their own thread count
+  void sort(const std::function<bool(const T&, const T&)>& predicate,
+            size_t buffer_size = kSortBufferSize,
+            unsigned int threads = 1) {
     flush();
     // if no elements we are done
     if (memmap.size() == 0) {
       return;
     }
-    std::sort(static_cast<T*>(memmap), static_cast<T*>(memmap) + memmap.size(), predicate);
-    return;
+    buffer_size = std::max(buffer_size, static_cast<size_t>(1));
+    T* data = static_cast<T*>(memmap);
+    std::vector<T> scratch;
+
+    // it all fits so sort it in one go
+    if (memmap.size() <= buffer_size) {
+      sort_range(data, data + memmap.size(), predicate, threads, scratch);
+      return;
+    }
+
+    // sort each run on its own
+    std::vector<std::pair<size_t, size_t>> runs;
+    for (size_t begin = 0; begin < memmap.size(); begin += buffer_size) {
+      runs.emplace_back(begin, std::min(begin + buffer_size, memmap.size()));
+      sort_range(data + runs.back().first, data + runs.back().second, predicate, threads, scratch);
+    }
+    std::vector<T>().swap(scratch);
+
+    // merge the runs into a temporary file keeping the smallest head of each run at the top
+    auto greater = [&predicate, &runs, data](size_t a, size_t b) {
+      return predicate(data[runs[b].first], data[runs[a].first]);
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(greater)> heads(greater);
+    for (size_t i = 0; i < runs.size(); ++i) {
+      heads.push(i);
+    }
+    std::string merged_name = file_name + ".merge";
+    {
+      std::ofstream merged(merged_name, std::ios_base::binary | std::ios_base::trunc);
+      std::vector<T> merge_buffer;
+      merge_buffer.reserve(std::min(buffer_size, static_cast<size_t>(1024 * 1024 * 32 / sizeof(T))));
+      auto write = [&merged, &merge_buffer]() {
+        merged.write(static_cast<const char*>(static_cast<const void*>(merge_buffer.data())),
+                     merge_buffer.size() * sizeof(T));
+        merge_buffer.clear();
+      };
+      while (!heads.empty()) {
+        auto run = heads.top();
+        heads.pop();
+        merge_buffer.push_back(data[runs[run].first++]);
+        if (runs[run].first < runs[run].second) {
+          heads.push(run);
+        }
+        if (merge_buffer.size() == merge_buffer.capacity()) {
+          write();
+        }
+      }
+      write();
+      if (!merged) {
+        throw std::runtime_error(merged_name + ": " + strerror(errno));
+      }
+    }
+
+    // copy it back over the original
+    {
+      std::ifstream merged(merged_name, std::ios_base::binary);
+      if (!merged.read(static_cast<char*>(static_cast<void*>(data)), memmap.size() * sizeof(T))) {
+        throw std::runtime_error(merged_name + ": " + strerror(errno));
+      }
+    }
+    std::remove(merged_name.c_str());
   }
 
   // perform an volatile operation on all the items of this sequence
@@ -481,6 +548,70 @@ public:
   }
 
 protected:
+  // sort a range of elements by splitting it into one chunk per thread, sorting those in parallel
+  // and then merging pairs of them in parallel until only one is left. the scratch space is
+  // resized to hold as many elements as the range
+  static void sort_range(T* begin,
+                         T* end,
+                         const std::function<bool(const T&, const T&)>& predicate,
+                         unsigned int threads,
+                         std::vector<T>& scratch) {
+    // not worth spinning up threads for small ranges
+    constexpr size_t kMinChunkSize = 64 * 1024;
+    size_t count = end - begin;
+    size_t chunks = std::min(static_cast<size_t>(threads), count / kMinChunkSize);
+    if (chunks < 2) {
+      std::sort(begin, end, predicate);
+      return;
+    }
+
+    // sort each chunk
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= chunks; ++i) {
+      bounds.push_back(count * i / chunks);
+    }
+    std::list<std::thread> workers;
+    for (size_t i = 0; i < chunks; ++i) {
+      workers.emplace_back([begin, &bounds, &predicate, i]() {
+        std::sort(begin + bounds[i], begin + bounds[i + 1], predicate);
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+
+    // merge pairs of chunks back and forth between the range and the scratch space. the scratch
+    // space is filled by copying so that elements need not be default constructible
+    scratch.assign(begin, end);
+    T* source = begin;
+    T* target = scratch.data();
+    while (bounds.size() > 2) {
+      workers.clear();
+      std::vector<size_t> merged_bounds;
+      for (size_t i = 0; i + 1 < bounds.size(); i += 2) {
+        merged_bounds.push_back(bounds[i]);
+        // the odd one out is just copied over
+        if (i + 2 >= bounds.size()) {
+          std::copy(source + bounds[i], source + bounds[i + 1], target + bounds[i]);
+          continue;
+        }
+        workers.emplace_back([source, target, &bounds, &predicate, i]() {
+          std::merge(source + bounds[i], source + bounds[i + 1], source + bounds[i + 1],
+                     source + bounds[i + 2], target + bounds[i], predicate);
+        });
+      }
+      merged_bounds.push_back(count);
+      for (auto& worker : workers) {
+        worker.join();
+      }
+      bounds.swap(merged_bounds);
+      std::swap(source, target);
+    }
+    if (source != begin) {
+      std::copy(source, source + count, begin);
+    }
+  }
+
   std::shared_ptr<std::fstream> file;
   std::string file_name;
   std::vector<T> write_buffer;
@@ -551,7 +682,9 @@ struct tar {
     }
   };
 
-  tar(const std::string& tar_file, bool regular_files_only = true)
+  tar(const std::string& tar_file,
+      bool regular_files_only = true,
+      bool traverse_on_construction = true)
       : tar_file(tar_file), corrupt_blocks(0) {
     // get the file size
     struct stat s;
@@ -567,6 +700,21 @@ struct tar {
     // map the file
     mm.map(tar_file, s.st_size);
 
+    // find out whats in it unless the caller knows a faster way
+    if (traverse_on_construction) {
+      traverse(regular_files_only);
+    }
+  }
+
+  // the header of the first entry in the archive, if there is a valid one
+  const header_t* first() const {
+    const header_t* h = static_cast<const header_t*>(static_cast<const void*>(mm.get()));
+    return h->verify() ? h : nullptr;
+  }
+
+  void traverse(bool regular_files_only = true) {
+    contents.clear();
+    corrupt_blocks = 0;
     // rip through the tar to see whats in it noting that most tars end with 2 empty blocks
     // but we can concatenate tars and get empty blocks in between so we'll just be pretty
     // lax about it and we'll count the ones we cant make sense of
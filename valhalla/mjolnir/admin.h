@@ -2,13 +2,17 @@
 #define VALHALLA_MJOLNIR_ADMIN_H_
 
 #include <boost/geometry.hpp>
+#include <boost/geometry/geometries/box.hpp>
 #include <boost/geometry/geometries/point_xy.hpp>
 #include <boost/geometry/geometries/polygon.hpp>
 #include <boost/geometry/io/wkt/wkt.hpp>
+#include <boost/geometry/index/rtree.hpp>
 #include <boost/geometry/multi/geometries/multi_polygon.hpp>
 #include <cstdint>
+#include <functional>
 #include <sqlite3.h>
 #include <unordered_map>
+#include <vector>
 #include <valhalla/baldr/graphconstants.h>
 #include <valhalla/midgard/aabb2.h>
 #include <valhalla/midgard/pointll.h>
@@ -25,43 +29,200 @@ namespace mjolnir {
 typedef boost::geometry::model::d2::point_xy<double> point_type;
 typedef boost::geometry::model::polygon<point_type> polygon_type;
 typedef boost::geometry::model::multi_polygon<polygon_type> multi_polygon_type;
+typedef boost::geometry::model::box<point_type> box_type;
 
 /**
- * Get the dbhandle of a sqlite db.  Used for timezones and admins DBs.
- * @param  database   db file location.
+ * A polygon prepared for many point in polygon tests. A grid is laid over its bounding box and
+ * each cell lists the edges that pass through it. Whether the middle of each cell is inside is
+ * worked out once, so a point only has to be checked against the edges of its own cell: every
+ * edge between the point and the middle of the cell flips the answer. Cells without edges are
+ * entirely inside or outside. Polygons with only a few hundred edges are quicker to test as they
+ * are so they get no grid.
  */
-sqlite3* GetDBHandle(const std::string& database);
+class PreparedPolygon {
+public:
+  /**
+   * Lay the grid over the polygon.
+   * @param  polygon  the polygon including any holes
+   */
+  PreparedPolygon(const polygon_type& polygon);
+
+  /**
+   * Same as boost::geometry::covered_by, points on the boundary are covered.
+   * @param  p  point that needs to be checked
+   * @return true if the polygon covers the point
+   */
+  bool covers(const point_type& p) const;
+
+  /**
+   * @return the polygon
+   */
+  const polygon_type& polygon() const {
+    return polygon_;
+  }
+
+protected:
+  // what we know about the middle of a cell
+  enum class CellState : uint8_t { kOutside, kInside, kUnknown };
+
+  // the cell a point falls into, clamped to the grid
+  uint32_t cell(const point_type& p, uint32_t& column, uint32_t& row) const;
+  point_type center(const uint32_t column, const uint32_t row) const;
+
+  // flips the state once for each edge of the cell that crosses the segment from a to b. returns
+  // false if the segment touches an edge anywhere else, then counting crossings is no good
+  bool flip(const point_type& a, const point_type& b, const uint32_t cell, bool& state) const;
+
+  polygon_type polygon_;
+  box_type box_;
+  uint32_t columns_;
+  uint32_t rows_;
+  double cell_width_;
+  double cell_height_;
+  // the edges of all the rings
+  std::vector<std::pair<point_type, point_type>> edges_;
+  // the edges of a cell are cell_edges_ from cell_offsets_[cell] up to cell_offsets_[cell + 1]
+  std::vector<uint32_t> cell_offsets_;
+  std::vector<uint32_t> cell_edges_;
+  std::vector<CellState> cell_states_;
+};
+
+/**
+ * An in memory spatial index of polygons each of which is identified by an id. Multipolygons are
+ * split into their parts and the bounding box of every part goes into an rtree so that finding
+ * the polygons near a point or a tile does not have to test every polygon. The parts are kept
+ * as prepared polygons so testing a point only looks at the edges close to it. Once built the index
+ * is only ever read so it can be shared between threads.
+ */
+class PolygonIndex {
+public:
+  /**
+   * Add a polygon to the index. Polygons added after build() is called are not searchable until
+   * build() is called again.
+   * @param  id          the id to return for this polygon, must be non zero
+   * @param  multi_poly  the polygon
+   */
+  void add(const uint32_t id, const multi_polygon_type& multi_poly);
+
+  /**
+   * Pack all the polygons added so far into the rtree.
+   */
+  void build();
+
+  /**
+   * Get the ids of the polygons that intersect the bounding box.
+   * @param  aabb  the bounding box, typically that of a tile
+   * @return the unique ids of the intersecting polygons
+   */
+  std::vector<uint32_t> intersects(const AABB2<PointLL>& aabb) const;
+
+  /**
+   * Get the id of a polygon that covers the point.
+   * @param  ll      point that needs to be checked
+   * @param  accept  optionally restricts which polygon ids can be returned
+   * @return the id of the covering polygon or 0 if there is none
+   */
+  uint32_t covered_by(const PointLL& ll,
+                      const std::function<bool(uint32_t)>& accept = nullptr) const;
+
+  /**
+   * @return the number of polygon parts in the index
+   */
+  size_t size() const {
+    return parts_.size();
+  }
+
+  /**
+   * @return true if there are no polygons in the index
+   */
+  bool empty() const {
+    return parts_.empty();
+  }
+
+protected:
+  typedef std::pair<box_type, uint32_t> value_type;
+  typedef boost::geometry::index::rtree<value_type, boost::geometry::index::rstar<16>> rtree_type;
+
+  // the parts of all the polygons and the id each part belongs to
+  std::vector<std::pair<uint32_t, PreparedPolygon>> parts_;
+  // bounding boxes of the parts along with the index of the part
+  rtree_type rtree_;
+};
 
 /**
- * Get the polygon index.  Used by tz and admin areas.  Checks if the pointLL is covered_by the
- * poly.
- * @param  polys   unordered map of polys.
- * @param  ll      point that needs to be checked.
+ * The admin polygons of the whole admin db loaded into memory once. States (admin level 4) and
+ * countries (admin level 2) are kept in separate indexes because tiles only fall back to the
+ * countries when no state intersects them.
  */
-uint32_t GetMultiPolyId(const std::unordered_map<uint32_t, multi_polygon_type>& polys,
-                        const PointLL& ll);
+class AdminIndex {
+public:
+  /**
+   * Load all of the admins from the db and index them.
+   * @param  db_handle    sqlite3 db handle, if null the index is empty
+   */
+  AdminIndex(sqlite3* db_handle);
+
+  /**
+   * The admins that apply to a given tile.
+   */
+  struct TileAdmins {
+    // which of the indexes the admins came from
+    const PolygonIndex* polys = nullptr;
+    // admin id in the index to admin index in the tile
+    std::unordered_map<uint32_t, uint32_t> indexes;
+    // whether or not the admin (by tile admin index) drives on the right
+    std::unordered_map<uint32_t, bool> drive_on_right;
+
+    /**
+     * Get the tile admin index of the admin covering the point.
+     * @param  ll      point that needs to be checked
+     * @return the tile admin index or 0 if no admin of this tile covers the point
+     */
+    uint32_t GetAdminIndex(const PointLL& ll) const;
+  };
+
+  /**
+   * Add the admins intersecting the bounding box to the tile.
+   * @param  aabb             bb of the tile
+   * @param  tilebuilder      Graph tile builder
+   * @return the admins of the tile
+   */
+  TileAdmins AddAdmins(const AABB2<PointLL>& aabb, GraphTileBuilder& tilebuilder) const;
+
+  /**
+   * @return true if no admins were loaded
+   */
+  bool empty() const {
+    return info_.empty();
+  }
+
+protected:
+  struct admin_info_t {
+    std::string country_name;
+    std::string state_name;
+    std::string country_iso;
+    std::string state_iso;
+    bool drive_on_right;
+  };
+
+  // the attributes of the admins, the admin id is the position in here plus one
+  std::vector<admin_info_t> info_;
+  PolygonIndex states_;
+  PolygonIndex countries_;
+};
 
 /**
- * Get the timezone polys from the db
- * @param  db_handle    sqlite3 db handle
- * @param  aabb         bb of the tile
+ * Get the dbhandle of a sqlite db.  Used for timezones and admins DBs.
+ * @param  database   db file location.
  */
-std::unordered_map<uint32_t, multi_polygon_type> GetTimeZones(sqlite3* db_handle,
-                                                              const AABB2<PointLL>& aabb);
+sqlite3* GetDBHandle(const std::string& database);
 
 /**
- * Get the admin polys that intersect with the tile bounding box.
- * @param  db_handle        sqlite3 db handle
- * @param  drive_on_right   unordered map that indicates if a country drives on right side of the
- * road
- * @param  aabb             bb of the tile
- * @param  tilebuilder      Graph tile builder
+ * Load all of the timezone polys from the db into a spatial index. The ids of the polygons are
+ * the timezone indexes.
+ * @param  db_handle    sqlite3 db handle
  */
-std::unordered_map<uint32_t, multi_polygon_type>
-GetAdminInfo(sqlite3* db_handle,
-             std::unordered_map<uint32_t, bool>& drive_on_right,
-             const AABB2<PointLL>& aabb,
-             GraphTileBuilder& tilebuilder);
+PolygonIndex GetTimeZoneIndex(sqlite3* db_handle);
 
 /**
  * Get all the country access records from the db and save them to a map.
@@ -9,8 +9,11 @@ extern "C" {
 
 #include <valhalla/mjolnir/osmdata.h>
 
+#include <array>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 namespace valhalla {
 namespace mjolnir {
@@ -18,21 +21,64 @@ namespace mjolnir {
 using Tags = std::unordered_map<std::string, std::string>;
 
 /**
+ * Runs the tags of osm objects through the node, way and relation functions of a lua script.
+ * The script functions are expected to only depend on the tags they are given, and of their
+ * count only on whether it is 0. The script sees the tags through a table that records which
+ * of them it read and what it wrote, so the results are remembered per distinct set of values
+ * of the tags the script ever read. Names, refs and the like are rarely read so most objects
+ * share an entry even though their full tag sets are all different.
  */
 class LuaTagTransform {
 public:
   /**
    * Constructor
-   * @param lua   the string containing the lua code
+   * @param lua         the string containing the lua code
+   * @param cache_size  how many distinct tag sets to remember the results of per object type
    */
-  LuaTagTransform(const std::string& lua);
+  LuaTagTransform(const std::string& lua, size_t cache_size = 65536);
 
   ~LuaTagTransform();
 
   Tags Transform(OSMType type, const Tags& tags);
 
 protected:
+  // what a run of the script did to the tags it was given
+  struct Result {
+    bool filtered = false;
+    // the script returned a table of its own rather than the one it was given
+    bool replaced = false;
+    Tags written;
+    std::vector<std::string> deleted;
+  };
+
+  // the results remembered for one object type and the tags they are keyed on
+  struct Memo {
+    std::unordered_map<std::string, Result> cache;
+    // keys that missed once, the result is only remembered when they miss again
+    std::unordered_set<std::string> seen;
+    std::unordered_set<std::string> read_keys;
+    // the script iterated over the tags so every one of them is part of the key
+    bool read_all = false;
+    size_t hits = 0;
+    size_t misses = 0;
+  };
+
+  // run the tags through the lua script
+  Tags Evaluate(OSMType type, const Tags& tags);
+
+  // run the tags through the lua script keeping track of which ones it read
+  bool Record(OSMType type, const Tags& tags, Result& result, Memo& memo, bool& read_more);
+
+  // the values of the tags the script has read so far, sorted by key
+  void MakeKey(const Memo& memo, const Tags& tags);
+
   lua_State* state_;
+
+  // results of previous transforms, one memo per object type
+  size_t cache_size_;
+  std::array<Memo, 3> memos_;
+  std::string key_;
+  std::vector<const Tags::value_type*> sorted_;
 };
 
 } // namespace mjolnir
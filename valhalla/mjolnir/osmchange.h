@@ -0,0 +1,72 @@
+#ifndef VALHALLA_MJOLNIR_OSMCHANGE_H
+#define VALHALLA_MJOLNIR_OSMCHANGE_H
+
+#include <cstdint>
+#include <istream>
+#include <set>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include <valhalla/baldr/graphid.h>
+#include <valhalla/baldr/graphreader.h>
+#include <valhalla/midgard/pointll.h>
+
+namespace valhalla {
+namespace mjolnir {
+
+/**
+ * The objects touched by an OSM change file (.osc). Creates, modifies and deletes are not told
+ * apart since any of them means the tiles the object is in have to be rebuilt.
+ */
+struct OSMChange {
+  // ids of the nodes, ways and relations that were created, modified or deleted
+  std::unordered_set<uint64_t> nodes;
+  std::unordered_set<uint64_t> ways;
+  std::unordered_set<uint64_t> relations;
+  // locations of the changed nodes, deletes do not always come with one
+  std::vector<midgard::PointLL> locations;
+  // nodes the changed ways are made of and nodes and ways that are members of the changed
+  // relations. they did not change themselves but they tell us where the changed objects are
+  std::unordered_set<uint64_t> member_nodes;
+  std::unordered_set<uint64_t> member_ways;
+
+  /**
+   * Parse an osmChange xml document.
+   * @param  stream  the document
+   * @return the objects touched by the change
+   */
+  static OSMChange Parse(std::istream& stream);
+
+  /**
+   * Parse an osmChange xml file.
+   * @param  file_name  the .osc file
+   * @return the objects touched by the change
+   */
+  static OSMChange Parse(const std::string& file_name);
+};
+
+/**
+ * Work out which tiles have to be rebuilt because of a change. These are the local level tiles
+ * holding a changed node or an edge of a changed way, the tiles on the other hierarchy levels
+ * which those local tiles belong to and any transit tiles over them. Edges of changed ways and
+ * of the ways in changed relations are found by scanning the existing tiles so that ways whose
+ * nodes did not move are still caught. The old location of moved or deleted nodes, the ways
+ * through them and the location of the nodes that changed ways and relations are made of come
+ * from the ways and way nodes files of the last build when they are still around. This only
+ * finds the tiles, it does not rebuild them.
+ * @param  reader          graph reader over the current tiles
+ * @param  change          the objects touched by the change
+ * @param  ways_file       ways file of the last build, skipped if it does not exist
+ * @param  way_nodes_file  way nodes file of the last build, skipped if it does not exist
+ * @return the ids of the affected tiles, tiles that do not exist yet are included
+ */
+std::set<baldr::GraphId> AffectedTiles(baldr::GraphReader& reader,
+                                       const OSMChange& change,
+                                       const std::string& ways_file = "",
+                                       const std::string& way_nodes_file = "");
+
+} // namespace mjolnir
+} // namespace valhalla
+
+#endif // VALHALLA_MJOLNIR_OSMCHANGE_H
@@ -1,11 +1,14 @@
 #ifndef VALHALLA_MJOLNIR_OSMDATA_H
 #define VALHALLA_MJOLNIR_OSMDATA_H
 
+#include <algorithm>
 #include <cstdint>
 #include <map>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 #include <valhalla/mjolnir/osmaccessrestriction.h>
@@ -35,22 +38,256 @@ struct OSMLaneConnectivity {
   std::string from_lanes;
 };
 
-using RestrictionsMultiMap = std::unordered_multimap<uint64_t, OSMRestriction>;
+/**
+ * Values attached to osm ids kept in a flat array sorted by id, so that each entry costs no
+ * more than its id and value. The pbf files come sorted by id so values are added in order,
+ * when more than one file is parsed the ids start over and the array has to be sorted again
+ * before values can be found.
+ */
+template <class T>
+class OSMIdMap {
+public:
+  /**
+   * Constructor
+   * @param  keep_first  whether the first or the last value added for an id is kept
+   */
+  explicit OSMIdMap(bool keep_first = false) : keep_first_(keep_first) {
+  }
+
+  /**
+   * Set the value for an id. Only the value of the last id added can be replaced.
+   * @param  id     osm id
+   * @param  value  value for the id
+   * @return false if the id was the last one added and its first value is kept instead
+   */
+  bool set(const uint64_t id, const T& value) {
+    if (!entries_.empty() && id <= entries_.back().first) {
+      if (id == entries_.back().first) {
+        if (keep_first_) {
+          return false;
+        }
+        entries_.back().second = value;
+        return true;
+      }
+      sorted_ = false;
+    }
+    entries_.emplace_back(id, value);
+    return true;
+  }
+
+  /**
+   * Sort the entries by id, for ids that were added more than once only the first or the last
+   * value is kept.
+   */
+  void sort() {
+    if (!sorted_) {
+      std::stable_sort(entries_.begin(), entries_.end(),
+                       [](const entry_t& a, const entry_t& b) { return a.first < b.first; });
+      auto same = [](const entry_t& a, const entry_t& b) { return a.first == b.first; };
+      if (keep_first_) {
+        entries_.erase(std::unique(entries_.begin(), entries_.end(), same), entries_.end());
+      } else {
+        auto last = std::unique(entries_.rbegin(), entries_.rend(), same);
+        entries_.erase(entries_.begin(), last.base());
+      }
+      sorted_ = true;
+    }
+    entries_.shrink_to_fit();
+  }
+
+  /**
+   * Find the value of an id.
+   * @param  id  osm id
+   * @return the value or nullptr if the id has none
+   */
+  const T* find(const uint64_t id) const {
+    if (!sorted_) {
+      throw std::logic_error("OSMIdMap has to be sorted before finding values");
+    }
+    auto entry = std::lower_bound(entries_.cbegin(), entries_.cend(), id,
+                                  [](const entry_t& a, const uint64_t id) { return a.first < id; });
+    return entry == entries_.cend() || entry->first != id ? nullptr : &entry->second;
+  }
+
+  /**
+   * Get the value of an id.
+   * @param  id  osm id
+   * @return the value, throws std::out_of_range if the id has none
+   */
+  const T& at(const uint64_t id) const {
+    const T* value = find(id);
+    if (value == nullptr) {
+      throw std::out_of_range("No value for osm id " + std::to_string(id));
+    }
+    return *value;
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+protected:
+  using entry_t = std::pair<uint64_t, T>;
+  std::vector<entry_t> entries_;
+  bool sorted_ = true;
+  bool keep_first_;
+};
+
+/**
+ * Any number of values per osm id kept in a flat array sorted by id. These are filled from
+ * relations whose members come in no particular order so the array is sorted once it is full.
+ * Values for the same id stay in the order they were added.
+ */
+template <class T>
+class OSMIdMultiMap {
+public:
+  using value_type = std::pair<uint64_t, T>;
+  using const_iterator = typename std::vector<value_type>::const_iterator;
+
+  void insert(const value_type& value) {
+    if (!entries_.empty() && value.first < entries_.back().first) {
+      sorted_ = false;
+    }
+    entries_.push_back(value);
+  }
+
+  void sort() {
+    if (!sorted_) {
+      std::stable_sort(entries_.begin(), entries_.end(),
+                       [](const value_type& a, const value_type& b) { return a.first < b.first; });
+      sorted_ = true;
+    }
+    entries_.shrink_to_fit();
+  }
+
+  /**
+   * Find the values of an id.
+   * @param  id  osm id
+   * @return the range of values, both are end() if the id has none
+   */
+  std::pair<const_iterator, const_iterator> equal_range(const uint64_t id) const {
+    if (!sorted_) {
+      throw std::logic_error("OSMIdMultiMap has to be sorted before finding values");
+    }
+    auto lower =
+        std::lower_bound(entries_.cbegin(), entries_.cend(), id,
+                         [](const value_type& a, const uint64_t id) { return a.first < id; });
+    auto upper =
+        std::upper_bound(lower, entries_.cend(), id,
+                         [](const uint64_t id, const value_type& a) { return id < a.first; });
+    return lower == upper ? std::make_pair(entries_.cend(), entries_.cend())
+                          : std::make_pair(lower, upper);
+  }
+
+  const_iterator end() const {
+    return entries_.cend();
+  }
+
+  size_t size() const {
+    return entries_.size();
+  }
+
+protected:
+  std::vector<value_type> entries_;
+  bool sorted_ = true;
+};
+
+using RestrictionsMultiMap = OSMIdMultiMap<OSMRestriction>;
 
 using ViaSet = std::unordered_set<uint64_t>;
 
 using EndMap = std::unordered_multimap<uint64_t, uint64_t>;
 
-using AccessRestrictionsMultiMap = std::unordered_multimap<uint64_t, OSMAccessRestriction>;
+using AccessRestrictionsMultiMap = OSMIdMultiMap<OSMAccessRestriction>;
 
-using BikeMultiMap = std::unordered_multimap<uint64_t, OSMBike>;
+using BikeMultiMap = OSMIdMultiMap<OSMBike>;
 
-using OSMStringMap = std::unordered_map<uint64_t, std::string>;
+/**
+ * Strings attached to osm ids. Each distinct string is only kept once and the ids point at it
+ * so that common values like exit refs are not repeated for every node that has them.
+ */
+class OSMStringMap {
+public:
+  void set(const uint64_t id, const std::string& value) {
+    indexes_.set(id, strings_.index(value));
+  }
+
+  void sort() {
+    indexes_.sort();
+  }
+
+  const std::string& at(const uint64_t id) const {
+    return strings_.name(indexes_.at(id));
+  }
+
+  size_t size() const {
+    return indexes_.size();
+  }
+
+protected:
+  OSMIdMap<uint32_t> indexes_;
+  UniqueNames strings_;
+};
+
+using OSMShapeMap = OSMIdMap<PointLL>;
 
-using OSMShapeMap = std::unordered_map<uint64_t, PointLL>;
-using OSMWayMap = std::unordered_map<uint64_t, std::list<uint64_t>>;
+/**
+ * The node ids of osm ways, kept one after the other in a single array. When a way is added more
+ * than once its first nodes are kept.
+ */
+class OSMWayMap {
+public:
+  // the node ids of a way
+  struct Nodes {
+    const uint64_t* begin() const {
+      return begin_;
+    }
+    const uint64_t* end() const {
+      return end_;
+    }
+    const uint64_t* begin_;
+    const uint64_t* end_;
+  };
+
+  void set(const uint64_t id, const std::vector<uint64_t>& nodes) {
+    // a way that was just added keeps its first nodes so dont store these ones
+    if (ways_.set(id, std::make_pair(nodes_.size(), nodes.size()))) {
+      nodes_.insert(nodes_.end(), nodes.begin(), nodes.end());
+    }
+  }
+
+  void sort() {
+    ways_.sort();
+    nodes_.shrink_to_fit();
+  }
+
+  /**
+   * Find the nodes of a way.
+   * @param  id  osm way id
+   * @param  nodes  set to the nodes of the way if it was found
+   * @return true if the way was found
+   */
+  bool find(const uint64_t id, Nodes& nodes) const {
+    const auto* way = ways_.find(id);
+    if (way == nullptr) {
+      return false;
+    }
+    nodes.begin_ = nodes_.data() + way->first;
+    nodes.end_ = nodes.begin_ + way->second;
+    return true;
+  }
+
+  size_t size() const {
+    return ways_.size();
+  }
+
+protected:
+  // offset and count of the nodes of each way
+  OSMIdMap<std::pair<size_t, size_t>> ways_{true};
+  std::vector<uint64_t> nodes_;
+};
 
-using OSMLaneConnectivityMultiMap = std::unordered_multimap<uint64_t, OSMLaneConnectivity>;
+using OSMLaneConnectivityMultiMap = OSMIdMultiMap<OSMLaneConnectivity>;
 
 enum class OSMType : uint8_t { kNode, kWay, kRelation };
 
@@ -96,8 +333,8 @@ struct OSMData {
   // Map that stores all the name info on a node
   OSMStringMap node_name;
 
-  // Map that stores an updated ref for a way
-  OSMStringMap way_ref;
+  // Updated refs for a way, one per relation with a direction that the way is a member of
+  OSMIdMultiMap<std::string> way_ref;
 
   // References
   UniqueNames ref_offset_map;
@@ -111,8 +348,8 @@ struct OSMData {
   // Backward turn lane strings
   UniqueNames bwd_turn_lanes_map;
 
-  // Map used in admins to store the shape of the nodes.
-  OSMShapeMap shape_map;
+  // Map used in admins to store the shape of the nodes, the first location of a node is kept
+  OSMShapeMap shape_map{true};
 
   // Map used in admins to store the ways.
   OSMWayMap way_map;
@@ -2,6 +2,7 @@
 #define VALHALLA_MJOLNIR_UTIL_H_
 
 #include <boost/property_tree/ptree.hpp>
+#include <cstdint>
 #include <list>
 #include <string>
 #include <valhalla/midgard/pointll.h>
@@ -10,6 +11,35 @@
 namespace valhalla {
 namespace mjolnir {
 
+/**
+ * The stages of building a tile set, in the order they run. Every stage after initialize
+ * works on the tiles in the tile_dir so a build can be resumed from the stage that failed.
+ */
+enum class BuildStage : int8_t {
+  kInvalid = -1,
+  kInitialize = 0, // parse the osm data and build the local level tiles
+  kEnhance = 1,
+  kTransit = 2,
+  kHierarchy = 3,
+  kShortcuts = 4,
+  kRestrictions = 5,
+  kValidate = 6
+};
+
+/**
+ * Get the name of a build stage.
+ * @param  stage  build stage
+ * @return the name of the stage
+ */
+std::string to_string(BuildStage stage);
+
+/**
+ * Get a build stage from its name.
+ * @param  name  name of the stage
+ * @return the stage or BuildStage::kInvalid if there is no stage with that name
+ */
+BuildStage string_to_buildstage(const std::string& name);
+
 /**
  * Splits a tag into a vector of strings.
  * @param  tag_value  tag to split
@@ -34,18 +64,26 @@ std::string remove_double_quotes(const std::string& s);
 uint32_t compute_curvature(const std::list<midgard::PointLL>& shape);
 
 /**
- * Build an entire valhalla tileset give a config file and some input pbfs
+ * Build an entire valhalla tileset give a config file and some input pbfs. Each stage is
+ * recorded in a checkpoint file in the tile_dir when it starts and when it completes, along with
+ * checksums of the flat files the later stages need, so that a build stopped between stages can be
+ * resumed without parsing the osm data again. The stages after initialize work on a copy of the
+ * tiles that replaces them once the stage is done, so a stage that was stopped can be run again.
  * @param config              used to tell the function where and how to build the tiles
  * @param input_files         tells what osm pbf files to build the tiles from
  * @param bin_file_prefix     name prefix for mmapped flat files used when parsing the osm pbf
  * @param free_protobuf       whether or not to unload the protobuffer lib, you cant use libpbf
  * after doing this
+ * @param start_stage         stage to start at, it must follow the last completed stage
+ * @param end_stage           last stage to run
  *
  */
 void build_tile_set(const boost::property_tree::ptree& config,
                     const std::vector<std::string>& input_files,
                     const std::string& bin_file_prefix = "",
-                    bool free_protobuf = true);
+                    bool free_protobuf = true,
+                    BuildStage start_stage = BuildStage::kInitialize,
+                    BuildStage end_stage = BuildStage::kValidate);
 
 } // namespace mjolnir
 } // namespace valhalla
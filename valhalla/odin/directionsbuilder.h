@@ -21,7 +21,7 @@ public:
   DirectionsBuilder();
 
   /**
-   * Returns the trip directions based on the specified directions options
+   * Fills in the trip directions based on the specified directions options
    * and trip path. This method calls ManeuversBuilder::Build and
    * NarrativeBuilder::Build to form the maneuver list. This method
    * calls PopulateTripDirections to transform the maneuver list into the
@@ -30,8 +30,12 @@ public:
    * @param directions_options The directions options such as: units and
    *                           language.
    * @param trip_path The trip path - list of nodes, edges, attributes and shape.
+   * @param trip_directions The trip directions to fill, they may be allocated
+   *                        on an arena in which case so are their maneuvers.
    */
-  TripDirections Build(const DirectionsOptions& directions_options, TripPath& trip_path);
+  void Build(const DirectionsOptions& directions_options,
+             TripPath& trip_path,
+             TripDirections& trip_directions);
 
 protected:
   /**
@@ -42,18 +46,19 @@ protected:
   void UpdateHeading(EnhancedTripPath* etp);
 
   /**
-   * Returns the trip directions based on the specified directions options,
+   * Populates the trip directions based on the specified directions options,
    * trip path, and maneuver list.
    * @param directions_options The directions options such as: units and
    *                           language.
    * @param etp The enhanced trip path - list of nodes, edges, attributes and shape.
    * @param maneuvers the maneuver list that contains the information required
    *                  to populate the trip directions.
-   * @returns the trip directions.
+   * @param trip_directions the trip directions to populate.
    */
-  TripDirections PopulateTripDirections(const DirectionsOptions& directions_options,
-                                        EnhancedTripPath* etp,
-                                        std::list<Maneuver>& maneuvers);
+  void PopulateTripDirections(const DirectionsOptions& directions_options,
+                              EnhancedTripPath* etp,
+                              std::list<Maneuver>& maneuvers,
+                              TripDirections& trip_directions);
 };
 
 } // namespace odin
@@ -24,8 +24,14 @@ public:
 #endif
   virtual void cleanup() override;
 
-  std::list<TripDirections> narrate(const valhalla_request_t& request,
-                                    std::list<TripPath>& legs) const;
+  // narrates each leg into the directions given, which should be allocated on the caller's arena
+  void narrate(const valhalla_request_t& request,
+               google::protobuf::RepeatedPtrField<TripPath>& legs,
+               google::protobuf::RepeatedPtrField<TripDirections>& narrated) const;
+
+protected:
+  // holds the legs and directions of the request being worked on, reset after each request
+  google::protobuf::Arena arena;
 };
 } // namespace odin
 } // namespace valhalla
@@ -269,7 +269,7 @@ public:
         (!forward && (edge->start_restriction() & access_mode()))) {
       // Get complex restrictions. Return false if no restrictions are found
       auto restrictions = tile->GetRestrictions(forward, edgeid, access_mode());
-      if (restrictions.size() == 0) {
+      if (restrictions.empty()) {
         return false;
       }
 
@@ -330,13 +330,7 @@ public:
   bool IsRestricted(const uint64_t restriction,
                     const uint64_t current_time,
                     const uint32_t tz_index) const {
-
-    baldr::TimeDomain td(restriction);
-    return baldr::DateTime::is_restricted(td.type(), td.begin_hrs(), td.begin_mins(), td.end_hrs(),
-                                          td.end_mins(), td.dow(), td.begin_week(), td.begin_month(),
-                                          td.begin_day_dow(), td.end_week(), td.end_month(),
-                                          td.end_day_dow(), current_time,
-                                          baldr::DateTime::get_tz_db().from_index(tz_index));
+    return time_domains_.is_restricted(restriction, current_time, tz_index);
   }
 
   /**
@@ -498,6 +492,9 @@ protected:
 
   // User specified edges to avoid
   std::unordered_set<baldr::GraphId> user_avoid_edges_;
+
+  // When the time domains of timed restrictions are in effect, remembered for this request
+  mutable baldr::TimeDomainCache time_domains_;
 };
 
 typedef std::shared_ptr<DynamicCost> cost_ptr_t;
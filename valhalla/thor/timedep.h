@@ -41,10 +41,22 @@ public:
                                             const std::shared_ptr<sif::DynamicCost>* mode_costing,
                                             const sif::TravelMode mode);
 
+  /**
+   * Set whether the search remembers the predicted speeds it decodes. This is on by default.
+   * @param  use_speed_memo  true to memoize predicted speeds during each search.
+   */
+  void set_speed_memo(const bool use_speed_memo) {
+    use_speed_memo_ = use_speed_memo;
+  }
+
 protected:
   uint32_t origin_tz_index_;
   uint32_t seconds_of_week_;
 
+  // Predicted speeds decoded so far in the current search, keyed by edge and 5 minute bucket
+  bool use_speed_memo_;
+  baldr::PredictedSpeedMemo speed_memo_;
+
   /**
    * Expand from the node along the forward search path. Immediately expands
    * from the end node of any transition edge (so no transition edges are added
@@ -116,10 +128,22 @@ public:
                                             const std::shared_ptr<sif::DynamicCost>* mode_costing,
                                             const sif::TravelMode mode);
 
+  /**
+   * Set whether the search remembers the predicted speeds it decodes. This is on by default.
+   * @param  use_speed_memo  true to memoize predicted speeds during each search.
+   */
+  void set_speed_memo(const bool use_speed_memo) {
+    use_speed_memo_ = use_speed_memo;
+  }
+
 protected:
   uint32_t dest_tz_index_;
   uint32_t seconds_of_week_;
 
+  // Predicted speeds decoded so far in the current search, keyed by edge and 5 minute bucket
+  bool use_speed_memo_;
+  baldr::PredictedSpeedMemo speed_memo_;
+
   // Access mode used by the costing method
   uint32_t access_mode_;
 
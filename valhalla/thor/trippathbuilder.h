@@ -35,10 +35,12 @@ public:
   virtual ~TripPathBuilder();
 
   /**
-   * Format the trip path output given the edges on the path.
-   * For now just return length. TODO - modify to return trip path.
+   * Format the trip path output given the edges on the path. The trip path is filled in place
+   * rather than returned so that callers can allocate it, and all of its nodes and edges, on
+   * a protobuf arena.
+   * @param  trip_path  Trip path to fill, it is cleared first
    */
-  static odin::TripPath
+  static void
   Build(const AttributesController& controller,
         baldr::GraphReader& graphreader,
         const std::shared_ptr<sif::DynamicCost>* mode_costing,
@@ -46,6 +48,7 @@ public:
         odin::Location& origin,
         odin::Location& dest,
         const std::list<odin::Location>& through_loc,
+        odin::TripPath& trip_path,
         const std::function<void()>* interrupt_callback = nullptr,
         std::unordered_map<size_t, std::pair<RouteDiscontinuity, RouteDiscontinuity>>*
             route_discontinuities = nullptr);
@@ -1,10 +1,12 @@
 #ifndef __VALHALLA_THOR_SERVICE_H__
 #define __VALHALLA_THOR_SERVICE_H__
 
+#include <chrono>
 #include <cstdint>
 #include <tuple>
 #include <vector>
 
+#include <boost/optional.hpp>
 #include <boost/property_tree/ptree.hpp>
 
 #include <valhalla/baldr/directededge.h>
@@ -48,13 +50,24 @@ public:
 #endif
   virtual void cleanup() override;
 
-  std::list<odin::TripPath> route(valhalla_request_t& request);
+  // the trip paths are added to the legs given, which should be allocated on the caller's arena
+  // so that the many nodes and edges of the paths are too
+  void route(valhalla_request_t& request, google::protobuf::RepeatedPtrField<odin::TripPath>& legs);
   std::string matrix(valhalla_request_t& request);
-  std::list<odin::TripPath> optimized_route(valhalla_request_t& request);
+  void optimized_route(valhalla_request_t& request,
+                       google::protobuf::RepeatedPtrField<odin::TripPath>& legs);
   std::string isochrones(valhalla_request_t& request);
-  odin::TripPath trace_route(valhalla_request_t& request);
+  void trace_route(valhalla_request_t& request, odin::TripPath& trip_path);
   std::string trace_attributes(valhalla_request_t& request);
 
+  // does thor's part of the request. matrices, isochrones and trace attributes are answered with
+  // json while routes leave their paths in the legs for odin to narrate and get nothing back
+  boost::optional<std::string> act(valhalla_request_t& request,
+                                   google::protobuf::RepeatedPtrField<odin::TripPath>& legs);
+  // logs the request if thor took longer on it than the long request threshold allows
+  void log_request(const valhalla_request_t& request,
+                   const std::chrono::system_clock::time_point& start) const;
+
 protected:
   std::vector<thor::PathInfo> get_path(PathAlgorithm* path_algorithm,
                                        odin::Location& origin,
@@ -66,18 +79,20 @@ protected:
   thor::PathAlgorithm* get_path_algorithm(const std::string& routetype,
                                           const odin::Location& origin,
                                           const odin::Location& destination);
-  odin::TripPath route_match(valhalla_request_t& request, const AttributesController& controller);
+  void route_match(valhalla_request_t& request,
+                   const AttributesController& controller,
+                   odin::TripPath& trip_path);
   std::vector<std::tuple<float, float, std::vector<thor::MatchResult>, odin::TripPath>>
   map_match(valhalla_request_t& request,
             const AttributesController& controller,
             uint32_t best_paths = 1);
 
-  std::list<odin::TripPath>
-  path_arrive_by(google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
-                 const std::string& costing);
-  std::list<odin::TripPath>
-  path_depart_at(google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
-                 const std::string& costing);
+  void path_arrive_by(google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
+                      const std::string& costing,
+                      google::protobuf::RepeatedPtrField<odin::TripPath>& legs);
+  void path_depart_at(google::protobuf::RepeatedPtrField<valhalla::odin::Location>& correlated,
+                      const std::string& costing,
+                      google::protobuf::RepeatedPtrField<odin::TripPath>& legs);
 
   void parse_locations(valhalla_request_t& request);
   void parse_measurements(const valhalla_request_t& request);
@@ -101,6 +116,8 @@ protected:
   SOURCE_TO_TARGET_ALGORITHM source_to_target_algorithm;
   meili::MapMatcherFactory matcher_factory;
   std::shared_ptr<baldr::GraphReader> reader;
+  // holds the trip paths of the request being worked on, reset after each request
+  google::protobuf::Arena arena;
 };
 
 } // namespace thor
@@ -8,6 +8,16 @@
 namespace valhalla {
 namespace tyr {
 
+#ifdef HAVE_HTTP
+/**
+ * Serves requests from the http server by running loki, thor and odin one after the other on
+ * the same thread. Unlike the pipeline of separate loki, thor and odin workers the request is
+ * parsed once and passed along by reference instead of being serialized between the stages.
+ * @param  config  Configuration, requests are taken from loki's proxy
+ */
+void run_service(const boost::property_tree::ptree& config);
+#endif
+
 class actor_t {
 public:
   actor_t(const boost::property_tree::ptree& config, bool auto_cleanup = false);
@@ -16,6 +26,8 @@ public:
                     const std::function<void()>& interrupt = []() -> void {});
   std::string locate(const std::string& request_str,
                      const std::function<void()>& interrupt = []() -> void {});
+  std::string bulk_locate(const std::string& request_str,
+                          const std::function<void()>& interrupt = []() -> void {});
   std::string matrix(const std::string& request_str,
                      const std::function<void()>& interrupt = []() -> void {});
   std::string optimized_route(const std::string& request_str,
@@ -26,9 +26,10 @@ namespace tyr {
 /**
  * Turn path and directions into a route that one can follow
  */
-std::string serializeDirections(const valhalla_request_t& request,
-                                const std::list<odin::TripPath>& path_legs,
-                                const std::list<odin::TripDirections>& directions_legs);
+std::string serializeDirections(
+    const valhalla_request_t& request,
+    const google::protobuf::RepeatedPtrField<odin::TripPath>& path_legs,
+    const google::protobuf::RepeatedPtrField<odin::TripDirections>& directions_legs);
 
 /**
  * Turn a time distance matrix into json that one can look up location pair results from
@@ -76,6 +77,22 @@ serializeLocate(const valhalla_request_t& request,
                 const std::unordered_map<baldr::Location, baldr::PathLocation>& projections,
                 baldr::GraphReader& reader);
 
+/**
+ * Write out the info about a single correlated point, the same as one entry of the
+ * locate response. Used to stream the response of a bulk locate
+ *
+ * @param request      The original request
+ * @param location     The input location
+ * @param projection   The correlated location or nullptr if it couldn't be correlated
+ * @param reader       A graph reader to get at the correlated points info
+ * @param stream       Where to write the json to
+ */
+void serializeLocation(const valhalla_request_t& request,
+                       const baldr::Location& location,
+                       const baldr::PathLocation* projection,
+                       baldr::GraphReader& reader,
+                       std::ostream& stream);
+
 /**
  * Turn a list of locations into a list of locations with a bool that says whether transit tiles are
  * near by